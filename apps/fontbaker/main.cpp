@@ -0,0 +1,75 @@
+/*
+-------------------------------------------------------------------------------
+Name:
+	Font Baker
+
+Description:
+	Bakes a TrueType font into a baked font asset (See final_fontloader.h), which contains the atlas bitmap, the glyph metrics and the kerning pairs.
+	A baked font is loaded with LoadFontFromBakedFile() or LoadFontFromBakedMemory() without any rasterization.
+	Use the staticdatamaker to embed the baked font as a static array.
+
+	Usage: fontbaker <ttf file> <output file> [font size] [first char] [last char] [atlas width] [atlas height] [kerning 0/1]
+
+License:
+	Copyright (c) 2017-2025 Torsten Spaete
+	MIT License (See LICENSE file)
+-------------------------------------------------------------------------------
+*/
+
+#define FPL_IMPLEMENTATION
+#define FPL_NO_WINDOW
+#define FPL_NO_VIDEO
+#define FPL_NO_AUDIO
+#include <final_platform_layer.h>
+
+#define FINAL_FONTLOADER_IMPLEMENTATION
+#include <final_fontloader.h>
+
+static int32_t GetArgument(const int argc, char **argv, const int index, const int32_t defaultValue) {
+	int32_t result = defaultValue;
+	if(index < argc) {
+		result = fplStringToS32(argv[index]);
+	}
+	return(result);
+}
+
+int main(int argc, char **argv) {
+	if(argc < 3) {
+		fplConsoleFormatOut("Usage: %s <ttf file> <output file> [font size] [first char] [last char] [atlas width] [atlas height] [kerning 0/1]\n", argv[0]);
+		return(-1);
+	}
+
+	const char *inputFilePath = argv[1];
+	const char *outputFilePath = argv[2];
+	int32_t fontSize = GetArgument(argc, argv, 3, 36);
+	int32_t firstChar = GetArgument(argc, argv, 4, 32);
+	int32_t lastChar = GetArgument(argc, argv, 5, 128);
+	int32_t atlasWidth = GetArgument(argc, argv, 6, 512);
+	int32_t atlasHeight = GetArgument(argc, argv, 7, 512);
+	bool loadKerning = GetArgument(argc, argv, 8, 1) != 0;
+	if(fontSize <= 0 || firstChar < 0 || lastChar <= firstChar || atlasWidth <= 0 || atlasHeight <= 0) {
+		fplConsoleFormatError("Invalid arguments!\n");
+		return(-1);
+	}
+
+	if(!fplPlatformInit(fplInitFlags_None, fpl_null)) {
+		return(-1);
+	}
+
+	int result = -1;
+	LoadedFont font;
+	if(LoadFontFromFile(fpl_null, inputFilePath, 0, (float)fontSize, (uint32_t)firstChar, (uint32_t)lastChar, (uint32_t)atlasWidth, (uint32_t)atlasHeight, loadKerning, &font)) {
+		if(SaveBakedFont(&font, outputFilePath)) {
+			fplConsoleFormatOut("Baked font '%s' with %u glyphs and %u kerning pairs into '%s' (%zu bytes)\n", inputFilePath, font.charCount, font.kerningTable.count, outputFilePath, GetBakedFontSize(&font));
+			result = 0;
+		} else {
+			fplConsoleFormatError("Failed writing baked font '%s'!\n", outputFilePath);
+		}
+		ReleaseFont(&font);
+	} else {
+		fplConsoleFormatError("Failed loading font '%s'!\n", inputFilePath);
+	}
+
+	fplPlatformRelease();
+	return(result);
+}
@@ -13,6 +13,13 @@ Author:
 	Torsten Spaete
 
 Changelog:
+	## 2026-10-18
+	- Added tests for pushing on the current block and for fmemPool
+	- Added benchmark for fmemPool vs malloc
+	- Added tests for concurrent blocks and sub arenas
+	- Added tests for virtual blocks
+	- Added multi-threaded test for concurrent blocks
+
 	## 2018-06-29
 	- Initial version
 -------------------------------------------------------------------------------
@@ -21,6 +28,16 @@ Changelog:
 #define FMEM_IMPLEMENTATION
 #include <final_memory.h>
 
+#include <stdio.h> // printf
+#include <stdlib.h> // malloc, free
+#include <time.h> // clock
+
+#if defined(_WIN32)
+#	include <windows.h> // CreateThread, WaitForSingleObject
+#else
+#	include <pthread.h> // pthread_create, pthread_join
+#endif
+
 #define fmemAlwaysAssert(exp) if(!(exp)) {*(int *)0 = 0;}
 
 static void TestTemporary() {
@@ -140,6 +157,344 @@ static void TestGrowMiddle() {
 	fmemFree(&mainBlock);
 }
 
+static void TestGrowCurrent() {
+	fmemMemoryBlock block;
+	fmemAlwaysAssert(fmemInit(&block, fmemType_Growable, 4096));
+	size_t firstSize = block.size;
+
+	// Fills the first block and appends a second one
+	uint8_t *first = fmemPush(&block, firstSize - 16, fmemPushFlags_None);
+	fmemAlwaysAssert(first == (uint8_t *)block.base && block.current == fmem_null);
+	uint8_t *second = fmemPush(&block, 64, fmemPushFlags_None);
+	fmemAlwaysAssert(second != fmem_null && block.current != fmem_null);
+	fmemAlwaysAssert(block.current->base == second && block.current->used == 64);
+
+	// Fits into the current (second) block
+	uint8_t *third = fmemPush(&block, 64, fmemPushFlags_None);
+	fmemAlwaysAssert(third == second + 64);
+
+	// Reset starts pushing on the first block again
+	fmemReset(&block);
+	fmemAlwaysAssert(block.current == fmem_null);
+	fmemAlwaysAssert(fmemPush(&block, 16, fmemPushFlags_None) == (uint8_t *)block.base);
+
+	fmemFree(&block);
+}
+
+typedef struct TestPoolItem {
+	uint64_t id;
+	float values[5];
+} TestPoolItem;
+
+static void TestPool() {
+	fmemPool pool;
+	fmemAlwaysAssert(!fmemPoolInit(&pool, 0, 16));
+	fmemAlwaysAssert(fmemPoolInitStruct(&pool, TestPoolItem, 16));
+	fmemAlwaysAssert(pool.itemSize >= sizeof(TestPoolItem) && (pool.itemSize % sizeof(void *)) == 0);
+
+	TestPoolItem *items[40];
+	for(size_t i = 0; i < 40; ++i) {
+		items[i] = fmemPoolPushStruct(&pool, TestPoolItem, fmemPushFlags_Clear);
+		fmemAlwaysAssert(items[i] != fmem_null && items[i]->id == 0);
+		items[i]->id = i;
+	}
+	fmemAlwaysAssert(pool.usedCount == 40);
+	for(size_t i = 0; i < 40; ++i) {
+		fmemAlwaysAssert(items[i]->id == i);
+	}
+
+	// Released items are reused in reverse order
+	fmemPoolRelease(&pool, items[3]);
+	fmemPoolRelease(&pool, items[17]);
+	fmemAlwaysAssert(pool.usedCount == 38);
+	fmemAlwaysAssert(fmemPoolPush(&pool, fmemPushFlags_None) == items[17]);
+	fmemAlwaysAssert(fmemPoolPush(&pool, fmemPushFlags_None) == items[3]);
+	fmemAlwaysAssert(pool.usedCount == 40);
+
+	fmemPoolFree(&pool);
+	fmemAlwaysAssert(pool.itemSize == 0 && pool.firstFree == fmem_null);
+}
+
+static void TestConcurrent() {
+	fmemMemoryBlock block;
+	fmemAlwaysAssert(!fmemInit(&block, fmemType_Concurrent, 0));
+	fmemAlwaysAssert(fmemInit(&block, fmemType_Concurrent, 4096));
+	size_t firstSize = block.size;
+
+	uint8_t *first = fmemPush(&block, firstSize, fmemPushFlags_None);
+	fmemAlwaysAssert(first == (uint8_t *)block.base && block.used == firstSize);
+
+	// Switches to a new block
+	uint8_t *second = fmemPush(&block, 64, fmemPushFlags_Clear);
+	fmemAlwaysAssert(second != fmem_null && block.current != fmem_null && block.current->base == second);
+	fmemMemoryBlock *secondBlock = block.current;
+
+	// Bigger than any block
+	uint8_t *big = fmemPush(&block, firstSize * 4, fmemPushFlags_None);
+	fmemAlwaysAssert(big != fmem_null && block.current != secondBlock);
+	fmemAlwaysAssert(fmemGetTotalSize(&block) >= firstSize * 6);
+
+	// After reset, the appended blocks are used again in order without allocating
+	size_t totalSize = fmemGetTotalSize(&block);
+	fmemReset(&block);
+	fmemAlwaysAssert(block.current == fmem_null && block.used == 0);
+	fmemAlwaysAssert(fmemPush(&block, firstSize, fmemPushFlags_None) == first);
+	fmemAlwaysAssert(fmemPush(&block, 64, fmemPushFlags_None) == second);
+	fmemAlwaysAssert(fmemGetTotalSize(&block) == totalSize);
+
+	fmemMemoryBlock temp;
+	fmemAlwaysAssert(!fmemBeginTemporary(&block, &temp));
+
+	fmemFree(&block);
+}
+
+#define CONCURRENT_THREAD_COUNT 8
+#define CONCURRENT_PUSH_COUNT 4096
+
+typedef struct ConcurrentRange {
+	uint8_t *data;
+	size_t size;
+} ConcurrentRange;
+
+typedef struct ConcurrentThreadData {
+	fmemMemoryBlock *block;
+	ConcurrentRange ranges[CONCURRENT_PUSH_COUNT];
+	size_t pushedSize;
+	uint8_t tag;
+} ConcurrentThreadData;
+
+// Pushes differently sized ranges and fills each range with the tag of the thread
+static void PushConcurrentRanges(ConcurrentThreadData *data) {
+	for(size_t i = 0; i < CONCURRENT_PUSH_COUNT; ++i) {
+		size_t size = 8 + (i % 13) * 8;
+		uint8_t *ptr = fmemPush(data->block, size, fmemPushFlags_None);
+		fmemAlwaysAssert(ptr != fmem_null);
+		FMEM_MEMSET(ptr, data->tag, size);
+		data->ranges[i].data = ptr;
+		data->ranges[i].size = size;
+		data->pushedSize += size;
+	}
+}
+
+#if defined(_WIN32)
+static DWORD WINAPI ConcurrentThreadProc(LPVOID userData) {
+	PushConcurrentRanges((ConcurrentThreadData *)userData);
+	return(0);
+}
+#else
+static void *ConcurrentThreadProc(void *userData) {
+	PushConcurrentRanges((ConcurrentThreadData *)userData);
+	return(fmem_null);
+}
+#endif
+
+static int CompareConcurrentRanges(const void *a, const void *b) {
+	const ConcurrentRange *rangeA = (const ConcurrentRange *)a;
+	const ConcurrentRange *rangeB = (const ConcurrentRange *)b;
+	if(rangeA->data < rangeB->data) {
+		return(-1);
+	}
+	return(rangeA->data > rangeB->data ? 1 : 0);
+}
+
+static void TestConcurrentThreads() {
+	// Small blocks, so the threads are racing for switching to the next block as well
+	fmemMemoryBlock block;
+	fmemAlwaysAssert(fmemInit(&block, fmemType_Concurrent, 4096));
+
+	ConcurrentThreadData *threadData = (ConcurrentThreadData *)malloc(sizeof(ConcurrentThreadData) * CONCURRENT_THREAD_COUNT);
+	fmemAlwaysAssert(threadData != fmem_null);
+	for(int i = 0; i < CONCURRENT_THREAD_COUNT; ++i) {
+		FMEM_MEMSET(&threadData[i], 0, sizeof(threadData[i]));
+		threadData[i].block = &block;
+		threadData[i].tag = (uint8_t)(i + 1);
+	}
+
+#if defined(_WIN32)
+	HANDLE threads[CONCURRENT_THREAD_COUNT];
+	for(int i = 0; i < CONCURRENT_THREAD_COUNT; ++i) {
+		threads[i] = CreateThread(fmem_null, 0, ConcurrentThreadProc, &threadData[i], 0, fmem_null);
+		fmemAlwaysAssert(threads[i] != fmem_null);
+	}
+	for(int i = 0; i < CONCURRENT_THREAD_COUNT; ++i) {
+		WaitForSingleObject(threads[i], INFINITE);
+		CloseHandle(threads[i]);
+	}
+#else
+	pthread_t threads[CONCURRENT_THREAD_COUNT];
+	for(int i = 0; i < CONCURRENT_THREAD_COUNT; ++i) {
+		fmemAlwaysAssert(pthread_create(&threads[i], fmem_null, ConcurrentThreadProc, &threadData[i]) == 0);
+	}
+	for(int i = 0; i < CONCURRENT_THREAD_COUNT; ++i) {
+		pthread_join(threads[i], fmem_null);
+	}
+#endif
+
+	// No range was overwritten by another thread
+	size_t rangeCount = CONCURRENT_THREAD_COUNT * CONCURRENT_PUSH_COUNT;
+	ConcurrentRange *ranges = (ConcurrentRange *)malloc(sizeof(ConcurrentRange) * rangeCount);
+	fmemAlwaysAssert(ranges != fmem_null);
+	size_t pushedSize = 0;
+	for(int i = 0; i < CONCURRENT_THREAD_COUNT; ++i) {
+		for(size_t j = 0; j < CONCURRENT_PUSH_COUNT; ++j) {
+			ConcurrentRange *range = &threadData[i].ranges[j];
+			for(size_t k = 0; k < range->size; ++k) {
+				fmemAlwaysAssert(range->data[k] == threadData[i].tag);
+			}
+			ranges[i * CONCURRENT_PUSH_COUNT + j] = *range;
+		}
+		pushedSize += threadData[i].pushedSize;
+	}
+
+	// Ranges do not overlap
+	qsort(ranges, rangeCount, sizeof(ConcurrentRange), CompareConcurrentRanges);
+	for(size_t i = 1; i < rangeCount; ++i) {
+		fmemAlwaysAssert(ranges[i - 1].data + ranges[i - 1].size <= ranges[i].data);
+	}
+
+	// Nothing is lost or counted twice, the used size of all blocks is exactly the pushed size
+	size_t totalUsed = 0;
+	fmemMemoryBlock *current = &block;
+	while(current != fmem_null) {
+		totalUsed += current->used;
+		fmemBlockHeader *header = FMEM__GETHEADER(current);
+		current = header->next;
+	}
+	fmemAlwaysAssert(totalUsed == pushedSize);
+
+	free(ranges);
+	free(threadData);
+	fmemFree(&block);
+}
+
+static void TestSubArena() {
+	fmemMemoryBlock parent;
+	fmemAlwaysAssert(fmemInit(&parent, fmemType_Concurrent, FMEM_KILOBYTES(64)));
+
+	fmemMemoryBlock arena;
+	fmemAlwaysAssert(!fmemInit(&arena, fmemType_SubArena, 1024));
+
+	// Only concurrent blocks can be shared between threads
+	fmemMemoryBlock growable;
+	fmemAlwaysAssert(fmemInit(&growable, fmemType_Growable, 1024));
+	fmemAlwaysAssert(!fmemInitSubArena(&arena, &growable, 1024));
+	fmemFree(&growable);
+
+	fmemAlwaysAssert(fmemInitSubArena(&arena, &parent, 1024));
+	fmemAlwaysAssert(arena.base == fmem_null && parent.used == 0);
+
+	// First chunk
+	uint8_t *a = fmemPush(&arena, 512, fmemPushFlags_None);
+	fmemAlwaysAssert(a == (uint8_t *)parent.base && parent.used == 1024);
+	uint8_t *b = fmemPush(&arena, 512, fmemPushFlags_None);
+	fmemAlwaysAssert(b == a + 512);
+
+	// Next chunk, sized for the push
+	uint8_t *c = fmemPush(&arena, 2048, fmemPushFlags_Clear);
+	fmemAlwaysAssert(c == (uint8_t *)parent.base + 1024 && parent.used == 3072);
+	fmemAlwaysAssert(arena.size == 2048 && arena.used == 2048);
+
+	// Frame end
+	fmemReset(&arena);
+	fmemReset(&parent);
+	fmemAlwaysAssert(fmemPush(&arena, 16, fmemPushFlags_None) == (uint8_t *)parent.base);
+
+	fmemFree(&arena);
+	fmemFree(&parent);
+}
+
+static void TestVirtual() {
+	fmemMemoryBlock block;
+	fmemAlwaysAssert(!fmemInit(&block, fmemType_Virtual, 0));
+	fmemAlwaysAssert(fmemInit(&block, fmemType_Virtual, FMEM_MEGABYTES(256)));
+	fmemAlwaysAssert(block.base != fmem_null && block.size >= FMEM_MEGABYTES(256));
+	fmemAlwaysAssert(block.used == 0 && block.committed == 0);
+
+	// Pushes are contiguous and commit on demand
+	uint8_t *first = fmemPush(&block, 100, fmemPushFlags_None);
+	fmemAlwaysAssert(first == (uint8_t *)block.base);
+	fmemAlwaysAssert(block.committed >= 100 && block.committed < FMEM_MEGABYTES(1));
+	uint8_t *second = fmemPush(&block, FMEM_MEGABYTES(3), fmemPushFlags_Clear);
+	fmemAlwaysAssert(second == first + 100);
+	fmemAlwaysAssert(block.committed >= block.used);
+	second[FMEM_MEGABYTES(3) - 1] = 42;
+
+	// Does not fit into the reserved range
+	fmemAlwaysAssert(fmemPush(&block, block.size, fmemPushFlags_None) == fmem_null);
+	fmemAlwaysAssert(fmemGetRemainingSize(&block) == block.size - block.used);
+
+	fmemMemoryBlock temp;
+	fmemAlwaysAssert(!fmemBeginTemporary(&block, &temp));
+
+	// Reset gives all pages back
+	fmemReset(&block);
+	fmemAlwaysAssert(block.used == 0 && block.committed == 0);
+	uint8_t *again = fmemPush(&block, 64, fmemPushFlags_None);
+	fmemAlwaysAssert(again == first);
+	again[0] = 1;
+
+	fmemFree(&block);
+	fmemAlwaysAssert(block.base == fmem_null);
+}
+
+#define BENCHMARK_ITEM_COUNT 1000000
+#define BENCHMARK_ROUNDS 8
+
+static double GetSecondsSince(const clock_t start) {
+	double result = (double)(clock() - start) / (double)CLOCKS_PER_SEC;
+	return(result);
+}
+
+// Allocates all items, releases every second item, allocates them again and releases everything
+static void BenchmarkPool() {
+	void **items = (void **)malloc(sizeof(void *) * BENCHMARK_ITEM_COUNT);
+	fmemAlwaysAssert(items != fmem_null);
+
+	clock_t mallocStart = clock();
+	for(int round = 0; round < BENCHMARK_ROUNDS; ++round) {
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; ++i) {
+			items[i] = malloc(sizeof(TestPoolItem));
+		}
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; i += 2) {
+			free(items[i]);
+		}
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; i += 2) {
+			items[i] = malloc(sizeof(TestPoolItem));
+		}
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; ++i) {
+			free(items[i]);
+		}
+	}
+	double mallocSeconds = GetSecondsSince(mallocStart);
+
+	fmemPool pool;
+	fmemAlwaysAssert(fmemPoolInitStruct(&pool, TestPoolItem, 4096));
+	clock_t poolStart = clock();
+	for(int round = 0; round < BENCHMARK_ROUNDS; ++round) {
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; ++i) {
+			items[i] = fmemPoolPush(&pool, fmemPushFlags_None);
+		}
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; i += 2) {
+			fmemPoolRelease(&pool, items[i]);
+		}
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; i += 2) {
+			items[i] = fmemPoolPush(&pool, fmemPushFlags_None);
+		}
+		for(size_t i = 0; i < BENCHMARK_ITEM_COUNT; ++i) {
+			fmemPoolRelease(&pool, items[i]);
+		}
+	}
+	double poolSeconds = GetSecondsSince(poolStart);
+	fmemAlwaysAssert(pool.usedCount == 0);
+	fmemPoolFree(&pool);
+
+	free(items);
+
+	printf("Pool benchmark (%d x %d items of %zu bytes):\n", BENCHMARK_ROUNDS, BENCHMARK_ITEM_COUNT, sizeof(TestPoolItem));
+	printf("\tmalloc/free: %.3f ms\n", mallocSeconds * 1000.0);
+	printf("\tfmemPool: %.3f ms\n", poolSeconds * 1000.0);
+}
+
 int main(int argc, char **args) {
 	TestGrowable(false, false);
 	TestGrowable(true, false);
@@ -147,5 +502,12 @@ int main(int argc, char **args) {
 	TestFixed();
 	TestTemporary();
 	TestGrowMiddle();
+	TestGrowCurrent();
+	TestPool();
+	TestConcurrent();
+	TestConcurrentThreads();
+	TestSubArena();
+	TestVirtual();
+	BenchmarkPool();
 	return 0;
 }
\ No newline at end of file
@@ -180,6 +180,9 @@ typedef FFMPEG_AV_FRAME_UNREF_FUNC(ffmpeg_av_frame_unref_func);
 // av_frame_move_ref
 #define FFMPEG_AV_FRAME_MOVE_REF_FUNC(name) void name(AVFrame *dst, AVFrame *src)
 typedef FFMPEG_AV_FRAME_MOVE_REF_FUNC(ffmpeg_av_frame_move_ref_func);
+// av_frame_ref
+#define FFMPEG_AV_FRAME_REF_FUNC(name) int name(AVFrame *dst, const AVFrame *src)
+typedef FFMPEG_AV_FRAME_REF_FUNC(ffmpeg_av_frame_ref_func);
 // av_image_get_buffer_size
 #define FFMPEG_AV_IMAGE_GET_BUFFER_SIZE_FUNC(name) int name(enum AVPixelFormat pix_fmt, int width, int height, int align)
 typedef FFMPEG_AV_IMAGE_GET_BUFFER_SIZE_FUNC(ffmpeg_av_image_get_buffer_size_func);
@@ -370,6 +373,7 @@ struct FFMPEGContext {
 	ffmpeg_av_frame_free_func* av_frame_free;
 	ffmpeg_av_frame_unref_func* av_frame_unref;
 	ffmpeg_av_frame_move_ref_func* av_frame_move_ref;
+	ffmpeg_av_frame_ref_func* av_frame_ref;
 	ffmpeg_av_image_get_buffer_size_func* av_image_get_buffer_size;
 	ffmpeg_av_image_get_linesize_func* av_image_get_linesize;
 	ffmpeg_av_image_fill_arrays_func* av_image_fill_arrays;
@@ -608,6 +612,7 @@ static bool LoadFFMPEG(FFMPEGContext& ffmpeg) {
 	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_frame_free, ffmpeg_av_frame_free_func, "av_frame_free");
 	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_frame_unref, ffmpeg_av_frame_unref_func, "av_frame_unref");
 	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_frame_move_ref, ffmpeg_av_frame_move_ref_func, "av_frame_move_ref");
+	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_frame_ref, ffmpeg_av_frame_ref_func, "av_frame_ref");
 	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_image_get_buffer_size, ffmpeg_av_image_get_buffer_size_func, "av_image_get_buffer_size");
 	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_image_get_linesize, ffmpeg_av_image_get_linesize_func, "av_image_get_linesize");
 	FFMPEG_GET_FUNCTION_ADDRESS(avUtilLib, avUtilLibFile, ffmpeg.av_image_fill_arrays, ffmpeg_av_image_fill_arrays_func, "av_image_fill_arrays");
@@ -642,6 +647,7 @@ static bool LoadFFMPEG(FFMPEGContext& ffmpeg) {
 	ffmpeg.av_frame_free = av_frame_free;
 	ffmpeg.av_frame_unref = av_frame_unref;
 	ffmpeg.av_frame_move_ref = av_frame_move_ref;
+	ffmpeg.av_frame_ref = av_frame_ref;
 	ffmpeg.av_image_get_buffer_size = av_image_get_buffer_size;
 	ffmpeg.av_image_get_linesize = av_image_get_linesize;
 	ffmpeg.av_image_fill_arrays = av_image_fill_arrays;
@@ -16,6 +16,21 @@ Author:
 	Torsten Spaete
 
 Changelog:
+	## 2026-10-18
+	- New: SSE2/AVX2/NEON row converters for YUV420P, YUV422P and NV12 to RGB32, selected at runtime
+	- New: Software conversion is split across rows and executed on a conversion thread pool
+	- New: Packets are taken from a fixed pool per stream and passed through lock-free single producer single consumer queues
+	- Changed: Decoders are only signaled when the packet queue was empty, the reader only when there was no free packet
+	- Fixed: Packets queued before a flush was leaked in the decoder
+	- New: Video frames are written into a persistent mapped pixel buffer ring by the decoder thread (GL_ARB_buffer_storage), the main thread only starts the upload
+	- New: Keyframe seek index per stream, built in the background and stored next to the media file (.fplidx)
+	- New: Frame accurate seeking, relative seeks are frame accurate when the seek index is ready
+	- New: Frame stepping with comma (backward) and period (forward), backward steps inside the current GOP are served from a decoded frame cache
+	- Changed: Audio samples are converted into the device format by the audio decoder thread and written into a lock-free ring buffer, the audio callback only copies them out
+	- New: Headless benchmark (--bench <file>) reporting frames per second, per stage latency and queue occupancy
+	- New: Headless conversion validation (--validate <file>), compares the SIMD conversion of every video frame with the scalar conversion
+	- Changed: YUV to RGB32 conversion uses fixed point integer math, so all row converters are bit-exact regardless of floating point contraction
+
 	## 2025-03-15
 	- Fixed audio sample buffer was not cleared when seeking
 
@@ -126,7 +141,8 @@ Features/Planned:
 	[x] Modern OpenGL 3.3
 	[x] OSD
 	[x] Seeking (+/- 5 secs)
-	[ ] Frame by frame stepping
+	[x] Frame by frame stepping
+	[x] Frame accurate seeking with a keyframe index
 	[ ] Support for audio format change while playing
 	[ ] Support for video format change while playing
 	[x] Image format conversion (YUY2, YUV > RGB24 etc.)
@@ -161,9 +177,12 @@ License:
 #include <final_platform_layer.h>
 
 #include <final_math.h>
+#include <final_buffer.h>
 
 #include "defines.h"
 #include "utils.h"
+#include "mpmc_queue.h"
+#include "seekindex.h"
 #include "ffmpeg.h"
 
 #include <final_fonts.h> // sulphur-point-regular font
@@ -289,6 +308,35 @@ struct MemoryStats {
 
 static MemoryStats globalMemStats = {};
 
+// Time spent in one stage of the pipeline, written by the thread running the stage only
+struct StageStats {
+	double totalTime;
+	double maxTime;
+	uint64_t count;
+};
+
+static void AddStageTime(StageStats &stats, const double time) {
+	stats.totalTime += time;
+	stats.maxTime = fplMax(stats.maxTime, time);
+	stats.count++;
+}
+
+// Fill level of a queue, sampled in a fixed interval
+struct QueueStats {
+	double total;
+	int64_t max;
+	uint64_t sampleCount;
+};
+
+static void AddQueueSample(QueueStats &stats, const int64_t value) {
+	stats.total += (double)value;
+	stats.max = fplMax(stats.max, value);
+	stats.sampleCount++;
+}
+
+// Used for converting YUV video frames in parallel
+static ConversionPool globalConversionPool = {};
+
 static void PrintMemStats() {
 	int32_t allocatedPackets = fplAtomicLoadS32(&globalMemStats.allocatedPackets);
 	int32_t usedPackets = fplAtomicLoadS32(&globalMemStats.usedPackets);
@@ -301,17 +349,43 @@ static void PrintMemStats() {
 // Constants
 //
 
-// Max number of frames in the queues
+// Max number of frames in the queues, audio is decoded directly into the sample buffer and has no frame queue
 constexpr uint32_t MAX_VIDEO_FRAME_QUEUE_COUNT = 4;
-constexpr uint32_t MAX_AUDIO_FRAME_QUEUE_COUNT = 8;
-constexpr uint32_t MAX_FRAME_QUEUE_COUNT = fplMax(MAX_AUDIO_FRAME_QUEUE_COUNT, MAX_VIDEO_FRAME_QUEUE_COUNT);
+constexpr uint32_t MAX_FRAME_QUEUE_COUNT = MAX_VIDEO_FRAME_QUEUE_COUNT;
 
 // Total size of data from all packet queues
-constexpr uint64_t MAX_PACKET_QUEUE_SIZE = fplMegaBytes(16);
+constexpr int64_t MAX_PACKET_QUEUE_SIZE = fplMegaBytes(16);
+
+// Max number of packets in a single queue, must be a power of two
+constexpr uint32_t MAX_PACKET_QUEUE_COUNT = 1024;
+
+// Number of packets in a queue, that are reserved for flush and null packets
+constexpr int32_t RESERVED_PACKET_COUNT = 2;
 
 // Min number of packet frames in a single queue
 constexpr uint32_t MIN_PACKET_FRAMES = 25;
 
+// Duration in seconds of converted audio samples, which are buffered for the audio callback
+constexpr double AUDIO_SAMPLE_BUFFER_DURATION = 0.5;
+
+// Max number of converted sample chunks in the audio sample buffer, must be a power of two
+constexpr uint32_t MAX_AUDIO_CHUNK_COUNT = 512;
+
+// Time in milliseconds the audio decoder waits, when the audio sample buffer is full
+constexpr uint32_t AUDIO_SAMPLE_BUFFER_WAIT_TIME = 5;
+
+// Max number of decoded video frames kept around the playhead for backward stepping
+constexpr int32_t MAX_GOP_CACHE_FRAME_COUNT = 32;
+
+// Min distance in seconds between two seek index entries for streams, where every packet is a keyframe (audio)
+constexpr double SEEK_INDEX_MIN_AUDIO_DISTANCE = 1.0;
+
+// Audio device format used in the benchmark, where no audio device exists
+constexpr uint32_t BENCHMARK_AUDIO_BUFFER_MILLISECONDS = 10;
+constexpr uint16_t BENCHMARK_AUDIO_PERIODS = 3;
+// Interval in seconds for sampling the queue occupancy in the benchmark
+constexpr double BENCHMARK_SAMPLE_INTERVAL = 0.001;
+
 // External clock min/max frames
 constexpr uint32_t EXTERNAL_CLOCK_MIN_FRAMES = 2;
 constexpr uint32_t EXTERNAL_CLOCK_MAX_FRAMES = 10;
@@ -343,20 +417,25 @@ static AVPacket globalFlushPacket = {};
 
 struct PacketList {
 	AVPacket packet;
-	PacketList *next;
 	int32_t serial;
 };
 
 struct PacketQueue {
-	fplMutexHandle lock;
+	// Packets from the reader to the decoder
+	SPSCBoundedQueue<PacketList *> packets;
+	// Released packets from the decoder back to the reader
+	SPSCBoundedQueue<PacketList *> freePackets;
+	// Fixed storage for all packets
+	PacketList *pool;
 	fplSignalHandle addedSignal;
-	fplSignalHandle freeSignal;
-	PacketList *first;
-	PacketList *last;
-	uint64_t size;
-	uint64_t duration;
-	int32_t packetCount;
+	// Signal of the reader, set when a packet gets available again
+	fplSignalHandle *freeSignal;
+	volatile int64_t size;
+	volatile int64_t duration;
+	volatile int32_t packetCount;
+	volatile int32_t freeCount;
 	int32_t serial;
+	bool isValid;
 };
 
 static bool IsFlushPacket(PacketList *packet) {
@@ -365,55 +444,55 @@ static bool IsFlushPacket(PacketList *packet) {
 	return(result);
 }
 
-static PacketList *AllocatePacket(PacketQueue &queue) {
-	PacketList *packet = (PacketList *)ffmpeg.av_mallocz(sizeof(PacketList));
-	if (packet == nullptr) {
-		return nullptr;
-	}
-	fplAtomicFetchAndAddS32(&globalMemStats.allocatedPackets, 1);
-	return(packet);
-}
-
-static void DestroyPacket(PacketQueue &queue, PacketList *packet) {
-	ffmpeg.av_freep(packet);
-	fplAtomicFetchAndAddS32(&globalMemStats.allocatedPackets, -1);
-}
-
 static void ReleasePacketData(PacketList *packet) {
 	if (!IsFlushPacket(packet)) {
 		ffmpeg.av_packet_unref(&packet->packet);
 	}
 }
 
+// Must be called from the decoder thread only (Or when the reader and the decoder are stopped)
 static void ReleasePacket(PacketQueue &queue, PacketList *packet) {
 	ReleasePacketData(packet);
-	DestroyPacket(queue, packet);
-	fplSignalSet(&queue.freeSignal);
+	packet->packet = {};
+	bool r = Enqueue(queue.freePackets, packet);
+	fplAssert(r == true);
+	fplAtomicFetchAndAddS32(&globalMemStats.allocatedPackets, -1);
+	// Wake up the reader only, when it could not acquire a packet before (Reserved packets are never handed out to the reader)
+	if (fplAtomicFetchAndAddS32(&queue.freeCount, 1) <= RESERVED_PACKET_COUNT) {
+		fplSignalSet(queue.freeSignal);
+	}
 }
 
-static bool AquirePacket(PacketQueue &queue, PacketList *&packet) {
-	bool result = false;
-	packet = AllocatePacket(queue);
-	if (packet != nullptr) {
-		result = true;
+// Must be called from the reader thread only (Or before the decoder is started)
+static bool AquirePacket(PacketQueue &queue, PacketList *&packet, const int32_t reservedCount) {
+	if (fplAtomicLoadS32(&queue.freeCount) <= reservedCount) {
+		return false;
 	}
+	bool result = Dequeue(queue.freePackets, packet);
+	fplAssert(result == true);
+	fplAtomicFetchAndAddS32(&queue.freeCount, -1);
+	fplAtomicFetchAndAddS32(&globalMemStats.allocatedPackets, 1);
 	return(result);
 }
 
+// Must be called from the decoder thread only (Or when the reader and the decoder are stopped)
+static bool PopPacket(PacketQueue &queue, PacketList *&packet) {
+	if (!Dequeue(queue.packets, packet)) {
+		return false;
+	}
+	fplAtomicFetchAndAddS64(&queue.duration, -packet->packet.duration);
+	fplAtomicFetchAndAddS64(&queue.size, -(int64_t)(packet->packet.size + sizeof(*packet)));
+	fplAtomicFetchAndAddS32(&queue.packetCount, -1);
+	fplAtomicFetchAndAddS32(&globalMemStats.usedPackets, -1);
+	return true;
+}
+
+// Releases all queued packets, the reader and the decoder must be stopped
 static void FlushPacketQueue(PacketQueue &queue) {
-	fplMutexLock(&queue.lock);
-	PacketList *p = queue.first;
-	while (p != nullptr) {
-		PacketList *n = p->next;
-		ReleasePacketData(p);
-		DestroyPacket(queue, p);
-		p = n;
-	}
-	queue.first = queue.last = nullptr;
-	queue.packetCount = 0;
-	queue.size = 0;
-	queue.duration = 0;
-	fplMutexUnlock(&queue.lock);
+	PacketList *p;
+	while (PopPacket(queue, p)) {
+		ReleasePacket(queue, p);
+	}
 	fplAtomicExchangeS32(&globalMemStats.usedPackets, 0);
 	fplAtomicExchangeS32(&globalMemStats.allocatedPackets, 0);
 #if PRINT_FLUSHES
@@ -422,79 +501,61 @@ static void FlushPacketQueue(PacketQueue &queue) {
 }
 
 static void DestroyPacketQueue(PacketQueue &queue) {
-	FlushPacketQueue(queue);
-	fplSignalDestroy(&queue.freeSignal);
+	if (queue.isValid) {
+		FlushPacketQueue(queue);
+	}
+	SPSCBoundedQueue<PacketList *>::Destroy(queue.freePackets);
+	SPSCBoundedQueue<PacketList *>::Destroy(queue.packets);
+	if (queue.pool != nullptr) {
+		fplMemoryFree(queue.pool);
+	}
 	fplSignalDestroy(&queue.addedSignal);
-	fplMutexDestroy(&queue.lock);
 	queue = {};
 }
 
-static bool InitPacketQueue(PacketQueue &queue) {
-	if (!fplMutexInit(&queue.lock)) {
-		return false;
-	}
+static bool InitPacketQueue(PacketQueue &queue, fplSignalHandle *freeSignal) {
+	queue = {};
+	queue.freeSignal = freeSignal;
 	if (!fplSignalInit(&queue.addedSignal, fplSignalValue_Unset)) {
 		return false;
 	}
-	if (!fplSignalInit(&queue.freeSignal, fplSignalValue_Unset)) {
+	queue.pool = (PacketList *)fplMemoryAllocate(sizeof(PacketList) * MAX_PACKET_QUEUE_COUNT);
+	if (queue.pool == nullptr) {
+		DestroyPacketQueue(queue);
 		return false;
 	}
+	// Both queues have the same capacity as the pool, so they never overflow
+	queue.packets = SPSCBoundedQueue<PacketList *>::Create(MAX_PACKET_QUEUE_COUNT);
+	queue.freePackets = SPSCBoundedQueue<PacketList *>::Create(MAX_PACKET_QUEUE_COUNT);
+	for (uint32_t packetIndex = 0; packetIndex < MAX_PACKET_QUEUE_COUNT; ++packetIndex) {
+		Enqueue(queue.freePackets, &queue.pool[packetIndex]);
+	}
+	queue.freeCount = MAX_PACKET_QUEUE_COUNT;
+	queue.isValid = true;
 	return true;
 }
 
+// Must be called from the reader thread only (Or before the decoder is started)
 static void PushPacket(PacketQueue &queue, PacketList *packet) {
-	fplMutexLock(&queue.lock);
-	{
-		packet->next = nullptr;
-		if (IsFlushPacket(packet)) {
-			queue.serial++;
-		}
-		packet->serial = queue.serial;
-		if (queue.first == nullptr) {
-			queue.first = packet;
-		}
-		if (queue.last != nullptr) {
-			fplAssert(queue.last->next == nullptr);
-			queue.last->next = packet;
-		}
-		queue.last = packet;
-		queue.size += packet->packet.size + sizeof(*packet);
-		queue.duration += packet->packet.duration;
-		fplAtomicFetchAndAddS32(&queue.packetCount, 1);
-		fplAtomicFetchAndAddS32(&globalMemStats.usedPackets, 1);
-		fplSignalSet(&queue.addedSignal);
+	if (IsFlushPacket(packet)) {
+		queue.serial++;
 	}
-	fplMutexUnlock(&queue.lock);
-}
-
-static bool PopPacket(PacketQueue &queue, PacketList *&packet) {
-	bool result = false;
-	fplMutexLock(&queue.lock);
-	{
-		if (queue.first != nullptr) {
-			PacketList *p = queue.first;
-			PacketList *n = p->next;
-			queue.first = n;
-			p->next = nullptr;
-			packet = p;
-			queue.duration -= packet->packet.duration;
-			queue.size -= packet->packet.size + sizeof(*packet);
-			if (queue.first == nullptr) {
-				queue.last = nullptr;
-			}
-			fplAtomicFetchAndAddS32(&queue.packetCount, -1);
-			fplAtomicFetchAndAddS32(&globalMemStats.usedPackets, -1);
-			result = true;
-		}
+	packet->serial = queue.serial;
+	fplAtomicFetchAndAddS64(&queue.size, packet->packet.size + sizeof(*packet));
+	fplAtomicFetchAndAddS64(&queue.duration, packet->packet.duration);
+	bool r = Enqueue(queue.packets, packet);
+	fplAssert(r == true);
+	fplAtomicFetchAndAddS32(&globalMemStats.usedPackets, 1);
+	// Wake up the decoder only, when the queue was empty before
+	if (fplAtomicFetchAndAddS32(&queue.packetCount, 1) == 0) {
+		fplSignalSet(&queue.addedSignal);
 	}
-	fplMutexUnlock(&queue.lock);
-	return(result);
 }
 
 static bool PushNullPacket(PacketQueue &queue, int streamIndex) {
 	bool result = false;
 	PacketList *packet = nullptr;
-	if (AquirePacket(queue, packet)) {
+	if (AquirePacket(queue, packet, 0)) {
 		ffmpeg.av_init_packet(&packet->packet);
 		packet->packet.data = nullptr;
 		packet->packet.size = 0;
@@ -508,7 +569,7 @@ static bool PushNullPacket(PacketQueue &queue, int streamIndex) {
 static bool PushFlushPacket(PacketQueue &queue) {
 	bool result = false;
 	PacketList *packet = nullptr;
-	if (AquirePacket(queue, packet)) {
+	if (AquirePacket(queue, packet, 0)) {
 		packet->packet = globalFlushPacket;
 		PushPacket(queue, packet);
 		result = true;
@@ -534,6 +595,8 @@ struct Frame {
 	int32_t width;
 	int32_t height;
 	bool32 isUploaded;
+	// Frame pixels was written into the upload ring slot of this frame by the decoder
+	bool32 isWritten;
 };
 
 static AVFrame *AllocateFrame() {
@@ -552,7 +615,6 @@ struct FrameQueue {
 	Frame frames[MAX_FRAME_QUEUE_COUNT];
 	fplMutexHandle lock;
 	fplSignalHandle signal;
-	PacketList *pendingPacket;
 	volatile uint32_t *stopped;
 	int32_t readIndex;
 	int32_t writeIndex;
@@ -561,7 +623,6 @@ struct FrameQueue {
 	int32_t keepLast;
 	int32_t readIndexShown;
 	bool32 isValid;
-	bool32 hasPendingPacket;
 };
 
 static bool InitFrameQueue(FrameQueue &queue, int32_t capacity, volatile uint32_t *stopped, int32_t keepLast) {
@@ -627,22 +688,6 @@ static bool PeekWritableFromFrameQueue(FrameQueue &queue, Frame *&frame) {
 	return true;
 }
 
-static bool PeekReadableFromFrameQueue(FrameQueue &queue, Frame *&frame) {
-	fplMutexLock(&queue.lock);
-	if ((queue.count - queue.readIndexShown) <= 0 || *queue.stopped) {
-		fplMutexUnlock(&queue.lock);
-		return false;
-	}
-	fplMutexUnlock(&queue.lock);
-
-	if (*queue.stopped) {
-		return false;
-	}
-
-	frame = &queue.frames[(queue.readIndex + queue.readIndexShown) % queue.capacity];
-	return true;
-}
-
 static void NextWritable(FrameQueue &queue) {
 	queue.writeIndex = (queue.writeIndex + 1) % queue.capacity;
 
@@ -700,11 +745,12 @@ struct MediaStream {
 };
 
 struct ReaderContext {
-	PacketQueue packetQueue;
 	fplMutexHandle lock;
+	fplSignalHandle freeSignal;
 	fplSignalHandle stopSignal;
 	fplSignalHandle resumeSignal;
 	fplThreadHandle *thread;
+	StageStats readStats;
 	volatile uint32_t readPacketCount;
 	volatile uint32_t stopRequest;
 	bool32 isEOF;
@@ -721,14 +767,14 @@ static bool InitReader(ReaderContext &outReader) {
 	if (!fplSignalInit(&outReader.resumeSignal, fplSignalValue_Unset)) {
 		return false;
 	}
-	if (!InitPacketQueue(outReader.packetQueue)) {
+	if (!fplSignalInit(&outReader.freeSignal, fplSignalValue_Unset)) {
 		return false;
 	}
 	return true;
 }
 
 static void DestroyReader(ReaderContext &reader) {
-	DestroyPacketQueue(reader.packetQueue);
+	fplSignalDestroy(&reader.freeSignal);
 	fplSignalDestroy(&reader.resumeSignal);
 	fplSignalDestroy(&reader.stopSignal);
 	fplMutexDestroy(&reader.lock);
@@ -749,6 +795,101 @@ static void StartReader(ReaderContext &reader, fpl_run_thread_callback *readerTh
 	reader.thread = fplThreadCreate(readerThreadFunc, state);
 }
 
+//
+// GOP Cache
+//
+// References to the decoded video frames since the last keyframe, sorted by the presentation timestamp.
+// Only used by the video decoder thread.
+struct GOPCache {
+	AVFrame *frames[MAX_GOP_CACHE_FRAME_COUNT];
+	int32_t first;
+	int32_t count;
+};
+
+static AVFrame *GetGOPCacheFrame(const GOPCache &cache, const int32_t index) {
+	fplAssert(index >= 0 && index < cache.count);
+	return cache.frames[(cache.first + index) % MAX_GOP_CACHE_FRAME_COUNT];
+}
+
+static void RemoveOldestGOPCacheFrame(GOPCache &cache) {
+	fplAssert(cache.count > 0);
+	ffmpeg.av_frame_free(&cache.frames[cache.first]);
+	cache.first = (cache.first + 1) % MAX_GOP_CACHE_FRAME_COUNT;
+	cache.count--;
+}
+
+static void ClearGOPCache(GOPCache &cache) {
+	while (cache.count > 0) {
+		RemoveOldestGOPCacheFrame(cache);
+	}
+	cache.first = 0;
+}
+
+static bool IsFrameInGOPCache(const GOPCache &cache, const int64_t pts) {
+	for (int32_t i = 0; i < cache.count; ++i) {
+		if (GetGOPCacheFrame(cache, i)->pts == pts) {
+			return true;
+		}
+	}
+	return false;
+}
+
+static void AddFrameToGOPCache(GOPCache &cache, const AVFrame *frame) {
+	if (frame->pts == AV_NOPTS_VALUE) {
+		ClearGOPCache(cache);
+		return;
+	}
+
+	// Frames decoded again after seeking back into the cached GOP are already there
+	if (IsFrameInGOPCache(cache, frame->pts)) {
+		return;
+	}
+
+	// A new GOP starts or the frames are not continuous anymore
+	if (cache.count > 0 && (frame->key_frame || frame->pts < GetGOPCacheFrame(cache, cache.count - 1)->pts)) {
+		ClearGOPCache(cache);
+	}
+
+	// The cache must start with a keyframe, otherwise the frames may be incomplete
+	if (cache.count == 0 && !frame->key_frame) {
+		return;
+	}
+
+	if (cache.count == MAX_GOP_CACHE_FRAME_COUNT) {
+		RemoveOldestGOPCacheFrame(cache);
+	}
+
+	AVFrame *ref = ffmpeg.av_frame_alloc();
+	if (ref == nullptr) {
+		return;
+	}
+	if (ffmpeg.av_frame_ref(ref, frame) < 0) {
+		ffmpeg.av_frame_free(&ref);
+		return;
+	}
+	cache.frames[(cache.first + cache.count) % MAX_GOP_CACHE_FRAME_COUNT] = ref;
+	cache.count++;
+}
+
+// Returns the cached frame which is presented at the target time (In stream time base) or null, when the target is not in the cached range
+static const AVFrame *FindGOPCacheFrame(const GOPCache &cache, const int64_t targetPTS, const int64_t frameDuration) {
+	if (cache.count == 0) {
+		return nullptr;
+	}
+	if (targetPTS < GetGOPCacheFrame(cache, 0)->pts || targetPTS >= GetGOPCacheFrame(cache, cache.count - 1)->pts + fplMax(frameDuration, (int64_t)1)) {
+		return nullptr;
+	}
+	const AVFrame *result = nullptr;
+	for (int32_t i = 0; i < cache.count; ++i) {
+		const AVFrame *frame = GetGOPCacheFrame(cache, i);
+		if (frame->pts > targetPTS) {
+			break;
+		}
+		result = frame;
+	}
+	return(result);
+}
+
 //
 // Decoder
 //
@@ -756,6 +897,7 @@ struct PlayerState;
 struct Decoder {
 	PacketQueue packetsQueue;
 	FrameQueue frameQueue;
+	GOPCache gopCache;
 	fplMutexHandle lock;
 	fplSignalHandle stopSignal;
 	fplSignalHandle resumeSignal;
@@ -763,6 +905,8 @@ struct Decoder {
 	PlayerState *state;
 	ReaderContext *reader;
 	MediaStream *stream;
+	// Packet which was rejected by the codec, it is send again on the next decode
+	PacketList *pendingPacket;
 	int64_t start_pts;
 	AVRational start_pts_tb;
 	int64_t next_pts;
@@ -770,8 +914,13 @@ struct Decoder {
 	volatile uint32_t stopRequest;
 	volatile uint32_t isEOF;
 	volatile uint32_t decodedFrameCount;
+	StageStats decodeStats;
+	// Target time in seconds of the last frame accurate seek, frames before it are dropped for the serial below
+	double accurateSeekPTS;
+	volatile int32_t accurateSeekSerial;
 	int32_t pktSerial;
 	int32_t finishedSerial;
+	bool32 hasPendingPacket;
 };
 
 static bool InitDecoder(Decoder &outDecoder, PlayerState *state, ReaderContext *reader, MediaStream *stream, uint32_t frameCapacity, int32_t keepLast) {
@@ -780,6 +929,7 @@ static bool InitDecoder(Decoder &outDecoder, PlayerState *state, ReaderContext *
 	outDecoder.reader = reader;
 	outDecoder.state = state;
 	outDecoder.pktSerial = -1;
+	outDecoder.accurateSeekSerial = -1;
 	outDecoder.start_pts = AV_NOPTS_VALUE;
 	if (!fplMutexInit(&outDecoder.lock)) {
 		return false;
@@ -790,10 +940,11 @@ static bool InitDecoder(Decoder &outDecoder, PlayerState *state, ReaderContext *
 	if (!fplSignalInit(&outDecoder.resumeSignal, fplSignalValue_Unset)) {
 		return false;
 	}
-	if (!InitPacketQueue(outDecoder.packetsQueue)) {
+	if (!InitPacketQueue(outDecoder.packetsQueue, &reader->freeSignal)) {
 		return false;
 	}
-	if (!InitFrameQueue(outDecoder.frameQueue, frameCapacity, &outDecoder.stopRequest, keepLast)) {
+	// Decoders without a frame capacity (Audio) do not need a frame queue
+	if (frameCapacity > 0 && !InitFrameQueue(outDecoder.frameQueue, frameCapacity, &outDecoder.stopRequest, keepLast)) {
 		return false;
 	}
 
@@ -801,7 +952,9 @@ static bool InitDecoder(Decoder &outDecoder, PlayerState *state, ReaderContext *
 }
 
 static void DestroyDecoder(Decoder &decoder) {
-	DestroyFrameQueue(decoder.frameQueue);
+	if (decoder.frameQueue.isValid) {
+		DestroyFrameQueue(decoder.frameQueue);
+	}
 	DestroyPacketQueue(decoder.packetsQueue);
 	fplSignalDestroy(&decoder.resumeSignal);
 	fplSignalDestroy(&decoder.stopSignal);
@@ -822,15 +975,18 @@ static void StopDecoder(Decoder &decoder) {
 	fplThreadTerminate(decoder.thread);
 	decoder.thread = nullptr;
 	FlushPacketQueue(decoder.packetsQueue);
+	ClearGOPCache(decoder.gopCache);
 }
 
-static void AddPacketToDecoder(Decoder &decoder, AVPacket *sourcePacket) {
+static bool AddPacketToDecoder(Decoder &decoder, AVPacket *sourcePacket) {
 	PacketList *targetPacket = nullptr;
-	if (AquirePacket(decoder.packetsQueue, targetPacket)) {
+	if (AquirePacket(decoder.packetsQueue, targetPacket, RESERVED_PACKET_COUNT)) {
 		fplAssert(targetPacket != nullptr);
 		targetPacket->packet = *sourcePacket;
 		PushPacket(decoder.packetsQueue, targetPacket);
+		return true;
 	}
+	return false;
 }
 
 //
@@ -1028,6 +1184,29 @@ static uint16_t videoQuadIndices[6] = {
 };
 
 constexpr uint32_t MAX_TARGET_TEXTURE_COUNT = 4;
+
+enum class VideoUploadMode : int32_t {
+	// Rendering is not initialized yet
+	Unknown = 0,
+	// Frames are written and uploaded on the main thread
+	MainThread,
+	// Frames are written into the upload ring by the decoder thread, the main thread only starts the upload
+	UploadRing,
+};
+
+#if USE_HARDWARE_RENDERING && USE_GL_PBO
+// Persistent mapped pixel buffer with one slot for each frame in the video frame queue
+struct VideoUploadRing {
+	GLsync fences[MAX_VIDEO_FRAME_QUEUE_COUNT];
+	size_t textureOffsets[MAX_TARGET_TEXTURE_COUNT];
+	uint8_t *base;
+	size_t slotSize;
+	GLuint bufferId;
+	// Set while the GPU may read from the slot
+	volatile int32_t isInFlight[MAX_VIDEO_FRAME_QUEUE_COUNT];
+};
+#endif
+
 struct VideoContext {
 	MediaStream stream;
 	Decoder decoder;
@@ -1041,11 +1220,16 @@ struct VideoContext {
 	GLuint vertexBufferId;
 	GLuint indexBufferId;
 	VideoShader *activeShader;
+#	if USE_GL_PBO
+	VideoUploadRing uploadRing;
+#	endif
 #endif
 
 	SwsContext *softwareScaleCtx;
 	uint32_t targetTextureCount;
 
+	volatile int32_t uploadMode;
+
 	volatile int32_t requireRelease;
 	volatile int32_t requireInit;
 
@@ -1123,42 +1307,82 @@ static void FlipSourcePicture(uint8_t *srcData[8], int srcLineSize[8], int heigh
 
 }
 
-static void UploadTexture(VideoContext &video, const AVFrame *sourceNativeFrame) {
+// Converts the entire frame into 32-bit RGB pixels with the size of the frame
+static void ConvertVideoFrameToRGB32(VideoContext &video, const AVFrame *sourceNativeFrame, uint8_t *data, const int32_t rowSize, const ConversionFlags extraFlags) {
 	AVCodecContext *videoCodecCtx = video.stream.codecContext;
 
 	AVPixelFormat pixelFormat = (AVPixelFormat)sourceNativeFrame->format;
 
+	int32_t dstLineSize[8] = { rowSize, 0 };
+	uint8_t *dstData[8] = { data, nullptr };
+	uint8_t *srcData[8];
+	int srcLineSize[8];
+	for (int i = 0; i < 8; ++i) {
+		srcData[i] = sourceNativeFrame->data[i];
+		srcLineSize[i] = sourceNativeFrame->linesize[i];
+	}
+
+#if USE_FFMPEG_SOFTWARE_CONVERSION
+	ffmpeg.sws_scale(video.softwareScaleCtx, (uint8_t const *const *)srcData, srcLineSize, 0, videoCodecCtx->height, dstData, dstLineSize);
+#else
+	uint32_t width = sourceNativeFrame->width;
+	uint32_t height = sourceNativeFrame->height;
+
+	ConversionFlags flags = extraFlags;
+#	if USE_HARDWARE_RENDERING
+	flags |= ConversionFlags::DstBGRA;
+#	endif
+
+	switch (pixelFormat) {
+		case AVPixelFormat::AV_PIX_FMT_YUV420P:
+		case AVPixelFormat::AV_PIX_FMT_YUVJ420P:
+			ConvertYUVToRGB32(YUVFormat::YUV420P, dstData, dstLineSize, width, height, srcData, srcLineSize, flags, &globalConversionPool);
+			break;
+		case AVPixelFormat::AV_PIX_FMT_YUV422P:
+		case AVPixelFormat::AV_PIX_FMT_YUVJ422P:
+			ConvertYUVToRGB32(YUVFormat::YUV422P, dstData, dstLineSize, width, height, srcData, srcLineSize, flags, &globalConversionPool);
+			break;
+		case AVPixelFormat::AV_PIX_FMT_NV12:
+			ConvertYUVToRGB32(YUVFormat::NV12, dstData, dstLineSize, width, height, srcData, srcLineSize, flags, &globalConversionPool);
+			break;
+		default:
+			ffmpeg.sws_scale(video.softwareScaleCtx, (uint8_t const *const *)srcData, srcLineSize, 0, videoCodecCtx->height, dstData, dstLineSize);
+			break;
+	}
+#endif
+}
+
+// Writes the pixels for the target texture, either by copying the plane or by converting the entire frame
+static void WriteVideoTexture(VideoContext &video, const uint32_t textureIndex, const AVFrame *sourceNativeFrame, uint8_t *data) {
+	fplAssert(textureIndex < video.targetTextureCount);
+	VideoTexture &targetTexture = video.targetTextures[textureIndex];
+
+	fplAssert(data != nullptr);
+
 #if USE_HARDWARE_RENDERING
+	AVPixelFormat pixelFormat = (AVPixelFormat)sourceNativeFrame->format;
 	if (IsPlanarYUVFormat(pixelFormat) && HasShaderForPixelFormat(pixelFormat)) {
 		switch (pixelFormat) {
 			case AVPixelFormat::AV_PIX_FMT_YUV420P:
 			case AVPixelFormat::AV_PIX_FMT_YUVJ420P:
+			{
 				fplAssert(video.targetTextureCount == 3);
-				for (uint32_t textureIndex = 0; textureIndex < video.targetTextureCount; ++textureIndex) {
-					VideoTexture &targetTexture = video.targetTextures[textureIndex];
-
-					uint8_t *data = LockVideoTexture(targetTexture);
-
-					fplAssert(data != nullptr);
 
-					uint32_t w = (textureIndex == 0) ? sourceNativeFrame->width : sourceNativeFrame->width / 2;
-					uint32_t h = (textureIndex == 0) ? sourceNativeFrame->height : sourceNativeFrame->height / 2;
+				uint32_t w = (textureIndex == 0) ? sourceNativeFrame->width : sourceNativeFrame->width / 2;
+				uint32_t h = (textureIndex == 0) ? sourceNativeFrame->height : sourceNativeFrame->height / 2;
 
-					fplAssert(targetTexture.width == w);
-					fplAssert(targetTexture.height == h);
+				fplAssert(targetTexture.width == w);
+				fplAssert(targetTexture.height == h);
 
-					uint32_t lineSize = sourceNativeFrame->linesize[textureIndex];
-					size_t copySize = targetTexture.width;
+				uint32_t lineSize = sourceNativeFrame->linesize[textureIndex];
+				size_t copySize = targetTexture.width;
 
-					uint8_t *target = data;
-					for (uint32_t y = 0; y < h; ++y) {
-						fplMemoryCopy(sourceNativeFrame->data[textureIndex] + y * lineSize, copySize, target);
-						target += targetTexture.rowSize;
-					}
-
-					UnlockVideoTexture(targetTexture);
+				uint8_t *target = data;
+				for (uint32_t y = 0; y < h; ++y) {
+					fplMemoryCopy(sourceNativeFrame->data[textureIndex] + y * lineSize, copySize, target);
+					target += targetTexture.rowSize;
 				}
-				return;
+			} return;
 			default:
 				break;
 		}
@@ -1166,44 +1390,166 @@ static void UploadTexture(VideoContext &video, const AVFrame *sourceNativeFrame)
 #endif
 
 	fplAssert(video.targetTextureCount == 1);
-	VideoTexture &targetTexture = video.targetTextures[0];
 	fplAssert(targetTexture.width == sourceNativeFrame->width);
 	fplAssert(targetTexture.height == sourceNativeFrame->height);
 
-	uint8_t *data = LockVideoTexture(targetTexture);
-	fplAssert(data != nullptr);
+	ConvertVideoFrameToRGB32(video, sourceNativeFrame, data, targetTexture.rowSize, ConversionFlags::None);
+}
 
-	int32_t dstLineSize[8] = { targetTexture.rowSize, 0 };
-	uint8_t *dstData[8] = { data, nullptr };
-	uint8_t *srcData[8];
-	int srcLineSize[8];
-	for (int i = 0; i < 8; ++i) {
-		srcData[i] = sourceNativeFrame->data[i];
-		srcLineSize[i] = sourceNativeFrame->linesize[i];
+static void UploadTexture(VideoContext &video, const AVFrame *sourceNativeFrame) {
+	for (uint32_t textureIndex = 0; textureIndex < video.targetTextureCount; ++textureIndex) {
+		VideoTexture &targetTexture = video.targetTextures[textureIndex];
+		uint8_t *data = LockVideoTexture(targetTexture);
+		WriteVideoTexture(video, textureIndex, sourceNativeFrame, data);
+		UnlockVideoTexture(targetTexture);
 	}
+}
 
-#if USE_FFMPEG_SOFTWARE_CONVERSION
-	ffmpeg.sws_scale(video.softwareScaleCtx, (uint8_t const *const *)srcData, srcLineSize, 0, videoCodecCtx->height, dstData, dstLineSize);
-#else
-	ConversionFlags flags = ConversionFlags::None;
-#	if USE_HARDWARE_RENDERING
-	flags |= ConversionFlags::DstBGRA;
-#	endif
+#if USE_HARDWARE_RENDERING && USE_GL_PBO
+//
+// Video upload ring (GL_ARB_buffer_storage)
+//
+// The decoder thread writes each frame into the slot of its frame queue index, using the persistent mapped memory.
+// The main thread only starts the upload from the slot and protects the slot with a fence, until the GPU has read it.
+// A slot gets written again, after its frame was released from the frame queue and its fence was signaled.
+//
+constexpr size_t VIDEO_UPLOAD_RING_ALIGNMENT = 256;
 
-	switch (pixelFormat) {
-		case AVPixelFormat::AV_PIX_FMT_YUV420P:
-		case AVPixelFormat::AV_PIX_FMT_YUVJ420P:
-			ConvertYUV420PToRGB32(dstData, dstLineSize, targetTexture.width, targetTexture.height, srcData, srcLineSize, flags);
-			break;
-		default:
-			ffmpeg.sws_scale(video.softwareScaleCtx, (uint8_t const *const *)srcData, srcLineSize, 0, videoCodecCtx->height, dstData, dstLineSize);
-			break;
+static bool IsPersistentBufferMappingSupported() {
+	if (glBufferStorage == nullptr || glMapBufferRange == nullptr || glFenceSync == nullptr || glClientWaitSync == nullptr) {
+		return false;
+	}
+	GLint majorVersion = 0, minorVersion = 0;
+	glGetIntegerv(GL_MAJOR_VERSION, &majorVersion);
+	glGetIntegerv(GL_MINOR_VERSION, &minorVersion);
+	if (majorVersion > 4 || (majorVersion == 4 && minorVersion >= 4)) {
+		return true;
+	}
+	GLint extensionCount = 0;
+	glGetIntegerv(GL_NUM_EXTENSIONS, &extensionCount);
+	for (GLint extensionIndex = 0; extensionIndex < extensionCount; ++extensionIndex) {
+		const char *extensionName = (const char *)glGetStringi(GL_EXTENSIONS, extensionIndex);
+		if (fplIsStringEqual(extensionName, "GL_ARB_buffer_storage")) {
+			return true;
+		}
+	}
+	return false;
 }
-#endif
 
-	UnlockVideoTexture(targetTexture);
+static void ReleaseVideoUploadRing(VideoUploadRing &ring) {
+	for (uint32_t slotIndex = 0; slotIndex < MAX_VIDEO_FRAME_QUEUE_COUNT; ++slotIndex) {
+		if (ring.fences[slotIndex] != nullptr) {
+			glDeleteSync(ring.fences[slotIndex]);
+		}
+	}
+	if (ring.bufferId) {
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.bufferId);
+		if (ring.base != nullptr) {
+			glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+		}
+		glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+		glDeleteBuffers(1, &ring.bufferId);
+	}
+	ring = {};
 }
 
+static bool InitVideoUploadRing(VideoUploadRing &ring, const VideoTexture *textures, const uint32_t textureCount) {
+	ring = {};
+
+	if (!IsPersistentBufferMappingSupported()) {
+		FPL_LOG_WARN("Video", "Persistent mapped buffers are not supported, upload video frames on the main thread");
+		return false;
+	}
+
+	size_t slotSize = 0;
+	for (uint32_t textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
+		ring.textureOffsets[textureIndex] = slotSize;
+		slotSize += fplGetAlignedSize((size_t)textures[textureIndex].rowSize * textures[textureIndex].height, VIDEO_UPLOAD_RING_ALIGNMENT);
+	}
+	ring.slotSize = slotSize;
+
+	size_t bufferSize = slotSize * MAX_VIDEO_FRAME_QUEUE_COUNT;
+	GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+	glGenBuffers(1, &ring.bufferId);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.bufferId);
+	glBufferStorage(GL_PIXEL_UNPACK_BUFFER, bufferSize, nullptr, flags);
+	ring.base = (uint8_t *)glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, bufferSize, flags);
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	CheckGLError();
+
+	if (ring.base == nullptr) {
+		FPL_LOG_WARN("Video", "Failed mapping upload ring with '%zu' bytes, upload video frames on the main thread", bufferSize);
+		ReleaseVideoUploadRing(ring);
+		return false;
+	}
+
+	return true;
+}
+
+// Called from the main thread, releases all slots the GPU has finished reading from
+static void UpdateVideoUploadRing(VideoUploadRing &ring) {
+	for (uint32_t slotIndex = 0; slotIndex < MAX_VIDEO_FRAME_QUEUE_COUNT; ++slotIndex) {
+		GLsync fence = ring.fences[slotIndex];
+		if (fence != nullptr) {
+			GLenum waitResult = glClientWaitSync(fence, 0, 0);
+			if (waitResult == GL_ALREADY_SIGNALED || waitResult == GL_CONDITION_SATISFIED) {
+				glDeleteSync(fence);
+				ring.fences[slotIndex] = nullptr;
+				fplAtomicStoreS32(&ring.isInFlight[slotIndex], 0);
+			}
+		}
+	}
+}
+
+// Called from the main thread, starts the upload of all textures from the given slot
+static void UploadVideoUploadRingSlot(VideoUploadRing &ring, const int32_t slotIndex, const VideoTexture *textures, const uint32_t textureCount) {
+	fplAssert(slotIndex >= 0 && slotIndex < (int32_t)MAX_VIDEO_FRAME_QUEUE_COUNT);
+	fplAssert(ring.fences[slotIndex] == nullptr);
+	size_t slotOffset = slotIndex * ring.slotSize;
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, ring.bufferId);
+	for (uint32_t textureIndex = 0; textureIndex < textureCount; ++textureIndex) {
+		const VideoTexture &texture = textures[textureIndex];
+		glBindTexture(texture.target, texture.id);
+		glTexSubImage2D(texture.target, 0, 0, 0, texture.width, texture.height, texture.format, GL_UNSIGNED_BYTE, (void *)(slotOffset + ring.textureOffsets[textureIndex]));
+		glBindTexture(texture.target, 0);
+	}
+	glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+	fplAtomicStoreS32(&ring.isInFlight[slotIndex], 1);
+	ring.fences[slotIndex] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+	CheckGLError();
+}
+
+// Called from the decoder thread, returns true when the frame was written into the given slot
+static bool WriteVideoFrameToUploadRing(VideoContext &video, const int32_t slotIndex, const AVFrame *sourceNativeFrame, volatile uint32_t *stopRequest) {
+	// Wait until the main thread has initialized the rendering
+	VideoUploadMode uploadMode;
+	while ((uploadMode = (VideoUploadMode)fplAtomicLoadS32(&video.uploadMode)) == VideoUploadMode::Unknown) {
+		if (*stopRequest) {
+			return false;
+		}
+		fplThreadSleep(1);
+	}
+	if (uploadMode != VideoUploadMode::UploadRing) {
+		return false;
+	}
+
+	// Wait until the GPU has finished reading the previous frame from the slot
+	VideoUploadRing &ring = video.uploadRing;
+	while (fplAtomicLoadS32(&ring.isInFlight[slotIndex])) {
+		if (*stopRequest) {
+			return false;
+		}
+		fplThreadSleep(1);
+	}
+
+	uint8_t *slot = ring.base + slotIndex * ring.slotSize;
+	for (uint32_t textureIndex = 0; textureIndex < video.targetTextureCount; ++textureIndex) {
+		WriteVideoTexture(video, textureIndex, sourceNativeFrame, slot + ring.textureOffsets[textureIndex]);
+	}
+	return true;
+}
+#endif // USE_HARDWARE_RENDERING && USE_GL_PBO
+
 //
 // Audio
 //
@@ -1227,6 +1573,15 @@ struct AudioChannelMap {
 	bool isActive;
 };
 
+// Range of converted samples in the audio sample buffer
+struct AudioChunk {
+	// Presentation time in seconds at the end of the chunk
+	double endPTS;
+	// Size in bytes
+	uint32_t size;
+	int32_t serial;
+};
+
 struct AudioContext {
 	MediaStream stream;
 	Decoder decoder;
@@ -1244,14 +1599,21 @@ struct AudioContext {
 	fplAudioBackendType backend;
 
 	SwrContext *softwareResampleCtx;
-	Frame *pendingAudioFrame;
+
+	// Samples converted by the decoder thread in the exact format of the audio device, the audio callback just copies them out
+	LockFreeRingBuffer sampleBuffer;
+	// Chunks of the sample buffer in the same order, so the audio callback knows the timing and the serial of the samples
+	SPSCBoundedQueue<AudioChunk> chunkQueue;
+	// Chunk which is currently played by the audio callback
+	AudioChunk playingChunk;
+	uint32_t playingChunkRemaining;
 
 	// @NOTE(final): Buffer holding some amount of samples in the format FPL expects, required for doing conversion using swr_convert().
 	uint8_t *conversionAudioBuffer;
 	uint32_t maxConversionAudioFrameCount;
 	uint32_t maxConversionAudioBufferSize;
-	uint32_t conversionAudioFramesRemaining;
-	uint32_t conversionAudioFrameIndex;
+
+	StageStats convertStats;
 
 	bool32 isValid;
 };
@@ -1330,6 +1692,9 @@ struct PlayerSettings {
 	bool32 isLoop;
 	bool32 isVideoDisabled;
 	bool32 isAudioDisabled;
+	bool32 isSeekIndexDisabled;
+	// Demux, decode and convert as fast as possible, without any window, audio device or presentation
+	bool32 isBenchmark;
 };
 
 static void InitPlayerSettings(PlayerSettings &settings) {
@@ -1339,15 +1704,159 @@ static void InitPlayerSettings(PlayerSettings &settings) {
 	settings.isInfiniteBuffer = false;
 	settings.isLoop = false;
 	settings.reorderDecoderPTS = -1;
+	settings.isSeekIndexDisabled = false;
+	settings.isBenchmark = false;
 }
 
 struct SeekState {
 	int64_t pos;
 	int64_t rel;
+	// Target in seconds for frame accurate seeking
+	double accurateTarget;
 	int32_t seekFlags;
+	bool32 isAccurate;
 	bool32 isRequired;
 };
 
+//
+// Seek Indexer
+//
+// Builds or loads the keyframe index of a local media file in the background
+struct SeekIndexer {
+	SeekIndex index;
+	char mediaFilePath[FPL_MAX_PATH_LENGTH];
+	fplThreadHandle *thread;
+	volatile uint32_t stopRequest;
+	// Index is complete and will not change anymore
+	volatile uint32_t isReady;
+};
+
+static int SeekIndexerInterruptCallback(void *opaque) {
+	SeekIndexer *indexer = (SeekIndexer *)opaque;
+	int result = indexer->stopRequest;
+	return(result);
+}
+
+static bool BuildSeekIndex(SeekIndexer &indexer, const uint64_t mediaFileSize, const uint64_t mediaModifyTime) {
+	AVFormatContext *formatCtx = ffmpeg.avformat_alloc_context();
+	if (formatCtx == nullptr) {
+		return false;
+	}
+	formatCtx->interrupt_callback.callback = SeekIndexerInterruptCallback;
+	formatCtx->interrupt_callback.opaque = &indexer;
+
+	// The context is released on failure
+	if (ffmpeg.avformat_open_input(&formatCtx, indexer.mediaFilePath, nullptr, nullptr) != 0) {
+		return false;
+	}
+
+	bool result = false;
+
+	InitSeekIndex(indexer.index, mediaFileSize, mediaModifyTime);
+
+	AVPacket packet = fplZeroInit;
+
+	if (ffmpeg.avformat_find_stream_info(formatCtx, nullptr) < 0) {
+		goto done;
+	}
+
+	for (uint32_t streamIndex = 0; streamIndex < formatCtx->nb_streams; ++streamIndex) {
+		AVStream *stream = formatCtx->streams[streamIndex];
+		AVMediaType codecType = stream->codecpar->codec_type;
+		if (codecType == AVMEDIA_TYPE_VIDEO || codecType == AVMEDIA_TYPE_AUDIO) {
+			int64_t minDistance = 0;
+			if (codecType == AVMEDIA_TYPE_AUDIO && stream->time_base.num > 0) {
+				minDistance = (int64_t)(SEEK_INDEX_MIN_AUDIO_DISTANCE * stream->time_base.den / stream->time_base.num);
+			}
+			AddSeekIndexStream(indexer.index, (int32_t)streamIndex, stream->time_base.num, stream->time_base.den, minDistance);
+		}
+	}
+
+	for (;;) {
+		int res = ffmpeg.av_read_frame(formatCtx, &packet);
+		if (res < 0) {
+			result = (res == AVERROR_EOF) && !indexer.stopRequest;
+			break;
+		}
+		if (packet.flags & AV_PKT_FLAG_KEY) {
+			SeekIndexStream *indexStream = FindSeekIndexStream(indexer.index, packet.stream_index);
+			int64_t pts = (packet.pts != AV_NOPTS_VALUE) ? packet.pts : packet.dts;
+			if (indexStream != nullptr && pts != AV_NOPTS_VALUE) {
+				int64_t dts = (packet.dts != AV_NOPTS_VALUE) ? packet.dts : SEEK_INDEX_NO_VALUE;
+				if (!AddSeekIndexEntry(*indexStream, pts, dts, packet.pos)) {
+					ffmpeg.av_packet_unref(&packet);
+					break;
+				}
+			}
+		}
+		ffmpeg.av_packet_unref(&packet);
+	}
+
+done:
+	ffmpeg.avformat_close_input(&formatCtx);
+	if (!result) {
+		ReleaseSeekIndex(indexer.index);
+	}
+	return(result);
+}
+
+static void SeekIndexerThreadProc(const fplThreadHandle *thread, void *userData) {
+	SeekIndexer *indexer = (SeekIndexer *)userData;
+	fplAssert(indexer != nullptr);
+
+	uint64_t mediaFileSize, mediaModifyTime;
+	if (!GetSeekIndexMediaKey(indexer->mediaFilePath, &mediaFileSize, &mediaModifyTime)) {
+		return;
+	}
+
+	char indexFilePath[FPL_MAX_PATH_LENGTH];
+	if (!GetSeekIndexFilePath(indexer->mediaFilePath, indexFilePath, fplArrayCount(indexFilePath))) {
+		return;
+	}
+
+	// Use the stored index, when the media file has not changed since
+	if (LoadSeekIndex(indexer->index, indexFilePath, mediaFileSize, mediaModifyTime)) {
+		FPL_LOG_INFO("App", "Loaded seek index '%s'\n", indexFilePath);
+		fplAtomicStoreU32(&indexer->isReady, 1);
+		return;
+	}
+
+	fplTimestamp startTime = fplTimestampQuery();
+	if (BuildSeekIndex(*indexer, mediaFileSize, mediaModifyTime)) {
+		double buildTime = fplTimestampElapsed(startTime, fplTimestampQuery());
+		FPL_LOG_INFO("App", "Built seek index for '%s' in %.2f secs\n", indexer->mediaFilePath, buildTime);
+		if (!SaveSeekIndex(indexer->index, indexFilePath)) {
+			FPL_LOG_WARN("App", "Failed saving seek index '%s'\n", indexFilePath);
+		}
+		fplAtomicStoreU32(&indexer->isReady, 1);
+	}
+}
+
+static void StartSeekIndexer(SeekIndexer &indexer, const char *mediaFilePath) {
+	fplAssert(indexer.thread == nullptr);
+	indexer.index = {};
+	indexer.stopRequest = 0;
+	indexer.isReady = 0;
+	fplCopyString(mediaFilePath, indexer.mediaFilePath, fplArrayCount(indexer.mediaFilePath));
+	indexer.thread = fplThreadCreate(SeekIndexerThreadProc, &indexer);
+}
+
+static void StopSeekIndexer(SeekIndexer &indexer) {
+	if (indexer.thread != nullptr) {
+		indexer.stopRequest = 1;
+		fplThreadWaitForOne(indexer.thread, FPL_TIMEOUT_INFINITE);
+		fplThreadTerminate(indexer.thread);
+		indexer.thread = nullptr;
+	}
+	ReleaseSeekIndex(indexer.index);
+	indexer.isReady = 0;
+}
+
+static bool IsSeekIndexReady(SeekIndexer &indexer) {
+	bool result = fplAtomicLoadU32(&indexer.isReady) != 0;
+	return(result);
+}
+
 //
 // Font
 //
@@ -1863,6 +2372,7 @@ struct PlayerState {
 
 	Clock externalClock;
 	SeekState seek;
+	SeekIndexer indexer;
 
 	AVFormatContext *formatCtx;
 
@@ -1948,7 +2458,7 @@ static void StopAndReleaseMedia(PlayerState &state, const uint32_t mainThreadId)
 	SetPlayingState(state, PlayingState::Stopping);
 
 	// Stop audio
-	if (state.audio.isValid) {
+	if (state.audio.isValid && !state.settings.isBenchmark) {
 		fplStopAudio();
 		fplAudioRelease();
 	}
@@ -1956,6 +2466,9 @@ static void StopAndReleaseMedia(PlayerState &state, const uint32_t mainThreadId)
 	// Stop reader
 	StopReader(state.reader);
 
+	// Stop indexer
+	StopSeekIndexer(state.indexer);
+
 	// Stop decoders
 	if (state.video.isValid) {
 		StopDecoder(state.video.decoder);
@@ -1993,8 +2506,13 @@ static bool LoadAndPlayMedia(PlayerState &state, const char *mediaURL, const uin
 	// Start reader
 	StartReader(state.reader, PacketReadThreadProc, &state);
 
+	// Start building or loading the seek index for local files
+	if (!state.settings.isSeekIndexDisabled && !state.isRealTime && fplFileExists(mediaURL)) {
+		StartSeekIndexer(state.indexer, mediaURL);
+	}
+
 	// Start playing audio
-	if (state.audio.isValid) {
+	if (state.audio.isValid && !state.settings.isBenchmark) {
 		fplSetAudioClientReadCallback(AudioReadCallback, &state.audio);
 		fplPlayAudio();
 	}
@@ -2087,6 +2605,8 @@ static void ReleaseApp(AppState &state, const uint32_t mainThreadId) {
 
 	ReleaseFontBuffer(state.fontBuffer);
 	ReleaseFontInfo(state.fontInfo);
+
+	ReleaseConversionPool(globalConversionPool);
 }
 
 static bool InitApp(AppState &state) {
@@ -2120,6 +2640,13 @@ static bool InitApp(AppState &state) {
 	// Font Buffer
 	state.fontBuffer = AllocFontBuffer(state.fontInfo.atlasWidth, state.fontInfo.atlasHeight, state.fontInfo.atlasBitmap);
 
+	// Conversion pool, the calling thread converts rows as well
+	size_t coreCount = fplCPUGetCoreCount();
+	uint32_t conversionThreadCount = coreCount > 1 ? (uint32_t)(coreCount - 1) : 0;
+	if (!InitConversionPool(globalConversionPool, conversionThreadCount)) {
+		FPL_LOG_WARN("App", "Failed initializing conversion pool with '%u' threads, convert on the calling thread only", conversionThreadCount);
+	}
+
 	// Player
 	InitPlayer(state.player);
 
@@ -2132,8 +2659,8 @@ static bool InitApp(AppState &state) {
 //
 // Utils
 //
-static void PutPacketBackToReader(ReaderContext &reader, PacketList *packet) {
-	ReleasePacket(reader.packetQueue, packet);
+static void PutPacketBackToReader(Decoder &decoder, PacketList *packet) {
+	ReleasePacket(decoder.packetsQueue, packet);
 }
 
 static bool StreamHasEnoughPackets(const AVStream *stream, const int streamIndex, const PacketQueue &queue) {
@@ -2291,10 +2818,10 @@ static DecodeResult DecodeFrame(ReaderContext &reader, Decoder &decoder, AVFrame
 		}
 
 		do {
-			if (decoder.frameQueue.hasPendingPacket) {
-				fplAssert(decoder.frameQueue.pendingPacket != nullptr);
-				pkt = decoder.frameQueue.pendingPacket;
-				decoder.frameQueue.hasPendingPacket = false;
+			if (decoder.hasPendingPacket) {
+				fplAssert(decoder.pendingPacket != nullptr);
+				pkt = decoder.pendingPacket;
+				decoder.hasPendingPacket = false;
 			} else {
 				pkt = nullptr;
 				if (PopPacket(decoder.packetsQueue, pkt)) {
@@ -2304,6 +2831,11 @@ static DecodeResult DecodeFrame(ReaderContext &reader, Decoder &decoder, AVFrame
 					return DecodeResult::RequireMorePackets;
 				}
 			}
+			if (decoder.packetsQueue.serial != decoder.pktSerial) {
+				// Packet was queued before the last flush, so it is released without decoding
+				PutPacketBackToReader(decoder, pkt);
+				pkt = nullptr;
+			}
 		} while (decoder.packetsQueue.serial != decoder.pktSerial);
 
 		if (pkt != nullptr) {
@@ -2315,13 +2847,13 @@ static DecodeResult DecodeFrame(ReaderContext &reader, Decoder &decoder, AVFrame
 				decoder.finishedSerial = 0;
 				decoder.next_pts = decoder.start_pts;
 				decoder.next_pts_tb = decoder.start_pts_tb;
-				PutPacketBackToReader(reader, pkt);
+				PutPacketBackToReader(decoder, pkt);
 			} else {
 				if (ffmpeg.avcodec_send_packet(codecCtx, &pkt->packet) == AVERROR(EAGAIN)) {
-					decoder.frameQueue.hasPendingPacket = true;
-					decoder.frameQueue.pendingPacket = pkt;
+					decoder.hasPendingPacket = true;
+					decoder.pendingPacket = pkt;
 				} else {
-					PutPacketBackToReader(reader, pkt);
+					PutPacketBackToReader(decoder, pkt);
 				}
 			}
 		}
@@ -2344,6 +2876,7 @@ static void QueuePicture(Decoder &decoder, AVFrame *sourceFrame, Frame *targetFr
 	targetFrame->duration = (currentFrameRate.num && currentFrameRate.den ? av_q2d({ currentFrameRate.den, currentFrameRate.num }) : 0);
 	targetFrame->serial = serial;
 	targetFrame->isUploaded = false;
+	targetFrame->isWritten = false;
 	targetFrame->sar = sourceFrame->sample_aspect_ratio;
 	targetFrame->width = sourceFrame->width;
 	targetFrame->height = sourceFrame->height;
@@ -2352,6 +2885,12 @@ static void QueuePicture(Decoder &decoder, AVFrame *sourceFrame, Frame *targetFr
 	fplDebugFormatOut("PTS V: %7.2f, Next: %7.2f\n", targetFrame->pts, decoder.next_pts);
 #endif
 
+#if USE_HARDWARE_RENDERING && USE_GL_PBO
+	// Write the pixels directly into the mapped memory, so the main thread just needs to start the upload
+	int32_t slotIndex = (int32_t)(targetFrame - decoder.frameQueue.frames);
+	targetFrame->isWritten = WriteVideoFrameToUploadRing(decoder.state->video, slotIndex, sourceFrame, &decoder.stopRequest);
+#endif
+
 	AddFrameToDecoder(decoder, targetFrame, sourceFrame);
 }
 
@@ -2381,25 +2920,62 @@ static void VideoDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 
 	AVStream *videoStream = decoder->stream->stream;
 
+	AVRational frameRate = ffmpeg.av_guess_frame_rate(state->formatCtx, videoStream, nullptr);
+	double frameDuration = (frameRate.num && frameRate.den) ? av_q2d({ frameRate.den, frameRate.num }) : 0.0;
+	AVRational secondsTimeBase = { 1, AV_TIME_BASE };
+
+	// Frames before this time are dropped for the serial of the last frame accurate seek
+	double accurateDropPTS = 0.0;
+	int32_t cacheLookupSerial = -1;
+	int32_t lastSerial = -1;
+
 	AVFrame *sourceFrame = ffmpeg.av_frame_alloc();
+	int32_t sourceFrameSerial = -1;
 	bool hasDecodedFrame = false;
+	bool skipWait = false;
 	for (;;) {
-		// Wait for any signal (Available packet, Free frame, Stopped, Wake up)
-		fplSignalWaitForAny(waitSignals, fplArrayCount(waitSignals), sizeof(fplSignalHandle *), FPL_TIMEOUT_INFINITE);
+		// Wait for any signal (Available packet, Free frame, Stopped, Wake up) or skip wait
+		if (!skipWait) {
+			fplSignalWaitForAny(waitSignals, fplArrayCount(waitSignals), sizeof(fplSignalHandle *), FPL_TIMEOUT_INFINITE);
+		} else {
+			skipWait = false;
+		}
 
 		// Stop decoder
 		if (decoder->stopRequest) {
 			break;
 		}
 
+		// Frame accurate seek was requested: When the target is in the GOP cache, it is queued directly.
+		// The packets from the keyframe are still decoded, but everything up to the cached frame is dropped.
+		int32_t accurateSeekSerial = fplAtomicLoadS32(&decoder->accurateSeekSerial);
+		if (accurateSeekSerial != cacheLookupSerial && accurateSeekSerial == decoder->packetsQueue.serial && decoder->pktSerial != accurateSeekSerial) {
+			cacheLookupSerial = accurateSeekSerial;
+			accurateDropPTS = decoder->accurateSeekPTS - frameDuration * 0.5;
+			if (hasDecodedFrame) {
+				// Decoded before the seek
+				ffmpeg.av_frame_unref(sourceFrame);
+				hasDecodedFrame = false;
+			}
+			int64_t targetPTS = ffmpeg.av_rescale_q((int64_t)(decoder->accurateSeekPTS * AV_TIME_BASE), secondsTimeBase, videoStream->time_base);
+			int64_t frameDurationPTS = ffmpeg.av_rescale_q((int64_t)(frameDuration * AV_TIME_BASE), secondsTimeBase, videoStream->time_base);
+			const AVFrame *cachedFrame = FindGOPCacheFrame(decoder->gopCache, targetPTS + frameDurationPTS / 2, frameDurationPTS);
+			if (cachedFrame != nullptr && ffmpeg.av_frame_ref(sourceFrame, cachedFrame) == 0) {
+				accurateDropPTS = av_q2d(videoStream->time_base) * cachedFrame->pts + frameDuration * 0.5;
+				sourceFrameSerial = accurateSeekSerial;
+				hasDecodedFrame = true;
+			}
+		}
+
 		// Wait until the decoder wakes up in the next iteration when the decoder is paused
-		if (decoder->isEOF) {
+		if (decoder->isEOF && !hasDecodedFrame) {
 			fplThreadSleep(10);
 			continue;
 		}
 
 		if (!hasDecodedFrame) {
 			// Decode video frame
+			fplTimestamp decodeStartTime = fplTimestampQuery();
 			DecodeResult decodeResult = DecodeFrame(reader, *decoder, sourceFrame);
 			if (decodeResult != DecodeResult::Success) {
 				if (decodeResult != DecodeResult::RequireMorePackets) {
@@ -2417,11 +2993,34 @@ static void VideoDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 					decoder->isEOF = 1;
 				}
 			} else {
+				AddStageTime(decoder->decodeStats, fplTimestampElapsed(decodeStartTime, fplTimestampQuery()));
 #if PRINT_QUEUE_INFOS
 				uint32_t decodedVideoFrameIndex = fplAtomicAddAndFetchU32(&decoder->decodedFrameCount, 1);
 				fplDebugFormatOut("Decoded video frame %lu\n", decodedVideoFrameIndex);
 #endif
 				hasDecodedFrame = true;
+				sourceFrameSerial = decoder->pktSerial;
+
+				// The cached frames are kept for frame accurate seeks only, any other seek may not start at a keyframe
+				if (decoder->pktSerial != lastSerial) {
+					lastSerial = decoder->pktSerial;
+					if (decoder->pktSerial != accurateSeekSerial) {
+						ClearGOPCache(decoder->gopCache);
+					}
+				}
+				AddFrameToGOPCache(decoder->gopCache, sourceFrame);
+
+				if (decoder->pktSerial == accurateSeekSerial && sourceFrame->pts != AV_NOPTS_VALUE) {
+					double threshold = (cacheLookupSerial == accurateSeekSerial) ? accurateDropPTS : decoder->accurateSeekPTS - frameDuration * 0.5;
+					double dpts = av_q2d(stream->stream->time_base) * sourceFrame->pts;
+					if (dpts < threshold) {
+						// Frame is before the seek target, continue decoding without waiting
+						ffmpeg.av_frame_unref(sourceFrame);
+						hasDecodedFrame = false;
+						skipWait = true;
+						continue;
+					}
+				}
 
 				if (state->settings.frameDrop > 0 || (state->settings.frameDrop && GetMasterSyncType(state) != AVSyncType::VideoMaster)) {
 					double dpts = NAN;
@@ -2449,7 +3048,7 @@ static void VideoDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 		if (hasDecodedFrame) {
 			Frame *targetFrame = nullptr;
 			if (PeekWritableFromFrameQueue(decoder->frameQueue, targetFrame)) {
-				QueuePicture(*decoder, sourceFrame, targetFrame, decoder->pktSerial);
+				QueuePicture(*decoder, sourceFrame, targetFrame, sourceFrameSerial);
 				ffmpeg.av_frame_unref(sourceFrame);
 				hasDecodedFrame = false;
 			}
@@ -2459,27 +3058,6 @@ static void VideoDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 	ffmpeg.av_frame_free(&sourceFrame);
 }
 
-static void QueueSamples(Decoder &decoder, AVFrame *sourceFrame, Frame *targetFrame, int32_t serial) {
-	fplAssert(targetFrame != nullptr);
-	fplAssert(targetFrame->frame != nullptr);
-	fplAssert(targetFrame->frame->pkt_size <= 0);
-	fplAssert(targetFrame->frame->nb_samples == 0);
-
-	AVStream *audioStream = decoder.stream->stream;
-	AVRational currentTimeBase = { 1, sourceFrame->sample_rate };
-
-	targetFrame->pos = sourceFrame->pkt_pos;
-	targetFrame->pts = (sourceFrame->pts == AV_NOPTS_VALUE) ? NAN : sourceFrame->pts * av_q2d(currentTimeBase);
-	targetFrame->duration = av_q2d({ sourceFrame->nb_samples, sourceFrame->sample_rate });
-	targetFrame->serial = serial;
-
-#if PRINT_PTS
-	fplDebugFormatOut("PTS A: %7.2f, Next: %7.2f\n", targetFrame->pts, decoder.next_pts);
-#endif
-
-	AddFrameToDecoder(decoder, targetFrame, sourceFrame);
-}
-
 static int SyncronizeAudio(PlayerState *state, const uint32_t sampleCount) {
 	int result = sampleCount;
 	if (GetMasterSyncType(state) != AVSyncType::AudioMaster) {
@@ -2505,7 +3083,81 @@ static int SyncronizeAudio(PlayerState *state, const uint32_t sampleCount) {
 			state->audio.audioDiffCum = 0;
 		}
 	}
-	return(result);
+	return(result);
+}
+
+// Converts all samples of the frame into the format of the audio device, returns the number of converted frames
+static uint32_t ConvertAudioSamples(AudioContext &audio, AVFrame *sourceFrame, const int wantedSampleCount) {
+	const AudioFormat &targetFormat = audio.audioTarget;
+	const uint32_t outputSampleStride = fplGetAudioFrameSizeInBytes(targetFormat.type, targetFormat.channels);
+	const uint32_t outputFormatSize = fplGetAudioFrameSizeInBytes(targetFormat.type, 1);
+
+	// @TODO(final): Handle audio format change here!
+	int conversionSampleCount = wantedSampleCount * (int)targetFormat.sampleRate / sourceFrame->sample_rate + 256;
+	conversionSampleCount = fplMin(conversionSampleCount, (int)audio.maxConversionAudioFrameCount);
+
+	// @TODO(final): Support for converting planar audio samples
+	uint8_t *targetSamples[8] = {};
+	targetSamples[0] = audio.conversionAudioBuffer;
+	int samplesPerChannel = ffmpeg.swr_convert(audio.softwareResampleCtx, (uint8_t **)targetSamples, conversionSampleCount, (const uint8_t **)sourceFrame->extended_data, sourceFrame->nb_samples);
+	if (samplesPerChannel <= 0) {
+		return 0;
+	}
+
+	// Reorder the channels to the speaker layout of the audio device
+	if (targetFormat.channels > 2 && audio.channelMap.isActive) {
+		uint8_t frameSamples[16 * 8];
+		fplAssert(outputSampleStride <= sizeof(frameSamples));
+		for (int frameIndex = 0; frameIndex < samplesPerChannel; ++frameIndex) {
+			uint8_t *frameData = audio.conversionAudioBuffer + frameIndex * outputSampleStride;
+			fplMemoryCopy(frameData, outputSampleStride, frameSamples);
+			for (uint32_t channelIndex = 0; channelIndex < targetFormat.channels; ++channelIndex) {
+				uint32_t targetChannelIndex = audio.channelMap.channels[channelIndex];
+				fplMemoryCopy(frameSamples + channelIndex * outputFormatSize, outputFormatSize, frameData + targetChannelIndex * outputFormatSize);
+			}
+		}
+	}
+
+	return (uint32_t)samplesPerChannel;
+}
+
+// Converted samples of one frame, which are not fully written into the sample buffer yet
+struct PendingAudioSamples {
+	// Presentation time in seconds at the start of the samples
+	double pts;
+	uint32_t size;
+	uint32_t offset;
+	int32_t serial;
+};
+
+// Writes as many pending samples into the sample buffer as possible, returns true when all samples are written
+static bool WritePendingAudioSamples(AudioContext &audio, PendingAudioSamples &pending) {
+	const uint32_t outputSampleStride = fplGetAudioFrameSizeInBytes(audio.audioTarget.type, audio.audioTarget.channels);
+	const double bytesPerSecond = (double)audio.audioTarget.bufferSizeInBytes;
+	while (pending.offset < pending.size) {
+		size_t freeBytes = 0;
+		if (!LockFreeRingBufferCanWrite(&audio.sampleBuffer, &freeBytes) || IsFull(audio.chunkQueue)) {
+			return false;
+		}
+		uint32_t bytesToWrite = (uint32_t)fplMin((size_t)(pending.size - pending.offset), freeBytes);
+		bytesToWrite -= bytesToWrite % outputSampleStride;
+		if (bytesToWrite == 0) {
+			return false;
+		}
+
+		bool written = LockFreeRingBufferWrite(&audio.sampleBuffer, audio.conversionAudioBuffer + pending.offset, bytesToWrite);
+		fplAssert(written);
+		pending.offset += bytesToWrite;
+
+		// The chunk is published after the samples, so the audio callback never sees a chunk without samples
+		AudioChunk chunk;
+		chunk.endPTS = pending.pts + pending.offset / bytesPerSecond;
+		chunk.size = bytesToWrite;
+		chunk.serial = pending.serial;
+		bool queued = Enqueue(audio.chunkQueue, chunk);
+		fplAssert(queued);
+	}
+	return true;
 }
 
 static void AudioDecodingThreadProc(const fplThreadHandle *thread, void *userData) {
@@ -2517,6 +3169,8 @@ static void AudioDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 	PlayerState *state = decoder->state;
 	fplAssert(state != nullptr);
 
+	AudioContext &audio = state->audio;
+
 	MediaStream *stream = decoder->stream;
 	fplAssert(stream != nullptr);
 	fplAssert(stream->isValid);
@@ -2525,8 +3179,6 @@ static void AudioDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 	fplSignalHandle *waitSignals[] = {
 		// New packet arrived
 		&decoder->packetsQueue.addedSignal,
-		// Frame queue changed
-		&decoder->frameQueue.signal,
 		// Stopped decoding
 		&decoder->stopSignal,
 		// Resume from sleeping
@@ -2534,75 +3186,112 @@ static void AudioDecodingThreadProc(const fplThreadHandle *thread, void *userDat
 	};
 
 	AVFrame *sourceFrame = ffmpeg.av_frame_alloc();
-	bool hasDecodedFrame = false;
+	PendingAudioSamples pending = {};
+	bool skipWait = false;
+	bool isBufferFull = false;
 	for (;;) {
-		// Wait for any signal (Available packet, Free frame, Stopped, Wake up)
-		fplSignalWaitForAny(waitSignals, fplArrayCount(waitSignals), sizeof(fplSignalHandle *), FPL_TIMEOUT_INFINITE);
+		// Wait for any signal (Available packet, Stopped, Wake up) or skip wait
+		// The audio callback does not signal anything, so we poll while the sample buffer is full
+		if (!skipWait) {
+			fplTimeoutValue timeout = isBufferFull ? AUDIO_SAMPLE_BUFFER_WAIT_TIME : FPL_TIMEOUT_INFINITE;
+			fplSignalWaitForAny(waitSignals, fplArrayCount(waitSignals), sizeof(fplSignalHandle *), timeout);
+		} else {
+			skipWait = false;
+		}
 
 		// Stop decoder
 		if (decoder->stopRequest) {
 			break;
 		}
 
+		// Write remaining samples from the last frame first, unless there was a seek in between
+		isBufferFull = false;
+		if (pending.offset < pending.size) {
+			if (pending.serial != decoder->packetsQueue.serial) {
+				pending = {};
+			} else if (!WritePendingAudioSamples(audio, pending)) {
+				isBufferFull = true;
+				continue;
+			}
+		}
+
 		// Wait until the decoder wakes up in the next iteration when the decoder is paused
 		if (decoder->isEOF) {
 			continue;
 		}
 
-		if (!hasDecodedFrame) {
-			// Decode video frame
-			DecodeResult decodeResult = DecodeFrame(reader, *decoder, sourceFrame);
-			if (decodeResult != DecodeResult::Success) {
-				if (decodeResult != DecodeResult::RequireMorePackets) {
-					ffmpeg.av_frame_unref(sourceFrame);
-				}
-				if (decodeResult == DecodeResult::EndOfStream) {
-					decoder->isEOF = 1;
-					continue;
-				} else if (decodeResult <= DecodeResult::Stopped) {
-					break;
-				}
+		// Decode audio frame
+		fplTimestamp decodeStartTime = fplTimestampQuery();
+		DecodeResult decodeResult = DecodeFrame(reader, *decoder, sourceFrame);
+		if (decodeResult != DecodeResult::Success) {
+			if (decodeResult != DecodeResult::RequireMorePackets) {
+				ffmpeg.av_frame_unref(sourceFrame);
+			}
+			if (decodeResult == DecodeResult::EndOfStream) {
+				decoder->isEOF = 1;
+				continue;
+			} else if (decodeResult <= DecodeResult::Stopped) {
+				break;
+			}
 
-				// Stream finished and no packets left to decode, then are finished as well
-				if (reader.isEOF && (decoder->packetsQueue.packetCount == 0)) {
-					decoder->isEOF = 1;
-				}
-			} else {
-#if PRINT_QUEUE_INFOS
-				uint32_t decodedAudioFrameIndex = fplAtomicAddAndFetchU32(&decoder->decodedFrameCount, 1);
-				fplDebugFormatOut("Decoded audio frame %lu\n", decodedAudioFrameIndex);
-#endif
-				hasDecodedFrame = true;
+			// Stream finished and no packets left to decode, then are finished as well
+			if (reader.isEOF && (decoder->packetsQueue.packetCount == 0)) {
+				decoder->isEOF = 1;
 			}
+			continue;
 		}
 
-		if (hasDecodedFrame) {
-			Frame *targetFrame = nullptr;
-			if (PeekWritableFromFrameQueue(decoder->frameQueue, targetFrame)) {
-				QueueSamples(*decoder, sourceFrame, targetFrame, decoder->pktSerial);
+		AddStageTime(decoder->decodeStats, fplTimestampElapsed(decodeStartTime, fplTimestampQuery()));
+
+#if PRINT_QUEUE_INFOS
+		uint32_t decodedAudioFrameIndex = fplAtomicAddAndFetchU32(&decoder->decodedFrameCount, 1);
+		fplDebugFormatOut("Decoded audio frame %lu\n", decodedAudioFrameIndex);
+#endif
+
+		// Continue decoding without waiting, until the sample buffer is full or there are no packets left
+		skipWait = true;
+
+		AVRational currentTimeBase = { 1, sourceFrame->sample_rate };
+		double pts = (sourceFrame->pts == AV_NOPTS_VALUE) ? NAN : sourceFrame->pts * av_q2d(currentTimeBase);
+
+#if PRINT_PTS
+		fplDebugFormatOut("PTS A: %7.2f, Next: %7.2f\n", pts, decoder->next_pts);
+#endif
+
+		// Drop all samples which ends before the target of a frame accurate seek
+		if (decoder->pktSerial == fplAtomicLoadS32(&decoder->accurateSeekSerial) && !isnan(pts)) {
+			double endPTS = pts + av_q2d({ sourceFrame->nb_samples, sourceFrame->sample_rate });
+			if (endPTS <= decoder->accurateSeekPTS) {
 				ffmpeg.av_frame_unref(sourceFrame);
-				hasDecodedFrame = false;
+				continue;
 			}
 		}
+
+		// Convert into the format of the audio device, so the audio callback just needs to copy the samples
+		int wantedSampleCount = SyncronizeAudio(state, sourceFrame->nb_samples);
+		fplTimestamp convertStartTime = fplTimestampQuery();
+		uint32_t convertedFrameCount = ConvertAudioSamples(audio, sourceFrame, wantedSampleCount);
+		AddStageTime(audio.convertStats, fplTimestampElapsed(convertStartTime, fplTimestampQuery()));
+		ffmpeg.av_frame_unref(sourceFrame);
+
+		pending.pts = pts;
+		pending.size = convertedFrameCount * fplGetAudioFrameSizeInBytes(audio.audioTarget.type, audio.audioTarget.channels);
+		pending.offset = 0;
+		pending.serial = decoder->pktSerial;
+		if (!WritePendingAudioSamples(audio, pending)) {
+			isBufferFull = true;
+			skipWait = false;
+		}
 	}
 	ffmpeg.av_frame_free(&sourceFrame);
 }
 
-static void WriteSilenceSamples(AudioContext *audio, uint32_t remainingFrameCount, uint32_t outputSampleStride, uint8_t *conversionAudioBuffer) {
-	audio->conversionAudioFramesRemaining = remainingFrameCount;
-	audio->conversionAudioFrameIndex = 0;
-	size_t bytesToClear = remainingFrameCount * outputSampleStride;
-	fplMemoryClear(conversionAudioBuffer, bytesToClear);
-
-}
-
 static uint32_t AudioReadCallback(const fplAudioFormat *nativeFormat, const uint32_t frameCount, void *outputSamples, void *userData) {
 	double audioCallbackTime = (double)ffmpeg.av_gettime_relative();
 
 	// FPL Audio Frame = Audio Sample = [Left S16][Right S16]
 	// FPL Output frame are interleaved only!
-	// FFMPEG Planar audio: (Each channel a plane -> AVFrame->data[channel])
-	// FFMPEG Non-planar audio (One plane, Interleaved samples -> AVFrame->extended_data) [Left][Right],[Left][Right],..
+	// The decoder thread already converted the samples into the native format, so we just copy them out of the sample buffer
 	AudioContext *audio = (AudioContext *)userData;
 	fplAssert(audio != nullptr);
 
@@ -2613,136 +3302,57 @@ static uint32_t AudioReadCallback(const fplAudioFormat *nativeFormat, const uint
 	uint32_t result = 0;
 
 	if (audio->isValid) {
-		uint8_t *conversionAudioBuffer = audio->conversionAudioBuffer;
-		uint32_t maxConversionAudioBufferSize = audio->maxConversionAudioBufferSize;
-
 		uint32_t outputSamplesStride = fplGetAudioFrameSizeInBytes(nativeFormat->type, nativeFormat->channels);
-		uint32_t outputFormatSize = fplGetAudioFrameSizeInBytes(nativeFormat->type, 1);
-
-		uint32_t maxOutputSampleBufferSize = outputSamplesStride * frameCount;
 
 		uint32_t nativeBufferSizeInBytes = fplGetAudioBufferSizeInBytes(nativeFormat->type, nativeFormat->channels, nativeFormat->bufferSizeInFrames);
 
 		AudioFormat *targetFormat = &state->audio.audioTarget;
+		double bytesPerSecond = (double)targetFormat->bufferSizeInBytes;
 
-		uint32_t remainingFrameCount = frameCount;
-		while (remainingFrameCount > 0) {
-			if (state->isPaused) {
-				WriteSilenceSamples(audio, remainingFrameCount, outputSamplesStride, conversionAudioBuffer);
-			}
-
-			// Consume audio in conversion buffer before we do anything else
-			if ((audio->conversionAudioFramesRemaining) > 0) {
-				uint32_t maxFramesToRead = audio->conversionAudioFramesRemaining;
-				uint32_t framesToRead = fplMin(remainingFrameCount, maxFramesToRead);
-				size_t bytesToCopy = framesToRead * outputSamplesStride;
-
-				fplAssert(audio->conversionAudioFrameIndex < audio->maxConversionAudioFrameCount);
-				size_t sourcePosition = audio->conversionAudioFrameIndex * outputSamplesStride;
-				fplAssert(sourcePosition < audio->maxConversionAudioBufferSize);
+		uint8_t *output = (uint8_t *)outputSamples;
 
-				size_t destPosition = (frameCount - remainingFrameCount) * outputSamplesStride;
-				fplAssert(destPosition < maxOutputSampleBufferSize);
-
-				if (nativeFormat->channels <= 2 || !state->audio.channelMap.isActive) {
-					fplMemoryCopy(conversionAudioBuffer + sourcePosition, bytesToCopy, (uint8_t *)outputSamples + destPosition);
-				} else {
-					for (uint32_t frameIndex = 0; frameIndex < framesToRead; ++frameIndex) {
-						uintptr_t sourceFramePosition = sourcePosition + frameIndex * outputSamplesStride;
-						uintptr_t destFramePosition = destPosition + frameIndex * outputSamplesStride;
-						for (uint32_t channelIndex = 0; channelIndex < nativeFormat->channels; ++channelIndex) {
-							uint32_t targetChannelIndex = state->audio.channelMap.channels[channelIndex];
-							fplMemoryCopy(conversionAudioBuffer + sourceFramePosition + channelIndex * outputFormatSize, outputFormatSize, (uint8_t *)outputSamples + destFramePosition + targetChannelIndex * outputFormatSize);
-						}
-					}
+		uint32_t remainingFrameCount = frameCount;
+		while (remainingFrameCount > 0 && !state->isPaused) {
+			AudioChunk &chunk = audio->playingChunk;
+			if (audio->playingChunkRemaining == 0) {
+				if (!Dequeue(audio->chunkQueue, chunk)) {
+					// Decoder is too slow or we reached the end
+					break;
 				}
+				audio->playingChunkRemaining = chunk.size;
 
-				remainingFrameCount -= framesToRead;
-				audio->conversionAudioFrameIndex += framesToRead;
-				audio->conversionAudioFramesRemaining -= framesToRead;
-				result += framesToRead;
-			}
-
-			// If we consumed all remaining audio frames, then we are done.
-			if (remainingFrameCount == 0) {
-				// @NOTE(final): Its highly possible that there are frames left in the conversion buffer, so dont clear anything here!
-				break;
+				// Skip samples which was converted before the last seek
+				if (chunk.serial != decoder.packetsQueue.serial) {
+					bool skipped = LockFreeRingBufferSkip(&audio->sampleBuffer, chunk.size);
+					fplAssert(skipped);
+					audio->playingChunkRemaining = 0;
+					continue;
+				}
 			}
 
-			// Convert entire pending frame into conversion buffer
-			if (audio->pendingAudioFrame != nullptr) {
-				fplAssert(audio->conversionAudioFramesRemaining == 0);
-				Frame *audioFrame = audio->pendingAudioFrame;
-				fplAssert(audioFrame->frame != nullptr);
-				audio->pendingAudioFrame = nullptr;
-
-				// Get conversion sample count
-				const uint32_t maxConversionSampleCount = audio->maxConversionAudioFrameCount;
-				int wantedSampleCount = SyncronizeAudio(state, audioFrame->frame->nb_samples);
-				int conversionSampleCount = wantedSampleCount * nativeFormat->sampleRate / audioFrame->frame->sample_rate + 256;
-
-				// @TODO(final): Handle audio format change here!
-
-				//
-				// Convert samples
-				//
-				const uint32_t sourceSampleCount = audioFrame->frame->nb_samples;
-				const uint32_t sourceChannels = audioFrame->frame->channels;
-				const uint32_t sourceFrameCount = sourceSampleCount;
-				uint8_t **sourceSamples = audioFrame->frame->extended_data;
-				// @TODO(final): Support for converting planar audio samples
-				uint8_t *targetSamples[8] = {};
-				targetSamples[0] = audio->conversionAudioBuffer;
-
-				// @NOTE(final): Conversion buffer needs to be big enough to hold the samples for the frame
-				fplAssert(conversionSampleCount <= (int)maxConversionSampleCount);
-				int samplesPerChannel = ffmpeg.swr_convert(audio->softwareResampleCtx, (uint8_t **)targetSamples, conversionSampleCount, (const uint8_t **)sourceSamples, sourceSampleCount);
-
-				// We are done with this audio frame, release it
-				NextReadable(decoder.frameQueue);
-
-				// Update audio clock
-				if (!isnan(audioFrame->pts)) {
-					state->audio.audioClock = audioFrame->pts + (double)audioFrame->frame->nb_samples / (double)audioFrame->frame->sample_rate;
-				} else {
-					state->audio.audioClock = NAN;
-				}
-				state->audio.audioClockSerial = audioFrame->serial;
+			uint32_t framesToRead = fplMin(remainingFrameCount, audio->playingChunkRemaining / outputSamplesStride);
+			uint32_t bytesToRead = framesToRead * outputSamplesStride;
+			bool isRead = LockFreeRingBufferRead(&audio->sampleBuffer, output + result * outputSamplesStride, bytesToRead);
+			fplAssert(isRead);
 
-				if (samplesPerChannel <= 0) {
-					break;
-				}
+			audio->playingChunkRemaining -= bytesToRead;
+			remainingFrameCount -= framesToRead;
+			result += framesToRead;
 
-				audio->conversionAudioFramesRemaining = samplesPerChannel;
-				audio->conversionAudioFrameIndex = 0;
-			}
+			// Presentation time at the end of the copied samples
+			audio->audioClock = chunk.endPTS - audio->playingChunkRemaining / bytesPerSecond;
+			audio->audioClockSerial = chunk.serial;
+		}
 
-			if ((audio->pendingAudioFrame == nullptr) && (audio->conversionAudioFramesRemaining == 0)) {
-				Frame *newAudioFrame;
-				if (!state->isPaused && PeekReadableFromFrameQueue(decoder.frameQueue, newAudioFrame)) {
-					if (newAudioFrame->serial != decoder.packetsQueue.serial) {
-						NextReadable(decoder.frameQueue);
-						continue;
-					}
-					audio->pendingAudioFrame = newAudioFrame;
-					audio->conversionAudioFrameIndex = 0;
-					audio->conversionAudioFramesRemaining = 0;
-					continue;
-				} else {
-					// No audio frame available, write silence for the remaining frames
-					if (remainingFrameCount > 0) {
-						WriteSilenceSamples(audio, remainingFrameCount, outputSamplesStride, conversionAudioBuffer);
-					} else {
-						break;
-					}
-				}
-			}
+		// Write silence for the remaining frames
+		if (remainingFrameCount > 0) {
+			fplMemoryClear(output + result * outputSamplesStride, remainingFrameCount * outputSamplesStride);
+			result += remainingFrameCount;
 		}
 
 		// Update audio clock
 		if (!isnan(audio->audioClock)) {
-			uint32_t writtenSize = result * outputSamplesStride;
-			double pts = audio->audioClock - (double)(nativeFormat->periods * nativeBufferSizeInBytes + writtenSize) / (double)targetFormat->bufferSizeInBytes;
+			double pts = audio->audioClock - (double)(nativeFormat->periods * nativeBufferSizeInBytes) / bytesPerSecond;
 			SetClockAt(audio->clock, pts, audio->audioClockSerial, audioCallbackTime / (double)AV_TIME_BASE);
 			SyncClockToSlave(state->externalClock, audio->clock);
 		}
@@ -2791,6 +3401,21 @@ static void SeekStream(PlayerState *state, int64_t pos, int64_t rel) {
 		seek->seekFlags = AVSEEK_FLAG_ANY; // Seek to and frame, not just key frames
 		if (state->seekByBytes)
 			seek->seekFlags |= AVSEEK_FLAG_BYTE; // Some file formats does not allow to seek by seconds
+		seek->isAccurate = false;
+		seek->isRequired = 1;
+		fplSignalSet(&state->reader.resumeSignal);
+	}
+}
+
+// Seeks to the keyframe before the target and let the decoders drop everything before the target
+static void SeekStreamAccurate(PlayerState *state, const double targetSeconds) {
+	SeekState *seek = &state->seek;
+	if (!seek->isRequired) {
+		seek->pos = (int64_t)(targetSeconds * AV_TIME_BASE);
+		seek->rel = 0;
+		seek->seekFlags = 0;
+		seek->accurateTarget = targetSeconds;
+		seek->isAccurate = true;
 		seek->isRequired = 1;
 		fplSignalSet(&state->reader.resumeSignal);
 	}
@@ -2817,6 +3442,77 @@ static void StepToNextFrame(PlayerState *state) {
 	state->step = 1;
 }
 
+static void StepToPreviousFrame(PlayerState *state) {
+	if (!state->video.isValid) {
+		return;
+	}
+	if (!state->isPaused) {
+		StreamTogglePause(state);
+	}
+
+	// Last shown frame
+	const Frame *frame = PeekFrameQueueLast(state->video.decoder.frameQueue);
+	double pts = frame->pts;
+	if (isnan(pts) || frame->serial != state->video.decoder.packetsQueue.serial) {
+		pts = GetClock(state->video.clock);
+	}
+	if (isnan(pts)) {
+		return;
+	}
+
+	AVRational frameRate = ffmpeg.av_guess_frame_rate(state->formatCtx, state->video.stream.stream, nullptr);
+	double frameDuration = (frameRate.num && frameRate.den) ? av_q2d({ frameRate.den, frameRate.num }) : 0.0;
+
+	double target = pts - frameDuration;
+	double start = (state->formatCtx->start_time != AV_NOPTS_VALUE) ? state->formatCtx->start_time / (double)AV_TIME_BASE : 0.0;
+	if (target < start) {
+		target = start;
+	}
+
+	// The seek goes to the GOP cache of the video decoder first, so stepping back inside the current GOP needs no decoding
+	SeekStreamAccurate(state, target);
+}
+
+static int SeekToKeyframe(PlayerState *state, const double targetSeconds) {
+	AVFormatContext *formatCtx = state->formatCtx;
+	const MediaStream &mediaStream = state->video.isValid ? state->video.stream : state->audio.stream;
+	fplAssert(mediaStream.stream != nullptr);
+	int streamIndex = mediaStream.streamIndex;
+	AVRational secondsTimeBase = { 1, AV_TIME_BASE };
+	int64_t targetTS = ffmpeg.av_rescale_q((int64_t)(targetSeconds * AV_TIME_BASE), secondsTimeBase, mediaStream.stream->time_base);
+
+	if (IsSeekIndexReady(state->indexer)) {
+		const SeekIndexStream *indexStream = FindSeekIndexStream(state->indexer.index, streamIndex);
+		if (indexStream != nullptr && indexStream->count > 0) {
+			int32_t entryIndex = fplMax(FindSeekIndexEntry(*indexStream, targetTS), 0);
+			const SeekIndexEntry &entry = indexStream->entries[entryIndex];
+			if (state->seekByBytes && entry.pos >= 0) {
+				return ffmpeg.avformat_seek_file(formatCtx, -1, INT64_MIN, entry.pos, entry.pos, AVSEEK_FLAG_BYTE);
+			}
+			// Demuxers are seeking by the decoding or the presentation timestamp, so the smaller one never skips the keyframe
+			int64_t keyframeTS = (entry.dts != SEEK_INDEX_NO_VALUE) ? fplMin(entry.pts, entry.dts) : entry.pts;
+			return ffmpeg.avformat_seek_file(formatCtx, streamIndex, INT64_MIN, keyframeTS, keyframeTS, 0);
+		}
+	}
+
+	// Without an index, we let the demuxer find the keyframe before the target
+	return ffmpeg.avformat_seek_file(formatCtx, streamIndex, INT64_MIN, targetTS, targetTS, 0);
+}
+
+static void SetAccurateSeekTarget(Decoder &decoder, const double targetSeconds) {
+	decoder.accurateSeekPTS = targetSeconds;
+	// The serial of the flush packet, which will be pushed next
+	fplAtomicStoreS32(&decoder.accurateSeekSerial, decoder.packetsQueue.serial + 1);
+}
+
+// Returns true, when all decoders has reached the end of the current serial and everything they have decoded was consumed
+static bool IsDecodingFinished(PlayerState *state) {
+	bool result =
+		(!state->audio.isValid || (state->audio.decoder.finishedSerial == state->audio.decoder.packetsQueue.serial && IsEmpty(state->audio.chunkQueue))) &&
+		(!state->video.isValid || (state->video.decoder.finishedSerial == state->video.decoder.packetsQueue.serial && GetFrameQueueRemainingCount(state->video.decoder.frameQueue) == 0));
+	return(result);
+}
+
 static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData) {
 	PlayerState *state = (PlayerState *)userData;
 	fplAssert(state != nullptr);
@@ -2831,7 +3527,7 @@ static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData)
 
 	fplSignalHandle *waitSignals[] = {
 		// We got a free packet for use to read into
-		&reader.packetQueue.freeSignal,
+		&reader.freeSignal,
 		// Reader should terminate
 		&reader.stopSignal,
 		// Reader can continue
@@ -2879,31 +3575,45 @@ static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData)
 #if PRINT_SEEKES
 			fplConsoleFormatOut("Seek to: %llu %llu %llu (%f %f %f)\n", seekMin, seekTarget, seekMax, seekMinSeconds, seekTargetSeconds, seekMaxSeconds);
 #endif
-			int seekResult = ffmpeg.avformat_seek_file(formatCtx, -1, seekMin, seekTarget, seekMax, seekFlags);
+			int seekResult;
+			if (state->seek.isAccurate) {
+				seekResult = SeekToKeyframe(state, state->seek.accurateTarget);
+			} else {
+				seekResult = ffmpeg.avformat_seek_file(formatCtx, -1, seekMin, seekTarget, seekMax, seekFlags);
+			}
 			if (seekResult < 0) {
 				// @TODO(final): Log seek error
 			} else {
+				// A packet read before the seek and still waiting for a free packet would be queued after the flush packet
+				if (hasPendingPacket) {
+					ffmpeg.av_packet_unref(&srcPacket);
+					hasPendingPacket = false;
+				}
+
+				// The decoders releases all packets queued before the flush packet
 				if (state->audio.isValid) {
-					FlushPacketQueue(state->audio.decoder.packetsQueue);
+					if (state->seek.isAccurate) {
+						SetAccurateSeekTarget(state->audio.decoder, state->seek.accurateTarget);
+					}
 					PushFlushPacket(state->audio.decoder.packetsQueue);
 
 					state->audio.decoder.isEOF = false;
 					fplSignalSet(&state->audio.decoder.resumeSignal);
-
-					state->audio.pendingAudioFrame = nullptr;
-					state->audio.conversionAudioFrameIndex = 0;
-					state->audio.conversionAudioFramesRemaining = 0;
 				}
 
 				if (state->video.isValid) {
-					FlushPacketQueue(state->video.decoder.packetsQueue);
+					if (state->seek.isAccurate) {
+						SetAccurateSeekTarget(state->video.decoder, state->seek.accurateTarget);
+					}
 					PushFlushPacket(state->video.decoder.packetsQueue);
 
 					state->video.decoder.isEOF = false;
 					fplSignalSet(&state->video.decoder.resumeSignal);
 				}
 
-				if (state->seek.seekFlags & AVSEEK_FLAG_BYTE) {
+				if (state->seek.isAccurate) {
+					SetClock(state->externalClock, state->seek.accurateTarget, 0);
+				} else if (state->seek.seekFlags & AVSEEK_FLAG_BYTE) {
 					SetClock(state->externalClock, NAN, 0);
 				} else {
 					SetClock(state->externalClock, seekTarget / (double)AV_TIME_BASE, 0);
@@ -2935,9 +3645,7 @@ static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData)
 		bool autoExit = true;
 		int64_t startTime = AV_NOPTS_VALUE;
 
-		if (!state->isPaused &&
-			(!state->audio.isValid || (state->audio.decoder.finishedSerial == state->audio.decoder.packetsQueue.serial && GetFrameQueueRemainingCount(state->audio.decoder.frameQueue) == 0)) &&
-			(!state->video.isValid || (state->video.decoder.finishedSerial == state->video.decoder.packetsQueue.serial && GetFrameQueueRemainingCount(state->video.decoder.frameQueue) == 0))) {
+		if (!state->isPaused && IsDecodingFinished(state)) {
 			if ((state->loop == -1) || (state->loop > 0)) {
 				if (state->loop > 0) {
 					--state->loop;
@@ -2952,6 +3660,7 @@ static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData)
 
 		// Read packet
 		if (!hasPendingPacket) {
+			fplTimestamp readStartTime = fplTimestampQuery();
 			int res = ffmpeg.av_read_frame(formatCtx, &srcPacket);
 			if (res < 0) {
 				if ((res == AVERROR_EOF || ffmpeg.avio_feof(formatCtx->pb)) && !reader.isEOF) {
@@ -2974,6 +3683,7 @@ static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData)
 				skipWait = true;
 				continue;
 			} else {
+				AddStageTime(reader.readStats, fplTimestampElapsed(readStartTime, fplTimestampQuery()));
 				hasPendingPacket = true;
 				reader.isEOF = false;
 			}
@@ -2994,12 +3704,18 @@ static void PacketReadThreadProc(const fplThreadHandle *thread, void *userData)
 				((timeInSeconds / (double)AV_TIME_BASE) <= ((double)state->settings.duration.value / (double)AV_TIME_BASE));
 
 			if ((videoStream != nullptr) && (srcPacket.stream_index == videoStream->streamIndex) && pktInPlayRange) {
-				AddPacketToDecoder(video.decoder, &srcPacket);
+				if (!AddPacketToDecoder(video.decoder, &srcPacket)) {
+					// No free packet left, wait until the decoder releases one
+					continue;
+				}
 #if PRINT_QUEUE_INFOS
 				fplDebugFormatOut("Queued video packet %lu\n", packetIndex);
 #endif
 			} else if ((audioStream != nullptr) && (srcPacket.stream_index == audioStream->streamIndex) && pktInPlayRange) {
-				AddPacketToDecoder(audio.decoder, &srcPacket);
+				if (!AddPacketToDecoder(audio.decoder, &srcPacket)) {
+					// No free packet left, wait until the decoder releases one
+					continue;
+				}
 #if PRINT_QUEUE_INFOS
 				fplDebugFormatOut("Queued audio packet %lu\n", packetIndex);
 #endif
@@ -3247,11 +3963,15 @@ static void RenderOSD(AppState *state, const Mat4f &proj, const float w, const f
 		{
 			osdPos = V2f(0, osdFontSize * 0.5f);
 			int32_t videoQueueCount = playerState->video.decoder.frameQueue.count;
-			int32_t audioQueueCount = playerState->audio.decoder.frameQueue.count;
+			int32_t audioBufferMillis = 0;
+			if (playerState->audio.isValid && playerState->audio.audioTarget.bufferSizeInBytes > 0) {
+				int64_t audioBufferFillCount = fplAtomicLoadS64(&playerState->audio.sampleBuffer.fillCount);
+				audioBufferMillis = (int32_t)(audioBufferFillCount * 1000 / playerState->audio.audioTarget.bufferSizeInBytes);
+			}
 			int32_t allocatedPackets = globalMemStats.allocatedPackets;
 			int32_t usedPackets = globalMemStats.usedPackets;
 
-			fplStringFormat(osdTextBuffer, fplArrayCount(osdTextBuffer), "Queue A/V: %d/%d, Packets U/A: %d/%d", audioQueueCount, videoQueueCount, usedPackets, allocatedPackets);
+			fplStringFormat(osdTextBuffer, fplArrayCount(osdTextBuffer), "Queue A/V: %d ms/%d, Packets U/A: %d/%d", audioBufferMillis, videoQueueCount, usedPackets, allocatedPackets);
 			PushTextToBuffer(state->fontBuffer, state->fontInfo, osdTextBuffer, osdFontSize, osdPos, V4f(1, 1, 1, 1), TextRenderMode::Baseline);
 			osdPos += V2f(0, -osdFontSize);
 		}
@@ -3306,8 +4026,20 @@ static void RenderVideoFrame(AppState *state) {
 			int readIndex = playerState->video.decoder.frameQueue.readIndex;
 			vp = PeekFrameQueueLast(playerState->video.decoder.frameQueue);
 			bool wasUploaded = false;
+#if USE_HARDWARE_RENDERING && USE_GL_PBO
+			UpdateVideoUploadRing(video.uploadRing);
+#endif
 			if (!vp->isUploaded) {
+#if USE_HARDWARE_RENDERING && USE_GL_PBO
+				if (vp->isWritten) {
+					int32_t slotIndex = (int32_t)(vp - playerState->video.decoder.frameQueue.frames);
+					UploadVideoUploadRingSlot(video.uploadRing, slotIndex, video.targetTextures, video.targetTextureCount);
+				} else {
+					UploadTexture(video, vp->frame);
+				}
+#else
 				UploadTexture(video, vp->frame);
+#endif
 				vp->isUploaded = true;
 				wasUploaded = true;
 			}
@@ -3596,6 +4328,9 @@ static int DecodeInterruptCallback(void *opaque) {
 
 static void ReleaseVideoRendering(VideoContext &video) {
 #if USE_HARDWARE_RENDERING
+#	if USE_GL_PBO
+	ReleaseVideoUploadRing(video.uploadRing);
+#	endif
 	glDeleteProgram(video.basicShader.programId);
 	video.basicShader.programId = 0;
 	glDeleteBuffers(1, &video.indexBufferId);
@@ -3611,6 +4346,7 @@ static void ReleaseVideoRendering(VideoContext &video) {
 	}
 	video.targetTextureCount = 0;
 
+	fplAtomicStoreS32(&video.uploadMode, (int32_t)VideoUploadMode::Unknown);
 	video.requireRelease = 0;
 	video.isRenderingInitialized = false;
 }
@@ -3686,12 +4422,24 @@ static bool InitializeVideoRendering(VideoContext &video, const AVCodecContext *
 	}
 #endif
 
+	{
+		VideoUploadMode uploadMode = VideoUploadMode::MainThread;
+#if USE_HARDWARE_RENDERING && USE_GL_PBO
+		if (InitVideoUploadRing(video.uploadRing, video.targetTextures, video.targetTextureCount)) {
+			uploadMode = VideoUploadMode::UploadRing;
+		}
+#endif
+		fplAtomicStoreS32(&video.uploadMode, (int32_t)uploadMode);
+	}
+
 	video.requireInit = 0;
 	video.isRenderingInitialized = true;
 	return true;
 
 failed:
 	ReleaseVideoRendering(video);
+	// Let the decoder know, that it should not wait for the upload ring anymore
+	fplAtomicStoreS32(&video.uploadMode, (int32_t)VideoUploadMode::MainThread);
 	video.requireInit = 0;
 	return false;
 }
@@ -3699,7 +4447,9 @@ failed:
 static void ReleaseVideo(VideoContext &video, const uint32_t mainThreadId) {
 	uint32_t localThreadId = fplGetCurrentThreadId();
 	if (localThreadId == mainThreadId) {
-		ReleaseVideoRendering(video);
+		if (video.isRenderingInitialized) {
+			ReleaseVideoRendering(video);
+		}
 	} else {
 		video.requireRelease = 1;
 	}
@@ -3752,7 +4502,10 @@ static bool InitializeVideo(PlayerState &state, const char *mediaFilePath, const
 	}
 
 	localThreadId = fplGetCurrentThreadId();
-	if (localThreadId == mainThreadId) {
+	if (state.settings.isBenchmark) {
+		// There is nothing to render to, so the decoder must never wait for the upload ring
+		fplAtomicStoreS32(&video.uploadMode, (int32_t)VideoUploadMode::MainThread);
+	} else if (localThreadId == mainThreadId) {
 		if (!InitializeVideoRendering(video, videoCodexCtx)) {
 			FPL_LOG_ERROR("Video", "Failed to initialize video rendering for file '%s'!\n", mediaFilePath);
 			goto failed;
@@ -3773,6 +4526,10 @@ failed:
 }
 
 static void ReleaseAudio(AudioContext &audio) {
+	if (audio.chunkQueue.buffer != nullptr) {
+		SPSCBoundedQueue<AudioChunk>::Destroy(audio.chunkQueue);
+	}
+	LockFreeRingBufferRelease(&audio.sampleBuffer);
 	if (audio.conversionAudioBuffer != nullptr) {
 		fplMemoryAlignedFree(audio.conversionAudioBuffer);
 	}
@@ -3975,6 +4732,18 @@ static bool InitializeAudio(PlayerState &state, const char *mediaFilePath) {
 	fplAudioSettings audioSettings = fplZeroInit;
 	fplSetDefaultAudioSettings(&audioSettings);
 
+	if (state.settings.isBenchmark) {
+		// There is no audio device, so we convert into a typical device format instead
+		nativeAudioFormat.type = fplAudioFormatType_S16;
+		nativeAudioFormat.channels = 2;
+		nativeAudioFormat.channelLayout = fplAudioChannelLayout_Stereo;
+		nativeAudioFormat.sampleRate = audioCodexCtx->sample_rate;
+		nativeAudioFormat.periods = BENCHMARK_AUDIO_PERIODS;
+		nativeAudioFormat.bufferSizeInFrames = fplGetAudioBufferSizeInFrames(nativeAudioFormat.sampleRate, BENCHMARK_AUDIO_BUFFER_MILLISECONDS);
+		state.audio.backend = fplAudioBackendType_None;
+		goto initDecoder;
+	}
+
 	// Overwrite target format with audio codec infos (e.g. Channels, Sample Rate, Format)
 	audioSettings.targetFormat.channels = audioCodexCtx->channels;
 	audioSettings.targetFormat.sampleRate = audioCodexCtx->sample_rate;
@@ -4002,8 +4771,9 @@ static bool InitializeAudio(PlayerState &state, const char *mediaFilePath) {
 
 	state.audio.backend = fplGetAudioBackendType();
 
+initDecoder:
 	// Init audio decoder
-	if (!InitDecoder(audio.decoder, &state, &state.reader, &audio.stream, MAX_AUDIO_FRAME_QUEUE_COUNT, 1)) {
+	if (!InitDecoder(audio.decoder, &state, &state.reader, &audio.stream, 0, 0)) {
 		FPL_LOG_ERROR("App", "Failed initialize audio decoder for media file '%s'!\n", mediaFilePath);
 		goto failed;
 	}
@@ -4070,8 +4840,19 @@ static bool InitializeAudio(PlayerState &state, const char *mediaFilePath) {
 	audio.maxConversionAudioBufferSize = ffmpeg.av_samples_get_buffer_size(&lineSize, targetChannelCount, targetSampleRate, targetSampleFormat, 1);
 	audio.maxConversionAudioFrameCount = audio.maxConversionAudioBufferSize / fplGetAudioSampleSizeInBytes(nativeAudioFormat.type) / targetChannelCount;
 	audio.conversionAudioBuffer = (uint8_t *)fplMemoryAlignedAllocate(audio.maxConversionAudioBufferSize, 16);
-	audio.conversionAudioFrameIndex = 0;
-	audio.conversionAudioFramesRemaining = 0;
+
+	// Allocate sample buffer in native format, which is filled by the audio decoder and read by the audio callback
+	{
+		uint32_t targetFrameSize = fplGetAudioFrameSizeInBytes(nativeAudioFormat.type, targetChannelCount);
+		uint32_t sampleBufferFrameCount = fplMax((uint32_t)(targetSampleRate * AUDIO_SAMPLE_BUFFER_DURATION), nativeAudioFormat.bufferSizeInFrames * 2);
+		if (!LockFreeRingBufferInit(&audio.sampleBuffer, (size_t)sampleBufferFrameCount * targetFrameSize, true)) {
+			FPL_LOG_ERROR("App", "Failed allocating audio sample buffer for media file '%s'!\n", mediaFilePath);
+			goto failed;
+		}
+		audio.chunkQueue = SPSCBoundedQueue<AudioChunk>::Create(MAX_AUDIO_CHUNK_COUNT);
+		audio.playingChunk = {};
+		audio.playingChunkRemaining = 0;
+	}
 
 	return true;
 
@@ -4256,7 +5037,12 @@ static void SeekRelative(PlayerState *state, double incr) {
 		if ((state->formatCtx->start_time != AV_NOPTS_VALUE) && (pos < start)) {
 			pos = start;
 		}
-		SeekStream(state, (int64_t)(pos * AV_TIME_BASE), (int64_t)(incr * AV_TIME_BASE));
+		if (IsSeekIndexReady(state->indexer)) {
+			// The index knows every keyframe, so we can seek exactly to the position
+			SeekStreamAccurate(state, pos);
+		} else {
+			SeekStream(state, (int64_t)(pos * AV_TIME_BASE), (int64_t)(incr * AV_TIME_BASE));
+		}
 	}
 }
 
@@ -4293,9 +5079,206 @@ static void LoadMediaThreadProc(const fplThreadHandle *thread, void *userData) {
 	}
 }
 
+//
+// Benchmark
+//
+static void PrintStageStats(const char *name, const StageStats &stats) {
+	double avgTime = stats.count > 0 ? stats.totalTime / (double)stats.count : 0.0;
+	fplConsoleFormatOut("  %-16s %10llu calls, avg %8.3f ms, max %8.3f ms, total %8.3f s\n", name, (unsigned long long)stats.count, avgTime * 1000.0, stats.maxTime * 1000.0, stats.totalTime);
+}
+
+static void PrintQueueStats(const char *name, const QueueStats &stats) {
+	double avgValue = stats.sampleCount > 0 ? stats.total / (double)stats.sampleCount : 0.0;
+	fplConsoleFormatOut("  %-16s avg %8.2f, max %6lld\n", name, avgValue, (long long)stats.max);
+}
+
+// Runs the reader, the decoders and the conversion as fast as possible and prints the results.
+// The main thread consumes the video frames and audio samples instead of the presentation, so no window, audio device or clock is involved.
+// When validating, every video frame is converted with the scalar converter as well and both results must be identical.
+static int RunBenchmark(const char *mediaFilePath, const bool validateConversion) {
+	fplLogSettings log = fplZeroInit;
+	log.maxLevel = fplLogLevel_Warning;
+	log.writers[0].flags = fplLogWriterFlags_StandardConsole;
+	fplSetLogSettings(&log);
+
+	if (!fplPlatformInit(fplInitFlags_Console, fpl_null)) {
+		return -1;
+	}
+
+	int result = -1;
+
+	PlayerState state = {};
+	uint32_t mainThreadId = fplGetMainThread()->id;
+
+	uint8_t *videoPixels = nullptr;
+	uint8_t *scalarPixels = nullptr;
+	size_t videoPixelsSize = 0;
+	int32_t videoRowSize = 0;
+	uint64_t mismatchFrameCount = 0;
+
+	StageStats videoConvertStats = {};
+	QueueStats videoPacketStats = {};
+	QueueStats audioPacketStats = {};
+	QueueStats videoFrameStats = {};
+	QueueStats audioBufferStats = {};
+	uint64_t videoFrameCount = 0;
+	uint64_t audioByteCount = 0;
+	double elapsedTime = 0.0;
+	fplTimestamp startTime;
+	fplTimestamp lastSampleTime;
+
+	size_t coreCount = fplCPUGetCoreCount();
+	uint32_t conversionThreadCount = coreCount > 1 ? (uint32_t)(coreCount - 1) : 0;
+
+	if (!LoadFFMPEG(ffmpeg)) {
+		goto release;
+	}
+	ffmpeg.av_register_all();
+	ffmpeg.av_init_packet(&globalFlushPacket);
+	globalFlushPacket.data = (uint8_t *)&globalFlushPacket;
+
+	if (!InitConversionPool(globalConversionPool, conversionThreadCount)) {
+		FPL_LOG_WARN("App", "Failed initializing conversion pool with '%u' threads, convert on the calling thread only", conversionThreadCount);
+	}
+
+	InitPlayer(state);
+	state.settings.isBenchmark = true;
+	state.settings.isSeekIndexDisabled = true;
+	state.settings.frameDrop = 0;
+
+	if (!LoadAndPlayMedia(state, mediaFilePath, mainThreadId)) {
+		goto release;
+	}
+
+	if (state.video.isValid) {
+		AVCodecContext *videoCodecCtx = state.video.stream.codecContext;
+		videoRowSize = videoCodecCtx->width * 4;
+		videoPixelsSize = (size_t)videoRowSize * videoCodecCtx->height;
+		videoPixels = (uint8_t *)fplMemoryAlignedAllocate(videoPixelsSize, 64);
+		if (validateConversion) {
+			scalarPixels = (uint8_t *)fplMemoryAlignedAllocate(videoPixelsSize, 64);
+		}
+	}
+
+	startTime = fplTimestampQuery();
+	lastSampleTime = startTime;
+	for (;;) {
+		bool isIdle = true;
+
+		// Convert the next decoded video frame, like the presentation would do it
+		if (state.video.isValid && GetFrameQueueRemainingCount(state.video.decoder.frameQueue) > 0) {
+			Frame *frame = PeekFrameQueue(state.video.decoder.frameQueue);
+			fplTimestamp convertStartTime = fplTimestampQuery();
+			ConvertVideoFrameToRGB32(state.video, frame->frame, videoPixels, videoRowSize, ConversionFlags::None);
+			AddStageTime(videoConvertStats, fplTimestampElapsed(convertStartTime, fplTimestampQuery()));
+			if (scalarPixels != nullptr) {
+				ConvertVideoFrameToRGB32(state.video, frame->frame, scalarPixels, videoRowSize, ConversionFlags::ForceScalar);
+				if (memcmp(videoPixels, scalarPixels, videoPixelsSize) != 0) {
+					++mismatchFrameCount;
+				}
+			}
+			NextReadable(state.video.decoder.frameQueue);
+			++videoFrameCount;
+			isIdle = false;
+		}
+
+		// Consume all converted audio samples, like the audio callback would do it
+		if (state.audio.isValid) {
+			AudioChunk chunk;
+			while (Dequeue(state.audio.chunkQueue, chunk)) {
+				bool skipped = LockFreeRingBufferSkip(&state.audio.sampleBuffer, chunk.size);
+				fplAssert(skipped);
+				audioByteCount += chunk.size;
+				isIdle = false;
+			}
+		}
+
+		fplTimestamp currentTime = fplTimestampQuery();
+		if (fplTimestampElapsed(lastSampleTime, currentTime) >= BENCHMARK_SAMPLE_INTERVAL) {
+			lastSampleTime = currentTime;
+			if (state.video.isValid) {
+				AddQueueSample(videoPacketStats, fplAtomicLoadS32(&state.video.decoder.packetsQueue.packetCount));
+				AddQueueSample(videoFrameStats, GetFrameQueueRemainingCount(state.video.decoder.frameQueue));
+			}
+			if (state.audio.isValid) {
+				AddQueueSample(audioPacketStats, fplAtomicLoadS32(&state.audio.decoder.packetsQueue.packetCount));
+				int64_t audioBufferFillCount = fplAtomicLoadS64(&state.audio.sampleBuffer.fillCount);
+				AddQueueSample(audioBufferStats, audioBufferFillCount * 1000 / state.audio.audioTarget.bufferSizeInBytes);
+			}
+		}
+
+		// The reader stops by itself, when all decoders are finished and everything was consumed
+		if (isIdle) {
+			if (fplGetThreadState(state.reader.thread) == fplThreadState_Stopped && IsDecodingFinished(&state)) {
+				break;
+			}
+			fplThreadYield();
+		}
+	}
+	elapsedTime = fplTimestampElapsed(startTime, fplTimestampQuery());
+
+	fplConsoleFormatOut("Benchmark: %s\n", mediaFilePath);
+	fplConsoleFormatOut("  Elapsed time:    %.3f s\n", elapsedTime);
+	if (state.video.isValid) {
+		AVCodecContext *videoCodecCtx = state.video.stream.codecContext;
+		fplConsoleFormatOut("  Video:           %d x %d, %s, %llu frames, %.2f fps\n", videoCodecCtx->width, videoCodecCtx->height, ffmpeg.av_get_pix_fmt_name(videoCodecCtx->pix_fmt), (unsigned long long)videoFrameCount, elapsedTime > 0 ? videoFrameCount / elapsedTime : 0.0);
+	}
+	if (state.audio.isValid) {
+		double audioSeconds = audioByteCount / (double)state.audio.audioTarget.bufferSizeInBytes;
+		fplConsoleFormatOut("  Audio:           %u Hz, %.3f s, %.2fx realtime\n", state.audio.audioTarget.sampleRate, audioSeconds, elapsedTime > 0 ? audioSeconds / elapsedTime : 0.0);
+	}
+	fplConsoleFormatOut("Stages:\n");
+	PrintStageStats("Read", state.reader.readStats);
+	if (state.video.isValid) {
+		PrintStageStats("Video decode", state.video.decoder.decodeStats);
+		PrintStageStats("Video convert", videoConvertStats);
+	}
+	if (state.audio.isValid) {
+		PrintStageStats("Audio decode", state.audio.decoder.decodeStats);
+		PrintStageStats("Audio convert", state.audio.convertStats);
+	}
+	fplConsoleFormatOut("Queues:\n");
+	if (state.video.isValid) {
+		PrintQueueStats("Video packets", videoPacketStats);
+		PrintQueueStats("Video frames", videoFrameStats);
+	}
+	if (state.audio.isValid) {
+		PrintQueueStats("Audio packets", audioPacketStats);
+		PrintQueueStats("Audio ms", audioBufferStats);
+	}
+	if (scalarPixels != nullptr) {
+		fplConsoleFormatOut("Validation:\n");
+		fplConsoleFormatOut("  %llu of %llu frames differ from the scalar conversion\n", (unsigned long long)mismatchFrameCount, (unsigned long long)videoFrameCount);
+	}
+
+	result = mismatchFrameCount == 0 ? 0 : -1;
+
+release:
+	if (scalarPixels != nullptr) {
+		fplMemoryAlignedFree(scalarPixels);
+	}
+	if (videoPixels != nullptr) {
+		fplMemoryAlignedFree(videoPixels);
+	}
+	if (state.state != PlayingState::Unloaded && state.state != PlayingState::Failed) {
+		StopAndReleaseMedia(state, mainThreadId);
+	}
+	ReleaseConversionPool(globalConversionPool);
+	ReleaseFFMPEG(ffmpeg);
+	fplPlatformRelease();
+	return(result);
+}
+
 int main(int argc, char **argv) {
 	int result = 0;
 
+	if (argc == 3 && fplIsStringEqual(argv[1], "--bench")) {
+		return RunBenchmark(argv[2], false);
+	}
+	if (argc == 3 && fplIsStringEqual(argv[1], "--validate")) {
+		return RunBenchmark(argv[2], true);
+	}
+
 	const char *mediaURL = argc == 2 ? argv[1] : nullptr;
 
 	if (fplGetStringLength(mediaURL) == 0) {
@@ -4412,6 +5395,16 @@ int main(int argc, char **argv) {
 									double seekRelative = (ev.keyboard.mappedKey == fplKey_Left) ? -SeekStep : SeekStep;
 									SeekRelative(&playerState, seekRelative);
 								} break;
+
+								case fplKey_OemComma:
+								{
+									StepToPreviousFrame(&playerState);
+								} break;
+
+								case fplKey_OemPeriod:
+								{
+									StepToNextFrame(&playerState);
+								} break;
 							}
 						}
 					}
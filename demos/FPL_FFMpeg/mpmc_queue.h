@@ -1,7 +1,6 @@
 #pragma once
 
-#include <stdint.h>
-#include <limits.h>
+#include <final_platform_layer.h>
 
 //
 // Lock-Free Multiple Procuder Multiple Consumer Queue
@@ -30,9 +29,9 @@ struct MPMCBoundedQueue {
 	static MPMCBoundedQueue<T> Create(size_t capacity) {
 		size_t bufferCount = capacity;
 		MPMCBoundedQueue<T> result = {};
-		result.buffer = (MPMCBoundedQueueCell<T> *)memory::MemoryAlignedAllocate(sizeof(MPMCBoundedQueueCell<T>) * bufferCount, CACHE_LINE_SIZE);
+		result.buffer = (MPMCBoundedQueueCell<T> *)fplMemoryAlignedAllocate(sizeof(MPMCBoundedQueueCell<T>) * bufferCount, CACHE_LINE_SIZE);
 		result.bufferMask = bufferCount - 1;
-		assert((bufferCount >= 2) && ((bufferCount & (bufferCount - 1)) == 0));
+		fplAssert((bufferCount >= 2) && ((bufferCount & (bufferCount - 1)) == 0));
 		for (size_t i = 0; i < bufferCount; i += 1) {
 			result.buffer[i].sequence = i;
 		}
@@ -42,7 +41,7 @@ struct MPMCBoundedQueue {
 	}
 
 	static void Destroy(MPMCBoundedQueue<T> &queue) {
-		memory::MemoryAlignedFree(queue.buffer);
+		fplMemoryAlignedFree(queue.buffer);
 		queue = {};
 	}
 };
@@ -50,17 +49,17 @@ struct MPMCBoundedQueue {
 template <typename T>
 static bool IsEmpty(MPMCBoundedQueue<T> &queue) {
 	MPMCBoundedQueueCell<T> *cell;
-	uint64_t pos = AtomicLoadU64(&queue.dequeuePos);
+	uint64_t pos = fplAtomicLoadU64(&queue.dequeuePos);
 	for (;;) {
 		cell = &queue.buffer[pos & queue.bufferMask];
-		uint64_t seq = AtomicLoadU64(&cell->sequence);
+		uint64_t seq = fplAtomicLoadU64(&cell->sequence);
 		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
 		if (dif == 0) {
 			break;
 		} else if (dif < 0)
 			return true;
 		else
-			pos = AtomicLoadU64(&queue.dequeuePos);
+			pos = fplAtomicLoadU64(&queue.dequeuePos);
 	}
 	return false;
 }
@@ -68,93 +67,114 @@ static bool IsEmpty(MPMCBoundedQueue<T> &queue) {
 template <typename T>
 static bool Enqueue(MPMCBoundedQueue<T> &queue, const T &data) {
 	MPMCBoundedQueueCell<T> *cell;
-	uint64_t pos = AtomicLoadU64(&queue.enqueuePos);
+	uint64_t pos = fplAtomicLoadU64(&queue.enqueuePos);
 	for (;;) {
 		cell = &queue.buffer[pos & queue.bufferMask];
-		uint64_t seq = AtomicLoadU64(&cell->sequence);
+		uint64_t seq = fplAtomicLoadU64(&cell->sequence);
 		intptr_t dif = (intptr_t)seq - (intptr_t)pos;
 		if (dif == 0) {
-			if (IsAtomicCompareAndExchangeU64(&queue.enqueuePos, pos, pos + 1)) {
+			if (fplAtomicIsCompareAndSwapU64(&queue.enqueuePos, pos, pos + 1)) {
 				break;
 			}
 		} else if (dif < 0)
 			return false;
 		else
-			pos = AtomicLoadU64(&queue.enqueuePos);
+			pos = fplAtomicLoadU64(&queue.enqueuePos);
 	}
 	cell->data = data;
-	AtomicStoreU64(&cell->sequence, pos + 1);
+	fplAtomicStoreU64(&cell->sequence, pos + 1);
 	return true;
 }
 
 template <typename T>
 static bool Dequeue(MPMCBoundedQueue<T> &queue, T &data) {
 	MPMCBoundedQueueCell<T> *cell;
-	uint64_t pos = AtomicLoadU64(&queue.dequeuePos);
+	uint64_t pos = fplAtomicLoadU64(&queue.dequeuePos);
 	for (;;) {
 		cell = &queue.buffer[pos & queue.bufferMask];
-		uint64_t seq = AtomicLoadU64(&cell->sequence);
+		uint64_t seq = fplAtomicLoadU64(&cell->sequence);
 		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + 1);
 		if (dif == 0) {
-			if (IsAtomicCompareAndExchangeU64(&queue.dequeuePos, pos, pos + 1)) {
+			if (fplAtomicIsCompareAndSwapU64(&queue.dequeuePos, pos, pos + 1)) {
 				break;
 			}
 		} else if (dif < 0)
 			return false;
 		else
-			pos = AtomicLoadU64(&queue.dequeuePos);
+			pos = fplAtomicLoadU64(&queue.dequeuePos);
 	}
 	data = cell->data;
-	AtomicStoreU64(&cell->sequence, pos + queue.bufferMask + 1);
+	fplAtomicStoreU64(&cell->sequence, pos + queue.bufferMask + 1);
 	return true;
 }
 
+//
+// Lock-Free Single Producer Single Consumer Queue
+// Same layout as the MPMC queue, but without sequence cells: Each position is only advanced by one thread, so no compare and swap is required
+//
 template <typename T>
-static T &PeekReadable(MPMCBoundedQueue<T> &queue, int32_t offset = 1) {
-	MPMCBoundedQueueCell<T> *cell;
-	uint64_t pos = AtomicLoadU64(&queue.dequeuePos);
-	for (;;) {
-		cell = &queue.buffer[pos & queue.bufferMask];
-		uint64_t seq = AtomicLoadU64(&cell->sequence);
-		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + offset);
-		if (dif == 0) {
-			break;
-		} else if (dif < 0)
-			return false;
-		else
-			pos = AtomicLoadU64(&queue.dequeuePos);
+struct SPSCBoundedQueue {
+	CacheLinePad pad0;
+	T *buffer;
+	size_t bufferMask;
+	CacheLinePad pad1;
+	volatile uint64_t enqueuePos;
+	CacheLinePad pad2;
+	volatile uint64_t dequeuePos;
+	CacheLinePad pad3;
+
+	static SPSCBoundedQueue<T> Create(size_t capacity) {
+		size_t bufferCount = capacity;
+		SPSCBoundedQueue<T> result = {};
+		fplAssert((bufferCount >= 2) && ((bufferCount & (bufferCount - 1)) == 0));
+		result.buffer = (T *)fplMemoryAlignedAllocate(sizeof(T) * bufferCount, CACHE_LINE_SIZE);
+		result.bufferMask = bufferCount - 1;
+		result.enqueuePos = 0;
+		result.dequeuePos = 0;
+		return(result);
 	}
-	data = cell->data;
-	return true;
-}
 
-template <typename T>
-static T &PeekWritable(MPMCBoundedQueue<T> &queue, int32_t offset = 1) {
-	MPMCBoundedQueueCell<T> *cell;
-	uint64_t pos = AtomicLoadU64(&queue.enqueuePos);
-	for (;;) {
-		cell = &queue.buffer[pos & queue.bufferMask];
-		uint64_t seq = AtomicLoadU64(&cell->sequence);
-		intptr_t dif = (intptr_t)seq - (intptr_t)(pos + offset);
-		if (dif == 0) {
-			break;
-		} else if (dif < 0)
-			return false;
-		else
-			pos = AtomicLoadU64(&queue.enqueuePos);
+	static void Destroy(SPSCBoundedQueue<T> &queue) {
+		fplMemoryAlignedFree(queue.buffer);
+		queue = {};
 	}
-	data = cell->data;
-	return true;
-}
+};
 
 template <typename T>
-static T &PeekPrev(MPMCBoundedQueue<T> &queue) {
-	T &result = Peek(queue, data, -1);
+static bool IsEmpty(SPSCBoundedQueue<T> &queue) {
+	uint64_t pos = fplAtomicLoadU64(&queue.dequeuePos);
+	bool result = fplAtomicLoadU64(&queue.enqueuePos) == pos;
 	return(result);
 }
 
+// Must be called from the producer thread only
 template <typename T>
-static T &PeekNext(MPMCBoundedQueue<T> &queue) {
-	T &result = Peek(queue, data, 1);
+static bool IsFull(SPSCBoundedQueue<T> &queue) {
+	uint64_t pos = queue.enqueuePos;
+	bool result = (pos - fplAtomicLoadU64(&queue.dequeuePos)) > queue.bufferMask;
 	return(result);
-}
\ No newline at end of file
+}
+
+// Must be called from the producer thread only
+template <typename T>
+static bool Enqueue(SPSCBoundedQueue<T> &queue, const T &data) {
+	uint64_t pos = queue.enqueuePos;
+	if ((pos - fplAtomicLoadU64(&queue.dequeuePos)) > queue.bufferMask) {
+		return false;
+	}
+	queue.buffer[pos & queue.bufferMask] = data;
+	fplAtomicStoreU64(&queue.enqueuePos, pos + 1);
+	return true;
+}
+
+// Must be called from the consumer thread only
+template <typename T>
+static bool Dequeue(SPSCBoundedQueue<T> &queue, T &data) {
+	uint64_t pos = queue.dequeuePos;
+	if (fplAtomicLoadU64(&queue.enqueuePos) == pos) {
+		return false;
+	}
+	data = queue.buffer[pos & queue.bufferMask];
+	fplAtomicStoreU64(&queue.dequeuePos, pos + 1);
+	return true;
+}
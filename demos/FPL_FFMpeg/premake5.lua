@@ -10,6 +10,7 @@ project "FPL_FFMpeg"
 		"defines.h",
 		"ffmpeg.h",
 		"mpmc_queue.h",
+		"seekindex.h",
 		"shaders.h",
 		"utils.h",
 		"fpl_ffmpeg.cpp",
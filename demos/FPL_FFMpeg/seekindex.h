@@ -0,0 +1,289 @@
+/*
+-------------------------------------------------------------------------------
+Name:
+	FPL-Demo | FFmpeg | Seek Index
+
+Description:
+	Keyframe index per stream, used to seek exactly to the keyframe before any presentation timestamp.
+
+	The index is built once by demuxing the whole media file in the background and stored next to it (media path + ".fplidx").
+	It is keyed by the size and the last modify time of the media file, so a changed file never uses a stale index.
+
+	File layout:
+
+	[Header] [Stream Header|Entries] [Stream Header|Entries] ...
+
+	Entries are sorted by the presentation timestamp and all timestamps are in the time base of the stream.
+	A finished index is never changed, so it can be read from any thread without locking.
+
+License:
+	Copyright (c) 2017-2025 Torsten Spaete
+	MIT License (See LICENSE file)
+-------------------------------------------------------------------------------
+*/
+
+#ifndef SEEKINDEX_H
+#define SEEKINDEX_H
+
+#include <final_platform_layer.h>
+
+#define SEEK_INDEX_FILE_MAGIC 0x58495046 // FPIX
+#define SEEK_INDEX_VERSION 1
+#define SEEK_INDEX_FILE_EXTENSION ".fplidx"
+#define SEEK_INDEX_MAX_STREAM_COUNT 8
+#define SEEK_INDEX_INITIAL_CAPACITY 256
+#define SEEK_INDEX_NO_VALUE INT64_MIN
+
+typedef struct SeekIndexFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t mediaFileSize;
+	uint64_t mediaModifyTime;
+	uint32_t streamCount;
+	uint32_t reserved;
+} SeekIndexFileHeader;
+
+typedef struct SeekIndexStreamHeader {
+	int32_t streamIndex;
+	int32_t timeBaseNum;
+	int32_t timeBaseDen;
+	uint32_t entryCount;
+} SeekIndexStreamHeader;
+
+typedef struct SeekIndexEntry {
+	// Presentation timestamp
+	int64_t pts;
+	// Decoding timestamp or SEEK_INDEX_NO_VALUE
+	int64_t dts;
+	// Byte position in the media file or -1
+	int64_t pos;
+} SeekIndexEntry;
+
+typedef struct SeekIndexStream {
+	SeekIndexEntry *entries;
+	// Entries closer than this distance to the previous entry are skipped (Streams where every packet is a keyframe, like audio)
+	int64_t minDistance;
+	uint32_t count;
+	uint32_t capacity;
+	int32_t streamIndex;
+	int32_t timeBaseNum;
+	int32_t timeBaseDen;
+} SeekIndexStream;
+
+typedef struct SeekIndex {
+	SeekIndexStream streams[SEEK_INDEX_MAX_STREAM_COUNT];
+	uint64_t mediaFileSize;
+	uint64_t mediaModifyTime;
+	uint32_t streamCount;
+} SeekIndex;
+
+static bool GetSeekIndexFilePath(const char *mediaFilePath, char *outFilePath, const size_t maxOutFilePathLen) {
+	size_t len = fplStringFormat(outFilePath, maxOutFilePathLen, "%s%s", mediaFilePath, SEEK_INDEX_FILE_EXTENSION);
+	bool result = len > 0 && len < maxOutFilePathLen;
+	return(result);
+}
+
+static bool GetSeekIndexMediaKey(const char *mediaFilePath, uint64_t *outFileSize, uint64_t *outModifyTime) {
+	fplFileTimeStamps timeStamps;
+	if (!fplFileGetTimestampsFromPath(mediaFilePath, &timeStamps)) {
+		return false;
+	}
+	*outFileSize = fplFileGetSizeFromPath64(mediaFilePath);
+	*outModifyTime = timeStamps.lastModifyTime;
+	return true;
+}
+
+static void ReleaseSeekIndex(SeekIndex &index) {
+	for (uint32_t streamIndex = 0; streamIndex < index.streamCount; ++streamIndex) {
+		SeekIndexStream *stream = index.streams + streamIndex;
+		if (stream->entries != nullptr) {
+			fplMemoryFree(stream->entries);
+		}
+	}
+	index = {};
+}
+
+static void InitSeekIndex(SeekIndex &index, const uint64_t mediaFileSize, const uint64_t mediaModifyTime) {
+	index = {};
+	index.mediaFileSize = mediaFileSize;
+	index.mediaModifyTime = mediaModifyTime;
+}
+
+static SeekIndexStream *AddSeekIndexStream(SeekIndex &index, const int32_t streamIndex, const int32_t timeBaseNum, const int32_t timeBaseDen, const int64_t minDistance) {
+	if (index.streamCount == SEEK_INDEX_MAX_STREAM_COUNT) {
+		return nullptr;
+	}
+	SeekIndexStream *result = index.streams + index.streamCount++;
+	*result = {};
+	result->streamIndex = streamIndex;
+	result->timeBaseNum = timeBaseNum;
+	result->timeBaseDen = timeBaseDen;
+	result->minDistance = minDistance;
+	return(result);
+}
+
+static const SeekIndexStream *FindSeekIndexStream(const SeekIndex &index, const int32_t streamIndex) {
+	for (uint32_t i = 0; i < index.streamCount; ++i) {
+		if (index.streams[i].streamIndex == streamIndex) {
+			return &index.streams[i];
+		}
+	}
+	return nullptr;
+}
+
+static SeekIndexStream *FindSeekIndexStream(SeekIndex &index, const int32_t streamIndex) {
+	const SeekIndex &constIndex = index;
+	return (SeekIndexStream *)FindSeekIndexStream(constIndex, streamIndex);
+}
+
+static bool AddSeekIndexEntry(SeekIndexStream &stream, const int64_t pts, const int64_t dts, const int64_t pos) {
+	if (stream.count > 0 && stream.minDistance > 0) {
+		const SeekIndexEntry &last = stream.entries[stream.count - 1];
+		if (pts >= last.pts && (pts - last.pts) < stream.minDistance) {
+			return true;
+		}
+	}
+	if (stream.count == stream.capacity) {
+		uint32_t newCapacity = stream.capacity > 0 ? stream.capacity * 2 : SEEK_INDEX_INITIAL_CAPACITY;
+		SeekIndexEntry *newEntries = (SeekIndexEntry *)fplMemoryAllocate(sizeof(SeekIndexEntry) * newCapacity);
+		if (newEntries == nullptr) {
+			return false;
+		}
+		if (stream.entries != nullptr) {
+			fplMemoryCopy(stream.entries, sizeof(SeekIndexEntry) * stream.count, newEntries);
+			fplMemoryFree(stream.entries);
+		}
+		stream.entries = newEntries;
+		stream.capacity = newCapacity;
+	}
+
+	// Keyframes are demuxed in decoding order, so the presentation order is restored by insertion
+	uint32_t insertIndex = stream.count;
+	while (insertIndex > 0 && stream.entries[insertIndex - 1].pts > pts) {
+		stream.entries[insertIndex] = stream.entries[insertIndex - 1];
+		--insertIndex;
+	}
+	SeekIndexEntry *entry = stream.entries + insertIndex;
+	entry->pts = pts;
+	entry->dts = dts;
+	entry->pos = pos;
+	++stream.count;
+	return true;
+}
+
+// Returns the index of the last keyframe with a presentation timestamp less or equal than the target, or -1 when the target is before the first keyframe
+static int32_t FindSeekIndexEntry(const SeekIndexStream &stream, const int64_t targetPTS) {
+	int32_t lo = 0;
+	int32_t hi = (int32_t)stream.count - 1;
+	int32_t result = -1;
+	while (lo <= hi) {
+		int32_t mid = lo + (hi - lo) / 2;
+		if (stream.entries[mid].pts <= targetPTS) {
+			result = mid;
+			lo = mid + 1;
+		} else {
+			hi = mid - 1;
+		}
+	}
+	return(result);
+}
+
+static bool SaveSeekIndex(const SeekIndex &index, const char *filePath) {
+	fplFileHandle file;
+	if (!fplFileCreateBinary(filePath, &file)) {
+		return false;
+	}
+
+	bool result = false;
+
+	SeekIndexFileHeader header = fplZeroInit;
+	header.magic = SEEK_INDEX_FILE_MAGIC;
+	header.version = SEEK_INDEX_VERSION;
+	header.mediaFileSize = index.mediaFileSize;
+	header.mediaModifyTime = index.mediaModifyTime;
+	header.streamCount = index.streamCount;
+	if (fplFileWriteBlock32(&file, &header, sizeof(header)) != sizeof(header)) {
+		goto done;
+	}
+
+	for (uint32_t streamIndex = 0; streamIndex < index.streamCount; ++streamIndex) {
+		const SeekIndexStream &stream = index.streams[streamIndex];
+		SeekIndexStreamHeader streamHeader = fplZeroInit;
+		streamHeader.streamIndex = stream.streamIndex;
+		streamHeader.timeBaseNum = stream.timeBaseNum;
+		streamHeader.timeBaseDen = stream.timeBaseDen;
+		streamHeader.entryCount = stream.count;
+		if (fplFileWriteBlock32(&file, &streamHeader, sizeof(streamHeader)) != sizeof(streamHeader)) {
+			goto done;
+		}
+		uint64_t entriesSize = sizeof(SeekIndexEntry) * (uint64_t)stream.count;
+		if (entriesSize > 0 && fplFileWriteBlock64(&file, stream.entries, entriesSize) != entriesSize) {
+			goto done;
+		}
+	}
+
+	result = true;
+
+done:
+	fplFileClose(&file);
+	if (!result) {
+		fplFileDelete(filePath);
+	}
+	return(result);
+}
+
+static bool LoadSeekIndex(SeekIndex &index, const char *filePath, const uint64_t mediaFileSize, const uint64_t mediaModifyTime) {
+	index = {};
+
+	fplFileHandle file;
+	if (!fplFileOpenBinary(filePath, &file)) {
+		return false;
+	}
+
+	bool result = false;
+
+	SeekIndexFileHeader header;
+	if (fplFileReadBlock32(&file, sizeof(header), &header, sizeof(header)) != sizeof(header)) {
+		goto done;
+	}
+	if (header.magic != SEEK_INDEX_FILE_MAGIC || header.version != SEEK_INDEX_VERSION || header.streamCount > SEEK_INDEX_MAX_STREAM_COUNT) {
+		goto done;
+	}
+	if (header.mediaFileSize != mediaFileSize || header.mediaModifyTime != mediaModifyTime) {
+		goto done;
+	}
+
+	InitSeekIndex(index, mediaFileSize, mediaModifyTime);
+
+	for (uint32_t streamIndex = 0; streamIndex < header.streamCount; ++streamIndex) {
+		SeekIndexStreamHeader streamHeader;
+		if (fplFileReadBlock32(&file, sizeof(streamHeader), &streamHeader, sizeof(streamHeader)) != sizeof(streamHeader)) {
+			goto done;
+		}
+		SeekIndexStream *stream = AddSeekIndexStream(index, streamHeader.streamIndex, streamHeader.timeBaseNum, streamHeader.timeBaseDen, 0);
+		fplAssert(stream != nullptr);
+		if (streamHeader.entryCount > 0) {
+			uint64_t entriesSize = sizeof(SeekIndexEntry) * (uint64_t)streamHeader.entryCount;
+			stream->entries = (SeekIndexEntry *)fplMemoryAllocate((size_t)entriesSize);
+			if (stream->entries == nullptr) {
+				goto done;
+			}
+			stream->capacity = streamHeader.entryCount;
+			if (fplFileReadBlock64(&file, entriesSize, stream->entries, entriesSize) != entriesSize) {
+				goto done;
+			}
+			stream->count = streamHeader.entryCount;
+		}
+	}
+
+	result = true;
+
+done:
+	fplFileClose(&file);
+	if (!result) {
+		ReleaseSeekIndex(index);
+	}
+	return(result);
+}
+
+#endif // SEEKINDEX_H
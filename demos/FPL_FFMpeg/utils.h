@@ -5,6 +5,23 @@
 
 #include <final_platform_layer.h>
 
+#include <string.h> // memcpy
+
+#if defined(FPL_ARCH_X64) || defined(FPL_ARCH_X86)
+#	include <immintrin.h>
+#	define YUV_SIMD_X86
+#	if defined(FPL_COMPILER_MSVC)
+#		define YUV_TARGET_SSE2
+#		define YUV_TARGET_AVX2
+#	else
+#		define YUV_TARGET_SSE2 __attribute__((target("sse2")))
+#		define YUV_TARGET_AVX2 __attribute__((target("avx2")))
+#	endif
+#elif defined(FPL_ARCH_ARM64)
+#	include <arm_neon.h>
+#	define YUV_SIMD_NEON
+#endif
+
 struct BitmapInfoheader {
 	uint32_t biSize;
 	int32_t biWidth;
@@ -79,7 +96,7 @@ static void FillRGB32TestColor(uint8_t *destData, int32_t destScanline, int32_t
 	}
 }
 
-inline uint8_t ClipByte(float v) {
+inline uint8_t ClipByte(int32_t v) {
 	if (v < 0)
 		return 0;
 	if (v > 255)
@@ -87,10 +104,22 @@ inline uint8_t ClipByte(float v) {
 	return (uint8_t)v;
 }
 
+// Fixed point YUV factors with 13 fractional bits, the largest factor still fits into a signed 16-bit value
+constexpr int32_t YUV_FIXED_SHIFT = 13;
+constexpr int32_t YUV_FIXED_ROUND = 1 << (YUV_FIXED_SHIFT - 1);
+constexpr int16_t YUV_FACTOR_Y = 9535; // 1.164
+constexpr int16_t YUV_FACTOR_RV = 16531; // 2.018
+constexpr int16_t YUV_FACTOR_GU = 6660; // 0.813
+constexpr int16_t YUV_FACTOR_GV = 3203; // 0.391
+constexpr int16_t YUV_FACTOR_BU = 13074; // 1.596
+
 inline uint32_t YUVToRGB32(const uint8_t y, const uint8_t u, const uint8_t v, const bool isBGRA) {
-	float r = (1.164f * (float)(y - 16)) + (2.018f * (float)(v - 128));
-	float g = (1.164f * (float)(y - 16)) - (0.813f * (float)(u - 128)) - (0.391f * (float)(v - 128));
-	float b = (1.164f * (float)(y - 16)) + (1.596f * (float)(u - 128));
+	int32_t yf = YUV_FACTOR_Y * ((int32_t)y - 16) + YUV_FIXED_ROUND;
+	int32_t uf = (int32_t)u - 128;
+	int32_t vf = (int32_t)v - 128;
+	int32_t r = (yf + YUV_FACTOR_RV * vf) >> YUV_FIXED_SHIFT;
+	int32_t g = (yf - YUV_FACTOR_GU * uf - YUV_FACTOR_GV * vf) >> YUV_FIXED_SHIFT;
+	int32_t b = (yf + YUV_FACTOR_BU * uf) >> YUV_FIXED_SHIFT;
 	uint32_t result;
 	if (isBGRA) {
 		result = ((uint8_t)255 << 24) | (ClipByte(b) << 16) | (ClipByte(g) << 8) | ClipByte(r);
@@ -103,27 +132,403 @@ inline uint32_t YUVToRGB32(const uint8_t y, const uint8_t u, const uint8_t v, co
 enum class ConversionFlags : uint32_t {
 	None = 0,
 	DstBGRA = 1 << 0,
+	// Use the scalar row converter only, to validate the SIMD row converters (--validate)
+	ForceScalar = 1 << 1,
 };
 FPL_ENUM_AS_FLAGS_OPERATORS(ConversionFlags);
 
-static void ConvertYUV420PToRGB32(uint8_t *destData[8], int32_t destLineSize[8], int32_t width, int32_t height, uint8_t *sourceData[8], int32_t sourceLineSize[8], const ConversionFlags flags) {
-	// Planar YUV 4:2:0, 12bpp, (1 Cr & Cb sample per 2x2 Y samples)
-	constexpr uint32_t YPLANE = 0;
-	constexpr uint32_t UPLANE = 1;
-	constexpr uint32_t VPLANE = 2;
-	const bool dstBGRA = (flags & ConversionFlags::DstBGRA) == ConversionFlags::DstBGRA;
-	for (int32_t y = 0; y < height; ++y) {
-		uint32_t *dst32 = (uint32_t *)((uint8_t *)destData[0] + y * destLineSize[0]);
-		uint8_t *srcY = sourceData[YPLANE] + y * sourceLineSize[YPLANE];
-		uint8_t *srcU = sourceData[UPLANE] + (y / 2) * sourceLineSize[UPLANE];
-		uint8_t *srcV = sourceData[VPLANE] + (y / 2) * sourceLineSize[VPLANE];
-		for (int32_t x = 0; x < width; ++x) {
-			uint8_t yComponent = *(srcY + x * sizeof(uint8_t));
-			uint8_t uComponent = *(srcU + (x / 2) * sizeof(uint8_t));
-			uint8_t vComponent = *(srcV + (x / 2) * sizeof(uint8_t));
-			*dst32++ = YUVToRGB32(yComponent, uComponent, vComponent, dstBGRA);
+//
+// Row based YUV to RGB32 conversion
+// All row converters produce exactly the same output as YUVToRGB32(), because all use the same fixed point integer math.
+// Chroma sample for pixel x is at (x / 2) * chromaStep, so planar formats use a step of 1 and NV12 uses a step of 2.
+//
+typedef void (yuv_row_converter)(uint32_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV, const int32_t chromaStep, const int32_t startX, const int32_t width, const bool isBGRA);
+
+static void ConvertYUVRowToRGB32Scalar(uint32_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV, const int32_t chromaStep, const int32_t startX, const int32_t width, const bool isBGRA) {
+	for (int32_t x = startX; x < width; ++x) {
+		int32_t c = (x >> 1) * chromaStep;
+		dst[x] = YUVToRGB32(srcY[x], srcU[c], srcV[c], isBGRA);
+	}
+}
+
+// Compiles to a single load, unlike fplMemoryCopy()
+inline uint32_t LoadUnalignedU32(const uint8_t *p) {
+	uint32_t result;
+	memcpy(&result, p, sizeof(result));
+	return(result);
+}
+
+#if defined(YUV_SIMD_X86)
+// Packs 8 clamped bytes per color channel into 8 pixels
+YUV_TARGET_SSE2 inline void StoreRGB32x8SSE2(uint32_t *dst, const __m128i r, const __m128i g, const __m128i b, const bool isBGRA) {
+	__m128i c0 = isBGRA ? r : b;
+	__m128i c2 = isBGRA ? b : r;
+	__m128i lo = _mm_unpacklo_epi8(c0, g);
+	__m128i hi = _mm_unpacklo_epi8(c2, _mm_set1_epi8((char)0xFF));
+	_mm_storeu_si128((__m128i *)dst, _mm_unpacklo_epi16(lo, hi));
+	_mm_storeu_si128((__m128i *)(dst + 4), _mm_unpackhi_epi16(lo, hi));
+}
+
+// Loads 4 chroma samples for 8 pixels as 16-bit values, each sample duplicated for two pixels
+YUV_TARGET_SSE2 inline __m128i LoadChromaX8SSE2(const uint8_t *src, const int32_t chromaStep) {
+	__m128i result;
+	if (chromaStep == 1) {
+		result = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)LoadUnalignedU32(src)), _mm_setzero_si128());
+	} else {
+		// Interleaved chroma, only the even bytes are used
+		result = _mm_and_si128(_mm_loadl_epi64((const __m128i *)src), _mm_set1_epi16(0xFF));
+	}
+	result = _mm_unpacklo_epi16(result, result);
+	return(result);
+}
+
+// Factors for _mm_madd_epi16(), which computes a * first + b * second for interleaved 16-bit pairs of a and b
+YUV_TARGET_SSE2 inline __m128i SetFactorPairSSE2(const int16_t first, const int16_t second) {
+	__m128i result = _mm_set1_epi32((int)(((uint32_t)(uint16_t)second << 16) | (uint16_t)first));
+	return(result);
+}
+
+YUV_TARGET_SSE2 static void ConvertYUVRowToRGB32SSE2(uint32_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV, const int32_t chromaStep, const int32_t startX, const int32_t width, const bool isBGRA) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i yOffset = _mm_set1_epi16(16);
+	const __m128i uvOffset = _mm_set1_epi16(128);
+	const __m128i round = _mm_set1_epi32(YUV_FIXED_ROUND);
+	const __m128i rFactors = SetFactorPairSSE2(YUV_FACTOR_Y, YUV_FACTOR_RV);
+	const __m128i gFactors = SetFactorPairSSE2(YUV_FACTOR_Y, -YUV_FACTOR_GU);
+	const __m128i gvFactors = SetFactorPairSSE2(-YUV_FACTOR_GV, 0);
+	const __m128i bFactors = SetFactorPairSSE2(YUV_FACTOR_Y, YUV_FACTOR_BU);
+	// Interleaved chroma reads one byte past the last V sample, so the last block is left to the scalar converter
+	const int32_t simdWidth = width - (chromaStep - 1);
+	int32_t x = startX;
+	for (; x + 8 <= simdWidth; x += 8) {
+		int32_t c = (x >> 1) * chromaStep;
+		__m128i y16 = _mm_sub_epi16(_mm_unpacklo_epi8(_mm_loadl_epi64((const __m128i *)(srcY + x)), zero), yOffset);
+		__m128i u16 = _mm_sub_epi16(LoadChromaX8SSE2(srcU + c, chromaStep), uvOffset);
+		__m128i v16 = _mm_sub_epi16(LoadChromaX8SSE2(srcV + c, chromaStep), uvOffset);
+		__m128i r32[2], g32[2], b32[2];
+		for (int half = 0; half < 2; ++half) {
+			__m128i yv = half == 0 ? _mm_unpacklo_epi16(y16, v16) : _mm_unpackhi_epi16(y16, v16);
+			__m128i yu = half == 0 ? _mm_unpacklo_epi16(y16, u16) : _mm_unpackhi_epi16(y16, u16);
+			__m128i v0 = half == 0 ? _mm_unpacklo_epi16(v16, zero) : _mm_unpackhi_epi16(v16, zero);
+			__m128i gf = _mm_add_epi32(_mm_madd_epi16(yu, gFactors), _mm_madd_epi16(v0, gvFactors));
+			r32[half] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yv, rFactors), round), YUV_FIXED_SHIFT);
+			g32[half] = _mm_srai_epi32(_mm_add_epi32(gf, round), YUV_FIXED_SHIFT);
+			b32[half] = _mm_srai_epi32(_mm_add_epi32(_mm_madd_epi16(yu, bFactors), round), YUV_FIXED_SHIFT);
+		}
+		// Saturated packing is the same as ClipByte()
+		__m128i r8 = _mm_packus_epi16(_mm_packs_epi32(r32[0], r32[1]), zero);
+		__m128i g8 = _mm_packus_epi16(_mm_packs_epi32(g32[0], g32[1]), zero);
+		__m128i b8 = _mm_packus_epi16(_mm_packs_epi32(b32[0], b32[1]), zero);
+		StoreRGB32x8SSE2(dst + x, r8, g8, b8, isBGRA);
+	}
+	ConvertYUVRowToRGB32Scalar(dst, srcY, srcU, srcV, chromaStep, x, width, isBGRA);
+}
+
+YUV_TARGET_AVX2 static void ConvertYUVRowToRGB32AVX2(uint32_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV, const int32_t chromaStep, const int32_t startX, const int32_t width, const bool isBGRA) {
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i chromaMask = _mm_set1_epi16(0xFF);
+	const __m256i yOffset = _mm256_set1_epi32(16);
+	const __m256i uvOffset = _mm256_set1_epi32(128);
+	const __m256i round = _mm256_set1_epi32(YUV_FIXED_ROUND);
+	const __m256i yFactor = _mm256_set1_epi32(YUV_FACTOR_Y);
+	const __m256i rvFactor = _mm256_set1_epi32(YUV_FACTOR_RV);
+	const __m256i guFactor = _mm256_set1_epi32(YUV_FACTOR_GU);
+	const __m256i gvFactor = _mm256_set1_epi32(YUV_FACTOR_GV);
+	const __m256i buFactor = _mm256_set1_epi32(YUV_FACTOR_BU);
+	// Interleaved chroma reads one byte past the last V sample, so the last block is left to the scalar converter
+	const int32_t simdWidth = width - (chromaStep - 1);
+	int32_t x = startX;
+	for (; x + 8 <= simdWidth; x += 8) {
+		int32_t c = (x >> 1) * chromaStep;
+		__m128i u8, v8;
+		if (chromaStep == 1) {
+			u8 = _mm_cvtsi32_si128((int)LoadUnalignedU32(srcU + c));
+			v8 = _mm_cvtsi32_si128((int)LoadUnalignedU32(srcV + c));
+		} else {
+			u8 = _mm_packus_epi16(_mm_and_si128(_mm_loadl_epi64((const __m128i *)(srcU + c)), chromaMask), zero);
+			v8 = _mm_packus_epi16(_mm_and_si128(_mm_loadl_epi64((const __m128i *)(srcV + c)), chromaMask), zero);
+		}
+		__m256i y32 = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i *)(srcY + x)));
+		__m256i u32 = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(u8, u8));
+		__m256i v32 = _mm256_cvtepu8_epi32(_mm_unpacklo_epi8(v8, v8));
+		__m256i yf = _mm256_add_epi32(_mm256_mullo_epi32(yFactor, _mm256_sub_epi32(y32, yOffset)), round);
+		__m256i uf = _mm256_sub_epi32(u32, uvOffset);
+		__m256i vf = _mm256_sub_epi32(v32, uvOffset);
+		__m256i r32 = _mm256_srai_epi32(_mm256_add_epi32(yf, _mm256_mullo_epi32(rvFactor, vf)), YUV_FIXED_SHIFT);
+		__m256i g32 = _mm256_srai_epi32(_mm256_sub_epi32(_mm256_sub_epi32(yf, _mm256_mullo_epi32(guFactor, uf)), _mm256_mullo_epi32(gvFactor, vf)), YUV_FIXED_SHIFT);
+		__m256i b32 = _mm256_srai_epi32(_mm256_add_epi32(yf, _mm256_mullo_epi32(buFactor, uf)), YUV_FIXED_SHIFT);
+		__m128i r8 = _mm_packus_epi16(_mm_packs_epi32(_mm256_castsi256_si128(r32), _mm256_extracti128_si256(r32, 1)), zero);
+		__m128i g8 = _mm_packus_epi16(_mm_packs_epi32(_mm256_castsi256_si128(g32), _mm256_extracti128_si256(g32, 1)), zero);
+		__m128i b8 = _mm_packus_epi16(_mm_packs_epi32(_mm256_castsi256_si128(b32), _mm256_extracti128_si256(b32, 1)), zero);
+		__m128i c0 = isBGRA ? r8 : b8;
+		__m128i c2 = isBGRA ? b8 : r8;
+		__m128i lo = _mm_unpacklo_epi8(c0, g8);
+		__m128i hi = _mm_unpacklo_epi8(c2, _mm_set1_epi8((char)0xFF));
+		_mm_storeu_si128((__m128i *)(dst + x), _mm_unpacklo_epi16(lo, hi));
+		_mm_storeu_si128((__m128i *)(dst + x + 4), _mm_unpackhi_epi16(lo, hi));
+	}
+	ConvertYUVRowToRGB32Scalar(dst, srcY, srcU, srcV, chromaStep, x, width, isBGRA);
+}
+#endif // YUV_SIMD_X86
+
+#if defined(YUV_SIMD_NEON)
+// Loads 4 chroma samples for 8 pixels, each sample duplicated for two pixels
+inline uint8x8_t LoadChromaX8NEON(const uint8_t *src, const int32_t chromaStep) {
+	uint8x8_t samples;
+	if (chromaStep == 1) {
+		samples = vreinterpret_u8_u32(vdup_n_u32(LoadUnalignedU32(src)));
+	} else {
+		// Interleaved chroma, only the even bytes are used
+		uint8x8_t interleaved = vld1_u8(src);
+		samples = vuzp_u8(interleaved, interleaved).val[0];
+	}
+	return vzip_u8(samples, samples).val[0];
+}
+
+inline uint8x8_t ConvertS32x8ToU8NEON(const int32x4_t lo, const int32x4_t hi) {
+	// Saturated narrowing is the same as ClipByte()
+	int16x8_t s16 = vcombine_s16(vqmovn_s32(lo), vqmovn_s32(hi));
+	return vqmovun_s16(s16);
+}
+
+static void ConvertYUVRowToRGB32NEON(uint32_t *dst, const uint8_t *srcY, const uint8_t *srcU, const uint8_t *srcV, const int32_t chromaStep, const int32_t startX, const int32_t width, const bool isBGRA) {
+	const int32x4_t round = vdupq_n_s32(YUV_FIXED_ROUND);
+	// Interleaved chroma reads one byte past the last V sample, so the last block is left to the scalar converter
+	const int32_t simdWidth = width - (chromaStep - 1);
+	int32_t x = startX;
+	for (; x + 8 <= simdWidth; x += 8) {
+		int32_t c = (x >> 1) * chromaStep;
+		int16x8_t y16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(vld1_u8(srcY + x))), vdupq_n_s16(16));
+		int16x8_t u16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(LoadChromaX8NEON(srcU + c, chromaStep))), vdupq_n_s16(128));
+		int16x8_t v16 = vsubq_s16(vreinterpretq_s16_u16(vmovl_u8(LoadChromaX8NEON(srcV + c, chromaStep))), vdupq_n_s16(128));
+		int32x4_t rf[2], gf[2], bf[2];
+		for (int half = 0; half < 2; ++half) {
+			int16x4_t yh = half == 0 ? vget_low_s16(y16) : vget_high_s16(y16);
+			int16x4_t uh = half == 0 ? vget_low_s16(u16) : vget_high_s16(u16);
+			int16x4_t vh = half == 0 ? vget_low_s16(v16) : vget_high_s16(v16);
+			int32x4_t yf = vmlal_n_s16(round, yh, YUV_FACTOR_Y);
+			rf[half] = vshrq_n_s32(vmlal_n_s16(yf, vh, YUV_FACTOR_RV), YUV_FIXED_SHIFT);
+			gf[half] = vshrq_n_s32(vmlsl_n_s16(vmlsl_n_s16(yf, uh, YUV_FACTOR_GU), vh, YUV_FACTOR_GV), YUV_FIXED_SHIFT);
+			bf[half] = vshrq_n_s32(vmlal_n_s16(yf, uh, YUV_FACTOR_BU), YUV_FIXED_SHIFT);
+		}
+		uint8x8_t r8 = ConvertS32x8ToU8NEON(rf[0], rf[1]);
+		uint8x8_t b8 = ConvertS32x8ToU8NEON(bf[0], bf[1]);
+		uint8x8x4_t pixels;
+		pixels.val[0] = isBGRA ? r8 : b8;
+		pixels.val[1] = ConvertS32x8ToU8NEON(gf[0], gf[1]);
+		pixels.val[2] = isBGRA ? b8 : r8;
+		pixels.val[3] = vdup_n_u8(0xFF);
+		vst4_u8((uint8_t *)(dst + x), pixels);
+	}
+	ConvertYUVRowToRGB32Scalar(dst, srcY, srcU, srcV, chromaStep, x, width, isBGRA);
+}
+#endif // YUV_SIMD_NEON
+
+static yuv_row_converter *SelectYUVRowConverter() {
+	yuv_row_converter *result = ConvertYUVRowToRGB32Scalar;
+#if defined(YUV_SIMD_X86)
+	fplCPUCapabilities caps = fplZeroInit;
+	if (fplCPUGetCapabilities(&caps) && caps.type == fplCPUCapabilitiesType_X86) {
+		if (caps.x86.hasAVX2) {
+			result = ConvertYUVRowToRGB32AVX2;
+		} else if (caps.x86.hasSSE2) {
+			result = ConvertYUVRowToRGB32SSE2;
+		}
+	}
+#elif defined(YUV_SIMD_NEON)
+	result = ConvertYUVRowToRGB32NEON;
+#endif
+	return(result);
+}
+
+enum class YUVFormat : uint32_t {
+	// Planar YUV 4:2:0, 1 Cr & Cb sample per 2x2 Y samples
+	YUV420P = 0,
+	// Planar YUV 4:2:2, 1 Cr & Cb sample per 2x1 Y samples
+	YUV422P,
+	// Y plane and interleaved UV plane, 1 Cr & Cb sample per 2x2 Y samples
+	NV12,
+};
+
+struct YUVConversion {
+	uint8_t *destData;
+	uint8_t *sourceData[3];
+	int32_t destLineSize;
+	int32_t sourceLineSize[3];
+	int32_t width;
+	int32_t height;
+	YUVFormat format;
+	yuv_row_converter *rowConverter;
+	bool isBGRA;
+};
+
+static void ConvertYUVRowsToRGB32(const YUVConversion &conv, const int32_t startRow, const int32_t endRow) {
+	const int32_t chromaStep = conv.format == YUVFormat::NV12 ? 2 : 1;
+	const int32_t chromaShiftY = conv.format == YUVFormat::YUV422P ? 0 : 1;
+	for (int32_t y = startRow; y < endRow; ++y) {
+		int32_t chromaY = y >> chromaShiftY;
+		uint32_t *dst = (uint32_t *)(conv.destData + y * conv.destLineSize);
+		const uint8_t *srcY = conv.sourceData[0] + y * conv.sourceLineSize[0];
+		const uint8_t *srcU = conv.sourceData[1] + chromaY * conv.sourceLineSize[1];
+		const uint8_t *srcV;
+		if (conv.format == YUVFormat::NV12) {
+			srcV = srcU + 1;
+		} else {
+			srcV = conv.sourceData[2] + chromaY * conv.sourceLineSize[2];
+		}
+		conv.rowConverter(dst, srcY, srcU, srcV, chromaStep, 0, conv.width, conv.isBGRA);
+	}
+}
+
+//
+// Conversion pool, converts blocks of rows in parallel (The calling thread converts blocks as well)
+//
+constexpr uint32_t MAX_CONVERSION_THREAD_COUNT = 32;
+constexpr int32_t CONVERSION_ROW_BLOCK_SIZE = 16;
+
+struct ConversionPool {
+	fplThreadHandle *threads[MAX_CONVERSION_THREAD_COUNT];
+	fplMutexHandle mutex;
+	fplConditionVariable workCondition;
+	fplConditionVariable doneCondition;
+	YUVConversion conversion;
+	yuv_row_converter *rowConverter;
+	volatile int32_t nextBlock;
+	volatile int32_t finishedBlocks;
+	int32_t blockCount;
+	int32_t activeWorkers;
+	uint32_t generation;
+	uint32_t threadCount;
+	volatile int32_t shutdown;
+	// Only one conversion can use the pool at a time
+	volatile int32_t isBusy;
+	bool isValid;
+};
+
+// Converts blocks of the current conversion, until there are no blocks left
+static void ProcessConversionBlocks(ConversionPool &pool) {
+	int32_t block;
+	while ((block = fplAtomicFetchAndAddS32(&pool.nextBlock, 1)) < pool.blockCount) {
+		int32_t startRow = block * CONVERSION_ROW_BLOCK_SIZE;
+		int32_t endRow = fplMin(startRow + CONVERSION_ROW_BLOCK_SIZE, pool.conversion.height);
+		ConvertYUVRowsToRGB32(pool.conversion, startRow, endRow);
+		fplAtomicFetchAndAddS32(&pool.finishedBlocks, 1);
+	}
+}
+
+static void ConversionWorkerThreadProc(const fplThreadHandle *thread, void *data) {
+	ConversionPool &pool = *(ConversionPool *)data;
+	uint32_t lastGeneration = 0;
+	fplMutexLock(&pool.mutex);
+	while (!pool.shutdown) {
+		if (pool.generation == lastGeneration) {
+			fplConditionWait(&pool.workCondition, &pool.mutex, FPL_TIMEOUT_INFINITE);
+			continue;
+		}
+		// Workers join a conversion only while holding the lock, so a new conversion is never started while a worker converts
+		lastGeneration = pool.generation;
+		++pool.activeWorkers;
+		fplMutexUnlock(&pool.mutex);
+
+		ProcessConversionBlocks(pool);
+
+		fplMutexLock(&pool.mutex);
+		--pool.activeWorkers;
+		fplConditionSignal(&pool.doneCondition);
+	}
+	fplMutexUnlock(&pool.mutex);
+}
+
+static void ReleaseConversionPool(ConversionPool &pool) {
+	if (pool.threadCount > 0) {
+		fplMutexLock(&pool.mutex);
+		pool.shutdown = 1;
+		fplConditionBroadcast(&pool.workCondition);
+		fplMutexUnlock(&pool.mutex);
+		fplThreadWaitForAll(pool.threads, pool.threadCount, sizeof(fplThreadHandle *), FPL_TIMEOUT_INFINITE);
+	}
+	if (pool.isValid) {
+		fplConditionDestroy(&pool.doneCondition);
+		fplConditionDestroy(&pool.workCondition);
+		fplMutexDestroy(&pool.mutex);
+	}
+	pool = {};
+}
+
+static bool InitConversionPool(ConversionPool &pool, const uint32_t threadCount) {
+	pool = {};
+	pool.rowConverter = SelectYUVRowConverter();
+	if (!fplMutexInit(&pool.mutex)) {
+		return false;
+	}
+	if (!fplConditionInit(&pool.workCondition)) {
+		fplMutexDestroy(&pool.mutex);
+		return false;
+	}
+	if (!fplConditionInit(&pool.doneCondition)) {
+		fplConditionDestroy(&pool.workCondition);
+		fplMutexDestroy(&pool.mutex);
+		return false;
+	}
+	pool.isValid = true;
+	uint32_t count = fplMin(threadCount, MAX_CONVERSION_THREAD_COUNT);
+	for (uint32_t threadIndex = 0; threadIndex < count; ++threadIndex) {
+		pool.threads[threadIndex] = fplThreadCreate(ConversionWorkerThreadProc, &pool);
+		if (pool.threads[threadIndex] == fpl_null) {
+			ReleaseConversionPool(pool);
+			return false;
 		}
+		++pool.threadCount;
+	}
+	return true;
+}
+
+// Converts a YUV picture into RGB32, parallelized across rows when a conversion pool is given
+static void ConvertYUVToRGB32(const YUVFormat format, uint8_t *destData[8], int32_t destLineSize[8], int32_t width, int32_t height, uint8_t *sourceData[8], int32_t sourceLineSize[8], const ConversionFlags flags, ConversionPool *pool) {
+	YUVConversion conv = {};
+	conv.destData = destData[0];
+	conv.destLineSize = destLineSize[0];
+	for (int planeIndex = 0; planeIndex < 3; ++planeIndex) {
+		conv.sourceData[planeIndex] = sourceData[planeIndex];
+		conv.sourceLineSize[planeIndex] = sourceLineSize[planeIndex];
+	}
+	conv.width = width;
+	conv.height = height;
+	conv.format = format;
+	conv.isBGRA = (flags & ConversionFlags::DstBGRA) == ConversionFlags::DstBGRA;
+	if ((flags & ConversionFlags::ForceScalar) == ConversionFlags::ForceScalar) {
+		conv.rowConverter = ConvertYUVRowToRGB32Scalar;
+	} else {
+		conv.rowConverter = (pool != nullptr && pool->isValid) ? pool->rowConverter : SelectYUVRowConverter();
 	}
+
+	int32_t blockCount = (height + CONVERSION_ROW_BLOCK_SIZE - 1) / CONVERSION_ROW_BLOCK_SIZE;
+	if (pool == nullptr || pool->threadCount == 0 || blockCount < 2 || !fplAtomicIsCompareAndSwapS32(&pool->isBusy, 0, 1)) {
+		ConvertYUVRowsToRGB32(conv, 0, height);
+		return;
+	}
+
+	fplMutexLock(&pool->mutex);
+	while (pool->activeWorkers > 0) {
+		fplConditionWait(&pool->doneCondition, &pool->mutex, FPL_TIMEOUT_INFINITE);
+	}
+	pool->conversion = conv;
+	pool->blockCount = blockCount;
+	fplAtomicStoreS32(&pool->finishedBlocks, 0);
+	fplAtomicStoreS32(&pool->nextBlock, 0);
+	++pool->generation;
+	fplConditionBroadcast(&pool->workCondition);
+	fplMutexUnlock(&pool->mutex);
+
+	ProcessConversionBlocks(*pool);
+
+	fplMutexLock(&pool->mutex);
+	while (fplAtomicLoadS32(&pool->finishedBlocks) < blockCount || pool->activeWorkers > 0) {
+		fplConditionWait(&pool->doneCondition, &pool->mutex, FPL_TIMEOUT_INFINITE);
+	}
+	fplMutexUnlock(&pool->mutex);
+
+	fplAtomicStoreS32(&pool->isBusy, 0);
 }
 
 static void ConvertRGB24ToRGB32(uint8_t *destData, int32_t destScanline, int32_t width, int32_t height, int32_t sourceScanLine, uint8_t *sourceData) {
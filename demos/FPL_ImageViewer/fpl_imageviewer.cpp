@@ -4,7 +4,7 @@ Name:
 	FPL-Demo | ImageViewer
 
 Version:
-	v0.5.5 (version.h)
+	v0.5.6 (version.h)
 
 Description:
 	Very simple opengl based image viewer.
@@ -18,10 +18,33 @@ Requirements:
 	- Final Dynamic OpenGL
 	- STB_image
 
+Parameters:
+	[path] Folder or picture file
+	-r Load pictures recursively
+	-t=<count> Number of load threads
+	-p=<count> Number of pictures to preload
+	-c=<size> Maximum edge size of cached previews, zero disables the preview cache
+	-m=<megabytes> Memory budget for decoded pictures and textures
+
 Author:
 	Torsten Spaete
 
 Changelog:
+	## v0.5.6
+	- New: Persistent preview cache (previewcache.h), stored in the home path next to the log file
+	- New: Memory budgeted LRU picture cache, pictures are kept when paging instead of reloading the entire window
+	- New: Prefetch window is shifted in paging direction
+	- Changed: Loads inside the new window are kept when paging, only loads outside are canceled
+	- New: Pictures are scanned in a background thread using fplDirectoryScan(), so the first pictures are shown while the scan continues
+	- Changed: Pictures are sorted by path when the scan is finished, the active picture stays selected
+	- New: Huge pictures are split into a tiled pyramid on the load threads, only the visible tiles of the current zoom level are loaded within the memory budget
+	- New: Zoom with the mouse wheel or +/-, pan by dragging with the left mouse button, 0 resets the zoom
+	- Fixed: -p parameter was ignored
+	- Fixed: Recursive loading was never ending on POSIX, due to the "." and ".." entries
+	- Fixed: Textures was not released when a new folder was loaded
+	- Fixed: Tile files of previous sessions are deleted at startup
+	- Fixed: Memory budget was drifting when a folder was loaded while pictures was in loading, pictures which failed to upload was never evicted
+
 	## v0.5.5
 	- Reflect api changes in FPL 0.9.4
 	- Fixed broken legacy opengl rendering
@@ -104,6 +127,21 @@ License:
 // Enable this to prevent the usage of modern OpenGL
 #define FORCE_LEGACY_OPENGL 0
 
+// Default maximum edge size of cached previews (-c parameter)
+#define PREVIEW_CACHE_DEFAULT_SIZE 2048
+// Maximum size of the preview cache pack file
+#define PREVIEW_CACHE_MAX_FILE_SIZE (4ULL * 1024ULL * 1024ULL * 1024ULL)
+
+// Default memory budget in megabytes for decoded pictures and textures (-m parameter)
+#define PICTURE_CACHE_DEFAULT_BUDGET 512
+
+// Pictures with a edge larger than this (or the maximum texture size) are split into a tiled pyramid
+#define TILED_PICTURE_THRESHOLD 8192
+// Edge size of a single tile in a tiled pyramid
+#define PICTURE_TILE_SIZE 512
+// Maximum number of tile uploads per frame
+#define MAX_TILE_UPLOADS_PER_FRAME 8
+
 #define FPL_IMPLEMENTATION
 #define FPL_LOGGING
 #define FPL_NO_VIDEO_VULKAN
@@ -123,6 +161,7 @@ License:
 #include "shadersources.h"
 #include "imageresources.h"
 #include "version.h"
+#include "previewcache.h"
 
 #define FLOG_IMPLEMENTATION
 #include "logging.h"
@@ -286,6 +325,8 @@ inline float ScalarLerp(float a, float t, float b) {
 
 typedef struct PictureFile {
 	char filePath[FPL_MAX_PATH_LENGTH];
+	// Index to the view picture, only valid when the view picture has the same file index and is not unloaded
+	int viewPictureIndex;
 } PictureFile;
 
 typedef enum LoadedPictureStateType {
@@ -293,7 +334,7 @@ typedef enum LoadedPictureStateType {
 	LoadedPictureState_Unloaded = 0,
 	LoadedPictureState_LoadingData,
 	LoadedPictureState_ToUpload,
-	LoadedPictureState_Discard,
+	LoadedPictureState_Queued,
 	LoadedPictureState_Ready,
 } LoadedPictureStateType;
 
@@ -316,13 +357,57 @@ typedef struct ImageData {
 #define MAX_PICTURE_MIPMAPS (1)
 #define MIN_PICTURE_MIPMAP_SIZE 512
 
+typedef struct PictureTile {
+	uint8_t* data;
+	uint64_t fileOffset;
+	uint64_t lastUsedFrame;
+	uint32_t x;
+	uint32_t y;
+	uint32_t width;
+	uint32_t height;
+	GLuint textureId;
+	volatile LoadedPictureState state;
+} PictureTile;
+
+typedef struct PictureTileLevel {
+	uint32_t width;
+	uint32_t height;
+	uint32_t tileCountX;
+	uint32_t tileCountY;
+	uint32_t firstTile;
+} PictureTileLevel;
+
+#define MAX_PICTURE_TILE_LEVELS 16
+
+// Tiled pyramid of a huge picture, level zero is the full resolution.
+// The tiles are stored in a temporary tile file and only the visible tiles are loaded into textures.
+// The level above the last level (fits into a single tile) is the overview image in the view picture.
+typedef struct PictureTiles {
+	char filePath[FPL_MAX_PATH_LENGTH];
+	PictureTileLevel levels[MAX_PICTURE_TILE_LEVELS];
+	PictureTile* tiles;
+	uint32_t tileCount;
+	uint32_t levelCount;
+	uint32_t width;
+	uint32_t height;
+} PictureTiles;
+
 typedef struct ViewPicture {
 	StreamingFileBuffer fileStream;
 	char filePath[FPL_MAX_PATH_LENGTH];
 	ImageData imageData[MAX_PICTURE_MIPMAPS];
+	// Downsampled preview from the preview cache, shown as a placeholder while the full picture is loading
+	ImageData preview;
+	PictureTiles* tiles;
+	uint64_t lastUsedFrame;
+	size_t memorySize;
 	float progress;
 	size_t fileIndex;
 	volatile LoadedPictureState state;
+	volatile LoadedPictureState previewState;
+	// Number of load threads which are reading a tile of this picture
+	volatile int32_t tileLoadCount;
+	volatile bool canceled;
 	uint8_t mipmapCount;
 } ViewPicture;
 
@@ -344,10 +429,14 @@ typedef struct PictureLoadThread {
 #define MAX_VIEW_PICTURE_COUNT MAX_LOAD_THREAD_COUNT * 4
 #define MAX_LOAD_QUEUE_COUNT MAX_VIEW_PICTURE_COUNT * 2
 #define PAGE_INCREMENT_COUNT 10
+#define MIN_PICTURE_ZOOM 0.25f
+#define MAX_PICTURE_ZOOM 256.0f
 
 typedef struct LoadQueueValue {
 	int fileIndex;
 	int pictureIndex;
+	// Index of the tile to load, -1 loads the picture itself
+	int tileIndex;
 } LoadQueueValue;
 
 typedef struct LoadQueueEntry {
@@ -380,6 +469,8 @@ typedef struct ViewerParameters {
 	const char* path;
 	uint32_t threadCount;
 	uint32_t preloadCount;
+	uint32_t previewCacheSize;
+	uint32_t cacheBudget;
 	bool recursive;
 	bool preview;
 	bool border;
@@ -443,14 +534,45 @@ typedef struct ViewerState {
 	PictureFile* pictureFiles;
 	size_t pictureFileCapacity;
 	size_t pictureFileCount;
-	size_t folderCount;
 	int activeFileIndex;
 
+	// Background directory scan, found pictures are added to the picture files in the main thread
+	fplThreadHandle* scanThread;
+	fplMutexHandle scanLock;
+	PictureFile* scannedFiles;
+	size_t scannedFileCapacity;
+	size_t scannedFileCount;
+	char scanSkipPath[FPL_MAX_PATH_LENGTH];
+	volatile bool scanCanceled;
+	volatile bool isScanning;
+	bool scanRecursive;
+
 	ViewPicture viewPictures[MAX_VIEW_PICTURE_COUNT];
 	size_t viewPicturesCapacity;
 	int viewPictureIndex;
 	bool doPictureReload;
 
+	// Window of files to preload, shifted in the direction of paging
+	size_t windowCount;
+	int windowFirstFileIndex;
+	int windowLastFileIndex;
+	int pageDirection;
+
+	// Bytes of all decoded pictures and textures
+	size_t pictureCacheSize;
+	uint64_t frameIndex;
+
+	// Tile files of tiled pictures are stored in this path, prefixed with the session id
+	char tilePath[FPL_MAX_PATH_LENGTH];
+	uint64_t tileSessionId;
+	uint32_t tiledPictureThreshold;
+
+	// Zoom and pan of the active picture, zoom of one fits the picture into the window
+	float zoom;
+	Vec2f pan;
+	Vec2f lastMousePos;
+	bool isDragging;
+
 	PictureLoadThread loadThreads[MAX_LOAD_THREAD_COUNT];
 	size_t loadThreadCount;
 
@@ -460,6 +582,8 @@ typedef struct ViewerState {
 	LoadQueue loadQueue;
 	size_t loadQueueCapacity;
 
+	PreviewCache previewCache;
+
 	GLenum textureTarget;
 	GLuint vertexArray;
 	GLuint colorShaderProgram;
@@ -549,7 +673,6 @@ static void ClearPictureFiles(ViewerState* state) {
 	state->pictureFileCount = 0;
 	state->pictureFileCapacity = 0;
 	state->rootPath[0] = 0;
-	state->folderCount = 0;
 }
 
 static void AddPictureFile(ViewerState* state, const char* filePath) {
@@ -563,29 +686,69 @@ static void AddPictureFile(ViewerState* state, const char* filePath) {
 	}
 	PictureFile* pictureFile = &state->pictureFiles[state->pictureFileCount++];
 	fplCopyString(filePath, pictureFile->filePath, fplArrayCount(pictureFile->filePath));
+	pictureFile->viewPictureIndex = -1;
 }
 
-static void AddPicturesFromPath(ViewerState* state, const char* path, const bool recursive) {
-	fplFileEntry entry;
-	size_t addedPics = 0;
-	for (bool hasEntry = fplDirectoryListBegin(path, "*", &entry); hasEntry; hasEntry = fplDirectoryListNext(&entry)) {
-		if (!hasEntry) {
-			break;
-		}
-		char fullPath[FPL_MAX_PATH_LENGTH];
-		fplPathCombine(fullPath, fplArrayCount(fullPath), 2, path, entry.name);
-		if (entry.type == fplFileEntryType_File) {
-			if (IsPictureFile(fullPath)) {
-				AddPictureFile(state, fullPath);
-				++addedPics;
-			}
-		} else if (recursive && entry.type == fplFileEntryType_Directory) {
-			AddPicturesFromPath(state, fullPath, true);
+static bool ScanPictureFileCallback(const char* fullPath, const fplFileEntry* entry, void* userData) {
+	ViewerState* state = (ViewerState*)userData;
+	if (state->scanCanceled) {
+		return(false);
+	}
+	if (entry->type == fplFileEntryType_File && IsPictureFile(fullPath)) {
+		fplMutexLock(&state->scanLock);
+		if (state->scannedFileCount == state->scannedFileCapacity) {
+			state->scannedFileCapacity = state->scannedFileCapacity > 0 ? state->scannedFileCapacity * 2 : 64;
+			state->scannedFiles = (PictureFile*)realloc(state->scannedFiles, sizeof(PictureFile) * state->scannedFileCapacity);
 		}
+		PictureFile* pictureFile = &state->scannedFiles[state->scannedFileCount++];
+		fplCopyString(fullPath, pictureFile->filePath, fplArrayCount(pictureFile->filePath));
+		pictureFile->viewPictureIndex = -1;
+		fplMutexUnlock(&state->scanLock);
+	}
+	return(true);
+}
+
+static void ScanPicturesThreadProc(const fplThreadHandle* thread, void* data) {
+	ViewerState* state = (ViewerState*)data;
+	fplDirectoryScanFlags flags = fplDirectoryScanFlags_FilesOnly | fplDirectoryScanFlags_NameAndTypeOnly;
+	if (state->scanRecursive) {
+		flags |= fplDirectoryScanFlags_Recursive;
 	}
-	if (addedPics > 0) {
-		++state->folderCount;
+	uint64_t startTime = fplMillisecondsQuery();
+	fplDirectoryScan(state->rootPath, fpl_null, flags, state->params.threadCount, ScanPictureFileCallback, state);
+	flogWrite("%s scanning path '%s' in %llu ms", (state->scanCanceled ? "Canceled" : "Finished"), state->rootPath, (unsigned long long)(fplMillisecondsQuery() - startTime));
+	state->isScanning = false;
+}
+
+static void StartScanPictures(ViewerState* state, const bool recursive) {
+	fplAssert(state->scanThread == fpl_null);
+	state->scanRecursive = recursive;
+	state->scanCanceled = false;
+	state->isScanning = true;
+	state->scanThread = fplThreadCreate(ScanPicturesThreadProc, state);
+	if (state->scanThread == fpl_null) {
+		state->isScanning = false;
+	}
+}
+
+static void StopScanPictures(ViewerState* state) {
+	if (state->scanThread != fpl_null) {
+		state->scanCanceled = true;
+		fplThreadWaitForOne(state->scanThread, FPL_TIMEOUT_INFINITE);
+		state->scanThread = fpl_null;
 	}
+	state->isScanning = false;
+	state->scannedFileCount = 0;
+	state->scanSkipPath[0] = 0;
+}
+
+static void ReleaseScannedPictures(ViewerState* state) {
+	StopScanPictures(state);
+	if (state->scannedFiles != fpl_null) {
+		free(state->scannedFiles);
+		state->scannedFiles = fpl_null;
+	}
+	state->scannedFileCapacity = 0;
 }
 
 static void ReleaseTexture(GLuint* target) {
@@ -654,11 +817,253 @@ static void ClearPictureData(ViewPicture* viewPicture, bool noTextures) {
 	}
 }
 
+// Releases the placeholder preview of a picture, the load thread must not be loading the picture anymore.
+// Must be called from the main thread only.
+static void ReleasePicturePreview(ViewPicture* viewPic) {
+	if (viewPic->preview.data != fpl_null) {
+		free(viewPic->preview.data);
+	}
+	if (viewPic->preview.textureId > 0) {
+		ReleaseTexture(&viewPic->preview.textureId);
+	}
+	fplClearStruct(&viewPic->preview);
+	fplAtomicStoreS32(&viewPic->previewState, LoadedPictureState_Unloaded);
+}
+
+static void BuildTileFilePath(const ViewerState* state, const int pictureIndex, char* outPath, const size_t maxOutPathLen) {
+	char fileName[64];
+	fplStringFormat(fileName, fplArrayCount(fileName), "%llu_%d.tiles", (unsigned long long)state->tileSessionId, pictureIndex);
+	fplPathCombine(outPath, maxOutPathLen, 2, state->tilePath, fileName);
+}
+
+// Deletes the tile files which are left over from previous sessions, e.g. after a crash
+static void DeleteStaleTileFiles(const ViewerState* state) {
+	char sessionPrefix[32];
+	size_t sessionPrefixLen = fplStringFormat(sessionPrefix, fplArrayCount(sessionPrefix), "%llu_", (unsigned long long)state->tileSessionId);
+	char filePath[FPL_MAX_PATH_LENGTH];
+	fplFileEntry fileEntry;
+	for (bool r = fplDirectoryListBegin(state->tilePath, "*.tiles", &fileEntry); r; r = fplDirectoryListNext(&fileEntry)) {
+		if (fileEntry.type != fplFileEntryType_File || fplIsStringEqualLen(fileEntry.name, sessionPrefixLen, sessionPrefix, sessionPrefixLen)) {
+			continue;
+		}
+		fplPathCombine(filePath, fplArrayCount(filePath), 2, state->tilePath, fileEntry.name);
+		if (fplFileDelete(filePath)) {
+			flogWrite("Deleted stale tile file '%s'", filePath);
+		}
+	}
+	fplDirectoryListEnd(&fileEntry);
+}
+
+static void FreePictureTiles(PictureTiles* tiles) {
+	if (tiles->tiles != fpl_null) {
+		free(tiles->tiles);
+	}
+	free(tiles);
+}
+
+// Releases the tiles, tile textures and the tile file of a picture, the picture must not be ready anymore.
+// Must be called from the main thread only.
+static void ReleasePictureTiles(ViewPicture* viewPic) {
+	PictureTiles* tiles = viewPic->tiles;
+	if (tiles == fpl_null) {
+		return;
+	}
+	fplAssert(fplAtomicLoadS32(&viewPic->state) != LoadedPictureState_Ready);
+
+	// Wait for load threads which are still reading a tile, new tile loads are rejected because the picture is not ready anymore
+	fplAtomicReadWriteFence();
+	while (fplAtomicLoadS32(&viewPic->tileLoadCount) > 0) {
+		fplThreadYield();
+	}
+
+	for (uint32_t tileIndex = 0; tileIndex < tiles->tileCount; ++tileIndex) {
+		PictureTile* tile = &tiles->tiles[tileIndex];
+		if (tile->data != fpl_null) {
+			free(tile->data);
+		}
+		if (tile->textureId > 0) {
+			ReleaseTexture(&tile->textureId);
+		}
+	}
+	fplFileDelete(tiles->filePath);
+	FreePictureTiles(tiles);
+	viewPic->tiles = fpl_null;
+}
+
 static void ClearViewPictures(ViewerState* state) {
 	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
-		state->viewPictures[i].state = LoadedPictureState_Unloaded;
-		state->viewPictures[i].progress = 0.0f;
-		ClearPictureData(&state->viewPictures[i], true);
+		ViewPicture* viewPic = &state->viewPictures[i];
+		// Pictures in loading are released in the next reload
+		LoadedPictureState loadState = fplAtomicLoadS32(&viewPic->state);
+		if (loadState == LoadedPictureState_Queued && !fplAtomicIsCompareAndSwapS32(&viewPic->state, LoadedPictureState_Queued, LoadedPictureState_Unloaded)) {
+			loadState = LoadedPictureState_LoadingData;
+		}
+		if (loadState == LoadedPictureState_LoadingData) {
+			viewPic->canceled = true;
+			continue;
+		}
+		fplAtomicStoreS32(&viewPic->state, LoadedPictureState_Unloaded);
+		viewPic->progress = 0.0f;
+		ReleasePictureTiles(viewPic);
+		ReleasePicturePreview(viewPic);
+		ClearPictureData(viewPic, false);
+		// Pictures in loading are still counted, until they are released in the next reload
+		fplAssert(state->pictureCacheSize >= viewPic->memorySize);
+		state->pictureCacheSize -= viewPic->memorySize;
+		viewPic->memorySize = 0;
+	}
+	state->viewPictureIndex = -1;
+	state->windowFirstFileIndex = state->windowLastFileIndex = -1;
+}
+
+static ViewPicture* FindViewPicture(ViewerState* state, const int fileIndex) {
+	fplAssert(fileIndex >= 0 && fileIndex < (int)state->pictureFileCount);
+	int pictureIndex = state->pictureFiles[fileIndex].viewPictureIndex;
+	if (pictureIndex < 0) {
+		return(fpl_null);
+	}
+	ViewPicture* result = &state->viewPictures[pictureIndex];
+	if ((int)result->fileIndex != fileIndex || fplAtomicLoadS32(&result->state) == LoadedPictureState_Unloaded) {
+		return(fpl_null);
+	}
+	return(result);
+}
+
+static bool IsFileInWindow(const ViewerState* state, const size_t fileIndex) {
+	bool result = state->windowFirstFileIndex >= 0 && (int)fileIndex >= state->windowFirstFileIndex && (int)fileIndex <= state->windowLastFileIndex;
+	return(result);
+}
+
+// Releases the data and textures of a picture which is not in loading, must be called from the main thread only
+static void ReleaseViewPicture(ViewerState* state, ViewPicture* viewPic) {
+	LoadedPictureState loadState = fplAtomicLoadS32(&viewPic->state);
+	fplAssert(loadState != LoadedPictureState_LoadingData && loadState != LoadedPictureState_Queued);
+	if (loadState != LoadedPictureState_Unloaded) {
+		fplDebugFormatOut("Release picture '%s'[%zu]\n", viewPic->filePath, viewPic->fileIndex);
+	}
+	fplAtomicStoreS32(&viewPic->state, LoadedPictureState_Unloaded);
+	ReleasePictureTiles(viewPic);
+	ReleasePicturePreview(viewPic);
+	ClearPictureData(viewPic, false);
+	fplAssert(state->pictureCacheSize >= viewPic->memorySize);
+	state->pictureCacheSize -= viewPic->memorySize;
+	viewPic->memorySize = 0;
+	viewPic->progress = 0.0f;
+}
+
+// Returns a unloaded picture or evicts the least recently used picture outside of the window
+static ViewPicture* AcquireViewPicture(ViewerState* state) {
+	ViewPicture* result = fpl_null;
+	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+		ViewPicture* viewPic = &state->viewPictures[i];
+		if (fplAtomicLoadS32(&viewPic->state) == LoadedPictureState_Unloaded) {
+			return(viewPic);
+		}
+	}
+	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+		ViewPicture* viewPic = &state->viewPictures[i];
+		LoadedPictureState loadState = fplAtomicLoadS32(&viewPic->state);
+		if ((loadState == LoadedPictureState_Ready || loadState == LoadedPictureState_Error) && !IsFileInWindow(state, viewPic->fileIndex)) {
+			if (result == fpl_null || viewPic->lastUsedFrame < result->lastUsedFrame) {
+				result = viewPic;
+			}
+		}
+	}
+	if (result != fpl_null) {
+		ReleaseViewPicture(state, result);
+	}
+	return(result);
+}
+
+// Evicts the least recently used pictures outside of the window, until the cache fits into the memory budget.
+// Pictures which failed to upload are counted as well, so they are evicted the same way.
+static void EvictViewPictures(ViewerState* state) {
+	size_t budget = (size_t)state->params.cacheBudget * 1024 * 1024;
+	while (state->pictureCacheSize > budget) {
+		ViewPicture* oldest = fpl_null;
+		for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+			ViewPicture* viewPic = &state->viewPictures[i];
+			LoadedPictureState loadState = fplAtomicLoadS32(&viewPic->state);
+			if ((loadState == LoadedPictureState_Ready || loadState == LoadedPictureState_Error) && !IsFileInWindow(state, viewPic->fileIndex)) {
+				if (oldest == fpl_null || viewPic->lastUsedFrame < oldest->lastUsedFrame) {
+					oldest = viewPic;
+				}
+			}
+		}
+		if (oldest == fpl_null) {
+			break;
+		}
+		ReleaseViewPicture(state, oldest);
+	}
+}
+
+static void ReleasePictureTile(ViewerState* state, ViewPicture* viewPic, PictureTile* tile) {
+	fplAssert(fplAtomicLoadS32(&tile->state) == LoadedPictureState_Ready);
+	size_t tileSize = (size_t)tile->width * tile->height * 4;
+	ReleaseTexture(&tile->textureId);
+	fplAssert(viewPic->memorySize >= tileSize && state->pictureCacheSize >= tileSize);
+	viewPic->memorySize -= tileSize;
+	state->pictureCacheSize -= tileSize;
+	fplAtomicStoreS32(&tile->state, LoadedPictureState_Unloaded);
+}
+
+// Evicts the least recently used tiles which was not visible in the last frame, until the cache fits into the memory budget
+static void EvictPictureTiles(ViewerState* state) {
+	size_t budget = (size_t)state->params.cacheBudget * 1024 * 1024;
+	while (state->pictureCacheSize > budget) {
+		ViewPicture* oldestPic = fpl_null;
+		PictureTile* oldestTile = fpl_null;
+		for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+			ViewPicture* viewPic = &state->viewPictures[i];
+			if (viewPic->tiles == fpl_null || fplAtomicLoadS32(&viewPic->state) != LoadedPictureState_Ready) {
+				continue;
+			}
+			for (uint32_t tileIndex = 0; tileIndex < viewPic->tiles->tileCount; ++tileIndex) {
+				PictureTile* tile = &viewPic->tiles->tiles[tileIndex];
+				if (tile->lastUsedFrame + 1 < state->frameIndex && fplAtomicLoadS32(&tile->state) == LoadedPictureState_Ready) {
+					if (oldestTile == fpl_null || tile->lastUsedFrame < oldestTile->lastUsedFrame) {
+						oldestPic = viewPic;
+						oldestTile = tile;
+					}
+				}
+			}
+		}
+		if (oldestTile == fpl_null) {
+			break;
+		}
+		ReleasePictureTile(state, oldestPic, oldestTile);
+	}
+}
+
+// Uploads loaded tiles and drops queued tiles which are not visible anymore
+static void UpdatePictureTiles(ViewerState* state) {
+	uint32_t uploadCount = 0;
+	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+		ViewPicture* viewPic = &state->viewPictures[i];
+		if (viewPic->tiles == fpl_null || fplAtomicLoadS32(&viewPic->state) != LoadedPictureState_Ready) {
+			continue;
+		}
+		for (uint32_t tileIndex = 0; tileIndex < viewPic->tiles->tileCount; ++tileIndex) {
+			PictureTile* tile = &viewPic->tiles->tiles[tileIndex];
+			LoadedPictureState tileState = fplAtomicLoadS32(&tile->state);
+			if (tileState == LoadedPictureState_ToUpload && uploadCount < MAX_TILE_UPLOADS_PER_FRAME) {
+				fplAssert(tile->data != fpl_null && tile->textureId == 0);
+				tile->textureId = AllocateTexture(tile->width, tile->height, 4, tile->data, false, state->textureTarget, state->features.srgbFrameBuffer);
+				free(tile->data);
+				tile->data = fpl_null;
+				if (tile->textureId > 0) {
+					size_t tileSize = (size_t)tile->width * tile->height * 4;
+					viewPic->memorySize += tileSize;
+					state->pictureCacheSize += tileSize;
+					fplAtomicStoreS32(&tile->state, LoadedPictureState_Ready);
+				} else {
+					fplAtomicStoreS32(&tile->state, LoadedPictureState_Error);
+				}
+				++uploadCount;
+			} else if (tileState == LoadedPictureState_Queued && tile->lastUsedFrame + 1 < state->frameIndex) {
+				fplAtomicIsCompareAndSwapS32(&tile->state, LoadedPictureState_Queued, LoadedPictureState_Unloaded);
+			}
+		}
 	}
 }
 
@@ -673,7 +1078,7 @@ int ReadPictureStreamCallback(void* user, char* data, int size) {
 	// fill 'data' with 'size' bytes.  return number of bytes actually read
 	LoadPictureContext* ctx = (LoadPictureContext*)user;
 	ViewPicture* pic = ctx->viewPic;
-	if (ctx->canceled) {
+	if (ctx->canceled || pic->canceled) {
 		return -1;
 	}
 	fplAssert(size >= 0);
@@ -684,10 +1089,10 @@ int ReadPictureStreamCallback(void* user, char* data, int size) {
 void SkipPictureStreamCallback(void* user, int n) {
 	// skip the next 'n' bytes, or 'unget' the last -n bytes if negative
 	LoadPictureContext* ctx = (LoadPictureContext*)user;
-	if (ctx->canceled) {
+	ViewPicture* pic = ctx->viewPic;
+	if (ctx->canceled || pic->canceled) {
 		return;
 	}
-	ViewPicture* pic = ctx->viewPic;
 	fplFileSetPosition32(&pic->fileStream.handle, n, fplFilePositionMode_Current);
 	UpdateStreamProgress(pic);
 }
@@ -695,7 +1100,7 @@ int EofPictureStreamCallback(void* user) {
 	// returns nonzero if we are at end of file/data
 	LoadPictureContext* ctx = (LoadPictureContext*)user;
 	ViewPicture* pic = ctx->viewPic;
-	if (ctx->canceled) {
+	if (ctx->canceled || pic->canceled) {
 		return 1;
 	}
 	int res = 0;
@@ -713,6 +1118,140 @@ static void DownsampleImage(const ImageData* sourceData, ImageData* destData) {
 	destData->data = targetData;
 }
 
+// Splits a decoded RGBA picture into a tiled pyramid and writes all tiles into the tile file.
+// Each level is the half of the previous level, until it fits into a single tile which is returned as overview.
+// The pixels are released in any case.
+static bool BuildPictureTiles(ViewerState* state, LoadPictureContext* ctx, ViewPicture* pic, uint8_t* pixels, const uint32_t width, const uint32_t height, ImageData* outOverview) {
+	fplAssert(pic->tiles == fpl_null);
+	PictureTiles* tiles = (PictureTiles*)calloc(1, sizeof(PictureTiles));
+	tiles->width = width;
+	tiles->height = height;
+
+	// Compute levels and tiles, the tiles are stored in order of the levels and rows
+	uint32_t levelWidth = width;
+	uint32_t levelHeight = height;
+	while ((levelWidth > PICTURE_TILE_SIZE || levelHeight > PICTURE_TILE_SIZE) && tiles->levelCount < MAX_PICTURE_TILE_LEVELS) {
+		PictureTileLevel* level = &tiles->levels[tiles->levelCount++];
+		level->width = levelWidth;
+		level->height = levelHeight;
+		level->tileCountX = (levelWidth + PICTURE_TILE_SIZE - 1) / PICTURE_TILE_SIZE;
+		level->tileCountY = (levelHeight + PICTURE_TILE_SIZE - 1) / PICTURE_TILE_SIZE;
+		level->firstTile = tiles->tileCount;
+		tiles->tileCount += level->tileCountX * level->tileCountY;
+		levelWidth = fplMax((levelWidth + 1) / 2, 1);
+		levelHeight = fplMax((levelHeight + 1) / 2, 1);
+	}
+	tiles->tiles = (PictureTile*)calloc(tiles->tileCount, sizeof(PictureTile));
+	uint64_t fileOffset = 0;
+	for (uint32_t levelIndex = 0; levelIndex < tiles->levelCount; ++levelIndex) {
+		const PictureTileLevel* level = &tiles->levels[levelIndex];
+		for (uint32_t tileY = 0; tileY < level->tileCountY; ++tileY) {
+			for (uint32_t tileX = 0; tileX < level->tileCountX; ++tileX) {
+				PictureTile* tile = &tiles->tiles[level->firstTile + tileY * level->tileCountX + tileX];
+				tile->x = tileX * PICTURE_TILE_SIZE;
+				tile->y = tileY * PICTURE_TILE_SIZE;
+				tile->width = fplMin(level->width - tile->x, PICTURE_TILE_SIZE);
+				tile->height = fplMin(level->height - tile->y, PICTURE_TILE_SIZE);
+				tile->fileOffset = fileOffset;
+				fileOffset += (uint64_t)tile->width * tile->height * 4;
+			}
+		}
+	}
+
+	int pictureIndex = (int)(pic - state->viewPictures);
+	BuildTileFilePath(state, pictureIndex, tiles->filePath, fplArrayCount(tiles->filePath));
+
+	fplFileHandle fileHandle;
+	if (!fplFileCreateBinary(tiles->filePath, &fileHandle)) {
+		flogWrite("Failed to create tile file '%s' for picture '%s'", tiles->filePath, pic->filePath);
+		stbi_image_free(pixels);
+		FreePictureTiles(tiles);
+		return(false);
+	}
+
+	uint8_t* tileBuffer = (uint8_t*)malloc(PICTURE_TILE_SIZE * PICTURE_TILE_SIZE * 4);
+	ImageData current = fplStructInit(ImageData, pixels, width, height, 4, 0);
+	bool result = true;
+	for (uint32_t levelIndex = 0; levelIndex < tiles->levelCount && result; ++levelIndex) {
+		const PictureTileLevel* level = &tiles->levels[levelIndex];
+		fplAssert(current.width == level->width && current.height == level->height);
+		for (uint32_t tileIndex = 0; tileIndex < level->tileCountX * level->tileCountY; ++tileIndex) {
+			if (ctx->canceled || pic->canceled) {
+				result = false;
+				break;
+			}
+			const PictureTile* tile = &tiles->tiles[level->firstTile + tileIndex];
+			size_t tileStride = (size_t)tile->width * 4;
+			for (uint32_t row = 0; row < tile->height; ++row) {
+				const uint8_t* src = current.data + ((size_t)(tile->y + row) * current.width + tile->x) * 4;
+				fplMemoryCopy(src, tileStride, tileBuffer + row * tileStride);
+			}
+			uint64_t tileSize = tileStride * tile->height;
+			if (fplFileWriteBlock64(&fileHandle, tileBuffer, tileSize) != tileSize) {
+				flogWrite("Failed to write tile file '%s' for picture '%s'", tiles->filePath, pic->filePath);
+				result = false;
+				break;
+			}
+		}
+		if (result) {
+			// Next level or the overview
+			ImageData next = fplZeroInit;
+			next.width = fplMax((current.width + 1) / 2, 1);
+			next.height = fplMax((current.height + 1) / 2, 1);
+			next.components = 4;
+			DownsampleImage(&current, &next);
+			stbi_image_free(current.data);
+			current = next;
+			pic->progress = 0.75f + 0.25f * (float)(levelIndex + 1) / (float)tiles->levelCount;
+		}
+	}
+	free(tileBuffer);
+	fplFileClose(&fileHandle);
+
+	if (!result) {
+		stbi_image_free(current.data);
+		fplFileDelete(tiles->filePath);
+		FreePictureTiles(tiles);
+		return(false);
+	}
+
+	flogWrite("Built tiled pyramid for picture '%s' [%d] with %lu levels and %lu tiles", pic->filePath, pic->fileIndex, tiles->levelCount, tiles->tileCount);
+	pic->tiles = tiles;
+	*outOverview = current;
+	return(true);
+}
+
+// Reads a single queued tile from the tile file, the tile is rejected when the picture is not ready anymore
+static void LoadPictureTile(ViewPicture* pic, const int fileIndex, const int tileIndex) {
+	fplAtomicIncrementS32(&pic->tileLoadCount);
+	PictureTiles* tiles = (fplAtomicLoadS32(&pic->state) == LoadedPictureState_Ready && (int)pic->fileIndex == fileIndex) ? pic->tiles : fpl_null;
+	if (tiles != fpl_null && tileIndex < (int)tiles->tileCount) {
+		PictureTile* tile = &tiles->tiles[tileIndex];
+		if (fplAtomicIsCompareAndSwapS32(&tile->state, LoadedPictureState_Queued, LoadedPictureState_LoadingData)) {
+			fplAssert(tile->data == fpl_null);
+			uint64_t tileSize = (uint64_t)tile->width * tile->height * 4;
+			uint8_t* data = (uint8_t*)malloc((size_t)tileSize);
+			bool isLoaded = false;
+			fplFileHandle fileHandle;
+			if (fplFileOpenBinary(tiles->filePath, &fileHandle)) {
+				if (fplFileSetPosition64(&fileHandle, (int64_t)tile->fileOffset, fplFilePositionMode_Beginning) == tile->fileOffset) {
+					isLoaded = fplFileReadBlock64(&fileHandle, tileSize, data, tileSize) == tileSize;
+				}
+				fplFileClose(&fileHandle);
+			}
+			if (isLoaded) {
+				tile->data = data;
+				fplAtomicStoreS32(&tile->state, LoadedPictureState_ToUpload);
+			} else {
+				flogWrite("Failed to load tile [%d] of picture '%s' from tile file '%s'", tileIndex, pic->filePath, tiles->filePath);
+				free(data);
+				fplAtomicStoreS32(&tile->state, LoadedPictureState_Error);
+			}
+		}
+	}
+	fplAtomicAddAndFetchS32(&pic->tileLoadCount, -1);
+}
+
 static void LoadPictureThreadProc(const fplThreadHandle* thread, void* data) {
 	PictureLoadThread* loadThread = (PictureLoadThread*)data;
 	ViewerState* state = loadThread->state;
@@ -731,32 +1270,32 @@ static void LoadPictureThreadProc(const fplThreadHandle* thread, void* data) {
 		}
 
 		if (hasValue) {
-			fplAssert(valueToLoad.fileIndex >= 0 && valueToLoad.fileIndex < (int)state->pictureFileCount);
+			hasValue = false;
 			fplAssert(valueToLoad.pictureIndex >= 0 && valueToLoad.pictureIndex < (int)state->viewPicturesCapacity);
 			ViewPicture* loadedPic = &state->viewPictures[valueToLoad.pictureIndex];
-			const PictureFile* picFile = &state->pictureFiles[valueToLoad.fileIndex];
 
-			LoadedPictureState loadState = fplAtomicLoadS32(&loadedPic->state);
-			if (loadState == LoadedPictureState_Discard || loadThread->context.canceled || loadedPic->fileStream.handle.isValid) {
+			// Entries of pictures which was canceled or reused for another file are skipped
+			if (loadThread->context.canceled || (int)loadedPic->fileIndex != valueToLoad.fileIndex) {
 				continue;
 			}
-			if (loadState == LoadedPictureState_Unloaded || loadState == LoadedPictureState_Error) {
-				fplAtomicStoreS32(&loadedPic->state, LoadedPictureState_LoadingData);
-
+			if (valueToLoad.tileIndex >= 0) {
+				LoadPictureTile(loadedPic, valueToLoad.fileIndex, valueToLoad.tileIndex);
+				continue;
+			}
+			if (fplAtomicIsCompareAndSwapS32(&loadedPic->state, LoadedPictureState_Queued, LoadedPictureState_LoadingData)) {
 				// @TODO(final): This should not be neccesary, but in case there are left-overs...
 				ClearPictureData(loadedPic, true);
 
 				ImageData* firstImage = &loadedPic->imageData[0];
 
+				fplAssert(loadedPic->tiles == fpl_null);
 				fplAssert(!loadedPic->fileStream.handle.isValid);
 				fplAssert(firstImage->data == fpl_null);
 				fplAssert(firstImage->textureId == 0);
-				fplAssert(picFile->filePath != fpl_null);
+				fplAssert(fplAtomicLoadS32(&loadedPic->previewState) == LoadedPictureState_Unloaded);
 
 				loadedPic->progress = 0.0f;
 				loadedPic->fileStream.size = 0;
-				loadedPic->fileIndex = (size_t)valueToLoad.fileIndex;
-				fplCopyString(picFile->filePath, loadedPic->filePath, fplArrayCount(loadedPic->filePath));
 				firstImage->width = firstImage->height = 0;
 				firstImage->components = 0;
 				loadThread->context.viewPic = loadedPic;
@@ -764,8 +1303,38 @@ static void LoadPictureThreadProc(const fplThreadHandle* thread, void* data) {
 				int w = 0, h = 0, comp = 0;
 				uint8_t* decodedData = fpl_null;
 
-				flogWrite("Load picture stream '%s' [%d]", loadedPic->filePath, loadedPic->fileIndex);
-				if (fplFileOpenBinary(loadedPic->filePath, &loadedPic->fileStream.handle)) {
+				// Try the preview cache first, so we dont have to decode the picture again.
+				// Pictures smaller than the preview size are stored in full resolution, so the cached picture is final.
+				// Bigger pictures are stored downsampled, which is shown as a placeholder only until the full picture is decoded.
+				PreviewCacheKey cacheKey;
+				bool hasCacheKey = state->previewCache.isOpen && PreviewCacheMakeKey(loadedPic->filePath, &cacheKey);
+				bool isCached = false;
+				bool hasPreview = false;
+				if (hasCacheKey) {
+					uint8_t* cachedData = fpl_null;
+					uint32_t cachedWidth, cachedHeight, cachedComponents;
+					if (PreviewCacheLoad(&state->previewCache, &cacheKey, &cachedData, &cachedWidth, &cachedHeight, &cachedComponents)) {
+						if (fplMax(cachedWidth, cachedHeight) < state->previewCache.previewSize) {
+							flogWrite("Loaded picture '%s' [%d] from preview cache, Size (%d x %d)", loadedPic->filePath, loadedPic->fileIndex, cachedWidth, cachedHeight);
+							decodedData = cachedData;
+							w = (int)cachedWidth;
+							h = (int)cachedHeight;
+							isCached = true;
+						} else {
+							loadedPic->preview.data = cachedData;
+							loadedPic->preview.width = cachedWidth;
+							loadedPic->preview.height = cachedHeight;
+							loadedPic->preview.components = cachedComponents;
+							fplAtomicStoreS32(&loadedPic->previewState, LoadedPictureState_ToUpload);
+							hasPreview = true;
+						}
+					}
+				}
+
+				if (!isCached) {
+					flogWrite("Load picture stream '%s' [%d]", loadedPic->filePath, loadedPic->fileIndex);
+				}
+				if (!isCached && fplFileOpenBinary(loadedPic->filePath, &loadedPic->fileStream.handle)) {
 					loadedPic->fileStream.size = fplFileGetSizeFromHandle32(&loadedPic->fileStream.handle);
 					stbi_io_callbacks callbacks;
 					callbacks.read = ReadPictureStreamCallback;
@@ -776,16 +1345,54 @@ static void LoadPictureThreadProc(const fplThreadHandle* thread, void* data) {
 					fplFileClose(&loadedPic->fileStream.handle);
 				}
 
-				if (loadThread->shutdown || loadThread->context.canceled) {
+				bool isCanceled = loadThread->shutdown || loadThread->context.canceled;
+				if (isCanceled) {
 					// Loading is canceled
 					if (decodedData != fpl_null) {
 						stbi_image_free(decodedData);
 						decodedData = fpl_null;
 					}
 				}
+				// Huge pictures are split into a tiled pyramid, so only the visible tiles needs to be in memory
+				bool isTiled = false;
+				if (decodedData != fpl_null && !isCached && (uint32_t)fplMax(w, h) > state->tiledPictureThreshold) {
+					flogWrite("Successfully loaded picture stream '%s' [%d], Size (%d x %d)", loadedPic->filePath, loadedPic->fileIndex, w, h);
+					ImageData overview = fplZeroInit;
+					if (BuildPictureTiles(state, &loadThread->context, loadedPic, decodedData, (uint32_t)w, (uint32_t)h, &overview)) {
+						decodedData = overview.data;
+						w = (int)overview.width;
+						h = (int)overview.height;
+						isTiled = true;
+					} else {
+						decodedData = fpl_null;
+					}
+				}
+
 				if (decodedData != fpl_null) {
 					// Loading was successful, mark it as ToUpload
-					flogWrite("Successfully loaded picture stream '%s' [%d], Size (%d x %d)", loadedPic->filePath, loadedPic->fileIndex, w, h);
+					if (!isCached && !isTiled) {
+						flogWrite("Successfully loaded picture stream '%s' [%d], Size (%d x %d)", loadedPic->filePath, loadedPic->fileIndex, w, h);
+					}
+
+					// Store a preview for the next time, big pictures are downsampled to the preview size.
+					// Tiled pictures are not stored, because the preview would replace the full resolution tiles.
+					if (!isCached && !hasPreview && !isTiled && hasCacheKey) {
+						uint32_t previewSize = state->previewCache.previewSize;
+						uint32_t maxSize = (uint32_t)fplMax(w, h);
+						if (maxSize > previewSize) {
+							float scale = (float)previewSize / (float)maxSize;
+							ImageData sourceImage = fplStructInit(ImageData, decodedData, (uint32_t)w, (uint32_t)h, 4, 0);
+							ImageData previewImage = fplZeroInit;
+							previewImage.width = fplMax((uint32_t)((float)w * scale + 0.5f), 1);
+							previewImage.height = fplMax((uint32_t)((float)h * scale + 0.5f), 1);
+							previewImage.components = 4;
+							DownsampleImage(&sourceImage, &previewImage);
+							PreviewCacheStore(&state->previewCache, &cacheKey, previewImage.data, previewImage.width, previewImage.height, previewImage.components);
+							stbi_image_free(previewImage.data);
+						} else {
+							PreviewCacheStore(&state->previewCache, &cacheKey, decodedData, (uint32_t)w, (uint32_t)h, 4);
+						}
+					}
 
 					firstImage->width = (uint32_t)w;
 					firstImage->height = (uint32_t)h;
@@ -813,14 +1420,13 @@ static void LoadPictureThreadProc(const fplThreadHandle* thread, void* data) {
 
 					fplAtomicStoreS32(&loadedPic->state, LoadedPictureState_ToUpload);
 				} else {
-					// Failed or canceled loading
-					bool isFailed = !(loadThread->shutdown || loadThread->context.canceled);
+					// Failed or canceled loading, canceled pictures are unloaded so they can be queued again
+					bool isFailed = !(isCanceled || loadThread->context.canceled || loadedPic->canceled);
 					flogWrite("%s loaded picture stream '%s' [%d], Size (%d x %d)", (isFailed ? "Failed" : "Canceled"), loadedPic->filePath, loadedPic->fileIndex, w, h);
 					loadedPic->progress = 1.0f;
-					fplAtomicStoreS32(&loadedPic->state, LoadedPictureState_Error);
+					fplAtomicStoreS32(&loadedPic->state, isFailed ? LoadedPictureState_Error : LoadedPictureState_Unloaded);
 				}
 			}
-			hasValue = false;
 		}
 	}
 }
@@ -863,54 +1469,95 @@ static void ShutdownLoadThreads(ViewerState* state) {
 	}
 }
 
-static void QueueUpPictures(ViewerState* state) {
-	// Compute how many pictures we need to preload on the left/right side
-	int capacity = (int)state->viewPicturesCapacity;
-	int maxSidePreloadCount = capacity / 2;
-	state->viewPictureIndex = maxSidePreloadCount;
-	fplAssert(state->activeFileIndex >= 0 && state->activeFileIndex < (int)state->pictureFileCount);
-	int preloadCountLeft;
-	int preloadCountRight;
-	if (state->activeFileIndex > 0) {
-		preloadCountLeft = fplMin(state->activeFileIndex, maxSidePreloadCount);
+static void UpdatePictureWindow(ViewerState* state) {
+	// The window is shifted in the paging direction, so that most of the preloaded pictures are ahead
+	int fileCount = (int)state->pictureFileCount;
+	int windowCount = fplMin((int)state->windowCount, fileCount);
+	int sideCount = windowCount - 1;
+	int aheadCount = state->pageDirection != 0 ? (sideCount * 3) / 4 : sideCount / 2;
+	int behindCount = sideCount - aheadCount;
+	int first;
+	if (state->pageDirection < 0) {
+		first = state->activeFileIndex - aheadCount;
 	} else {
-		preloadCountLeft = 0;
-	}
-	if (state->activeFileIndex < ((int)state->pictureFileCount - 1)) {
-		int diff = (int)state->pictureFileCount - state->activeFileIndex;
-		preloadCountRight = fplMax(fplMin(diff, maxSidePreloadCount), 0);
-	} else {
-		preloadCountRight = 0;
+		first = state->activeFileIndex - behindCount;
 	}
+	first = fplMax(fplMin(first, fileCount - windowCount), 0);
+	state->windowFirstFileIndex = first;
+	state->windowLastFileIndex = first + windowCount - 1;
+}
+
+static void QueueUpPictures(ViewerState* state) {
+	fplAssert(state->activeFileIndex >= 0 && state->activeFileIndex < (int)state->pictureFileCount);
 
-	// First picture
-	LoadQueueValue newValue;
-	newValue.fileIndex = state->activeFileIndex;
-	newValue.pictureIndex = state->viewPictureIndex;
-	TryQueueEnqueue(&state->loadQueue, newValue);
+	UpdatePictureWindow(state);
 
-	// Enqueu pictures from the left side
-	for (int i = 1; i <= preloadCountLeft; ++i) {
-		if ((state->activeFileIndex - i) >= 0) {
-			newValue.fileIndex = state->activeFileIndex - i;
-			newValue.pictureIndex = state->viewPictureIndex - i;
-			TryQueueEnqueue(&state->loadQueue, newValue);
+	// Cancel queued and loading pictures outside of the window, loads inside the window are kept
+	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+		ViewPicture* viewPic = &state->viewPictures[i];
+		LoadedPictureState loadState = fplAtomicLoadS32(&viewPic->state);
+		if (IsFileInWindow(state, viewPic->fileIndex)) {
+			continue;
+		}
+		if (loadState == LoadedPictureState_Queued) {
+			fplAtomicIsCompareAndSwapS32(&viewPic->state, LoadedPictureState_Queued, LoadedPictureState_Unloaded);
+		} else if (loadState == LoadedPictureState_LoadingData) {
+			viewPic->canceled = true;
 		}
 	}
 
-	// Enqueu pictures from the right side
-	for (int i = 1; i <= preloadCountRight; ++i) {
-		if ((state->activeFileIndex + i) < (int)state->pictureFileCount) {
-			newValue.fileIndex = state->activeFileIndex + i;
-			newValue.pictureIndex = state->viewPictureIndex + i;
-			TryQueueEnqueue(&state->loadQueue, newValue);
+	// Enqueue missing pictures, starting from the active picture and alternating between both sides, ahead first
+	int direction = state->pageDirection < 0 ? -1 : 1;
+	int maxDistance = state->windowLastFileIndex - state->windowFirstFileIndex;
+	bool hasQueued = false;
+	bool isFull = false;
+	for (int distance = 0; distance <= maxDistance && !isFull; ++distance) {
+		for (int side = 0; side < (distance > 0 ? 2 : 1); ++side) {
+			int fileIndex = state->activeFileIndex + (side == 0 ? direction : -direction) * distance;
+			if (!IsFileInWindow(state, fileIndex)) {
+				continue;
+			}
+			ViewPicture* viewPic = FindViewPicture(state, fileIndex);
+			if (viewPic != fpl_null) {
+				viewPic->lastUsedFrame = state->frameIndex;
+				continue;
+			}
+			viewPic = AcquireViewPicture(state);
+			if (viewPic == fpl_null) {
+				isFull = true;
+				break;
+			}
+			int pictureIndex = (int)(viewPic - state->viewPictures);
+			PictureFile* picFile = &state->pictureFiles[fileIndex];
+			fplCopyString(picFile->filePath, viewPic->filePath, fplArrayCount(viewPic->filePath));
+			viewPic->fileIndex = (size_t)fileIndex;
+			viewPic->lastUsedFrame = state->frameIndex;
+			viewPic->progress = 0.0f;
+			viewPic->canceled = false;
+			picFile->viewPictureIndex = pictureIndex;
+			// A canceled load may have left a placeholder preview behind
+			ReleasePicturePreview(viewPic);
+			fplAtomicStoreS32(&viewPic->state, LoadedPictureState_Queued);
+
+			LoadQueueValue newValue;
+			newValue.fileIndex = fileIndex;
+			newValue.pictureIndex = pictureIndex;
+			newValue.tileIndex = -1;
+			if (!TryQueueEnqueue(&state->loadQueue, newValue)) {
+				// Queue is full, try again in the next frame
+				fplAtomicStoreS32(&viewPic->state, LoadedPictureState_Unloaded);
+				isFull = true;
+				break;
+			}
+			hasQueued = true;
 		}
 	}
 
 	// Wakeup load threads
-	for (size_t i = 0; i < state->loadThreadCount; ++i) {
-		state->loadThreads[i].context.canceled = false;
-		fplConditionSignal(&state->loadThreads[i].condition);
+	if (hasQueued) {
+		for (size_t i = 0; i < state->loadThreadCount; ++i) {
+			fplConditionSignal(&state->loadThreads[i].condition);
+		}
 	}
 }
 
@@ -920,37 +1567,59 @@ static void UpdateWindowTitle(ViewerState* state) {
 		const char* filterName = state->filters[state->activeFilter].name;
 		const char* picFilename = fplExtractFileName(state->pictureFiles[state->activeFileIndex].filePath);
 		fplStringFormat(titleBuffer, fplArrayCount(titleBuffer), "%s v%s - %s [%d / %zu] {%s}", VER_PRODUCTNAME_STR, VER_PRODUCTVERSION_STR, picFilename, (state->activeFileIndex + 1), state->pictureFileCount, filterName);
+	} else if (state->isScanning) {
+		fplStringFormat(titleBuffer, fplArrayCount(titleBuffer), "%s v%s - Scanning for pictures...", VER_PRODUCTNAME_STR, VER_PRODUCTVERSION_STR);
 	} else {
 		fplStringFormat(titleBuffer, fplArrayCount(titleBuffer), "%s v%s - No pictures found", VER_PRODUCTNAME_STR, VER_PRODUCTVERSION_STR);
 	}
+	if (state->isScanning && state->activeFileIndex > -1) {
+		fplStringAppend(" (Scanning...)", titleBuffer, fplArrayCount(titleBuffer));
+	}
 	fplSetWindowTitle(titleBuffer);
 }
 
+static void ResetPictureZoom(ViewerState* state) {
+	state->zoom = 1.0f;
+	state->pan = V2f(0.0f, 0.0f);
+	state->isDragging = false;
+}
+
+// Zooms the active picture, the picture point below the focus (relative to the window center) stays at the same position
+static void ZoomPicture(ViewerState* state, const float factor, const Vec2f focus) {
+	float newZoom = fplMax(fplMin(state->zoom * factor, MAX_PICTURE_ZOOM), MIN_PICTURE_ZOOM);
+	float ratio = newZoom / state->zoom;
+	state->pan.x = focus.x - (focus.x - state->pan.x) * ratio;
+	state->pan.y = focus.y - (focus.y - state->pan.y) * ratio;
+	state->zoom = newZoom;
+}
+
+static Vec2f GetMouseFocus(const int32_t mouseX, const int32_t mouseY) {
+	Vec2f result = V2f(0.0f, 0.0f);
+	fplWindowSize winSize;
+	if (fplGetWindowSize(&winSize)) {
+		result.x = (float)mouseX - (float)winSize.width * 0.5f;
+		result.y = (float)winSize.height * 0.5f - (float)mouseY;
+	}
+	return(result);
+}
+
 static void ChangeViewPicture(ViewerState* state, const int offset, const bool forceReload) {
+	ResetPictureZoom(state);
 	if (state->pictureFileCount == 0) {
-		fplAssert(state->viewPictureIndex == -1);
-		fplAssert(state->activeFileIndex == -1);
+		// Pictures may still come from the scan
+		state->activeFileIndex = -1;
+		UpdateWindowTitle(state);
 		return;
 	}
-	int capacity = (int)state->viewPicturesCapacity;
-	bool loadPictures = false;
-	int viewIndex;
-	if (state->viewPictureIndex == -1 || forceReload) {
-		viewIndex = capacity / 2;
-		loadPictures = true;
-	} else {
-		viewIndex = state->viewPictureIndex + offset;
-		if (viewIndex < 0 || viewIndex >= capacity) {
-			viewIndex = capacity / 2;
-			loadPictures = true;
-		}
+	if (offset != 0) {
+		state->pageDirection = offset > 0 ? 1 : -1;
 	}
-	state->viewPictureIndex = viewIndex;
 	state->activeFileIndex = fplMax(fplMin(state->activeFileIndex + offset, (int)state->pictureFileCount - 1), 0);
 
 	UpdateWindowTitle(state);
 
-	if (loadPictures) {
+	// Pictures are queued in the next update, already loaded or loading pictures are kept
+	if (forceReload) {
 		state->doPictureReload = true;
 		ShutdownQueue(&state->loadQueue);
 		StopLoadingInThreads(state);
@@ -969,6 +1638,8 @@ static uint32_t ParseNumber(const char** p) {
 static void ParseParameters(ViewerParameters* params, const int argc, char** argv) {
 	fplClearStruct(params);
 	params->path = fpl_null;
+	params->previewCacheSize = PREVIEW_CACHE_DEFAULT_SIZE;
+	params->cacheBudget = PICTURE_CACHE_DEFAULT_BUDGET;
 	for (int i = 0; i < argc; ++i) {
 		const char* p = argv[i];
 		if (p[0] == '-') {
@@ -984,6 +1655,14 @@ static void ParseParameters(ViewerParameters* params, const int argc, char** arg
 				case 't':
 					params->threadCount = 0;
 					break;
+				case 'p':
+					params->preloadCount = 0;
+					break;
+				case 'c':
+					params->previewCacheSize = 0;
+					break;
+				case 'm':
+					break;
 				default:
 					continue;
 			}
@@ -1003,6 +1682,22 @@ static void ParseParameters(ViewerParameters* params, const int argc, char** arg
 				} else {
 					continue;
 				}
+			} else if (param == 'c') {
+				++p;
+				if (p[0] == '=') {
+					++p;
+					params->previewCacheSize = ParseNumber(&p);
+				} else {
+					params->previewCacheSize = PREVIEW_CACHE_DEFAULT_SIZE;
+				}
+			} else if (param == 'm') {
+				++p;
+				if (p[0] == '=') {
+					++p;
+					params->cacheBudget = ParseNumber(&p);
+				} else {
+					continue;
+				}
 			}
 		} else {
 			params->path = p;
@@ -1100,13 +1795,20 @@ static void CheckGLError(const char* stmt, const char* fname, int line) {
 	} while (0)
 
 static void Kill(ViewerState* state) {
+	ReleaseScannedPictures(state);
+	fplMutexDestroy(&state->scanLock);
 	ShutdownQueue(&state->loadQueue);
 	ShutdownLoadThreads(state);
 	ClearPictureFiles(state);
 	ClearViewPictures(state);
+	if (state->previewCache.isOpen) {
+		flogWrite("Preview cache hits: %lu, misses: %lu", state->previewCache.hitCount, state->previewCache.missCount);
+		PreviewCacheClose(&state->previewCache);
+	}
 }
 
 static void Clear(ViewerState* state) {
+	StopScanPictures(state);
 	ShutdownQueue(&state->loadQueue);
 	StopLoadingInThreads(state);
 	ClearPictureFiles(state);
@@ -1123,22 +1825,101 @@ static bool FindPictureIndexByPath(ViewerState* state, const char* path, size_t*
 	return(false);
 }
 
+static int ComparePictureFiles(const void* a, const void* b) {
+	const PictureFile* fileA = (const PictureFile*)a;
+	const PictureFile* fileB = (const PictureFile*)b;
+	int result = strcmp(fileA->filePath, fileB->filePath);
+	return(result);
+}
+
+// Sorts the picture files by path and moves the view pictures and the active picture to the new file indices, must be called from the main thread
+static void SortPictureFiles(ViewerState* state) {
+	if (state->pictureFileCount < 2) {
+		return;
+	}
+	char activeFilePath[FPL_MAX_PATH_LENGTH] = fplZeroInit;
+	if (state->activeFileIndex > -1) {
+		fplCopyString(state->pictureFiles[state->activeFileIndex].filePath, activeFilePath, fplArrayCount(activeFilePath));
+	}
+
+	qsort(state->pictureFiles, state->pictureFileCount, sizeof(*state->pictureFiles), ComparePictureFiles);
+
+	for (size_t fileIndex = 0; fileIndex < state->pictureFileCount; ++fileIndex) {
+		PictureFile* picFile = &state->pictureFiles[fileIndex];
+		if (picFile->viewPictureIndex < 0 || picFile->viewPictureIndex >= (int)state->viewPicturesCapacity) {
+			continue;
+		}
+		// Links of reused view pictures are stale, see FindViewPicture
+		ViewPicture* viewPic = &state->viewPictures[picFile->viewPictureIndex];
+		if (viewPic->fileIndex == fileIndex || fplAtomicLoadS32(&viewPic->state) == LoadedPictureState_Unloaded || !fplIsStringEqual(viewPic->filePath, picFile->filePath)) {
+			continue;
+		}
+		viewPic->fileIndex = fileIndex;
+
+		// Queued entries with the old file index are skipped by the load threads, so these are queued again
+		fplAtomicIsCompareAndSwapS32(&viewPic->state, LoadedPictureState_Queued, LoadedPictureState_Unloaded);
+		if (viewPic->tiles != fpl_null) {
+			for (uint32_t tileIndex = 0; tileIndex < viewPic->tiles->tileCount; ++tileIndex) {
+				fplAtomicIsCompareAndSwapS32(&viewPic->tiles->tiles[tileIndex].state, LoadedPictureState_Queued, LoadedPictureState_Unloaded);
+			}
+		}
+	}
+
+	if (state->activeFileIndex > -1) {
+		size_t activeIndex;
+		if (FindPictureIndexByPath(state, activeFilePath, &activeIndex)) {
+			state->activeFileIndex = (int)activeIndex;
+		}
+	}
+}
+
+// Adds the pictures found by the scan so far, must be called from the main thread
+static void AddScannedPictures(ViewerState* state) {
+	if (state->scanThread == fpl_null) {
+		return;
+	}
+	bool isFinished = !state->isScanning;
+	size_t oldCount = state->pictureFileCount;
+	fplMutexLock(&state->scanLock);
+	for (size_t i = 0; i < state->scannedFileCount; ++i) {
+		const char* filePath = state->scannedFiles[i].filePath;
+		if (!fplIsStringEqual(filePath, state->scanSkipPath)) {
+			AddPictureFile(state, filePath);
+		}
+	}
+	state->scannedFileCount = 0;
+	fplMutexUnlock(&state->scanLock);
+	if (isFinished) {
+		fplThreadWaitForOne(state->scanThread, FPL_TIMEOUT_INFINITE);
+		state->scanThread = fpl_null;
+		// The scan reports the pictures in any order, so the final order is always the same
+		SortPictureFiles(state);
+		flogWrite("Found %zu pictures in path '%s'", state->pictureFileCount, state->rootPath);
+	}
+	if (state->activeFileIndex == -1 && state->pictureFileCount > 0) {
+		ChangeViewPicture(state, 0, true);
+	} else if (isFinished || state->pictureFileCount != oldCount) {
+		UpdateWindowTitle(state);
+	}
+}
+
 static bool LoadPicturesPath(ViewerState* state, const char* path, const bool recursive, size_t* startIndex) {
 	bool result = false;
 	Clear(state);
 	flogWrite("Loading pictures from path '%s'", path);
+	state->activeFileIndex = -1;
+	*startIndex = 0;
 	if (fplDirectoryExists(path)) {
 		fplCopyString(path, state->rootPath, fplArrayCount(state->rootPath));
-		AddPicturesFromPath(state, state->rootPath, recursive);
-		result = state->pictureFileCount > 0;
-		*startIndex = 0;
+		StartScanPictures(state, recursive);
+		result = true;
 	} else if (fplFileExists(path)) {
 		if (IsPictureFile(path)) {
+			// The picture itself is shown first, all other pictures are added while scanning
 			fplExtractFilePath(path, state->rootPath, fplArrayCount(state->rootPath));
-			AddPicturesFromPath(state, state->rootPath, recursive);
-			if (!FindPictureIndexByPath(state, path, startIndex)) {
-				startIndex = 0;
-			}
+			AddPictureFile(state, path);
+			fplCopyString(path, state->scanSkipPath, fplArrayCount(state->scanSkipPath));
+			StartScanPictures(state, recursive);
 			result = true;
 		}
 	}
@@ -1263,6 +2044,33 @@ static bool Init(ViewerState* state) {
 	state->activeFileIndex = -1;
 	state->doPictureReload = false;
 
+	fplMutexInit(&state->scanLock);
+
+	ResetPictureZoom(state);
+
+	// Pictures which does not fit into a single texture are tiled
+	GLint maxTextureSize = 0;
+	glGetIntegerv(state->textureTarget == GL_TEXTURE_RECTANGLE ? GL_MAX_RECTANGLE_TEXTURE_SIZE : GL_MAX_TEXTURE_SIZE, &maxTextureSize);
+	state->tiledPictureThreshold = maxTextureSize > 0 ? fplMin((uint32_t)maxTextureSize, TILED_PICTURE_THRESHOLD) : TILED_PICTURE_THRESHOLD;
+	fplGetHomePath(state->tilePath, fplArrayCount(state->tilePath));
+	fplPathCombine(state->tilePath, fplArrayCount(state->tilePath), 3, state->tilePath, VER_INTERNALNAME_STR, "tiles");
+	fplDirectoriesCreate(state->tilePath);
+	state->tileSessionId = fplMillisecondsQuery();
+	DeleteStaleTileFiles(state);
+	flogWrite("Pictures larger than %lu are tiled in path '%s'", state->tiledPictureThreshold, state->tilePath);
+
+	// Open preview cache, before any load thread is started
+	if (state->params.previewCacheSize > 0) {
+		char cacheFilePath[FPL_MAX_PATH_LENGTH];
+		fplGetHomePath(cacheFilePath, fplArrayCount(cacheFilePath));
+		fplPathCombine(cacheFilePath, fplArrayCount(cacheFilePath), 3, cacheFilePath, VER_INTERNALNAME_STR, "previews.pack");
+		if (PreviewCacheOpen(&state->previewCache, cacheFilePath, state->params.previewCacheSize, PREVIEW_CACHE_MAX_FILE_SIZE)) {
+			flogWrite("Opened preview cache '%s' with %zu entries", cacheFilePath, state->previewCache.entryCount);
+		} else {
+			flogWrite("Failed to open preview cache '%s'", cacheFilePath);
+		}
+	}
+
 	// Allocate and startup load threads
 	size_t threadCount;
 	if (state->params.threadCount > 0) {
@@ -1281,8 +2089,12 @@ static bool Init(ViewerState* state) {
 	} else {
 		preloadCapacity = 16;
 	}
-	size_t queueCapacity = RoundToPowerOfTwo((preloadCapacity + 1) * 2);
-	state->viewPicturesCapacity = preloadCapacity + 1;
+	// The window is at most the half of all view pictures, so there are always pictures left for caching
+	state->windowCount = fplMin(preloadCapacity + 1, MAX_VIEW_PICTURE_COUNT / 2);
+	state->windowFirstFileIndex = state->windowLastFileIndex = -1;
+	state->pageDirection = 0;
+	state->viewPicturesCapacity = MAX_VIEW_PICTURE_COUNT;
+	size_t queueCapacity = fplMin(RoundToPowerOfTwo(state->windowCount * 4), MAX_LOAD_QUEUE_COUNT);
 	state->loadQueueCapacity = queueCapacity;
 
 	fplAssert(fplIsPowerOfTwo(queueCapacity));
@@ -1491,42 +2303,94 @@ static void DrawTexturedRectangle(ViewerState* state, const GLuint textureId, co
 	fplAssert(glGetError() == GL_NO_ERROR);
 }
 
-static void UpdateAndRender(ViewerState* state, const float deltaTime) {
-	// Discard textures on the left/right side when the fileIndex is out of bounds
-	if (state->viewPictureIndex != -1) {
-		ViewPicture* currentPic = &state->viewPictures[state->viewPictureIndex];
-		if (currentPic->fileIndex == 0) {
-			for (int i = 0; i < state->viewPictureIndex; ++i) {
-				ViewPicture* sidePic = &state->viewPictures[i];
-				if (sidePic->state == LoadedPictureState_Ready) {
-					fplAtomicStoreS32(&sidePic->state, LoadedPictureState_Discard);
-				}
-			}
-		} else if (currentPic->fileIndex == state->pictureFileCount - 1) {
-			for (int i = state->viewPictureIndex + 1; i < (int)state->viewPicturesCapacity; ++i) {
-				ViewPicture* sidePic = &state->viewPictures[i];
-				if (sidePic->state == LoadedPictureState_Ready) {
-					fplAtomicStoreS32(&sidePic->state, LoadedPictureState_Discard);
+// Draws the visible tiles of the level matching the current zoom, tiles which are not loaded are queued up
+static void DrawPictureTiles(ViewerState* state, ViewPicture* pic, const Mat4f* vpMat, const float viewLeft, const float viewTop, const float viewWidth, const float viewHeight, const float screenW, const float screenH, const Vec4f color) {
+	PictureTiles* tiles = pic->tiles;
+
+	// Use the smallest level, which has at least one picture pixel per screen pixel
+	float picturePixelsPerScreenPixel = (float)tiles->width / viewWidth;
+	uint32_t levelIndex = 0;
+	while (levelIndex < tiles->levelCount && picturePixelsPerScreenPixel >= 2.0f) {
+		picturePixelsPerScreenPixel *= 0.5f;
+		++levelIndex;
+	}
+	if (levelIndex == tiles->levelCount) {
+		// Overview is good enough
+		return;
+	}
+
+	const PictureTileLevel* level = &tiles->levels[levelIndex];
+	float scaleX = viewWidth / (float)level->width;
+	float scaleY = viewHeight / (float)level->height;
+	float tileScreenW = (float)PICTURE_TILE_SIZE * scaleX;
+	float tileScreenH = (float)PICTURE_TILE_SIZE * scaleY;
+	float screenLeft = -screenW * 0.5f;
+	float screenTop = screenH * 0.5f;
+	int firstTileX = fplMax((int)floorf((screenLeft - viewLeft) / tileScreenW), 0);
+	int lastTileX = fplMin((int)floorf((screenLeft + screenW - viewLeft) / tileScreenW), (int)level->tileCountX - 1);
+	int firstTileY = fplMax((int)floorf((viewTop - screenTop) / tileScreenH), 0);
+	int lastTileY = fplMin((int)floorf((viewTop - screenTop + screenH) / tileScreenH), (int)level->tileCountY - 1);
+
+	int pictureIndex = (int)(pic - state->viewPictures);
+	GLuint filterProgramId = state->filters[state->activeFilter].programId;
+	bool hasQueued = false;
+	for (int tileY = firstTileY; tileY <= lastTileY; ++tileY) {
+		for (int tileX = firstTileX; tileX <= lastTileX; ++tileX) {
+			int tileIndex = (int)level->firstTile + tileY * (int)level->tileCountX + tileX;
+			PictureTile* tile = &tiles->tiles[tileIndex];
+			tile->lastUsedFrame = state->frameIndex;
+			LoadedPictureState tileState = fplAtomicLoadS32(&tile->state);
+			if (tileState == LoadedPictureState_Ready) {
+				float tileW = (float)tile->width * scaleX;
+				float tileH = (float)tile->height * scaleY;
+				float tileLeft = viewLeft + (float)tile->x * scaleX;
+				float tileTop = viewTop - (float)tile->y * scaleY;
+				Mat4f modelMat;
+				BuildModelMat(tileLeft + tileW * 0.5f, tileTop - tileH * 0.5f, tileW * 0.5f, tileH * 0.5f, &modelMat);
+				Vec2f texSize = V2f((float)tile->width, (float)tile->height);
+				Vec2f texScale = state->features.rectangleTextures ? texSize : V2f(1.0f, 1.0f);
+				DrawTexturedRectangle(state, tile->textureId, state->textureTarget, filterProgramId, vpMat, &modelMat, color, texSize, texScale);
+			} else if (tileState == LoadedPictureState_Unloaded && fplAtomicIsCompareAndSwapS32(&tile->state, LoadedPictureState_Unloaded, LoadedPictureState_Queued)) {
+				LoadQueueValue newValue;
+				newValue.fileIndex = (int)pic->fileIndex;
+				newValue.pictureIndex = pictureIndex;
+				newValue.tileIndex = tileIndex;
+				if (TryQueueEnqueue(&state->loadQueue, newValue)) {
+					hasQueued = true;
+				} else {
+					// Queue is full, try again in the next frame
+					fplAtomicStoreS32(&tile->state, LoadedPictureState_Unloaded);
 				}
 			}
 		}
 	}
 
-	// Discard or upload textures
-	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
-		ViewPicture* loadedPic = &state->viewPictures[i];
+	// Wakeup load threads
+	if (hasQueued) {
+		for (size_t i = 0; i < state->loadThreadCount; ++i) {
+			fplConditionSignal(&state->loadThreads[i].condition);
+		}
+	}
+}
 
-		if (fplAtomicLoadS32(&loadedPic->state) == LoadedPictureState_Discard) {
+static void UpdateAndRender(ViewerState* state, const float deltaTime) {
+	++state->frameIndex;
 
-			for (int p = 0; p < fplArrayCount(loadedPic->imageData); ++p) {
-				if (loadedPic->imageData[p].textureId > 0) {
-					fplDebugFormatOut("Release texture '%s'[%d]\n", loadedPic->filePath, loadedPic->fileIndex);
-					ReleaseTexture(&loadedPic->imageData[p].textureId);
-				}
-			}
+	AddScannedPictures(state);
 
-			fplAtomicStoreS32(&loadedPic->state, LoadedPictureState_Unloaded);
-		} else if (fplAtomicLoadS32(&loadedPic->state) == LoadedPictureState_ToUpload) {
+	// Upload textures
+	for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
+		ViewPicture* loadedPic = &state->viewPictures[i];
+		if (fplAtomicLoadS32(&loadedPic->previewState) == LoadedPictureState_ToUpload && fplAtomicLoadS32(&loadedPic->state) == LoadedPictureState_LoadingData) {
+			ImageData* preview = &loadedPic->preview;
+			preview->textureId = AllocateTexture(preview->width, preview->height, (uint8_t)preview->components, preview->data, false, state->textureTarget, state->features.srgbFrameBuffer);
+			free(preview->data);
+			preview->data = fpl_null;
+			fplAtomicStoreS32(&loadedPic->previewState, preview->textureId > 0 ? LoadedPictureState_Ready : LoadedPictureState_Error);
+		}
+		if (fplAtomicLoadS32(&loadedPic->state) == LoadedPictureState_ToUpload) {
+			// The full picture replaces the placeholder preview
+			ReleasePicturePreview(loadedPic);
 			for (int p = 0; p < fplArrayCount(loadedPic->imageData); ++p) {
 				if (loadedPic->imageData[p].textureId > 0) {
 					fplDebugFormatOut("Release texture '%s'[%d]\n", loadedPic->filePath, loadedPic->fileIndex);
@@ -1536,6 +2400,7 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 			}
 
 			bool hasError = false;
+			size_t memorySize = 0;
 			uint32_t mipmapCount = loadedPic->mipmapCount + 1;
 			for (uint32_t mipmapIndex = 0; mipmapIndex < mipmapCount; ++mipmapIndex) {
 				ImageData* currentImageData = &loadedPic->imageData[mipmapIndex];
@@ -1550,11 +2415,16 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 					hasError = true;
 					break;
 				}
+				memorySize += (size_t)currentImageData->width * currentImageData->height * currentImageData->components;
 
 				stbi_image_free(currentImageData->data);
 				currentImageData->data = fpl_null;
 			}
 
+			loadedPic->memorySize = memorySize;
+			loadedPic->lastUsedFrame = state->frameIndex;
+			state->pictureCacheSize += memorySize;
+
 			if (!hasError) {
 				fplAtomicStoreS32(&loadedPic->state, LoadedPictureState_Ready);
 			} else {
@@ -1564,28 +2434,48 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 			loadedPic->progress = 1.0f;
 		}
 	}
+	UpdatePictureTiles(state);
 	fplAssert(glGetError() == GL_NO_ERROR);
 
-	// Start to queue up pictures to load
 	if (state->doPictureReload) {
-		size_t notUnloadedCount = 0;
+		// Release all pictures and wait until all loads are finished, before we start to queue up pictures again
+		size_t loadingCount = 0;
 		for (size_t i = 0; i < state->viewPicturesCapacity; ++i) {
 			ViewPicture* viewPic = &state->viewPictures[i];
 			LoadedPictureState loadState = fplAtomicLoadS32(&viewPic->state);
-			if (loadState != LoadedPictureState_Unloaded) {
-				if (loadState != LoadedPictureState_Error) {
-					fplAtomicStoreS32(&viewPic->state, LoadedPictureState_Discard);
-					++notUnloadedCount;
+			if (loadState == LoadedPictureState_Queued) {
+				if (!fplAtomicIsCompareAndSwapS32(&viewPic->state, LoadedPictureState_Queued, LoadedPictureState_Unloaded)) {
+					++loadingCount;
 				}
+			} else if (loadState == LoadedPictureState_LoadingData) {
+				viewPic->canceled = true;
+				++loadingCount;
+			} else if (loadState != LoadedPictureState_Unloaded) {
+				ReleaseViewPicture(state, viewPic);
 			}
 		}
-		if (notUnloadedCount == 0) {
+		if (loadingCount == 0) {
+			fplAssert(state->pictureCacheSize == 0);
 			InitQueue(&state->loadQueue, state->loadQueueCapacity);
-			QueueUpPictures(state);
+			for (size_t i = 0; i < state->loadThreadCount; ++i) {
+				state->loadThreads[i].context.canceled = false;
+			}
 			state->doPictureReload = false;
 		}
 	}
 
+	// Start to queue up pictures to load and evict old pictures outside the window
+	state->viewPictureIndex = -1;
+	if (!state->doPictureReload && state->activeFileIndex > -1 && state->pictureFileCount > 0) {
+		QueueUpPictures(state);
+		EvictPictureTiles(state);
+		EvictViewPictures(state);
+		ViewPicture* activePic = FindViewPicture(state, state->activeFileIndex);
+		if (activePic != fpl_null) {
+			state->viewPictureIndex = (int)(activePic - state->viewPictures);
+		}
+	}
+
 	int w, h;
 	fplWindowSize winSize;
 	if (fplGetWindowSize(&winSize)) {
@@ -1626,10 +2516,14 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 		int framePictureStart = fplMin(-pictureFrameSideCount, 0);
 		int framePictureEnd = (framePictureStart + 1 + pictureFrameSideCount);
 		for (int framePictureOffset = framePictureStart; framePictureOffset < (framePictureEnd + 1); ++framePictureOffset) {
-			if ((state->viewPictureIndex + framePictureOffset) < 0 || (state->viewPictureIndex + framePictureOffset) > ((int)state->viewPicturesCapacity - 1)) {
+			int frameFileIndex = state->activeFileIndex + framePictureOffset;
+			if (frameFileIndex < 0 || frameFileIndex > ((int)state->pictureFileCount - 1)) {
+				continue;
+			}
+			ViewPicture* loadedPic = FindViewPicture(state, frameFileIndex);
+			if (loadedPic == fpl_null) {
 				continue;
 			}
-			ViewPicture* loadedPic = &state->viewPictures[state->viewPictureIndex + framePictureOffset];
 			LoadedPictureState pictureState = fplAtomicLoadS32(&loadedPic->state);
 			if (pictureState == LoadedPictureState_Unloaded) {
 				continue;
@@ -1640,9 +2534,10 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 			float targetRectY = targetRectBottom;
 
 			if (pictureState == LoadedPictureState_Ready) {
+				// Tiled pictures are layouted by the full resolution, not by the overview
 				ImageData imageData = loadedPic->imageData[0];
-				float texW = (float)imageData.width;
-				float texH = (float)imageData.height;
+				float texW = (float)(loadedPic->tiles != fpl_null ? loadedPic->tiles->width : imageData.width);
+				float texH = (float)(loadedPic->tiles != fpl_null ? loadedPic->tiles->height : imageData.height);
 				float viewWidth;
 				float viewHeight;
 				float viewX;
@@ -1677,6 +2572,15 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 					viewX = targetRectX;
 					viewY = targetRectY;
 				}
+				if (framePictureOffset == 0) {
+					// Zoom and pan the active picture around its center
+					float centerX = viewX + viewWidth * 0.5f + state->pan.x;
+					float centerY = viewY + viewHeight * 0.5f + state->pan.y;
+					viewWidth *= state->zoom;
+					viewHeight *= state->zoom;
+					viewX = centerX - viewWidth * 0.5f;
+					viewY = centerY - viewHeight * 0.5f;
+				}
 				float viewLeft = viewX;
 				float viewRight = viewX + viewWidth;
 				float viewBottom = viewY;
@@ -1709,7 +2613,33 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 
 				GLuint filterProgramId = state->filters[state->activeFilter].programId;
 				DrawTexturedRectangle(state, actualImageData->textureId, state->textureTarget, filterProgramId, &viewProjection, &modelMat, texColor, texSize, texScale);
+
+				// Visible tiles are drawn on top of the overview, missing tiles are queued up
+				if (loadedPic->tiles != fpl_null) {
+					DrawPictureTiles(state, loadedPic, &viewProjection, viewLeft, viewTop, viewWidth, viewHeight, screenW, screenH, texColor);
+				}
 			} else if (pictureState == LoadedPictureState_LoadingData) {
+				// Show the preview from the preview cache, until the full picture is loaded
+				if (fplAtomicLoadS32(&loadedPic->previewState) == LoadedPictureState_Ready) {
+					ImageData* preview = &loadedPic->preview;
+					float previewW = targetRectWidth;
+					float previewH = targetRectHeight;
+					if ((state->viewFlags & PictureViewFlags_KeepAspectRatio) == PictureViewFlags_KeepAspectRatio) {
+						float aspect = (float)preview->width / (float)preview->height;
+						previewH = targetRectWidth / aspect;
+						if (previewH > targetRectHeight) {
+							previewH = targetRectHeight;
+							previewW = targetRectHeight * aspect;
+						}
+					}
+					Mat4f modelMat;
+					BuildModelMat(targetRectX + targetRectWidth * 0.5f, targetRectY + targetRectHeight * 0.5f, previewW * 0.5f, previewH * 0.5f, &modelMat);
+					Vec2f texSize = V2f((float)preview->width, (float)preview->height);
+					Vec2f texScale = state->features.rectangleTextures ? texSize : V2f(1.0f, 1.0f);
+					GLuint filterProgramId = state->filters[state->activeFilter].programId;
+					DrawTexturedRectangle(state, preview->textureId, state->textureTarget, filterProgramId, &viewProjection, &modelMat, V4f(1, 1, 1, targetOpacity), texSize, texScale);
+				}
+
 				float progressPadding = 4;
 				float progressAspect = 400.0f / 10.0f;
 				float progressW = targetRectWidth * 0.5f;
@@ -1739,8 +2669,8 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 		}
 	}
 
-	if (state->params.preview && state->viewPicturesCapacity > 1 && state->pictureFileCount) {
-		int blockCount = (int)state->viewPicturesCapacity;
+	if (state->params.preview && state->windowCount > 1 && state->pictureFileCount && state->windowFirstFileIndex > -1) {
+		int blockCount = state->windowLastFileIndex - state->windowFirstFileIndex + 1;
 		float maxBlockW = ((fplMin(screenW, screenH)) * 0.75f);
 		float blockPadding = 4;
 		float blockW = ((maxBlockW - ((float)(blockCount - 1) * blockPadding)) / (float)blockCount);
@@ -1749,12 +2679,13 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 		float blocksBottom = (-screenH * 0.5f + blockPadding);
 		Vec2f blockExt = V2f(blockW * 0.5f, blockH * 0.5f);
 		for (int i = 0; i < blockCount; ++i) {
-			ViewPicture* loadedPic = &state->viewPictures[i];
+			int blockFileIndex = state->windowFirstFileIndex + i;
+			ViewPicture* loadedPic = FindViewPicture(state, blockFileIndex);
 			float bx = blocksLeft + (float)i * blockW + ((float)i * blockPadding);
 			float by = blocksBottom;
 			Vec2f blockPos = V2f(bx + blockW * 0.5f, by + blockH * 0.5f);
 
-			LoadedPictureState loadState = fplAtomicLoadS32(&loadedPic->state);
+			LoadedPictureState loadState = loadedPic != fpl_null ? fplAtomicLoadS32(&loadedPic->state) : LoadedPictureState_Unloaded;
 			if (loadState != LoadedPictureState_Unloaded) {
 				Vec4f color = V4f(0, 0, 0, 0);
 				switch (loadState) {
@@ -1767,7 +2698,7 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 					case LoadedPictureState_ToUpload:
 						color = V4f(0, 0.5f, 0.5f, 0.5f);
 						break;
-					case LoadedPictureState_Discard:
+					case LoadedPictureState_Queued:
 						color = V4f(0.75f, 0.25f, 0.0f, 0.5f);
 						break;
 					case LoadedPictureState_Error:
@@ -1797,12 +2728,12 @@ static void UpdateAndRender(ViewerState* state, const float deltaTime) {
 
 			Vec4f blockColor;
 			float blockLineWidth;
-			if (i == state->viewPictureIndex) {
+			if (blockFileIndex == state->activeFileIndex) {
 				blockLineWidth = 2;
 				blockColor = V4f(0, 1, 0, 1);
 			} else {
 				blockLineWidth = 1;
-				if (loadedPic->state == LoadedPictureState_Unloaded) {
+				if (loadState == LoadedPictureState_Unloaded) {
 					blockColor = V4f(1, 1, 1, 0.2f);
 				} else {
 					blockColor = V4f(1, 1, 1, 0.5f);
@@ -1841,6 +2772,8 @@ int main(int argc, char** argv) {
 
 	ViewerState* state = (ViewerState*)fplMemoryAllocate(sizeof(ViewerState));
 	state->params.preview = true;
+	state->params.previewCacheSize = PREVIEW_CACHE_DEFAULT_SIZE;
+	state->params.cacheBudget = PICTURE_CACHE_DEFAULT_BUDGET;
 	if (argc >= 2) {
 		ParseParameters(&state->params, argc - 1, argv + 1);
 	}
@@ -1851,6 +2784,8 @@ int main(int argc, char** argv) {
 	flogWrite("Thread count: %lu", state->params.threadCount);
 	flogWrite("Preview enabled: %s", (state->params.preview ? "yes" : "no"));
 	flogWrite("Recursive enabled: %s", (state->params.recursive ? "yes" : "no"));
+	flogWrite("Preview cache size: %lu", state->params.previewCacheSize);
+	flogWrite("Picture cache budget: %lu MB", state->params.cacheBudget);
 
 	int returnCode = 0;
 	fplSettings settings;
@@ -1958,10 +2893,10 @@ int main(int argc, char** argv) {
 										}
 									} else if (ev.keyboard.mappedKey == fplKey_Home) {
 										int delta = 0 - (int)state->activeFileIndex;
-										ChangeViewPicture(state, delta, true);
+										ChangeViewPicture(state, delta, false);
 									} else if (ev.keyboard.mappedKey == fplKey_End) {
 										int delta = (int)state->pictureFileCount - state->activeFileIndex;
-										ChangeViewPicture(state, delta, true);
+										ChangeViewPicture(state, delta, false);
 									} else if (ev.keyboard.mappedKey == fplKey_F) {
 										fplSetWindowFullscreenSize(!fplIsWindowFullscreen(), 0, 0, 0);
 									} else if (ev.keyboard.mappedKey == fplKey_P) {
@@ -1971,11 +2906,33 @@ int main(int argc, char** argv) {
 									} else if (ev.keyboard.mappedKey == fplKey_T) {
 										state->activeFilter = (state->activeFilter + 1) % state->filterCount;
 										UpdateWindowTitle(state);
+									} else if (ev.keyboard.mappedKey == fplKey_Add || ev.keyboard.mappedKey == fplKey_OemPlus) {
+										ZoomPicture(state, 1.5f, V2f(0.0f, 0.0f));
+									} else if (ev.keyboard.mappedKey == fplKey_Substract || ev.keyboard.mappedKey == fplKey_OemMinus) {
+										ZoomPicture(state, 1.0f / 1.5f, V2f(0.0f, 0.0f));
+									} else if (ev.keyboard.mappedKey == fplKey_0 || ev.keyboard.mappedKey == fplKey_NumPad0) {
+										ResetPictureZoom(state);
 									}
 								}
 							}
 						} break;
 
+						case fplEventType_Mouse:
+						{
+							// Zoom with the mouse wheel at the cursor and pan while the left mouse button is down
+							if (ev.mouse.type == fplMouseEventType_Wheel) {
+								ZoomPicture(state, powf(1.25f, ev.mouse.wheelDelta), GetMouseFocus(ev.mouse.mouseX, ev.mouse.mouseY));
+							} else if (ev.mouse.type == fplMouseEventType_Button && ev.mouse.mouseButton == fplMouseButtonType_Left) {
+								state->isDragging = ev.mouse.buttonState >= fplButtonState_Press;
+								state->lastMousePos = V2f((float)ev.mouse.mouseX, (float)ev.mouse.mouseY);
+							} else if (ev.mouse.type == fplMouseEventType_Move && state->isDragging) {
+								Vec2f mousePos = V2f((float)ev.mouse.mouseX, (float)ev.mouse.mouseY);
+								state->pan.x += mousePos.x - state->lastMousePos.x;
+								state->pan.y -= mousePos.y - state->lastMousePos.y;
+								state->lastMousePos = mousePos;
+							}
+						} break;
+
 						default:
 							break;
 					}
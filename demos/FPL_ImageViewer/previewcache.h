@@ -0,0 +1,430 @@
+/*
+-------------------------------------------------------------------------------
+Name:
+	FPL-Demo | ImageViewer | Preview Cache
+
+Description:
+	Persistent on-disk cache for downsampled picture previews.
+
+	Entries are keyed by the full file path, the file size and the last modify time,
+	so a changed or replaced picture never hits a stale preview.
+
+	All previews are stored in a single pack file, which is appended only:
+
+	[Header] [Entry Header|Path|Pixels] [Entry Header|Path|Pixels] ...
+
+	Entry headers and pixels are aligned to 16 bytes, so the pack file can be memory mapped and the pixels uploaded directly.
+	The part of the pack file which exists at open time is memory mapped, entries added in the same session are read from the file.
+	A truncated or damaged tail (e.g. after a crash) is detected by the entry magic and will be overwritten by the next stored entry.
+
+	All functions are thread-safe.
+
+License:
+	Copyright (c) 2017-2025 Torsten Spaete
+	MIT License (See LICENSE file)
+-------------------------------------------------------------------------------
+*/
+
+#ifndef PREVIEWCACHE_H
+#define PREVIEWCACHE_H
+
+#include <final_platform_layer.h>
+
+#include <stdio.h> // FILE, fopen
+#include <stdlib.h> // malloc
+
+#if defined(FPL_PLATFORM_WINDOWS)
+#	define PreviewCacheSeek(file, offset) _fseeki64(file, (__int64)(offset), SEEK_SET)
+#else
+#	include <sys/mman.h> // mmap, munmap
+#	include <sys/stat.h> // fstat
+#	include <fcntl.h> // open
+#	include <unistd.h> // close
+#	define PreviewCacheSeek(file, offset) fseeko(file, (off_t)(offset), SEEK_SET)
+#endif
+
+#define PREVIEW_CACHE_FILE_MAGIC 0x43505646 // FVPC
+#define PREVIEW_CACHE_ENTRY_MAGIC 0x45505646 // FVPE
+#define PREVIEW_CACHE_VERSION 1
+#define PREVIEW_CACHE_ALIGNMENT 16
+
+typedef struct PreviewCacheFileHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint32_t previewSize;
+	uint32_t reserved;
+} PreviewCacheFileHeader;
+fplStaticAssert(sizeof(PreviewCacheFileHeader) % PREVIEW_CACHE_ALIGNMENT == 0);
+
+typedef struct PreviewCacheEntryHeader {
+	uint64_t hash;
+	uint64_t fileSize;
+	uint64_t modifyTime;
+	uint32_t magic;
+	uint32_t width;
+	uint32_t height;
+	uint32_t components;
+	uint32_t pathLength;
+	uint32_t dataSize;
+} PreviewCacheEntryHeader;
+fplStaticAssert(sizeof(PreviewCacheEntryHeader) % PREVIEW_CACHE_ALIGNMENT == 0);
+
+typedef struct PreviewCacheKey {
+	const char *filePath;
+	uint64_t fileSize;
+	uint64_t modifyTime;
+	uint64_t hash;
+	uint32_t pathLength;
+} PreviewCacheKey;
+
+typedef struct PreviewCacheSlot {
+	// Zero means empty
+	uint64_t hash;
+	uint64_t offset;
+} PreviewCacheSlot;
+
+typedef struct PreviewCache {
+	fplMutexHandle lock;
+	FILE *file;
+	const uint8_t *mappedBase;
+	size_t mappedSize;
+#if defined(FPL_PLATFORM_WINDOWS)
+	HANDLE mappedFileHandle;
+	HANDLE mappingHandle;
+#endif
+	PreviewCacheSlot *slots;
+	size_t slotCapacity;
+	size_t entryCount;
+	uint64_t writeOffset;
+	uint64_t maxFileSize;
+	uint32_t previewSize;
+	volatile uint32_t hitCount;
+	volatile uint32_t missCount;
+	bool isOpen;
+} PreviewCache;
+
+inline uint64_t PreviewCacheAlign(const uint64_t value) {
+	uint64_t result = (value + (PREVIEW_CACHE_ALIGNMENT - 1)) & ~(uint64_t)(PREVIEW_CACHE_ALIGNMENT - 1);
+	return(result);
+}
+
+inline uint64_t PreviewCacheGetEntrySize(const uint32_t pathLength, const uint32_t dataSize) {
+	uint64_t result = sizeof(PreviewCacheEntryHeader) + PreviewCacheAlign(pathLength) + PreviewCacheAlign(dataSize);
+	return(result);
+}
+
+// FNV-1a over the path, the file size and the modify time
+static uint64_t PreviewCacheComputeHash(const char *filePath, const uint32_t pathLength, const uint64_t fileSize, const uint64_t modifyTime) {
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	for (uint32_t i = 0; i < pathLength; ++i) {
+		hash = (hash ^ (uint8_t)filePath[i]) * 0x100000001b3ULL;
+	}
+	uint64_t values[2] = { fileSize, modifyTime };
+	const uint8_t *bytes = (const uint8_t *)values;
+	for (size_t i = 0; i < sizeof(values); ++i) {
+		hash = (hash ^ bytes[i]) * 0x100000001b3ULL;
+	}
+	return(hash != 0 ? hash : 1);
+}
+
+static bool PreviewCacheMakeKey(const char *filePath, PreviewCacheKey *outKey) {
+	fplFileTimeStamps timeStamps;
+	if (!fplFileGetTimestampsFromPath(filePath, &timeStamps)) {
+		return(false);
+	}
+	fplClearStruct(outKey);
+	outKey->filePath = filePath;
+	outKey->pathLength = (uint32_t)fplGetStringLength(filePath);
+	outKey->fileSize = fplFileGetSizeFromPath64(filePath);
+	outKey->modifyTime = timeStamps.lastModifyTime;
+	outKey->hash = PreviewCacheComputeHash(filePath, outKey->pathLength, outKey->fileSize, outKey->modifyTime);
+	return(true);
+}
+
+static void PreviewCache__InsertSlot(PreviewCacheSlot *slots, const size_t capacity, const uint64_t hash, const uint64_t offset) {
+	size_t mask = capacity - 1;
+	size_t index = (size_t)hash & mask;
+	while (slots[index].hash != 0) {
+		index = (index + 1) & mask;
+	}
+	slots[index].hash = hash;
+	slots[index].offset = offset;
+}
+
+static void PreviewCache__AddToIndex(PreviewCache *cache, const uint64_t hash, const uint64_t offset) {
+	// Keep the load factor below 50%, so the linear probing stays short
+	if ((cache->entryCount + 1) * 2 > cache->slotCapacity) {
+		size_t newCapacity = fplMax(cache->slotCapacity * 2, (size_t)1024);
+		PreviewCacheSlot *newSlots = (PreviewCacheSlot *)fplMemoryAllocate(sizeof(PreviewCacheSlot) * newCapacity);
+		for (size_t i = 0; i < cache->slotCapacity; ++i) {
+			if (cache->slots[i].hash != 0) {
+				PreviewCache__InsertSlot(newSlots, newCapacity, cache->slots[i].hash, cache->slots[i].offset);
+			}
+		}
+		if (cache->slots != fpl_null) {
+			fplMemoryFree(cache->slots);
+		}
+		cache->slots = newSlots;
+		cache->slotCapacity = newCapacity;
+	}
+	PreviewCache__InsertSlot(cache->slots, cache->slotCapacity, hash, offset);
+	++cache->entryCount;
+}
+
+static bool PreviewCache__ReadAt(PreviewCache *cache, const uint64_t offset, void *target, const size_t size) {
+	if (offset + size <= cache->mappedSize) {
+		fplMemoryCopy(cache->mappedBase + offset, size, target);
+		return(true);
+	}
+	if (PreviewCacheSeek(cache->file, offset) != 0) {
+		return(false);
+	}
+	bool result = fread(target, 1, size, cache->file) == size;
+	return(result);
+}
+
+static bool PreviewCache__IsValidEntry(const PreviewCache *cache, const PreviewCacheEntryHeader *entry, const uint64_t offset, const uint64_t fileSize) {
+	if (entry->magic != PREVIEW_CACHE_ENTRY_MAGIC || entry->hash == 0) {
+		return(false);
+	}
+	if (entry->width == 0 || entry->height == 0 || entry->components == 0 || entry->components > 4) {
+		return(false);
+	}
+	if ((uint64_t)entry->width * entry->height * entry->components != entry->dataSize) {
+		return(false);
+	}
+	if (entry->pathLength == 0 || entry->pathLength >= FPL_MAX_PATH_LENGTH) {
+		return(false);
+	}
+	bool result = (offset + PreviewCacheGetEntrySize(entry->pathLength, entry->dataSize)) <= fileSize;
+	return(result);
+}
+
+static void PreviewCache__Map(PreviewCache *cache, const char *filePath, const uint64_t size) {
+	cache->mappedBase = fpl_null;
+	cache->mappedSize = 0;
+	if (size == 0 || size > (uint64_t)SIZE_MAX) {
+		return;
+	}
+#if defined(FPL_PLATFORM_WINDOWS)
+	cache->mappedFileHandle = CreateFileA(filePath, GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, fpl_null, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, fpl_null);
+	if (cache->mappedFileHandle == INVALID_HANDLE_VALUE) {
+		cache->mappedFileHandle = fpl_null;
+		return;
+	}
+	cache->mappingHandle = CreateFileMappingA(cache->mappedFileHandle, fpl_null, PAGE_READONLY, (DWORD)(size >> 32), (DWORD)(size & 0xFFFFFFFF), fpl_null);
+	if (cache->mappingHandle != fpl_null) {
+		void *base = MapViewOfFile(cache->mappingHandle, FILE_MAP_READ, 0, 0, (SIZE_T)size);
+		if (base != fpl_null) {
+			cache->mappedBase = (const uint8_t *)base;
+			cache->mappedSize = (size_t)size;
+		}
+	}
+#else
+	int fd = open(filePath, O_RDONLY);
+	if (fd == -1) {
+		return;
+	}
+	void *base = mmap(fpl_null, (size_t)size, PROT_READ, MAP_SHARED, fd, 0);
+	close(fd);
+	if (base != MAP_FAILED) {
+		cache->mappedBase = (const uint8_t *)base;
+		cache->mappedSize = (size_t)size;
+	}
+#endif
+}
+
+static void PreviewCache__Unmap(PreviewCache *cache) {
+#if defined(FPL_PLATFORM_WINDOWS)
+	if (cache->mappedBase != fpl_null) {
+		UnmapViewOfFile(cache->mappedBase);
+	}
+	if (cache->mappingHandle != fpl_null) {
+		CloseHandle(cache->mappingHandle);
+		cache->mappingHandle = fpl_null;
+	}
+	if (cache->mappedFileHandle != fpl_null) {
+		CloseHandle(cache->mappedFileHandle);
+		cache->mappedFileHandle = fpl_null;
+	}
+#else
+	if (cache->mappedBase != fpl_null) {
+		munmap((void *)cache->mappedBase, cache->mappedSize);
+	}
+#endif
+	cache->mappedBase = fpl_null;
+	cache->mappedSize = 0;
+}
+
+static void PreviewCacheClose(PreviewCache *cache) {
+	if (!cache->isOpen) {
+		return;
+	}
+	PreviewCache__Unmap(cache);
+	if (cache->file != fpl_null) {
+		fclose(cache->file);
+	}
+	if (cache->slots != fpl_null) {
+		fplMemoryFree(cache->slots);
+	}
+	fplMutexDestroy(&cache->lock);
+	fplClearStruct(cache);
+}
+
+// Opens or creates the pack file and builds the in-memory index from all valid entries.
+// A pack file with a different version or preview size is discarded.
+static bool PreviewCacheOpen(PreviewCache *cache, const char *filePath, const uint32_t previewSize, const uint64_t maxFileSize) {
+	fplClearStruct(cache);
+
+	PreviewCacheFileHeader expectedHeader = fplZeroInit;
+	expectedHeader.magic = PREVIEW_CACHE_FILE_MAGIC;
+	expectedHeader.version = PREVIEW_CACHE_VERSION;
+	expectedHeader.previewSize = previewSize;
+
+	FILE *file = fopen(filePath, "r+b");
+	if (file != fpl_null) {
+		PreviewCacheFileHeader header = fplZeroInit;
+		if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != expectedHeader.magic || header.version != expectedHeader.version || header.previewSize != expectedHeader.previewSize) {
+			fclose(file);
+			file = fpl_null;
+		}
+	}
+	if (file == fpl_null) {
+		file = fopen(filePath, "w+b");
+		if (file == fpl_null) {
+			return(false);
+		}
+		if (fwrite(&expectedHeader, sizeof(expectedHeader), 1, file) != 1) {
+			fclose(file);
+			return(false);
+		}
+		fflush(file);
+	}
+
+	if (!fplMutexInit(&cache->lock)) {
+		fclose(file);
+		return(false);
+	}
+
+	cache->file = file;
+	cache->previewSize = previewSize;
+	cache->maxFileSize = maxFileSize;
+	cache->isOpen = true;
+
+	// Scan all entry headers until the end or the first damaged entry
+	uint64_t fileSize = fplFileGetSizeFromPath64(filePath);
+	uint64_t offset = sizeof(PreviewCacheFileHeader);
+	while (offset + sizeof(PreviewCacheEntryHeader) <= fileSize) {
+		PreviewCacheEntryHeader entry;
+		if (!PreviewCache__ReadAt(cache, offset, &entry, sizeof(entry))) {
+			break;
+		}
+		if (!PreviewCache__IsValidEntry(cache, &entry, offset, fileSize)) {
+			break;
+		}
+		PreviewCache__AddToIndex(cache, entry.hash, offset);
+		offset += PreviewCacheGetEntrySize(entry.pathLength, entry.dataSize);
+	}
+	cache->writeOffset = offset;
+
+	PreviewCache__Map(cache, filePath, cache->writeOffset);
+
+	return(true);
+}
+
+// Returns true when a preview for the key was found, the pixels are allocated with malloc and must be released by the caller
+static bool PreviewCacheLoad(PreviewCache *cache, const PreviewCacheKey *key, uint8_t **outPixels, uint32_t *outWidth, uint32_t *outHeight, uint32_t *outComponents) {
+	if (!cache->isOpen) {
+		return(false);
+	}
+	bool result = false;
+	fplMutexLock(&cache->lock);
+	if (cache->slotCapacity > 0) {
+		size_t mask = cache->slotCapacity - 1;
+		for (size_t index = (size_t)key->hash & mask; cache->slots[index].hash != 0; index = (index + 1) & mask) {
+			if (cache->slots[index].hash != key->hash) {
+				continue;
+			}
+			uint64_t offset = cache->slots[index].offset;
+			PreviewCacheEntryHeader entry;
+			if (!PreviewCache__ReadAt(cache, offset, &entry, sizeof(entry))) {
+				break;
+			}
+			if (entry.fileSize != key->fileSize || entry.modifyTime != key->modifyTime || entry.pathLength != key->pathLength) {
+				continue;
+			}
+			char path[FPL_MAX_PATH_LENGTH];
+			if (!PreviewCache__ReadAt(cache, offset + sizeof(entry), path, entry.pathLength)) {
+				break;
+			}
+			if (!fplIsStringEqualLen(path, entry.pathLength, key->filePath, key->pathLength)) {
+				continue;
+			}
+			uint8_t *pixels = (uint8_t *)malloc(entry.dataSize);
+			if (pixels == fpl_null) {
+				break;
+			}
+			uint64_t dataOffset = offset + sizeof(entry) + PreviewCacheAlign(entry.pathLength);
+			if (!PreviewCache__ReadAt(cache, dataOffset, pixels, entry.dataSize)) {
+				free(pixels);
+				break;
+			}
+			*outPixels = pixels;
+			*outWidth = entry.width;
+			*outHeight = entry.height;
+			*outComponents = entry.components;
+			result = true;
+			break;
+		}
+	}
+	fplMutexUnlock(&cache->lock);
+	if (result) {
+		fplAtomicIncrementU32(&cache->hitCount);
+	} else {
+		fplAtomicIncrementU32(&cache->missCount);
+	}
+	return(result);
+}
+
+// Appends the preview to the pack file, returns false when the pack file has reached its maximum size or writing failed
+static bool PreviewCacheStore(PreviewCache *cache, const PreviewCacheKey *key, const uint8_t *pixels, const uint32_t width, const uint32_t height, const uint32_t components) {
+	if (!cache->isOpen || key->pathLength == 0 || key->pathLength >= FPL_MAX_PATH_LENGTH) {
+		return(false);
+	}
+
+	PreviewCacheEntryHeader entry = fplZeroInit;
+	entry.hash = key->hash;
+	entry.fileSize = key->fileSize;
+	entry.modifyTime = key->modifyTime;
+	entry.magic = PREVIEW_CACHE_ENTRY_MAGIC;
+	entry.width = width;
+	entry.height = height;
+	entry.components = components;
+	entry.pathLength = key->pathLength;
+	entry.dataSize = width * height * components;
+
+	uint8_t padding[PREVIEW_CACHE_ALIGNMENT] = fplZeroInit;
+	size_t pathPadding = (size_t)(PreviewCacheAlign(entry.pathLength) - entry.pathLength);
+	size_t dataPadding = (size_t)(PreviewCacheAlign(entry.dataSize) - entry.dataSize);
+
+	bool result = false;
+	fplMutexLock(&cache->lock);
+	uint64_t entrySize = PreviewCacheGetEntrySize(entry.pathLength, entry.dataSize);
+	if (cache->writeOffset + entrySize <= cache->maxFileSize && PreviewCacheSeek(cache->file, cache->writeOffset) == 0) {
+		result =
+			(fwrite(&entry, sizeof(entry), 1, cache->file) == 1) &&
+			(fwrite(key->filePath, 1, entry.pathLength, cache->file) == entry.pathLength) &&
+			(fwrite(padding, 1, pathPadding, cache->file) == pathPadding) &&
+			(fwrite(pixels, 1, entry.dataSize, cache->file) == entry.dataSize) &&
+			(fwrite(padding, 1, dataPadding, cache->file) == dataPadding);
+		fflush(cache->file);
+		if (result) {
+			PreviewCache__AddToIndex(cache, entry.hash, cache->writeOffset);
+			cache->writeOffset += entrySize;
+		}
+	}
+	fplMutexUnlock(&cache->lock);
+	return(result);
+}
+
+#endif // PREVIEWCACHE_H
@@ -385,35 +385,41 @@ void DemoApplication::UpdateAndRender(const float frameTime, const uint64_t cycl
 	}
 }
 
-void DemoApplication::LoadDemo(const size_t demoIndex) {
-	if (demo != nullptr) {
-		delete demo;
-		demo = nullptr;
-	}
+BaseSimulation *CreateDemoSimulation(const size_t demoIndex, std::string &outTitle) {
+	BaseSimulation *result = nullptr;
 	switch (demoIndex) {
 		case 0:
 		{
-			demo = new Demo1::ParticleSimulation();
-			demoTitle = Demo1::kDemoName;
+			result = new Demo1::ParticleSimulation();
+			outTitle = Demo1::kDemoName;
 		} break;
 		case 1:
 		{
-			demo = new Demo2::ParticleSimulation();
-			demoTitle = Demo2::kDemoName;
+			result = new Demo2::ParticleSimulation();
+			outTitle = Demo2::kDemoName;
 		} break;
 		case 2:
 		{
-			demo = new Demo3::ParticleSimulation();
-			demoTitle = Demo3::kDemoName;
+			result = new Demo3::ParticleSimulation();
+			outTitle = Demo3::kDemoName;
 		} break;
 		case 3:
 		{
-			demo = new Demo4::ParticleSimulation();
-			demoTitle = Demo4::kDemoName;
+			result = new Demo4::ParticleSimulation();
+			outTitle = Demo4::kDemoName;
 		} break;
 		default:
 			assert(false);
 	}
+	return(result);
+}
+
+void DemoApplication::LoadDemo(const size_t demoIndex) {
+	if (demo != nullptr) {
+		delete demo;
+		demo = nullptr;
+	}
+	demo = CreateDemoSimulation(demoIndex, demoTitle);
 	demo->SetMultiThreading(multiThreadingActive);
 	LoadScenario(activeScenarioIndex);
 }
@@ -483,9 +489,8 @@ void DemoApplication::KeyUp(const fplKey key) {
 	}
 }
 
-void DemoApplication::LoadScenario(size_t scenarioIndex) {
+void LoadSPHScenario(BaseSimulation *demo, const size_t scenarioIndex) {
 	SPHScenario *scenario = &SPHScenarios[scenarioIndex];
-	activeScenarioName = scenario->name;
 	demo->ResetStats();
 	demo->ClearBodies();
 	demo->ClearParticles();
@@ -542,4 +547,9 @@ void DemoApplication::LoadScenario(size_t scenarioIndex) {
 	}
 }
 
+void DemoApplication::LoadScenario(size_t scenarioIndex) {
+	activeScenarioName = SPHScenarios[scenarioIndex].name;
+	LoadSPHScenario(demo, scenarioIndex);
+}
+
 #endif
\ No newline at end of file
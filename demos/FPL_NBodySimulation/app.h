@@ -71,6 +71,9 @@ struct Application {
 	virtual void UpdateAndRender(const float frametime, const uint64_t cycles) = 0;
 };
 
+BaseSimulation *CreateDemoSimulation(const size_t demoIndex, std::string &outTitle);
+void LoadSPHScenario(BaseSimulation *demo, const size_t scenarioIndex);
+
 struct FrameStatistics {
 	SPHStatistics stats;
 	float simulationTime;
@@ -0,0 +1,362 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+
+#include "app.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+
+//
+// Headless benchmark
+//
+// Runs every demo and scenario without a window or GL context for a fixed number of frames
+// and writes min/avg/max/percentiles of the simulation time per phase as JSON or CSV.
+//
+enum class BenchmarkOutputFormat {
+	Json = 0,
+	Csv,
+};
+
+const size_t kBenchmarkAllIndices = (size_t)-1;
+
+struct HeadlessBenchmarkSettings {
+	const char *outputFilePath;
+	size_t frameCount;
+	size_t iterationCount;
+	size_t demoIndex;
+	size_t scenarioIndex;
+	BenchmarkOutputFormat format;
+	bool multiThreading;
+
+	HeadlessBenchmarkSettings() :
+		outputFilePath(nullptr),
+		frameCount(kBenchmarkFrameCount),
+		iterationCount(kBenchmarkIterationCount),
+		demoIndex(kBenchmarkAllIndices),
+		scenarioIndex(kBenchmarkAllIndices),
+		format(BenchmarkOutputFormat::Json),
+		multiThreading(true) {
+	}
+};
+
+enum BenchmarkPhase {
+	BenchmarkPhase_Total = 0,
+	BenchmarkPhase_Emitters,
+	BenchmarkPhase_Integration,
+	BenchmarkPhase_ViscosityForces,
+	BenchmarkPhase_Predict,
+	BenchmarkPhase_UpdateGrid,
+	BenchmarkPhase_NeighborSearch,
+	BenchmarkPhase_DensityAndPressure,
+	BenchmarkPhase_DeltaPositions,
+	BenchmarkPhase_Collisions,
+
+	BenchmarkPhase_Count,
+};
+
+static const char *BenchmarkPhaseNames[BenchmarkPhase_Count] = {
+	"total",
+	"emitters",
+	"integration",
+	"viscosityForces",
+	"predict",
+	"updateGrid",
+	"neighborSearch",
+	"densityAndPressure",
+	"deltaPositions",
+	"collisions",
+};
+
+struct BenchmarkPhaseSummary {
+	float min;
+	float avg;
+	float max;
+	float p50;
+	float p90;
+	float p99;
+};
+
+struct HeadlessBenchmarkResult {
+	std::string demoName;
+	std::string scenarioName;
+	size_t demoIndex;
+	size_t scenarioIndex;
+	size_t threadCount;
+	size_t frameCount;
+	size_t iterationCount;
+	size_t particleCount;
+	BenchmarkPhaseSummary phases[BenchmarkPhase_Count];
+};
+
+inline float GetBenchmarkPhaseTime(const FrameStatistics &frame, const BenchmarkPhase phase) {
+	switch (phase) {
+		case BenchmarkPhase_Total:
+			return frame.simulationTime;
+		case BenchmarkPhase_Emitters:
+			return frame.stats.time.emitters;
+		case BenchmarkPhase_Integration:
+			return frame.stats.time.integration;
+		case BenchmarkPhase_ViscosityForces:
+			return frame.stats.time.viscosityForces;
+		case BenchmarkPhase_Predict:
+			return frame.stats.time.predict;
+		case BenchmarkPhase_UpdateGrid:
+			return frame.stats.time.updateGrid;
+		case BenchmarkPhase_NeighborSearch:
+			return frame.stats.time.neighborSearch;
+		case BenchmarkPhase_DensityAndPressure:
+			return frame.stats.time.densityAndPressure;
+		case BenchmarkPhase_DeltaPositions:
+			return frame.stats.time.deltaPositions;
+		case BenchmarkPhase_Collisions:
+			return frame.stats.time.collisions;
+		default:
+			return 0.0f;
+	}
+}
+
+// Nearest-rank percentile on a sorted sample array
+inline float GetSortedPercentile(const std::vector<float> &sorted, const float percentile) {
+	assert(sorted.size() > 0);
+	size_t rank = (size_t)ceilf(percentile * 0.01f * (float)sorted.size());
+	size_t index = rank > 0 ? rank - 1 : 0;
+	index = std::min(index, sorted.size() - 1);
+	return sorted[index];
+}
+
+static BenchmarkPhaseSummary ComputeBenchmarkPhaseSummary(std::vector<float> &samples) {
+	BenchmarkPhaseSummary result = {};
+	if (samples.size() == 0) {
+		return(result);
+	}
+	std::sort(samples.begin(), samples.end());
+	float sum = 0.0f;
+	for (size_t i = 0; i < samples.size(); ++i) {
+		Accumulate(sum, samples[i]);
+	}
+	result.min = samples.front();
+	result.max = samples.back();
+	result.avg = sum / (float)samples.size();
+	result.p50 = GetSortedPercentile(samples, 50.0f);
+	result.p90 = GetSortedPercentile(samples, 90.0f);
+	result.p99 = GetSortedPercentile(samples, 99.0f);
+	return(result);
+}
+
+static void AccumulateFrameStatistics(SPHStatistics &target, const SPHStatistics &source) {
+	Accumulate(target.time.emitters, source.time.emitters);
+	Accumulate(target.time.integration, source.time.integration);
+	Accumulate(target.time.viscosityForces, source.time.viscosityForces);
+	Accumulate(target.time.predict, source.time.predict);
+	Accumulate(target.time.updateGrid, source.time.updateGrid);
+	Accumulate(target.time.neighborSearch, source.time.neighborSearch);
+	Accumulate(target.time.densityAndPressure, source.time.densityAndPressure);
+	Accumulate(target.time.deltaPositions, source.time.deltaPositions);
+	Accumulate(target.time.collisions, source.time.collisions);
+	UpdateMin(target.minParticleNeighborCount, source.minParticleNeighborCount);
+	UpdateMax(target.maxParticleNeighborCount, source.maxParticleNeighborCount);
+	UpdateMin(target.minCellParticleCount, source.minCellParticleCount);
+	UpdateMax(target.maxCellParticleCount, source.maxCellParticleCount);
+}
+
+static HeadlessBenchmarkResult RunHeadlessScenario(BaseSimulation *demo, const HeadlessBenchmarkSettings &settings, const size_t demoIndex, const std::string &demoName, const size_t scenarioIndex) {
+	HeadlessBenchmarkResult result = HeadlessBenchmarkResult();
+	result.demoName = demoName;
+	result.demoIndex = demoIndex;
+	result.scenarioIndex = scenarioIndex;
+	result.scenarioName = SPHScenarios[scenarioIndex].name;
+	result.frameCount = settings.frameCount;
+	result.iterationCount = settings.iterationCount;
+	result.threadCount = demo->IsMultiThreading() ? demo->GetWorkerThreadCount() : 1;
+
+	std::vector<FrameStatistics> frames;
+	frames.reserve(settings.frameCount * settings.iterationCount);
+	for (size_t iterationIndex = 0; iterationIndex < settings.iterationCount; ++iterationIndex) {
+		LoadSPHScenario(demo, scenarioIndex);
+		for (size_t frameIndex = 0; frameIndex < settings.frameCount; ++frameIndex) {
+			// Per-phase timings are stored per update, so we sum them up across all substeps
+			FrameStatistics frame = FrameStatistics();
+			auto startClock = std::chrono::high_resolution_clock::now();
+			for (int step = 0; step < kSPHSubsteps; ++step) {
+				demo->Update(kSPHSubstepDeltaTime);
+				AccumulateFrameStatistics(frame.stats, demo->GetStats());
+			}
+			auto deltaClock = std::chrono::high_resolution_clock::now() - startClock;
+			frame.simulationTime = std::chrono::duration_cast<std::chrono::nanoseconds>(deltaClock).count() * nanosToMilliseconds;
+			frames.push_back(frame);
+		}
+		result.particleCount = std::max(result.particleCount, demo->GetParticleCount());
+	}
+
+	std::vector<float> samples;
+	samples.reserve(frames.size());
+	for (size_t phaseIndex = 0; phaseIndex < BenchmarkPhase_Count; ++phaseIndex) {
+		samples.clear();
+		for (size_t frameIndex = 0; frameIndex < frames.size(); ++frameIndex) {
+			samples.push_back(GetBenchmarkPhaseTime(frames[frameIndex], (BenchmarkPhase)phaseIndex));
+		}
+		result.phases[phaseIndex] = ComputeBenchmarkPhaseSummary(samples);
+	}
+
+	return(result);
+}
+
+static std::string EscapeJsonString(const std::string &value) {
+	std::string result;
+	result.reserve(value.size());
+	for (size_t i = 0; i < value.size(); ++i) {
+		char c = value[i];
+		if (c == '"' || c == '\\') {
+			result += '\\';
+			result += c;
+		} else if ((unsigned char)c < 0x20) {
+			result += ' ';
+		} else {
+			result += c;
+		}
+	}
+	return(result);
+}
+
+static void WriteBenchmarkResultsJson(FILE *file, const std::string &cpuName, const std::vector<HeadlessBenchmarkResult> &results) {
+	fprintf(file, "{\n");
+	fprintf(file, "\t\"version\": \"%s\",\n", kAppVersion);
+	fprintf(file, "\t\"cpu\": \"%s\",\n", EscapeJsonString(cpuName).c_str());
+	fprintf(file, "\t\"unit\": \"ms\",\n");
+	fprintf(file, "\t\"results\": [\n");
+	for (size_t resultIndex = 0; resultIndex < results.size(); ++resultIndex) {
+		const HeadlessBenchmarkResult &result = results[resultIndex];
+		fprintf(file, "\t\t{\n");
+		fprintf(file, "\t\t\t\"demo\": %zu,\n", result.demoIndex + 1);
+		fprintf(file, "\t\t\t\"demoName\": \"%s\",\n", EscapeJsonString(result.demoName).c_str());
+		fprintf(file, "\t\t\t\"scenario\": %zu,\n", result.scenarioIndex + 1);
+		fprintf(file, "\t\t\t\"scenarioName\": \"%s\",\n", EscapeJsonString(result.scenarioName).c_str());
+		fprintf(file, "\t\t\t\"threads\": %zu,\n", result.threadCount);
+		fprintf(file, "\t\t\t\"frames\": %zu,\n", result.frameCount);
+		fprintf(file, "\t\t\t\"iterations\": %zu,\n", result.iterationCount);
+		fprintf(file, "\t\t\t\"particles\": %zu,\n", result.particleCount);
+		fprintf(file, "\t\t\t\"phases\": {\n");
+		for (size_t phaseIndex = 0; phaseIndex < BenchmarkPhase_Count; ++phaseIndex) {
+			const BenchmarkPhaseSummary &phase = result.phases[phaseIndex];
+			fprintf(file, "\t\t\t\t\"%s\": { \"min\": %f, \"avg\": %f, \"max\": %f, \"p50\": %f, \"p90\": %f, \"p99\": %f }%s\n",
+				BenchmarkPhaseNames[phaseIndex], phase.min, phase.avg, phase.max, phase.p50, phase.p90, phase.p99,
+				(phaseIndex < BenchmarkPhase_Count - 1) ? "," : "");
+		}
+		fprintf(file, "\t\t\t}\n");
+		fprintf(file, "\t\t}%s\n", (resultIndex < results.size() - 1) ? "," : "");
+	}
+	fprintf(file, "\t]\n");
+	fprintf(file, "}\n");
+}
+
+static void WriteBenchmarkResultsCsv(FILE *file, const std::vector<HeadlessBenchmarkResult> &results) {
+	fprintf(file, "demo,demoName,scenario,scenarioName,threads,frames,iterations,particles,phase,min,avg,max,p50,p90,p99\n");
+	for (size_t resultIndex = 0; resultIndex < results.size(); ++resultIndex) {
+		const HeadlessBenchmarkResult &result = results[resultIndex];
+		for (size_t phaseIndex = 0; phaseIndex < BenchmarkPhase_Count; ++phaseIndex) {
+			const BenchmarkPhaseSummary &phase = result.phases[phaseIndex];
+			fprintf(file, "%zu,\"%s\",%zu,\"%s\",%zu,%zu,%zu,%zu,%s,%f,%f,%f,%f,%f,%f\n",
+				result.demoIndex + 1, result.demoName.c_str(),
+				result.scenarioIndex + 1, result.scenarioName.c_str(),
+				result.threadCount, result.frameCount, result.iterationCount, result.particleCount,
+				BenchmarkPhaseNames[phaseIndex],
+				phase.min, phase.avg, phase.max, phase.p50, phase.p90, phase.p99);
+		}
+	}
+}
+
+static bool ParseBenchmarkCount(const char *value, size_t *outValue) {
+	char *end = nullptr;
+	unsigned long long parsed = strtoull(value, &end, 10);
+	if (end == value || *end != 0) {
+		return false;
+	}
+	*outValue = (size_t)parsed;
+	return true;
+}
+
+// Returns true when "--benchmark" was passed, in that case settings are filled from the remaining arguments:
+// --frames=N, --iterations=N, --demo=N (1-4), --scenario=N, --format=json|csv, --output=path, --single-threaded
+static bool ParseHeadlessBenchmarkArguments(const int argc, char **args, HeadlessBenchmarkSettings *outSettings, bool *outValid) {
+	bool isBenchmark = false;
+	bool isValid = true;
+	for (int argIndex = 1; argIndex < argc; ++argIndex) {
+		const char *arg = args[argIndex];
+		size_t index = 0;
+		if (strcmp(arg, "--benchmark") == 0) {
+			isBenchmark = true;
+		} else if (strcmp(arg, "--single-threaded") == 0) {
+			outSettings->multiThreading = false;
+		} else if (strncmp(arg, "--frames=", 9) == 0) {
+			isValid &= ParseBenchmarkCount(arg + 9, &outSettings->frameCount) && outSettings->frameCount > 0;
+		} else if (strncmp(arg, "--iterations=", 13) == 0) {
+			isValid &= ParseBenchmarkCount(arg + 13, &outSettings->iterationCount) && outSettings->iterationCount > 0;
+		} else if (strncmp(arg, "--demo=", 7) == 0) {
+			isValid &= ParseBenchmarkCount(arg + 7, &index) && index >= 1 && index <= kDemoCount;
+			outSettings->demoIndex = index - 1;
+		} else if (strncmp(arg, "--scenario=", 11) == 0) {
+			isValid &= ParseBenchmarkCount(arg + 11, &index) && index >= 1 && index <= fplArrayCount(SPHScenarios);
+			outSettings->scenarioIndex = index - 1;
+		} else if (strcmp(arg, "--format=json") == 0) {
+			outSettings->format = BenchmarkOutputFormat::Json;
+		} else if (strcmp(arg, "--format=csv") == 0) {
+			outSettings->format = BenchmarkOutputFormat::Csv;
+		} else if (strncmp(arg, "--output=", 9) == 0) {
+			outSettings->outputFilePath = arg + 9;
+		} else {
+			fprintf(stderr, "Unknown argument '%s'\n", arg);
+			isValid = false;
+		}
+	}
+	*outValid = isValid;
+	return(isBenchmark);
+}
+
+static int RunHeadlessBenchmark(const HeadlessBenchmarkSettings &settings) {
+	char cpuNameBuffer[1024] = {};
+	fplCPUGetName(cpuNameBuffer, fplArrayCount(cpuNameBuffer));
+	std::string cpuName = cpuNameBuffer;
+
+	size_t firstDemo = settings.demoIndex == kBenchmarkAllIndices ? 0 : settings.demoIndex;
+	size_t lastDemo = settings.demoIndex == kBenchmarkAllIndices ? kDemoCount - 1 : settings.demoIndex;
+	size_t firstScenario = settings.scenarioIndex == kBenchmarkAllIndices ? 0 : settings.scenarioIndex;
+	size_t lastScenario = settings.scenarioIndex == kBenchmarkAllIndices ? fplArrayCount(SPHScenarios) - 1 : settings.scenarioIndex;
+
+	std::vector<HeadlessBenchmarkResult> results;
+	results.reserve((lastDemo - firstDemo + 1) * (lastScenario - firstScenario + 1));
+	for (size_t demoIndex = firstDemo; demoIndex <= lastDemo; ++demoIndex) {
+		std::string demoName;
+		BaseSimulation *demo = CreateDemoSimulation(demoIndex, demoName);
+		demo->SetMultiThreading(settings.multiThreading);
+		for (size_t scenarioIndex = firstScenario; scenarioIndex <= lastScenario; ++scenarioIndex) {
+			fprintf(stderr, "Benchmarking %s, scenario [%zu / %zu] %s\n", demoName.c_str(), scenarioIndex + 1, fplArrayCount(SPHScenarios), SPHScenarios[scenarioIndex].name);
+			results.push_back(RunHeadlessScenario(demo, settings, demoIndex, demoName, scenarioIndex));
+		}
+		delete demo;
+	}
+
+	FILE *file = stdout;
+	if (settings.outputFilePath != nullptr) {
+		file = fopen(settings.outputFilePath, "w");
+		if (file == nullptr) {
+			fprintf(stderr, "Failed opening benchmark output file '%s'\n", settings.outputFilePath);
+			return -1;
+		}
+	}
+	if (settings.format == BenchmarkOutputFormat::Csv) {
+		WriteBenchmarkResultsCsv(file, results);
+	} else {
+		WriteBenchmarkResultsJson(file, cpuName, results);
+	}
+	if (file != stdout) {
+		fclose(file);
+	}
+	return 0;
+}
+
+#endif
@@ -20,6 +20,10 @@ Description:
 		To start a benchmark hit "B" key.
 		To stop a benchmark hit "Escape" key.
 
+		Headless benchmark (no window, no OpenGL):
+			FPL_NBodySimulation --benchmark [--frames=N] [--iterations=N] [--demo=N] [--scenario=N] [--format=json|csv] [--output=file] [--single-threaded]
+		Runs all demos and scenarios and writes min/avg/max/p50/p90/p99 of the simulation time per phase in milliseconds.
+
 	Notes:
 		Collision detection is discrete, therefore particles may pass through bodies when they are too thin and particles too fast.
 
@@ -37,6 +41,10 @@ Todo:
 	- Migrate to modern opengl 3.3+
 
 Changelog:
+	# 2026-10-18
+	- Added headless benchmark mode with JSON/CSV output (--benchmark)
+	- Headless benchmark mode logs errors to stderr only, so the results on stdout stay valid JSON/CSV
+
 	# 2025-03-28
 	- Fixed warnings for int vs size_t
 
@@ -106,6 +114,7 @@ License:
 
 #include "app.cpp"
 #include "utils.h"
+#include "benchmark.h"
 
 #define STB_TRUETYPE_IMPLEMENTATION
 #include <stb/stb_truetype.h>
@@ -500,6 +509,26 @@ static void OpenGLDrawCommandBuffer(Render::CommandBuffer *commandBuffer) {
 }
 
 int main(int argc, char **args) {
+	HeadlessBenchmarkSettings benchmarkSettings = HeadlessBenchmarkSettings();
+	bool benchmarkArgsValid = false;
+	if (ParseHeadlessBenchmarkArguments(argc, args, &benchmarkSettings, &benchmarkArgsValid)) {
+		if (!benchmarkArgsValid) {
+			return -1;
+		}
+		// The results may be written to stdout, so logs go to stderr only
+		fplLogSettings logSettings = fplZeroInit;
+		logSettings.maxLevel = fplLogLevel_Error;
+		logSettings.writers[0].flags = fplLogWriterFlags_ErrorConsole;
+		fplSetLogSettings(&logSettings);
+
+		int result = -1;
+		if (fplPlatformInit(fplInitFlags_Console, fpl_null)) {
+			result = RunHeadlessBenchmark(benchmarkSettings);
+			fplPlatformRelease();
+		}
+		return(result);
+	}
+
 	fplSettings settings = fplMakeDefaultSettings();
 	settings.window.windowSize.width = kWindowWidth;
 	settings.window.windowSize.height = kWindowHeight;
@@ -0,0 +1,700 @@
+/*
+-------------------------------------------------------------------------------
+Name:
+	FPL-Demo | Raytracer | BVH
+
+Description:
+	Bounding volume hierarchy for spheres and triangles, built with a binned surface area heuristic (SAH).
+	Supports single ray and SIMD ray-packet traversal (8-wide AVX, 4-wide SSE2 or a scalar fallback).
+
+	Ray directions are expected to be normalized.
+
+License:
+	Copyright (c) 2017-2025 Torsten Spaete
+	MIT License (See LICENSE file)
+-------------------------------------------------------------------------------
+*/
+
+#ifndef BVH_H
+#define BVH_H
+
+#include <final_math.h>
+#include <final_geometry.h>
+
+#include <vector>
+
+#if defined(__AVX__)
+#	include <immintrin.h>
+#	define BVH_PACKET_WIDTH 8
+#	define BVH_LANES_AVX 1
+#elif defined(FPL_ARCH_X64) || defined(FPL_ARCH_X86)
+#	include <emmintrin.h>
+#	define BVH_PACKET_WIDTH 4
+#	define BVH_LANES_SSE2 1
+#else
+#	define BVH_PACKET_WIDTH 4
+#	define BVH_LANES_SCALAR 1
+#endif
+
+#define BVH_BIN_COUNT 16
+#define BVH_MAX_LEAF_SIZE 4
+#define BVH_STACK_SIZE 128
+// Traversal keeps at most one pending sibling per level plus the two children of the current node on the stack,
+// so nodes deeper than this are not split and stay leafs with more primitives
+#define BVH_MAX_DEPTH (BVH_STACK_SIZE - 2)
+#define BVH_NO_HIT UINT32_MAX
+
+//
+// Lanes
+//
+#if BVH_LANES_AVX
+typedef __m256 BVHLanes;
+fpl_force_inline BVHLanes BVHLanesSet(const float value) { return _mm256_set1_ps(value); }
+fpl_force_inline BVHLanes BVHLanesLoad(const float *values) { return _mm256_load_ps(values); }
+fpl_force_inline void BVHLanesStore(float *values, const BVHLanes a) { _mm256_store_ps(values, a); }
+fpl_force_inline BVHLanes BVHLanesAdd(const BVHLanes a, const BVHLanes b) { return _mm256_add_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesSub(const BVHLanes a, const BVHLanes b) { return _mm256_sub_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesMul(const BVHLanes a, const BVHLanes b) { return _mm256_mul_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesMin(const BVHLanes a, const BVHLanes b) { return _mm256_min_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesMax(const BVHLanes a, const BVHLanes b) { return _mm256_max_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesSqrt(const BVHLanes a) { return _mm256_sqrt_ps(a); }
+fpl_force_inline BVHLanes BVHLanesRcp(const BVHLanes a) { return _mm256_div_ps(_mm256_set1_ps(1.0f), a); }
+fpl_force_inline BVHLanes BVHLanesLess(const BVHLanes a, const BVHLanes b) { return _mm256_cmp_ps(a, b, _CMP_LT_OQ); }
+fpl_force_inline BVHLanes BVHLanesLessEqual(const BVHLanes a, const BVHLanes b) { return _mm256_cmp_ps(a, b, _CMP_LE_OQ); }
+fpl_force_inline BVHLanes BVHLanesGreater(const BVHLanes a, const BVHLanes b) { return _mm256_cmp_ps(a, b, _CMP_GT_OQ); }
+fpl_force_inline BVHLanes BVHLanesGreaterEqual(const BVHLanes a, const BVHLanes b) { return _mm256_cmp_ps(a, b, _CMP_GE_OQ); }
+fpl_force_inline BVHLanes BVHLanesAnd(const BVHLanes a, const BVHLanes b) { return _mm256_and_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesSelect(const BVHLanes mask, const BVHLanes a, const BVHLanes b) { return _mm256_blendv_ps(b, a, mask); }
+fpl_force_inline int BVHLanesMask(const BVHLanes a) { return _mm256_movemask_ps(a); }
+#elif BVH_LANES_SSE2
+typedef __m128 BVHLanes;
+fpl_force_inline BVHLanes BVHLanesSet(const float value) { return _mm_set1_ps(value); }
+fpl_force_inline BVHLanes BVHLanesLoad(const float *values) { return _mm_load_ps(values); }
+fpl_force_inline void BVHLanesStore(float *values, const BVHLanes a) { _mm_store_ps(values, a); }
+fpl_force_inline BVHLanes BVHLanesAdd(const BVHLanes a, const BVHLanes b) { return _mm_add_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesSub(const BVHLanes a, const BVHLanes b) { return _mm_sub_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesMul(const BVHLanes a, const BVHLanes b) { return _mm_mul_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesMin(const BVHLanes a, const BVHLanes b) { return _mm_min_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesMax(const BVHLanes a, const BVHLanes b) { return _mm_max_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesSqrt(const BVHLanes a) { return _mm_sqrt_ps(a); }
+fpl_force_inline BVHLanes BVHLanesRcp(const BVHLanes a) { return _mm_div_ps(_mm_set1_ps(1.0f), a); }
+fpl_force_inline BVHLanes BVHLanesLess(const BVHLanes a, const BVHLanes b) { return _mm_cmplt_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesLessEqual(const BVHLanes a, const BVHLanes b) { return _mm_cmple_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesGreater(const BVHLanes a, const BVHLanes b) { return _mm_cmpgt_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesGreaterEqual(const BVHLanes a, const BVHLanes b) { return _mm_cmpge_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesAnd(const BVHLanes a, const BVHLanes b) { return _mm_and_ps(a, b); }
+fpl_force_inline BVHLanes BVHLanesSelect(const BVHLanes mask, const BVHLanes a, const BVHLanes b) { return _mm_or_ps(_mm_and_ps(mask, a), _mm_andnot_ps(mask, b)); }
+fpl_force_inline int BVHLanesMask(const BVHLanes a) { return _mm_movemask_ps(a); }
+#else
+// @NOTE(final): Scalar emulation, masks are stored as 0.0 or 1.0
+struct BVHLanes {
+	float m[BVH_PACKET_WIDTH];
+};
+#define BVH__LANES_OP(expr) BVHLanes r; for (int i = 0; i < BVH_PACKET_WIDTH; ++i) { r.m[i] = (expr); } return(r)
+fpl_force_inline BVHLanes BVHLanesSet(const float value) { BVH__LANES_OP(value); }
+fpl_force_inline BVHLanes BVHLanesLoad(const float *values) { BVH__LANES_OP(values[i]); }
+fpl_force_inline void BVHLanesStore(float *values, const BVHLanes a) { for (int i = 0; i < BVH_PACKET_WIDTH; ++i) values[i] = a.m[i]; }
+fpl_force_inline BVHLanes BVHLanesAdd(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] + b.m[i]); }
+fpl_force_inline BVHLanes BVHLanesSub(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] - b.m[i]); }
+fpl_force_inline BVHLanes BVHLanesMul(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] * b.m[i]); }
+fpl_force_inline BVHLanes BVHLanesMin(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] < b.m[i] ? a.m[i] : b.m[i]); }
+fpl_force_inline BVHLanes BVHLanesMax(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] > b.m[i] ? a.m[i] : b.m[i]); }
+fpl_force_inline BVHLanes BVHLanesSqrt(const BVHLanes a) { BVH__LANES_OP(sqrtf(a.m[i])); }
+fpl_force_inline BVHLanes BVHLanesRcp(const BVHLanes a) { BVH__LANES_OP(1.0f / a.m[i]); }
+fpl_force_inline BVHLanes BVHLanesLess(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] < b.m[i] ? 1.0f : 0.0f); }
+fpl_force_inline BVHLanes BVHLanesLessEqual(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] <= b.m[i] ? 1.0f : 0.0f); }
+fpl_force_inline BVHLanes BVHLanesGreater(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] > b.m[i] ? 1.0f : 0.0f); }
+fpl_force_inline BVHLanes BVHLanesGreaterEqual(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(a.m[i] >= b.m[i] ? 1.0f : 0.0f); }
+fpl_force_inline BVHLanes BVHLanesAnd(const BVHLanes a, const BVHLanes b) { BVH__LANES_OP((a.m[i] != 0.0f && b.m[i] != 0.0f) ? 1.0f : 0.0f); }
+fpl_force_inline BVHLanes BVHLanesSelect(const BVHLanes mask, const BVHLanes a, const BVHLanes b) { BVH__LANES_OP(mask.m[i] != 0.0f ? a.m[i] : b.m[i]); }
+fpl_force_inline int BVHLanesMask(const BVHLanes a) { int r = 0; for (int i = 0; i < BVH_PACKET_WIDTH; ++i) { if (a.m[i] != 0.0f) r |= (1 << i); } return(r); }
+#undef BVH__LANES_OP
+#endif
+
+//
+// Primitives
+//
+enum class BVHPrimitiveKind : uint32_t {
+	Sphere = 0,
+	Triangle,
+};
+
+struct BVHTriangle {
+	Vec3f v0;
+	Vec3f e1;
+	Vec3f e2;
+	Vec3f normal;
+};
+
+struct BVHPrimitive {
+	union {
+		Sphere3f sphere;
+		BVHTriangle triangle;
+	};
+	BVHPrimitiveKind kind;
+	uint32_t materialIndex;
+};
+
+inline BVHPrimitive MakeBVHSphere(const Sphere3f &sphere, const uint32_t materialIndex) {
+	BVHPrimitive result = {};
+	result.kind = BVHPrimitiveKind::Sphere;
+	result.sphere = sphere;
+	result.materialIndex = materialIndex;
+	return(result);
+}
+
+inline BVHPrimitive MakeBVHTriangle(const Triangle3f &triangle, const uint32_t materialIndex) {
+	BVHPrimitive result = {};
+	result.kind = BVHPrimitiveKind::Triangle;
+	result.triangle.v0 = triangle.a;
+	result.triangle.e1 = triangle.b - triangle.a;
+	result.triangle.e2 = triangle.c - triangle.a;
+	result.triangle.normal = V3fNormalize(V3fCross(result.triangle.e1, result.triangle.e2));
+	result.materialIndex = materialIndex;
+	return(result);
+}
+
+//
+// Bounds
+//
+struct BVHBounds {
+	Vec3f min;
+	Vec3f max;
+};
+
+fpl_force_inline BVHBounds BVHEmptyBounds() {
+	BVHBounds result;
+	result.min = V3fInit(FLT_MAX, FLT_MAX, FLT_MAX);
+	result.max = V3fInit(-FLT_MAX, -FLT_MAX, -FLT_MAX);
+	return(result);
+}
+
+fpl_force_inline void BVHGrowBounds(BVHBounds &bounds, const Vec3f &p) {
+	bounds.min = V3fInit(Min(bounds.min.x, p.x), Min(bounds.min.y, p.y), Min(bounds.min.z, p.z));
+	bounds.max = V3fInit(Max(bounds.max.x, p.x), Max(bounds.max.y, p.y), Max(bounds.max.z, p.z));
+}
+
+fpl_force_inline void BVHGrowBounds(BVHBounds &bounds, const BVHBounds &other) {
+	bounds.min = V3fInit(Min(bounds.min.x, other.min.x), Min(bounds.min.y, other.min.y), Min(bounds.min.z, other.min.z));
+	bounds.max = V3fInit(Max(bounds.max.x, other.max.x), Max(bounds.max.y, other.max.y), Max(bounds.max.z, other.max.z));
+}
+
+fpl_force_inline float BVHBoundsArea(const BVHBounds &bounds) {
+	Vec3f e = bounds.max - bounds.min;
+	if (e.x < 0.0f || e.y < 0.0f || e.z < 0.0f) {
+		return 0.0f;
+	}
+	float result = 2.0f * (e.x * e.y + e.y * e.z + e.z * e.x);
+	return(result);
+}
+
+inline BVHBounds GetBVHPrimitiveBounds(const BVHPrimitive &prim) {
+	BVHBounds result = BVHEmptyBounds();
+	if (prim.kind == BVHPrimitiveKind::Sphere) {
+		Vec3f r = V3fInit(prim.sphere.radius, prim.sphere.radius, prim.sphere.radius);
+		result.min = prim.sphere.origin - r;
+		result.max = prim.sphere.origin + r;
+	} else {
+		BVHGrowBounds(result, prim.triangle.v0);
+		BVHGrowBounds(result, prim.triangle.v0 + prim.triangle.e1);
+		BVHGrowBounds(result, prim.triangle.v0 + prim.triangle.e2);
+	}
+	return(result);
+}
+
+//
+// BVH
+//
+struct BVHNode {
+	Vec3f boundsMin;
+	// Index of the left child for inner nodes (right = left + 1), first primitive for leafs
+	uint32_t leftFirst;
+	Vec3f boundsMax;
+	// Zero for inner nodes
+	uint32_t primitiveCount;
+
+	inline bool IsLeaf() const {
+		return primitiveCount > 0;
+	}
+};
+fplStaticAssert(sizeof(BVHNode) == 32);
+
+struct BVH {
+	std::vector<BVHNode> nodes;
+	std::vector<BVHPrimitive> primitives;
+	uint32_t nodeCount;
+};
+
+struct BVHBuildContext {
+	BVH *bvh;
+	std::vector<BVHBounds> primitiveBounds;
+	std::vector<Vec3f> centroids;
+};
+
+static void BVHUpdateNodeBounds(BVHBuildContext &ctx, BVHNode &node) {
+	BVHBounds bounds = BVHEmptyBounds();
+	for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+		BVHGrowBounds(bounds, ctx.primitiveBounds[node.leftFirst + i]);
+	}
+	node.boundsMin = bounds.min;
+	node.boundsMax = bounds.max;
+}
+
+static float BVHFindBestSplit(BVHBuildContext &ctx, const BVHNode &node, int &outAxis, float &outSplitPos) {
+	float bestCost = FLT_MAX;
+	for (int axis = 0; axis < 3; ++axis) {
+		float centroidMin = FLT_MAX;
+		float centroidMax = -FLT_MAX;
+		for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+			float c = ctx.centroids[node.leftFirst + i].m[axis];
+			centroidMin = Min(centroidMin, c);
+			centroidMax = Max(centroidMax, c);
+		}
+		// Tiny extents of degenerate meshes overflow the scale, these axes are not split as well
+		float scale = (float)BVH_BIN_COUNT / (centroidMax - centroidMin);
+		if (centroidMin == centroidMax || !(scale < FLT_MAX)) {
+			continue;
+		}
+
+		BVHBounds binBounds[BVH_BIN_COUNT];
+		uint32_t binCounts[BVH_BIN_COUNT] = {};
+		for (int binIndex = 0; binIndex < BVH_BIN_COUNT; ++binIndex) {
+			binBounds[binIndex] = BVHEmptyBounds();
+		}
+		for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+			uint32_t primIndex = node.leftFirst + i;
+			int binIndex = fplMin(BVH_BIN_COUNT - 1, (int)((ctx.centroids[primIndex].m[axis] - centroidMin) * scale));
+			binCounts[binIndex]++;
+			BVHGrowBounds(binBounds[binIndex], ctx.primitiveBounds[primIndex]);
+		}
+
+		// Sweep from both sides to get the areas and counts for each of the BVH_BIN_COUNT - 1 planes
+		float leftArea[BVH_BIN_COUNT - 1], rightArea[BVH_BIN_COUNT - 1];
+		uint32_t leftCount[BVH_BIN_COUNT - 1], rightCount[BVH_BIN_COUNT - 1];
+		BVHBounds leftBounds = BVHEmptyBounds();
+		BVHBounds rightBounds = BVHEmptyBounds();
+		uint32_t leftSum = 0, rightSum = 0;
+		for (int i = 0; i < BVH_BIN_COUNT - 1; ++i) {
+			leftSum += binCounts[i];
+			leftCount[i] = leftSum;
+			BVHGrowBounds(leftBounds, binBounds[i]);
+			leftArea[i] = BVHBoundsArea(leftBounds);
+
+			rightSum += binCounts[BVH_BIN_COUNT - 1 - i];
+			rightCount[BVH_BIN_COUNT - 2 - i] = rightSum;
+			BVHGrowBounds(rightBounds, binBounds[BVH_BIN_COUNT - 1 - i]);
+			rightArea[BVH_BIN_COUNT - 2 - i] = BVHBoundsArea(rightBounds);
+		}
+
+		float binWidth = (centroidMax - centroidMin) / (float)BVH_BIN_COUNT;
+		for (int i = 0; i < BVH_BIN_COUNT - 1; ++i) {
+			if (leftCount[i] == 0 || rightCount[i] == 0) {
+				continue;
+			}
+			float cost = leftCount[i] * leftArea[i] + rightCount[i] * rightArea[i];
+			if (cost < bestCost) {
+				bestCost = cost;
+				outAxis = axis;
+				outSplitPos = centroidMin + binWidth * (float)(i + 1);
+			}
+		}
+	}
+	return(bestCost);
+}
+
+static void BVHSwapPrimitives(BVHBuildContext &ctx, const uint32_t a, const uint32_t b) {
+	std::swap(ctx.bvh->primitives[a], ctx.bvh->primitives[b]);
+	std::swap(ctx.primitiveBounds[a], ctx.primitiveBounds[b]);
+	std::swap(ctx.centroids[a], ctx.centroids[b]);
+}
+
+static void BVHSubdivide(BVHBuildContext &ctx, const uint32_t nodeIndex, const uint32_t depth) {
+	BVH *bvh = ctx.bvh;
+	BVHNode &node = bvh->nodes[nodeIndex];
+	if (node.primitiveCount <= 2 || depth >= BVH_MAX_DEPTH) {
+		return;
+	}
+
+	int axis = -1;
+	float splitPos = 0.0f;
+	float splitCost = BVHFindBestSplit(ctx, node, axis, splitPos);
+
+	BVHBounds nodeBounds = { node.boundsMin, node.boundsMax };
+	float leafCost = (float)node.primitiveCount * BVHBoundsArea(nodeBounds);
+	if (axis < 0 || (splitCost >= leafCost && node.primitiveCount <= BVH_MAX_LEAF_SIZE)) {
+		return;
+	}
+
+	// Partition in place
+	uint32_t i = node.leftFirst;
+	uint32_t j = i + node.primitiveCount - 1;
+	while (i <= j) {
+		if (ctx.centroids[i].m[axis] < splitPos) {
+			++i;
+		} else {
+			BVHSwapPrimitives(ctx, i, j);
+			if (j == 0) break;
+			--j;
+		}
+	}
+
+	uint32_t leftCount = i - node.leftFirst;
+	if (leftCount == 0 || leftCount == node.primitiveCount) {
+		return;
+	}
+
+	uint32_t leftIndex = bvh->nodeCount++;
+	uint32_t rightIndex = bvh->nodeCount++;
+
+	BVHNode &left = bvh->nodes[leftIndex];
+	left.leftFirst = node.leftFirst;
+	left.primitiveCount = leftCount;
+
+	BVHNode &right = bvh->nodes[rightIndex];
+	right.leftFirst = i;
+	right.primitiveCount = node.primitiveCount - leftCount;
+
+	node.leftFirst = leftIndex;
+	node.primitiveCount = 0;
+
+	BVHUpdateNodeBounds(ctx, left);
+	BVHUpdateNodeBounds(ctx, right);
+
+	BVHSubdivide(ctx, leftIndex, depth + 1);
+	BVHSubdivide(ctx, rightIndex, depth + 1);
+}
+
+// Builds the hierarchy over bvh.primitives, the primitives are reordered in place
+static void BuildBVH(BVH &bvh) {
+	uint32_t primitiveCount = (uint32_t)bvh.primitives.size();
+	bvh.nodes.clear();
+	bvh.nodeCount = 0;
+	if (primitiveCount == 0) {
+		return;
+	}
+
+	BVHBuildContext ctx = {};
+	ctx.bvh = &bvh;
+	ctx.primitiveBounds.resize(primitiveCount);
+	ctx.centroids.resize(primitiveCount);
+	for (uint32_t primIndex = 0; primIndex < primitiveCount; ++primIndex) {
+		BVHBounds bounds = GetBVHPrimitiveBounds(bvh.primitives[primIndex]);
+		ctx.primitiveBounds[primIndex] = bounds;
+		ctx.centroids[primIndex] = (bounds.min + bounds.max) * 0.5f;
+	}
+
+	bvh.nodes.resize(primitiveCount * 2 - 1);
+	BVHNode &root = bvh.nodes[bvh.nodeCount++];
+	root.leftFirst = 0;
+	root.primitiveCount = primitiveCount;
+	BVHUpdateNodeBounds(ctx, root);
+	BVHSubdivide(ctx, 0, 0);
+	bvh.nodes.resize(bvh.nodeCount);
+}
+
+//
+// Single ray traversal
+//
+fpl_force_inline float BVHIntersectBounds(const Vec3f &origin, const Vec3f &invDir, const Vec3f &bmin, const Vec3f &bmax, const float tMin, const float tMax) {
+	float tx1 = (bmin.x - origin.x) * invDir.x, tx2 = (bmax.x - origin.x) * invDir.x;
+	float tNear = Min(tx1, tx2), tFar = Max(tx1, tx2);
+	float ty1 = (bmin.y - origin.y) * invDir.y, ty2 = (bmax.y - origin.y) * invDir.y;
+	tNear = Max(tNear, Min(ty1, ty2)), tFar = Min(tFar, Max(ty1, ty2));
+	float tz1 = (bmin.z - origin.z) * invDir.z, tz2 = (bmax.z - origin.z) * invDir.z;
+	tNear = Max(tNear, Min(tz1, tz2)), tFar = Min(tFar, Max(tz1, tz2));
+	if (tFar >= tNear && tFar > tMin && tNear < tMax) {
+		return(tNear);
+	}
+	return(FLT_MAX);
+}
+
+fpl_force_inline bool BVHIntersectPrimitive(const BVHPrimitive &prim, const Ray3f &ray, const float tMin, const float tMax, float &outT) {
+	if (prim.kind == BVHPrimitiveKind::Sphere) {
+		Vec3f oc = ray.origin - prim.sphere.origin;
+		float b = V3fDot(oc, ray.direction);
+		float c = V3fDot(oc, oc) - prim.sphere.radius * prim.sphere.radius;
+		float disc = b * b - c;
+		if (disc <= 0.0f) {
+			return(false);
+		}
+		float sq = SquareRoot(disc);
+		float t = -b - sq;
+		if (t <= tMin) {
+			t = -b + sq;
+		}
+		if (t > tMin && t < tMax) {
+			outT = t;
+			return(true);
+		}
+	} else {
+		const BVHTriangle &tri = prim.triangle;
+		Vec3f h = V3fCross(ray.direction, tri.e2);
+		float a = V3fDot(tri.e1, h);
+		if (a > -1e-8f && a < 1e-8f) {
+			return(false);
+		}
+		float f = 1.0f / a;
+		Vec3f s = ray.origin - tri.v0;
+		float u = f * V3fDot(s, h);
+		if (u < 0.0f || u > 1.0f) {
+			return(false);
+		}
+		Vec3f q = V3fCross(s, tri.e1);
+		float v = f * V3fDot(ray.direction, q);
+		if (v < 0.0f || (u + v) > 1.0f) {
+			return(false);
+		}
+		float t = f * V3fDot(tri.e2, q);
+		if (t > tMin && t < tMax) {
+			outT = t;
+			return(true);
+		}
+	}
+	return(false);
+}
+
+#if !(USE_BVH && USE_RAY_PACKETS)
+// Returns the index of the closest primitive or BVH_NO_HIT, inOutTMax is updated to the hit distance
+static uint32_t IntersectBVH(const BVH &bvh, const Ray3f &ray, const float tMin, float &inOutTMax) {
+	uint32_t result = BVH_NO_HIT;
+	if (bvh.nodeCount == 0) {
+		return(result);
+	}
+	Vec3f invDir = V3fInit(1.0f / ray.direction.x, 1.0f / ray.direction.y, 1.0f / ray.direction.z);
+	const BVHNode *nodes = bvh.nodes.data();
+	uint32_t stack[BVH_STACK_SIZE];
+	uint32_t stackCount = 0;
+	stack[stackCount++] = 0;
+	while (stackCount > 0) {
+		const BVHNode &node = nodes[stack[--stackCount]];
+		if (node.IsLeaf()) {
+			for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+				uint32_t primIndex = node.leftFirst + i;
+				float t;
+				if (BVHIntersectPrimitive(bvh.primitives[primIndex], ray, tMin, inOutTMax, t)) {
+					inOutTMax = t;
+					result = primIndex;
+				}
+			}
+			continue;
+		}
+		const BVHNode &left = nodes[node.leftFirst];
+		const BVHNode &right = nodes[node.leftFirst + 1];
+		float leftDist = BVHIntersectBounds(ray.origin, invDir, left.boundsMin, left.boundsMax, tMin, inOutTMax);
+		float rightDist = BVHIntersectBounds(ray.origin, invDir, right.boundsMin, right.boundsMax, tMin, inOutTMax);
+		uint32_t nearIndex = node.leftFirst, farIndex = node.leftFirst + 1;
+		if (leftDist > rightDist) {
+			std::swap(leftDist, rightDist);
+			std::swap(nearIndex, farIndex);
+		}
+		fplAssert(stackCount + 2 <= BVH_STACK_SIZE);
+		if (rightDist != FLT_MAX) {
+			stack[stackCount++] = farIndex;
+		}
+		if (leftDist != FLT_MAX) {
+			stack[stackCount++] = nearIndex;
+		}
+	}
+	return(result);
+}
+#endif // !(USE_BVH && USE_RAY_PACKETS)
+
+//
+// Packet traversal
+//
+struct BVHRayPacket {
+	alignas(32) float originX[BVH_PACKET_WIDTH];
+	alignas(32) float originY[BVH_PACKET_WIDTH];
+	alignas(32) float originZ[BVH_PACKET_WIDTH];
+	alignas(32) float dirX[BVH_PACKET_WIDTH];
+	alignas(32) float dirY[BVH_PACKET_WIDTH];
+	alignas(32) float dirZ[BVH_PACKET_WIDTH];
+	alignas(32) float tMax[BVH_PACKET_WIDTH];
+	uint32_t primIndex[BVH_PACKET_WIDTH];
+	// Bit per lane, inactive lanes are ignored by the traversal
+	int activeMask;
+};
+
+inline void SetBVHRayPacketLane(BVHRayPacket &packet, const uint32_t lane, const Ray3f &ray, const float tMax) {
+	fplAssert(lane < BVH_PACKET_WIDTH);
+	packet.originX[lane] = ray.origin.x;
+	packet.originY[lane] = ray.origin.y;
+	packet.originZ[lane] = ray.origin.z;
+	packet.dirX[lane] = ray.direction.x;
+	packet.dirY[lane] = ray.direction.y;
+	packet.dirZ[lane] = ray.direction.z;
+	packet.tMax[lane] = tMax;
+	packet.primIndex[lane] = BVH_NO_HIT;
+}
+
+struct BVHPacketLanes {
+	BVHLanes ox, oy, oz;
+	BVHLanes dx, dy, dz;
+	BVHLanes ix, iy, iz;
+	BVHLanes tMin;
+	BVHLanes tMax;
+};
+
+fpl_force_inline int BVHIntersectBoundsPacket(const BVHPacketLanes &lanes, const BVHNode &node, float &outNearest) {
+	BVHLanes tx1 = BVHLanesMul(BVHLanesSub(BVHLanesSet(node.boundsMin.x), lanes.ox), lanes.ix);
+	BVHLanes tx2 = BVHLanesMul(BVHLanesSub(BVHLanesSet(node.boundsMax.x), lanes.ox), lanes.ix);
+	BVHLanes ty1 = BVHLanesMul(BVHLanesSub(BVHLanesSet(node.boundsMin.y), lanes.oy), lanes.iy);
+	BVHLanes ty2 = BVHLanesMul(BVHLanesSub(BVHLanesSet(node.boundsMax.y), lanes.oy), lanes.iy);
+	BVHLanes tz1 = BVHLanesMul(BVHLanesSub(BVHLanesSet(node.boundsMin.z), lanes.oz), lanes.iz);
+	BVHLanes tz2 = BVHLanesMul(BVHLanesSub(BVHLanesSet(node.boundsMax.z), lanes.oz), lanes.iz);
+	BVHLanes tNear = BVHLanesMax(BVHLanesMax(BVHLanesMin(tx1, tx2), BVHLanesMin(ty1, ty2)), BVHLanesMin(tz1, tz2));
+	BVHLanes tFar = BVHLanesMin(BVHLanesMin(BVHLanesMax(tx1, tx2), BVHLanesMax(ty1, ty2)), BVHLanesMax(tz1, tz2));
+	BVHLanes hit = BVHLanesAnd(BVHLanesAnd(BVHLanesGreaterEqual(tFar, tNear), BVHLanesGreater(tFar, lanes.tMin)), BVHLanesLess(tNear, lanes.tMax));
+	int result = BVHLanesMask(hit);
+	if (result) {
+		alignas(32) float nearValues[BVH_PACKET_WIDTH];
+		BVHLanesStore(nearValues, tNear);
+		float nearest = FLT_MAX;
+		for (int lane = 0; lane < BVH_PACKET_WIDTH; ++lane) {
+			if (result & (1 << lane)) {
+				nearest = Min(nearest, nearValues[lane]);
+			}
+		}
+		outNearest = nearest;
+	}
+	return(result);
+}
+
+fpl_force_inline BVHLanes BVHIntersectPrimitivePacket(const BVHPacketLanes &lanes, const BVHPrimitive &prim) {
+	BVHLanes zero = BVHLanesSet(0.0f);
+	if (prim.kind == BVHPrimitiveKind::Sphere) {
+		BVHLanes ocx = BVHLanesSub(lanes.ox, BVHLanesSet(prim.sphere.origin.x));
+		BVHLanes ocy = BVHLanesSub(lanes.oy, BVHLanesSet(prim.sphere.origin.y));
+		BVHLanes ocz = BVHLanesSub(lanes.oz, BVHLanesSet(prim.sphere.origin.z));
+		BVHLanes b = BVHLanesAdd(BVHLanesAdd(BVHLanesMul(ocx, lanes.dx), BVHLanesMul(ocy, lanes.dy)), BVHLanesMul(ocz, lanes.dz));
+		BVHLanes c = BVHLanesSub(BVHLanesAdd(BVHLanesAdd(BVHLanesMul(ocx, ocx), BVHLanesMul(ocy, ocy)), BVHLanesMul(ocz, ocz)), BVHLanesSet(prim.sphere.radius * prim.sphere.radius));
+		BVHLanes disc = BVHLanesSub(BVHLanesMul(b, b), c);
+		BVHLanes sq = BVHLanesSqrt(BVHLanesMax(disc, zero));
+		BVHLanes negB = BVHLanesSub(zero, b);
+		BVHLanes tNear = BVHLanesSub(negB, sq);
+		BVHLanes tFarther = BVHLanesAdd(negB, sq);
+		BVHLanes t = BVHLanesSelect(BVHLanesGreater(tNear, lanes.tMin), tNear, tFarther);
+		BVHLanes valid = BVHLanesAnd(BVHLanesGreater(disc, zero), BVHLanesAnd(BVHLanesGreater(t, lanes.tMin), BVHLanesLess(t, lanes.tMax)));
+		return BVHLanesSelect(valid, t, BVHLanesSet(-1.0f));
+	} else {
+		const BVHTriangle &tri = prim.triangle;
+		BVHLanes e1x = BVHLanesSet(tri.e1.x), e1y = BVHLanesSet(tri.e1.y), e1z = BVHLanesSet(tri.e1.z);
+		BVHLanes e2x = BVHLanesSet(tri.e2.x), e2y = BVHLanesSet(tri.e2.y), e2z = BVHLanesSet(tri.e2.z);
+		// h = cross(d, e2)
+		BVHLanes hx = BVHLanesSub(BVHLanesMul(lanes.dy, e2z), BVHLanesMul(lanes.dz, e2y));
+		BVHLanes hy = BVHLanesSub(BVHLanesMul(lanes.dz, e2x), BVHLanesMul(lanes.dx, e2z));
+		BVHLanes hz = BVHLanesSub(BVHLanesMul(lanes.dx, e2y), BVHLanesMul(lanes.dy, e2x));
+		BVHLanes a = BVHLanesAdd(BVHLanesAdd(BVHLanesMul(e1x, hx), BVHLanesMul(e1y, hy)), BVHLanesMul(e1z, hz));
+		BVHLanes aAbs = BVHLanesMax(a, BVHLanesSub(zero, a));
+		BVHLanes f = BVHLanesRcp(a);
+		BVHLanes sx = BVHLanesSub(lanes.ox, BVHLanesSet(tri.v0.x));
+		BVHLanes sy = BVHLanesSub(lanes.oy, BVHLanesSet(tri.v0.y));
+		BVHLanes sz = BVHLanesSub(lanes.oz, BVHLanesSet(tri.v0.z));
+		BVHLanes u = BVHLanesMul(f, BVHLanesAdd(BVHLanesAdd(BVHLanesMul(sx, hx), BVHLanesMul(sy, hy)), BVHLanesMul(sz, hz)));
+		// q = cross(s, e1)
+		BVHLanes qx = BVHLanesSub(BVHLanesMul(sy, e1z), BVHLanesMul(sz, e1y));
+		BVHLanes qy = BVHLanesSub(BVHLanesMul(sz, e1x), BVHLanesMul(sx, e1z));
+		BVHLanes qz = BVHLanesSub(BVHLanesMul(sx, e1y), BVHLanesMul(sy, e1x));
+		BVHLanes v = BVHLanesMul(f, BVHLanesAdd(BVHLanesAdd(BVHLanesMul(lanes.dx, qx), BVHLanesMul(lanes.dy, qy)), BVHLanesMul(lanes.dz, qz)));
+		BVHLanes t = BVHLanesMul(f, BVHLanesAdd(BVHLanesAdd(BVHLanesMul(e2x, qx), BVHLanesMul(e2y, qy)), BVHLanesMul(e2z, qz)));
+		BVHLanes valid = BVHLanesAnd(BVHLanesGreater(aAbs, BVHLanesSet(1e-8f)), BVHLanesGreaterEqual(u, zero));
+		valid = BVHLanesAnd(valid, BVHLanesAnd(BVHLanesGreaterEqual(v, zero), BVHLanesLessEqual(BVHLanesAdd(u, v), BVHLanesSet(1.0f))));
+		valid = BVHLanesAnd(valid, BVHLanesAnd(BVHLanesGreater(t, lanes.tMin), BVHLanesLess(t, lanes.tMax)));
+		return BVHLanesSelect(valid, t, BVHLanesSet(-1.0f));
+	}
+}
+
+// Finds the closest primitive for every active lane, packet.tMax and packet.primIndex are updated for each lane that hits something
+static void IntersectBVHPacket(const BVH &bvh, BVHRayPacket &packet, const float tMin) {
+	if (bvh.nodeCount == 0 || packet.activeMask == 0) {
+		return;
+	}
+
+	// Inactive lanes get a negative max distance, so they never pass any test
+	for (int lane = 0; lane < BVH_PACKET_WIDTH; ++lane) {
+		if (!(packet.activeMask & (1 << lane))) {
+			packet.tMax[lane] = -FLT_MAX;
+			packet.originX[lane] = packet.originY[lane] = packet.originZ[lane] = 0.0f;
+			packet.dirX[lane] = packet.dirY[lane] = packet.dirZ[lane] = 1.0f;
+		}
+	}
+
+	BVHPacketLanes lanes;
+	lanes.ox = BVHLanesLoad(packet.originX);
+	lanes.oy = BVHLanesLoad(packet.originY);
+	lanes.oz = BVHLanesLoad(packet.originZ);
+	lanes.dx = BVHLanesLoad(packet.dirX);
+	lanes.dy = BVHLanesLoad(packet.dirY);
+	lanes.dz = BVHLanesLoad(packet.dirZ);
+	lanes.ix = BVHLanesRcp(lanes.dx);
+	lanes.iy = BVHLanesRcp(lanes.dy);
+	lanes.iz = BVHLanesRcp(lanes.dz);
+	lanes.tMin = BVHLanesSet(tMin);
+	lanes.tMax = BVHLanesLoad(packet.tMax);
+
+	const BVHNode *nodes = bvh.nodes.data();
+	const BVHPrimitive *primitives = bvh.primitives.data();
+
+	uint32_t stack[BVH_STACK_SIZE];
+	uint32_t stackCount = 0;
+	stack[stackCount++] = 0;
+	while (stackCount > 0) {
+		const BVHNode &node = nodes[stack[--stackCount]];
+		float nearest;
+		if (!BVHIntersectBoundsPacket(lanes, node, nearest)) {
+			continue;
+		}
+		if (node.IsLeaf()) {
+			for (uint32_t i = 0; i < node.primitiveCount; ++i) {
+				uint32_t primIndex = node.leftFirst + i;
+				BVHLanes t = BVHIntersectPrimitivePacket(lanes, primitives[primIndex]);
+				BVHLanes hit = BVHLanesGreater(t, BVHLanesSet(0.0f));
+				int hitMask = BVHLanesMask(hit);
+				if (hitMask) {
+					lanes.tMax = BVHLanesSelect(hit, t, lanes.tMax);
+					for (int lane = 0; lane < BVH_PACKET_WIDTH; ++lane) {
+						if (hitMask & (1 << lane)) {
+							packet.primIndex[lane] = primIndex;
+						}
+					}
+				}
+			}
+			continue;
+		}
+		// Visit the child with the closest entry distance first
+		float leftNear = FLT_MAX, rightNear = FLT_MAX;
+		int leftMask = BVHIntersectBoundsPacket(lanes, nodes[node.leftFirst], leftNear);
+		int rightMask = BVHIntersectBoundsPacket(lanes, nodes[node.leftFirst + 1], rightNear);
+		uint32_t nearIndex = node.leftFirst, farIndex = node.leftFirst + 1;
+		int nearMask = leftMask, farMask = rightMask;
+		if (leftNear > rightNear) {
+			std::swap(nearIndex, farIndex);
+			std::swap(nearMask, farMask);
+		}
+		fplAssert(stackCount + 2 <= BVH_STACK_SIZE);
+		if (farMask) {
+			stack[stackCount++] = farIndex;
+		}
+		if (nearMask) {
+			stack[stackCount++] = nearIndex;
+		}
+	}
+
+	BVHLanesStore(packet.tMax, lanes.tMax);
+}
+
+inline Vec3f GetBVHPrimitiveNormal(const BVHPrimitive &prim, const Vec3f &hitPoint, const Vec3f &rayDirection) {
+	Vec3f result;
+	if (prim.kind == BVHPrimitiveKind::Sphere) {
+		result = V3fNormalize(hitPoint - prim.sphere.origin);
+	} else {
+		// Triangles are two-sided
+		result = prim.triangle.normal;
+		if (V3fDot(result, rayDirection) > 0.0f) {
+			result = -result;
+		}
+	}
+	return(result);
+}
+
+#endif // BVH_H
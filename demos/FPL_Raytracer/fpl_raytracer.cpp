@@ -12,6 +12,21 @@ Description:
 	The point of this demo, is to test multithreading and software video output.
 	Also there are defines, which can be toggled to enable/disable false sharing or compiler reordering issues.
 
+	Offline render mode:
+	Run with --render to render the scene without creating a window and write the image to a PPM or PNG file.
+	Prints the rays per second, the timings of each phase and the utilization of each worker.
+	Options:
+		--output=<file.ppm|file.png>  Output file (Default: render.ppm)
+		--width=<pixels>              Image width (Default: 1280)
+		--height=<pixels>             Image height (Default: 768)
+		--tile-size=<pixels>          Tile size (Default: 64)
+		--spp=<count>                 Samples per pixel (Default: 128)
+		--bounces=<count>             Maximum bounces per path (Default: 4)
+		--threads=<count>             Number of threads including the main thread (Default: Number of cores, max 64)
+		--seed=<value>                Random seed (Default: 1337)
+		--spheres=<count>             Render the sphere field stress scene with the given number of spheres
+		--adaptive                    Stop converged tiles early
+
 Todo:
 	- Better random
 	- Fix bad random bounce
@@ -19,8 +34,6 @@ Todo:
 	- Blitting of raytracing image to the backbuffer with different sizes
 	- Lights
 	- Box Shape
-	- Triangle Shape
-	- SIMD?
 
 Requirements:
 	- C++/11 Compiler
@@ -32,6 +45,20 @@ Author:
 	Torsten Spaete
 
 Changelog:
+	## 2026-10-18
+	- Added progressive accumulation, one sample per pixel per pass
+	- Added adaptive sampling, converged tiles are stopped early
+	- Added per work order random series, instead of sharing one across all workers
+	- Fixed workers may miss the wake up signal
+	- Added work-stealing scheduler, idle workers steal the remaining scanlines of unfinished tiles
+	- Tiles are now scheduled in morton order
+	- Added per worker utilization report, printed when the image is finished
+	- Added headless offline render mode with PPM/PNG output (--render)
+	- Added binned SAH BVH for spheres and triangles
+	- Added triangle meshes
+	- Added SIMD ray-packet traversal (SSE2/AVX)
+	- Added sphere field stress scene
+
 	## 2019-08-09
 	- Fixed false sharing issues for work queue
 
@@ -56,6 +83,18 @@ License:
 // -> Resulting in crashes
 #define FIX_WRONG_INSTRUCTION_REORDER_IN_RELEASE 1
 
+// Define this to use a bounding volume hierarchy for spheres and triangles, instead of testing every object for every ray
+#define USE_BVH 1
+
+// Define this to trace the rays of a pixel in SIMD packets through the BVH (Requires USE_BVH)
+#define USE_RAY_PACKETS 1
+
+// Set this to a non-zero sphere count, to render a stress scene with a field of spheres and a triangle mesh instead
+#define SCENE_SPHERE_FIELD_COUNT 0
+
+// Maximum number of worker threads
+#define MAX_WORKER_COUNT 64
+
 #define FPL_IMPLEMENTATION
 #define FPL_NO_AUDIO
 #define FPL_NO_VIDEO_VULKAN
@@ -85,9 +124,14 @@ typedef int32_t b32;
 #include <final_geometry.h>
 #include <final_random.h>
 
+#include <string.h> // strncmp
+
 #include <vector>
 #include <new>
 
+#include "bvh.h"
+#include "image_output.h"
+
 struct Image32 {
 	Pixel *pixels;
 	u32 width;
@@ -107,6 +151,7 @@ enum class ObjectKind : s32 {
 	None = 0,
 	Plane,
 	Sphere,
+	Triangle,
 };
 
 struct Material {
@@ -119,6 +164,7 @@ struct Object {
 	union {
 		Plane3f plane;
 		Sphere3f sphere;
+		Triangle3f triangle;
 	};
 	ObjectKind kind;
 	u32 materialIndex;
@@ -139,6 +185,10 @@ struct Scene {
 	std::vector<Object> objects;
 	std::vector<Material> materials;
 
+	// Objects with infinite bounds, which cannot be stored in the BVH
+	std::vector<u32> unboundedObjects;
+	BVH bvh;
+
 	u32 AddMaterial(const Vec3f &emitColor, const Vec3f &reflectColor, const float scatter = 0.0f) {
 		fplAssert(materials.size() < (U32_MAX - 1));
 		u32 result = (u32)materials.size();
@@ -169,17 +219,90 @@ struct Scene {
 		obj.materialIndex = matIndex;
 		objects.push_back(obj);
 	}
+
+	void AddTriangle(const Vec3f &a, const Vec3f &b, const Vec3f &c, const u32 matIndex) {
+		fplAssert(matIndex < materials.size());
+		Object obj = {};
+		obj.kind = ObjectKind::Triangle;
+		obj.triangle.a = a;
+		obj.triangle.b = b;
+		obj.triangle.c = c;
+		obj.materialIndex = matIndex;
+		objects.push_back(obj);
+	}
+
+	void AddTriangleMesh(const Vec3f *vertices, const u32 vertexCount, const u32 *indices, const u32 indexCount, const Vec3f &translation, const f32 scale, const u32 matIndex) {
+		fplAssert((indexCount % 3) == 0);
+		for (u32 i = 0; i < indexCount; i += 3) {
+			fplAssert(indices[i + 0] < vertexCount && indices[i + 1] < vertexCount && indices[i + 2] < vertexCount);
+			Vec3f a = translation + vertices[indices[i + 0]] * scale;
+			Vec3f b = translation + vertices[indices[i + 1]] * scale;
+			Vec3f c = translation + vertices[indices[i + 2]] * scale;
+			AddTriangle(a, b, c, matIndex);
+		}
+	}
+
+	void BuildAccelerationStructure() {
+		unboundedObjects.clear();
+		bvh.primitives.clear();
+		for (u32 objectIndex = 0, objectCount = (u32)objects.size(); objectIndex < objectCount; ++objectIndex) {
+			const Object &obj = objects[objectIndex];
+			switch (obj.kind) {
+				case ObjectKind::Sphere:
+					bvh.primitives.push_back(MakeBVHSphere(obj.sphere, obj.materialIndex));
+					break;
+				case ObjectKind::Triangle:
+					bvh.primitives.push_back(MakeBVHTriangle(obj.triangle, obj.materialIndex));
+					break;
+				default:
+					unboundedObjects.push_back(objectIndex);
+					break;
+			}
+		}
+		BuildBVH(bvh);
+	}
 };
 
 struct RaytracerSettings {
 	u32 maxBounceCount;
+	// Maximum number of samples per pixel
 	u32 raysPerPixelCount;
+	// Number of samples per pixel added in each pass
+	u32 samplesPerPass;
+	// Minimum number of samples per pixel, before a tile is tested for convergence
+	u32 adaptiveMinSamples;
+	// Tiles where the average relative error of its pixels is below this threshold are converged
+	f32 adaptiveThreshold;
+	b32 isAdaptive;
+};
+
+struct TilingInfo {
+	u32 tileCountX;
+	u32 tileCountY;
+	u32 tileSizeX;
+	u32 tileSizeY;
+	u32 imageW;
+	u32 imageH;
+};
+
+struct TileState {
+	u32 sampleCount;
+	b32 isConverged;
 };
 
 struct Raytracer {
 	Image32 image;
 	RaytracerSettings settings;
-	RandomSeries rnd;
+	TilingInfo tiling;
+	// Sum of all linear samples per pixel
+	Vec3f *accumulation;
+	// Sum of all squared sample luminances per pixel, for estimating the variance
+	f32 *luminanceSquares;
+	TileState *tiles;
+	// Sum of the relative pixel errors for each row of each tile
+	f32 *tileRowErrors;
+	u64 seed;
+	u32 passIndex;
 	Vec2f halfPixelSize;
 };
 
@@ -340,6 +463,13 @@ static void Render(const App &app) {
 			case ObjectKind::Sphere:
 				DrawSphere(obj.sphere.origin, obj.sphere.radius);
 				break;
+			case ObjectKind::Triangle:
+				glBegin(GL_TRIANGLES);
+				glVertex3fv(&obj.triangle.a.m[0]);
+				glVertex3fv(&obj.triangle.b.m[0]);
+				glVertex3fv(&obj.triangle.c.m[0]);
+				glEnd();
+				break;
 		}
 	}
 #endif
@@ -401,15 +531,6 @@ static void Render(const App &app) {
 #endif // USE_OPENGL_NO_RAYTRACE
 }
 
-struct TilingInfo {
-	u32 tileCountX;
-	u32 tileCountY;
-	u32 tileSizeX;
-	u32 tileSizeY;
-	u32 imageW;
-	u32 imageH;
-};
-
 enum class WorkerState : s32 {
 	Stopped = 0,
 	Running,
@@ -425,9 +546,19 @@ struct WorkOrder {
 	u32 yMin;
 	u32 xMaxPlusOne;
 	u32 yMaxPlusOne;
+	u32 tileIndex;
+	u32 passIndex;
+	// Queue generation in the upper and the next unclaimed row in the lower 32-bits
+	volatile u64 rowState;
+	volatile u32 finishedRowCount;
 #if QUEUE_ALIGN_WORK_ORDERS_BY_CACHELINE == 1
-	u8 padding2[32];
+	u8 padding2[12];
 #endif
+
+	inline u32 GetRowCount() const volatile {
+		u32 result = yMaxPlusOne - yMin;
+		return(result);
+	}
 };
 
 #if QUEUE_ALIGN_WORK_ORDERS_BY_CACHELINE == 1
@@ -438,7 +569,7 @@ struct WorkQueue {
 	// @NOTE(final): Memory must be be aligned by 64-bit, otherwise we get false sharing issues.
 	WorkOrder *orders;
 	u32 capacity;
-	u32 workOrderCount;
+	volatile u32 workOrderCount;
 
 #if QUEUE_ADD_CACHELINE_PADDING_TO_VOLATILES == 1
 	u8 cacheline_padding1[64];
@@ -454,6 +585,12 @@ struct WorkQueue {
 	u8 cacheline_padding3[64];
 #endif
 
+	// Incremented on every reset, so workers never claim rows from orders of a previous pass
+	volatile u32 generation;
+#if QUEUE_ADD_CACHELINE_PADDING_TO_VOLATILES == 1
+	u8 cacheline_padding4[64];
+#endif
+
 	bool IsEmpty() {
 		bool result = workOrderCount == 0;
 		return(result);
@@ -476,6 +613,7 @@ struct WorkQueue {
 		workOrderCount = 0;
 		fplAtomicExchangeU32(&nextWorkOrderIndex, 0);
 		fplAtomicExchangeU32(&completionCount, 0);
+		fplAtomicExchangeU32(&generation, 0);
 	}
 
 	void Release() {
@@ -487,35 +625,90 @@ struct WorkQueue {
 	}
 
 	void Reset() {
-		workOrderCount = 0;
+		fplAtomicStoreU32(&workOrderCount, 0);
 		fplAtomicExchangeU32(&nextWorkOrderIndex, 0);
 		fplAtomicExchangeU32(&completionCount, 0);
+		fplAtomicIncrementU32(&generation);
 	}
 
-	void Push(Raytracer *rayTracer, const Scene *scene, const u32 xMin, const u32 yMin, const u32 xMaxPlusOne, const u32 yMaxPlusOne) {
+	void Push(Raytracer *rayTracer, const Scene *scene, const u32 xMin, const u32 yMin, const u32 xMaxPlusOne, const u32 yMaxPlusOne, const u32 tileIndex, const u32 passIndex) {
 		const fplThreadHandle *mainThread = fplGetMainThread();
 		u32 threadId = fplGetCurrentThreadId();
 		fplAssert(threadId == mainThread->id);
 		fplAssert(workOrderCount < capacity);
-		u32 index = workOrderCount++;
+		u32 index = workOrderCount;
 		WorkOrder *order = orders + index;
-		*order = {};
+		// @NOTE(final): Late workers from the previous pass may still try to claim rows from this order.
+		// Mark the order as exhausted with the current generation first, so their compare-and-swap fails
+		// and no worker claims a row while the fields below are written.
+		u64 generationBits = (u64)fplAtomicLoadU32(&generation) << 32;
+		fplAtomicExchangeU64(&order->rowState, generationBits | 0xFFFFFFFF);
 		order->raytracer = rayTracer;
 		order->scene = scene;
 		order->xMin = xMin;
 		order->yMin = yMin;
 		order->xMaxPlusOne = xMaxPlusOne;
 		order->yMaxPlusOne = yMaxPlusOne;
+		order->tileIndex = tileIndex;
+		order->passIndex = passIndex;
+		fplAtomicStoreU32(&order->finishedRowCount, 0);
+		// @NOTE(final): Rows become claimable only after all other fields are written
+		fplAtomicStoreU64(&order->rowState, generationBits);
+		// @NOTE(final): Publish the order after it is fully written, because workers may already pop while we push
+		fplAtomicStoreU32(&workOrderCount, index + 1);
 	}
 
 	bool Pop(u32 &outIndex) {
-		if (IsEmpty() || fplAtomicLoadU32(&nextWorkOrderIndex) >= workOrderCount) {
-			return(false);
+		// @NOTE(final): Compare-and-swap instead of fetch-and-add, so the index never overshoots the work order count.
+		// Otherwise a late worker may skip the first order of the next pass, which then would never be finished.
+		while (true) {
+			u32 index = fplAtomicLoadU32(&nextWorkOrderIndex);
+			if (index >= workOrderCount) {
+				return(false);
+			}
+			if (fplAtomicIsCompareAndSwapU32(&nextWorkOrderIndex, index, index + 1)) {
+				outIndex = index;
+				return(true);
+			}
+		}
+	}
+
+	// Finds the order with the most unclaimed rows, used by idle workers when there are no orders left to pop
+	bool Steal(const u32 expectedGeneration, u32 &outIndex) {
+		u32 count = fplAtomicLoadU32(&workOrderCount);
+		u32 maxRemainingRows = 0;
+		for (u32 index = 0; index < count; ++index) {
+			WorkOrder *order = orders + index;
+			u64 state = fplAtomicLoadU64(&order->rowState);
+			if ((u32)(state >> 32) != expectedGeneration) {
+				continue;
+			}
+			u32 nextRow = (u32)(state & 0xFFFFFFFF);
+			u32 rowCount = order->GetRowCount();
+			if (nextRow < rowCount && (rowCount - nextRow) > maxRemainingRows) {
+				maxRemainingRows = rowCount - nextRow;
+				outIndex = index;
+			}
+		}
+		return(maxRemainingRows > 0);
+	}
+
+	// Claims the next row of the order, returns false when all rows are claimed or the order belongs to another generation
+	bool ClaimRow(WorkOrder *order, const u32 expectedGeneration, u32 &outRow) {
+		while (true) {
+			u64 state = fplAtomicLoadU64(&order->rowState);
+			if ((u32)(state >> 32) != expectedGeneration) {
+				return(false);
+			}
+			u32 nextRow = (u32)(state & 0xFFFFFFFF);
+			if (nextRow >= order->GetRowCount()) {
+				return(false);
+			}
+			if (fplAtomicIsCompareAndSwapU64(&order->rowState, state, state + 1)) {
+				outRow = nextRow;
+				return(true);
+			}
 		}
-		u32 index = fplAtomicFetchAndAddU32(&nextWorkOrderIndex, 1);
-		fplAssert(index < workOrderCount);
-		outIndex = index;
-		return(true);
 	}
 };
 
@@ -534,6 +727,24 @@ struct Worker {
 	fplMutexHandle lockMutex;
 	fplConditionVariable nonEmptyCondition;
 
+	// Statistics, written by the worker only
+	fplSeconds busyTime;
+	u64 rayCount;
+	u32 tileCount;
+	u32 rowCount;
+	u32 stolenRowCount;
+#if QUEUE_ADD_CACHELINE_PADDING_TO_VOLATILES == 1
+	u8 cacheline_padding3[64];
+#endif
+
+	inline void ResetStatistics() {
+		busyTime = 0;
+		rayCount = 0;
+		tileCount = 0;
+		rowCount = 0;
+		stolenRowCount = 0;
+	}
+
 	inline void Start() {
 		fplAtomicExchangeS32((volatile s32 *)&state, (s32)WorkerState::Running);
 	}
@@ -586,11 +797,237 @@ static bool RaySphereIntersection(const Ray3f &ray, const Sphere3f &sphere, f32
 	return(false);
 }
 
+static bool RayTriangleIntersection(const Ray3f &ray, const Triangle3f &triangle, f32 &out, const float tolerance) {
+	Vec3f e1 = triangle.b - triangle.a;
+	Vec3f e2 = triangle.c - triangle.a;
+	Vec3f h = V3fCross(ray.direction, e2);
+	f32 a = V3fDot(e1, h);
+	if ((a > -tolerance) && (a < tolerance)) {
+		return(false);
+	}
+	f32 f = 1.0f / a;
+	Vec3f s = ray.origin - triangle.a;
+	f32 u = f * V3fDot(s, h);
+	if ((u < 0.0f) || (u > 1.0f)) {
+		return(false);
+	}
+	Vec3f q = V3fCross(s, e1);
+	f32 v = f * V3fDot(ray.direction, q);
+	if ((v < 0.0f) || ((u + v) > 1.0f)) {
+		return(false);
+	}
+	out = f * V3fDot(e2, q);
+	return(true);
+}
+
+struct TraceHit {
+	Vec3f normal;
+	f32 distance;
+	// Zero means nothing was hit
+	u32 materialIndex;
+};
+
+#if USE_BVH && USE_RAY_PACKETS
+const u32 RayBatchSize = BVH_PACKET_WIDTH;
+#else
+const u32 RayBatchSize = 1;
+#endif
+
+static void IntersectObject(const Object &obj, const Ray3f &ray, const f32 minHitDistance, TraceHit &hit) {
+	const f32 tolerance = 1e-6f;
+	f32 t = -F32_MAX;
+	switch (obj.kind) {
+		case ObjectKind::Plane:
+		{
+			if (RayPlaneIntersection(ray, obj.plane, t, tolerance)) {
+				if ((t > minHitDistance) && (t < hit.distance)) {
+					hit.distance = t;
+					hit.materialIndex = obj.materialIndex;
+					hit.normal = obj.plane.normal;
+				}
+			}
+		} break;
+
+		case ObjectKind::Sphere:
+		{
+			if (RaySphereIntersection(ray, obj.sphere, t, tolerance)) {
+				if ((t > minHitDistance) && (t < hit.distance)) {
+					hit.distance = t;
+					hit.materialIndex = obj.materialIndex;
+					Vec3f relativeOrigin = ray.origin - obj.sphere.origin;
+					hit.normal = V3fNormalize(t * ray.direction + relativeOrigin);
+				}
+			}
+		} break;
+
+		case ObjectKind::Triangle:
+		{
+			if (RayTriangleIntersection(ray, obj.triangle, t, tolerance)) {
+				if ((t > minHitDistance) && (t < hit.distance)) {
+					hit.distance = t;
+					hit.materialIndex = obj.materialIndex;
+					hit.normal = V3fNormalize(V3fCross(obj.triangle.b - obj.triangle.a, obj.triangle.c - obj.triangle.a));
+					if (V3fDot(hit.normal, ray.direction) > 0.0f) {
+						hit.normal = -hit.normal;
+					}
+				}
+			}
+		} break;
+
+		default:
+			break;
+	}
+}
+
+#if !(USE_BVH && USE_RAY_PACKETS)
+static TraceHit TraceRay(const Scene *scene, const Ray3f &ray, const f32 minHitDistance) {
+	TraceHit result = {};
+	result.distance = F32_MAX;
+#if USE_BVH
+	for (u32 objectIndex : scene->unboundedObjects) {
+		IntersectObject(scene->objects[objectIndex], ray, minHitDistance, result);
+	}
+	f32 tMax = result.distance;
+	u32 primIndex = IntersectBVH(scene->bvh, ray, minHitDistance, tMax);
+	if (primIndex != BVH_NO_HIT) {
+		const BVHPrimitive &prim = scene->bvh.primitives[primIndex];
+		result.distance = tMax;
+		result.materialIndex = prim.materialIndex;
+		result.normal = GetBVHPrimitiveNormal(prim, ray.origin + tMax * ray.direction, ray.direction);
+	}
+#else
+	for (const Object &obj : scene->objects) {
+		IntersectObject(obj, ray, minHitDistance, result);
+	}
+#endif
+	return(result);
+}
+#endif
+
+// Traces up to RayBatchSize rays, only rays with the bit set in activeMask are traced
+static void TraceRays(const Scene *scene, const Ray3f *rays, const u32 activeMask, const f32 minHitDistance, TraceHit *outHits) {
+#if USE_BVH && USE_RAY_PACKETS
+	BVHRayPacket packet;
+	packet.activeMask = (int)activeMask;
+	for (u32 lane = 0; lane < RayBatchSize; ++lane) {
+		if (!(activeMask & (1 << lane))) {
+			continue;
+		}
+		TraceHit &hit = outHits[lane];
+		hit = {};
+		hit.distance = F32_MAX;
+		for (u32 objectIndex : scene->unboundedObjects) {
+			IntersectObject(scene->objects[objectIndex], rays[lane], minHitDistance, hit);
+		}
+		SetBVHRayPacketLane(packet, lane, rays[lane], hit.distance);
+	}
+	IntersectBVHPacket(scene->bvh, packet, minHitDistance);
+	for (u32 lane = 0; lane < RayBatchSize; ++lane) {
+		if ((activeMask & (1 << lane)) && (packet.primIndex[lane] != BVH_NO_HIT)) {
+			const Ray3f &ray = rays[lane];
+			const BVHPrimitive &prim = scene->bvh.primitives[packet.primIndex[lane]];
+			TraceHit &hit = outHits[lane];
+			hit.distance = packet.tMax[lane];
+			hit.materialIndex = prim.materialIndex;
+			hit.normal = GetBVHPrimitiveNormal(prim, ray.origin + hit.distance * ray.direction, ray.direction);
+		}
+	}
+#else
+	for (u32 lane = 0; lane < RayBatchSize; ++lane) {
+		if (activeMask & (1 << lane)) {
+			outHits[lane] = TraceRay(scene, rays[lane], minHitDistance);
+		}
+	}
+#endif
+}
+
+// SplitMix64 finalizer, used to derive independent random streams
+static u64 MixSeed(const u64 seed, const u64 value) {
+	u64 z = seed + (value + 1) * UINT64_C(0x9E3779B97F4A7C15);
+	z = (z ^ (z >> 30)) * UINT64_C(0xBF58476D1CE4E5B9);
+	z = (z ^ (z >> 27)) * UINT64_C(0x94D049BB133111EB);
+	z = z ^ (z >> 31);
+	return(z != 0 ? z : 1);
+}
+
+constexpr f32 AdaptiveLuminanceBias = 1e-3f;
+
+inline f32 Luminance(const Vec3f &color) {
+	f32 result = 0.2126f * color.r + 0.7152f * color.g + 0.0722f * color.b;
+	return(result);
+}
+
+// Traces the paths for up to RayBatchSize camera rays and adds the gathered light to the samples, returns the number of traced rays
+static u32 TracePaths(const Scene *scene, const u32 maxBounceCount, RandomSeries *rnd, Ray3f *rays, u32 activeMask, Vec3f *outSamples) {
+	fplAssert(scene->materials.size() > 0);
+	const Material &defaultMaterial = scene->materials[0];
+
+	// @NOTE(final): Small offset, so bounced rays dont hit the surface they are starting from
+	const f32 minHitDistance = 1e-4f;
+
+	Vec3f attenuations[RayBatchSize];
+	for (u32 lane = 0; lane < RayBatchSize; ++lane) {
+		attenuations[lane] = V3fInit(1, 1, 1);
+	}
+
+	u32 rayCount = 0;
+	for (u32 bounceIndex = 0; (bounceIndex < maxBounceCount) && (activeMask != 0); ++bounceIndex) {
+		TraceHit hits[RayBatchSize];
+		TraceRays(scene, rays, activeMask, minHitDistance, hits);
+
+		for (u32 lane = 0; lane < RayBatchSize; ++lane) {
+			if (!(activeMask & (1 << lane))) {
+				continue;
+			}
+			++rayCount;
+
+			Ray3f &ray = rays[lane];
+			const TraceHit &hit = hits[lane];
+			Vec3f &sample = outSamples[lane];
+			Vec3f &attenuation = attenuations[lane];
+
+			if (hit.materialIndex) {
+				fplAssert(hit.materialIndex < scene->materials.size());
+				const Material &hitMaterial = scene->materials[hit.materialIndex];
+
+				sample += V3fHadamard(attenuation, hitMaterial.emitColor);
+
+				f32 cosineAttenuation = V3fDot(-ray.direction, hit.normal);
+				if (cosineAttenuation < 0) {
+					cosineAttenuation = 0;
+				}
+				attenuation = V3fHadamard(attenuation, cosineAttenuation * hitMaterial.reflectColor);
+
+				Vec3f pureBounce = ray.direction - 2.0f * V3fDot(ray.direction, hit.normal) * hit.normal;
+
+#if 1
+				// @NOTE(final): This is NOT a proper way to produce a random bounce. Do proper distribution based bounce
+				Vec3f randomAddon = V3fInit(RandomBilateral(rnd), RandomBilateral(rnd), RandomBilateral(rnd));
+				Vec3f randomBounce = V3fNormalize(hit.normal + randomAddon);
+#else
+				Vec3f randomBounce = RandomUnitHemisphere(rnd);
+#endif
+
+				// Ray for next bounce
+				ray.origin += hit.distance * ray.direction;
+				ray.direction = V3fNormalize(V3fLerp(randomBounce, hitMaterial.scatter, pureBounce));
+			} else {
+				sample += V3fHadamard(attenuation, defaultMaterial.emitColor);
+				activeMask &= ~(1 << lane);
+			}
+		}
+	}
+
+	return(rayCount);
+}
+
+// Adds the samples of one pass to the accumulation buffer for one row of a tile.
+// Neighboring pixels of a row are traced together, so each ray packet contains coherent camera rays.
 // @NOTE(final): "Order" must be volatile, otherwise the compile may reorder instructions here
 #if FIX_WRONG_INSTRUCTION_REORDER_IN_RELEASE
-static bool RaytracePart(Worker &worker, volatile WorkOrder &order) {
+static bool RaytraceRow(Worker &worker, volatile WorkOrder &order, const u32 row) {
 #else
-static bool RaytracePart(Worker &worker, WorkOrder &order) {
+static bool RaytraceRow(Worker &worker, WorkOrder &order, const u32 row) {
 #endif
 	const Scene *scene = order.scene;
 	Raytracer *raytracer = order.raytracer;
@@ -598,6 +1035,15 @@ static bool RaytracePart(Worker &worker, WorkOrder &order) {
 	fplAssert(raytracer != fpl_null);
 
 	Image32 &image = raytracer->image;
+	const RaytracerSettings &settings = raytracer->settings;
+
+	fplAssert(order.tileIndex < (raytracer->tiling.tileCountX * raytracer->tiling.tileCountY));
+	const TileState &tile = raytracer->tiles[order.tileIndex];
+	fplAssert(!tile.isConverged);
+
+	// Each row gets its own random stream, derived from the tile, the pass and the row.
+	// This way no random state is shared between workers and the image is reproducible, regardless of which worker traces which row.
+	RandomSeries rnd = RandomSeed(MixSeed(MixSeed(MixSeed(raytracer->seed, order.tileIndex), order.passIndex), row));
 
 	const f32 fov = scene->camera.fov;
 	const f32 halfTan = Tan(fov * 0.5f);
@@ -616,38 +1062,38 @@ static bool RaytracePart(Worker &worker, WorkOrder &order) {
 	f32 filmDistance = 1.0f;
 	Vec3f filmCenter = cameraPosition - filmDistance * cameraZ;
 
-	u32 raysPerPixel = raytracer->settings.raysPerPixelCount;
-	u32 maxBounceCount = raytracer->settings.maxBounceCount;
-
-	f32 contrib = 1.0f / (f32)raysPerPixel;
-
-	fplAssert(scene->materials.size() > 0);
-	const Material &defaultMaterial = scene->materials[0];
+	fplAssert(tile.sampleCount < settings.raysPerPixelCount);
+	u32 passSampleCount = fplMin(settings.samplesPerPass, settings.raysPerPixelCount - tile.sampleCount);
+	u32 newSampleCount = tile.sampleCount + passSampleCount;
+	f32 invSampleCount = 1.0f / (f32)newSampleCount;
 
-	for (u32 y = order.yMin; y < order.yMaxPlusOne; ++y) {
-		u32 inverseY = (image.height - 1 - y);
+	f32 sumRelativeError = 0.0f;
 
-		Pixel *row = &image.pixels[inverseY * image.width];
+	u32 y = order.yMin + row;
+	u32 inverseY = (image.height - 1 - y);
 
-		f32 ratioY = (f32)y / (f32)image.height;
-		f32 filmY = -1.0f + 2.0f * ratioY;
+	f32 ratioY = (f32)y / (f32)image.height;
+	f32 filmY = -1.0f + 2.0f * ratioY;
 
-		Pixel *col = row + order.xMin;
-		for (u32 x = order.xMin; x < order.xMaxPlusOne; ++x) {
-			if (worker.IsStopped())
-				return(false);
+	for (u32 x = order.xMin; x < order.xMaxPlusOne; x += RayBatchSize) {
+		if (worker.IsStopped())
+			return(false);
 
-			f32 ratioX = (f32)x / (f32)image.width;
-			f32 filmX = -1.0f + 2.0f * ratioX;
+		u32 laneCount = fplMin(RayBatchSize, order.xMaxPlusOne - x);
 
-			Vec3f finalColor = {};
+		Vec3f passColors[RayBatchSize] = {};
+		f32 passLuminanceSquares[RayBatchSize] = {};
 
-			for (u32 rayIndex = 0; rayIndex < raysPerPixel; ++rayIndex) {
-				if (worker.IsStopped())
-					return(false);
+		for (u32 sampleIndex = 0; sampleIndex < passSampleCount; ++sampleIndex) {
+			Ray3f rays[RayBatchSize];
+			Vec3f samples[RayBatchSize];
+			u32 activeMask = 0;
+			for (u32 lane = 0; lane < laneCount; ++lane) {
+				f32 ratioX = (f32)(x + lane) / (f32)image.width;
+				f32 filmX = -1.0f + 2.0f * ratioX;
 
-				f32 offsetX = RandomBilateral(&raytracer->rnd) * halfPixelSize.w;
-				f32 offsetY = RandomBilateral(&raytracer->rnd) * halfPixelSize.h;
+				f32 offsetX = RandomBilateral(&rnd) * halfPixelSize.w;
+				f32 offsetY = RandomBilateral(&rnd) * halfPixelSize.h;
 
 				f32 perspectiveX = (filmX + offsetX) * halfTan * aspectRatio;
 				f32 perspectiveY = (filmY + offsetY) * halfTan;
@@ -657,100 +1103,75 @@ static bool RaytracePart(Worker &worker, WorkOrder &order) {
 				Vec3f rayOrigin = cameraPosition;
 				Vec3f rayDirection = V3fNormalize(filmP - cameraPosition);
 
-				Ray3f ray = MakeRay(rayOrigin, rayDirection);
-
-				const f32 tolerance = 1e-6f;
-				f32 minHitDistance = 0.0f;
-
-				Vec3f sample = {};
-				Vec3f attenuation = V3fInit(1, 1, 1);
-
-				for (u32 bounceIndex = 0; bounceIndex < maxBounceCount; ++bounceIndex) {
-					if (worker.IsStopped())
-						return(false);
+				rays[lane] = MakeRay(rayOrigin, rayDirection);
+				samples[lane] = V3fZero();
+				activeMask |= (1 << lane);
+			}
 
-					f32 hitDistance = F32_MAX;
-					u32 hitMaterialIndex = 0;
-					Vec3f hitNormal = V3fZero();
+			worker.rayCount += TracePaths(scene, settings.maxBounceCount, &rnd, rays, activeMask, samples);
 
-					for (u32 objectIndex = 0, objectCount = (u32)scene->objects.size(); objectIndex < objectCount; ++objectIndex) {
-						if (worker.IsStopped())
-							return(false);
+			for (u32 lane = 0; lane < laneCount; ++lane) {
+				passColors[lane] += samples[lane];
+				f32 luminance = Luminance(samples[lane]);
+				passLuminanceSquares[lane] += luminance * luminance;
+			}
+		}
 
-						const Object *obj = &scene->objects[objectIndex];
+		for (u32 lane = 0; lane < laneCount; ++lane) {
+			u32 pixelIndex = inverseY * image.width + x + lane;
 
-						f32 t = -F32_MAX;
-						bool isHit = false;
-						if (obj->kind == ObjectKind::Plane) {
-							if (RayPlaneIntersection(ray, obj->plane, t, tolerance)) {
-								if ((t > minHitDistance) && (t < hitDistance)) {
-									hitDistance = t;
-									hitMaterialIndex = obj->materialIndex;
-									hitNormal = obj->plane.normal;
-								}
-							}
-						} else if (obj->kind == ObjectKind::Sphere) {
-							if (RaySphereIntersection(ray, obj->sphere, t, tolerance)) {
-								if ((t > minHitDistance) && (t < hitDistance)) {
-									hitDistance = t;
-									hitMaterialIndex = obj->materialIndex;
-									Vec3f relativeOrigin = ray.origin - obj->sphere.origin;
-									hitNormal = V3fNormalize(t * ray.direction + relativeOrigin);
-								}
-							}
-						}
-					}
+			Vec3f &accumulated = raytracer->accumulation[pixelIndex];
+			f32 &luminanceSquares = raytracer->luminanceSquares[pixelIndex];
+			accumulated += passColors[lane];
+			luminanceSquares += passLuminanceSquares[lane];
 
-					if (hitMaterialIndex) {
-						fplAssert(hitMaterialIndex < scene->materials.size());
-						const Material &hitMaterial = scene->materials[hitMaterialIndex];
+			Vec3f finalColor = accumulated * invSampleCount;
+			image.pixels[pixelIndex] = LinearToPixelSRGB(V4fInitXYZ(finalColor, 1.0f));
 
-						sample += V3fHadamard(attenuation, hitMaterial.emitColor);
+			if (settings.isAdaptive) {
+				// Relative standard error of the mean luminance, dark pixels are biased so they do not dominate the error
+				f32 meanLuminance = Luminance(finalColor);
+				f32 variance = Max(0.0f, luminanceSquares * invSampleCount - meanLuminance * meanLuminance);
+				f32 relativeError = SquareRoot(variance * invSampleCount) / (meanLuminance + AdaptiveLuminanceBias);
+				sumRelativeError += relativeError;
+			}
+		}
+	}
 
-						f32 cosineAttenuation = V3fDot(-ray.direction, hitNormal);
-						if (cosineAttenuation < 0) {
-							cosineAttenuation = 0;
-						}
-						attenuation = V3fHadamard(attenuation, cosineAttenuation * hitMaterial.reflectColor);
+	raytracer->tileRowErrors[order.tileIndex * raytracer->tiling.tileSizeY + row] = sumRelativeError;
 
-						Vec3f pureBounce = ray.direction - 2.0f * V3fDot(ray.direction, hitNormal) * hitNormal;
+	return(true);
+}
 
-#if 1
-						// @NOTE(final): This is NOT a proper way to produce a random bounce. Do proper distribution based bounce
-						Vec3f randomAddon = V3fInit(RandomBilateral(&raytracer->rnd), RandomBilateral(&raytracer->rnd), RandomBilateral(&raytracer->rnd));
-						Vec3f randomBounce = V3fNormalize(hitNormal + randomAddon);
+// Updates the sample count and the convergence state of the tile, after all rows of the order are finished
+#if FIX_WRONG_INSTRUCTION_REORDER_IN_RELEASE
+static void FinishTile(volatile WorkOrder &order) {
 #else
-						Vec3f randomBounce = RandomUnitHemisphere(&raytracer.rnd);
+static void FinishTile(WorkOrder &order) {
 #endif
+	Raytracer *raytracer = order.raytracer;
+	const RaytracerSettings &settings = raytracer->settings;
+	TileState &tile = raytracer->tiles[order.tileIndex];
 
-						// Ray for next bounce
-						ray.origin += hitDistance * ray.direction;
-						ray.direction = V3fNormalize(V3fLerp(randomBounce, hitMaterial.scatter, pureBounce));
-					} else {
-						sample += V3fHadamard(attenuation, defaultMaterial.emitColor);
-						break;
-					}
-				}
-
-				finalColor += contrib * sample;
-			}
-
-			Pixel outputPixel = LinearToPixelSRGB(V4fInitXYZ(finalColor, 1.0f));
-			*col = outputPixel;
-			++col;
-		}
+	u32 rowCount = order.GetRowCount();
+	f32 sumRelativeError = 0.0f;
+	for (u32 row = 0; row < rowCount; ++row) {
+		sumRelativeError += raytracer->tileRowErrors[order.tileIndex * raytracer->tiling.tileSizeY + row];
+	}
+	u32 tilePixelCount = (order.xMaxPlusOne - order.xMin) * rowCount;
+	f32 tileError = sumRelativeError / (f32)tilePixelCount;
 
-		++row;
+	u32 passSampleCount = fplMin(settings.samplesPerPass, settings.raysPerPixelCount - tile.sampleCount);
+	u32 newSampleCount = tile.sampleCount + passSampleCount;
 
-		if (worker.IsStopped())
-			return(false);
+	tile.sampleCount = newSampleCount;
+	if (newSampleCount >= settings.raysPerPixelCount) {
+		tile.isConverged = true;
+	} else if (settings.isAdaptive && (newSampleCount >= settings.adaptiveMinSamples) && (tileError < settings.adaptiveThreshold)) {
+		tile.isConverged = true;
 	}
-
-	return(true);
 }
 
-
-
 #if USE_OPENGL_NO_RAYTRACE
 static void InitGL() {
 	glClearColor(0.0f, 0.0f, 0.0f, 1.0f);
@@ -794,68 +1215,215 @@ static void InitScene(Scene &scene) {
 	scene.AddSphere(V3fInit(-1.0f, -0.75f, 0.9f), 0.3f, blueMat);
 }
 
-static void InitRaytracer(Raytracer &raytracer, const u32 raytraceWidth, const u32 raytraceHeight) {
+// Stress scene with a field of small spheres and a triangle mesh, for testing the acceleration structure
+static void InitSphereFieldScene(Scene &scene, const u32 sphereCount) {
+	scene.camera.eye = V3fInit(0, -10, 3);
+	scene.camera.target = V3fInit(0, 0, 0);
+	scene.camera.up = UnitUp;
+	scene.camera.fov = DegreesToRadians(30.0f);
+	scene.camera.zNear = 0.5f;
+	scene.camera.zFar = 100.0f;
+
+	scene.AddMaterial(V3fInit(0.152f, 0.22745f, 0.3647f), {});
+
+	u32 floorMat = scene.AddMaterial(V3fInit(0, 0.0f, 0), V3fInit(0.5f, 0.5f, 0.5f), 0.5f);
+	u32 meshMat = scene.AddMaterial(V3fInit(0.0f, 0.0f, 0.0f), V3fInit(0.9f, 0.9f, 0.2f), 0.9f);
+	u32 sphereMats[] = {
+		scene.AddMaterial(V3fInit(0.0f, 0.0f, 0.0f), V3fInit(1.0f, 1.0f, 1.0f), 1.0f),
+		scene.AddMaterial(V3fInit(0.25f, 0.0f, 0.0f), V3fInit(1.0f, 0.0f, 0.0f), 1.0f),
+		scene.AddMaterial(V3fInit(0.0f, 0.25f, 0.0f), V3fInit(0.0f, 1.0f, 0.0f), 0.5f),
+		scene.AddMaterial(V3fInit(0.0f, 0.0f, 0.25f), V3fInit(0.0f, 0.0f, 1.0f), 0.2f),
+	};
+
+	scene.AddPlane(V3fInit(0, 0, 1), 0.0f, floorMat);
+
+	RandomSeries series = RandomSeed(4711);
+	const f32 fieldSize = 8.0f;
+	u32 gridSize = (u32)SquareRoot((f32)sphereCount);
+	if (gridSize == 0) {
+		gridSize = 1;
+	}
+	const f32 spacing = fieldSize / (f32)gridSize;
+	const f32 radius = spacing * 0.4f;
+	for (u32 sphereIndex = 0; sphereIndex < sphereCount; ++sphereIndex) {
+		u32 gx = sphereIndex % gridSize;
+		u32 gy = sphereIndex / gridSize;
+		f32 x = -fieldSize * 0.5f + (gx + 0.5f) * spacing;
+		f32 y = -fieldSize * 0.5f + (gy + 0.5f) * spacing;
+		f32 z = radius + RandomUnilateral(&series) * radius;
+		u32 mat = sphereMats[RandomU32(&series) % fplArrayCount(sphereMats)];
+		scene.AddSphere(V3fInit(x, y, z), radius, mat);
+	}
+
+	// Octahedron mesh in the center of the field
+	const Vec3f octaVertices[] = {
+		V3fInit(1, 0, 0), V3fInit(-1, 0, 0),
+		V3fInit(0, 1, 0), V3fInit(0, -1, 0),
+		V3fInit(0, 0, 1), V3fInit(0, 0, -1),
+	};
+	const u32 octaIndices[] = {
+		0, 2, 4,	2, 1, 4,	1, 3, 4,	3, 0, 4,
+		2, 0, 5,	1, 2, 5,	3, 1, 5,	0, 3, 5,
+	};
+	scene.AddTriangleMesh(octaVertices, fplArrayCount(octaVertices), octaIndices, fplArrayCount(octaIndices), V3fInit(0, 0, 1.5f), 1.0f, meshMat);
+}
+
+static void ResetRaytracer(Raytracer &raytracer) {
+	const Image32 &image = raytracer.image;
+	const TilingInfo &tiling = raytracer.tiling;
+	fplMemoryClear(raytracer.accumulation, sizeof(*raytracer.accumulation) * image.width * image.height);
+	fplMemoryClear(raytracer.luminanceSquares, sizeof(*raytracer.luminanceSquares) * image.width * image.height);
+	fplMemoryClear(raytracer.tiles, sizeof(*raytracer.tiles) * tiling.tileCountX * tiling.tileCountY);
+	raytracer.passIndex = 0;
+}
+
+static bool IsRaytracerFinished(const Raytracer &raytracer) {
+	const u32 tileCount = raytracer.tiling.tileCountX * raytracer.tiling.tileCountY;
+	for (u32 tileIndex = 0; tileIndex < tileCount; ++tileIndex) {
+		if (!raytracer.tiles[tileIndex].isConverged) {
+			return(false);
+		}
+	}
+	return(true);
+}
+
+static void InitRaytracer(Raytracer &raytracer, const TilingInfo &tiling) {
 	Image32 &raytraceImage = raytracer.image;
-	raytraceImage.width = raytraceWidth;
-	raytraceImage.height = raytraceHeight;
+	raytraceImage.width = tiling.imageW;
+	raytraceImage.height = tiling.imageH;
 	raytraceImage.pixels = (Pixel *)fplMemoryAllocate(sizeof(Pixel) * raytraceImage.width * raytraceImage.height);
 	raytraceImage.Fill(MakePixelFromRGBA(0, 0, 0, 255));
 
+	raytracer.tiling = tiling;
+	raytracer.accumulation = (Vec3f *)fplMemoryAllocate(sizeof(*raytracer.accumulation) * raytraceImage.width * raytraceImage.height);
+	raytracer.luminanceSquares = (f32 *)fplMemoryAllocate(sizeof(*raytracer.luminanceSquares) * raytraceImage.width * raytraceImage.height);
+	raytracer.tiles = (TileState *)fplMemoryAllocate(sizeof(*raytracer.tiles) * tiling.tileCountX * tiling.tileCountY);
+	raytracer.tileRowErrors = (f32 *)fplMemoryAllocate(sizeof(*raytracer.tileRowErrors) * tiling.tileCountX * tiling.tileCountY * tiling.tileSizeY);
+
 	raytracer.halfPixelSize.w = 0.5f / (f32)raytraceImage.width;
 	raytracer.halfPixelSize.h = 0.5f / (f32)raytraceImage.height;
 
-	//raytracer.rnd = RandomSeed(fplTimeMilliseconds() % U64_MAX);
-	raytracer.rnd = RandomSeed(1337);
+	//raytracer.seed = fplTimeMilliseconds();
+	raytracer.seed = 1337;
 	raytracer.settings.maxBounceCount = 4;
-	raytracer.settings.raysPerPixelCount = 32;
+	raytracer.settings.raysPerPixelCount = 128;
+	raytracer.settings.samplesPerPass = 1;
+	raytracer.settings.isAdaptive = true;
+	raytracer.settings.adaptiveMinSamples = 8;
+	raytracer.settings.adaptiveThreshold = 0.03f;
+
+	ResetRaytracer(raytracer);
 }
 
-static void InitApp(App &app, const u32 raytraceWidth, const u32 raytraceHeight) {
+static void InitApp(App &app, const TilingInfo &tiling) {
 #if USE_OPENGL_NO_RAYTRACE
 	InitGL();
 #endif
 
+#if SCENE_SPHERE_FIELD_COUNT > 0
+	InitSphereFieldScene(app.scene, SCENE_SPHERE_FIELD_COUNT);
+#else
 	InitScene(app.scene);
-	InitRaytracer(app.raytracer, raytraceWidth, raytraceHeight);
+#endif
+	app.scene.BuildAccelerationStructure();
+	InitRaytracer(app.raytracer, tiling);
+}
+
+// Removes every second bit and compacts the remaining bits, used for decoding a 2D morton code
+static u32 MortonCompactBits(u32 value) {
+	value &= 0x55555555;
+	value = (value ^ (value >> 1)) & 0x33333333;
+	value = (value ^ (value >> 2)) & 0x0F0F0F0F;
+	value = (value ^ (value >> 4)) & 0x00FF00FF;
+	value = (value ^ (value >> 8)) & 0x0000FFFF;
+	return(value);
 }
 
-static void FillQueue(App &app, WorkQueue &queue, const TilingInfo &tilingInfo) {
+// Pushes one work order for each tile, which is not converged yet.
+// Tiles are pushed along a Z-curve, so tiles which are traced at the same time are close to each other and share more of the scene in the caches.
+static void FillQueue(App &app, WorkQueue &queue) {
 	queue.Reset();
 
 	fplAssert(queue.completionCount == 0);
 	fplAssert(queue.workOrderCount == 0);
 	fplAssert(queue.nextWorkOrderIndex == 0);
 
-	u32 totalTileCount = tilingInfo.tileCountX * tilingInfo.tileCountY;
+	Raytracer &raytracer = app.raytracer;
+	const TilingInfo &tilingInfo = raytracer.tiling;
+	u32 passIndex = raytracer.passIndex++;
 
-	for (u32 tileY = 0; tileY < tilingInfo.tileCountY; ++tileY) {
-		for (u32 tileX = 0; tileX < tilingInfo.tileCountX; ++tileX) {
-			u32 minX = tileX * tilingInfo.tileSizeX;
-			u32 minY = tileY * tilingInfo.tileSizeY;
-			u32 maxXPlusOne = fplMin(minX + tilingInfo.tileSizeX, tilingInfo.imageW);
-			u32 maxYPlusOne = fplMin(minY + tilingInfo.tileSizeY, tilingInfo.imageH);
-			queue.Push(&app.raytracer, &app.scene, minX, minY, maxXPlusOne, maxYPlusOne);
+	u32 curveSize = 1;
+	while (curveSize < tilingInfo.tileCountX || curveSize < tilingInfo.tileCountY) {
+		curveSize <<= 1;
+	}
+	fplAssert(curveSize <= 0xFFFF);
+
+	u32 curveLength = curveSize * curveSize;
+	for (u32 mortonCode = 0; mortonCode < curveLength; ++mortonCode) {
+		u32 tileX = MortonCompactBits(mortonCode);
+		u32 tileY = MortonCompactBits(mortonCode >> 1);
+		if (tileX >= tilingInfo.tileCountX || tileY >= tilingInfo.tileCountY) {
+			continue;
+		}
+		u32 tileIndex = tileY * tilingInfo.tileCountX + tileX;
+		if (raytracer.tiles[tileIndex].isConverged) {
+			continue;
 		}
+		u32 minX = tileX * tilingInfo.tileSizeX;
+		u32 minY = tileY * tilingInfo.tileSizeY;
+		u32 maxXPlusOne = fplMin(minX + tilingInfo.tileSizeX, tilingInfo.imageW);
+		u32 maxYPlusOne = fplMin(minY + tilingInfo.tileSizeY, tilingInfo.imageH);
+		queue.Push(&raytracer, &app.scene, minX, minY, maxXPlusOne, maxYPlusOne, tileIndex, passIndex);
 	}
-
-	fplAssert(queue.workOrderCount == totalTileCount);	
 }
 
 static void ReleaseApp(App &app) {
+	fplMemoryFree(app.raytracer.tileRowErrors);
+	fplMemoryFree(app.raytracer.tiles);
+	fplMemoryFree(app.raytracer.luminanceSquares);
+	fplMemoryFree(app.raytracer.accumulation);
 	fplMemoryFree(app.raytracer.image.pixels);
 }
 
+// Traces the rows of the next order from the queue.
+// When there are no orders left, the worker steals the remaining rows from the order with the most unclaimed rows.
 static bool RaytraceFromQueue(Worker *worker) {
-	fplAssert(worker->queue != fpl_null);
+	WorkQueue *queue = worker->queue;
+	fplAssert(queue != fpl_null);
+
+	u32 generation = fplAtomicLoadU32(&queue->generation);
 
 	u32 orderIndex = 0;
+	bool isStolen = false;
+	if (queue->Pop(orderIndex)) {
+		++worker->tileCount;
+	} else if (queue->Steal(generation, orderIndex)) {
+		isStolen = true;
+	} else {
+		return(false);
+	}
+
+	WorkOrder *order = queue->orders + orderIndex;
+
 	bool result = false;
-	if (worker->queue->Pop(orderIndex)) {
-		WorkOrder order = worker->queue->orders[orderIndex];
-		result = RaytracePart(*worker, order);
-		if (result) {
-			fplAtomicIncrementU32(&worker->queue->completionCount);
+	u32 row = 0;
+	while (queue->ClaimRow(order, generation, row)) {
+		fplTimestamp startTime = fplTimestampQuery();
+		if (!RaytraceRow(*worker, *order, row)) {
+			return(false);
 		}
+		worker->busyTime += fplTimestampElapsed(startTime, fplTimestampQuery());
+		++worker->rowCount;
+		if (isStolen) {
+			++worker->stolenRowCount;
+		}
+
+		// The worker which finishes the last row, finishes the tile
+		if (fplAtomicIncrementU32(&order->finishedRowCount) == order->GetRowCount()) {
+			FinishTile(*order);
+			fplAtomicIncrementU32(&queue->completionCount);
+		}
+		result = true;
 	}
 
 	return(result);
@@ -865,20 +1433,277 @@ static void WorkerThreadProc(const fplThreadHandle *thread, void *opaqueData) {
 	Worker *worker = (Worker *)opaqueData;
 	worker->Start();
 	while (true) {
-		if (worker->queue->IsEmpty() || worker->queue->IsFinished()) {
-			fplMutexLock(&worker->lockMutex);
+		// @NOTE(final): The queue state is tested while holding the lock, so we never miss a signal from the main thread
+		fplMutexLock(&worker->lockMutex);
+		while ((worker->queue->IsEmpty() || worker->queue->IsFinished()) && !worker->IsStopped()) {
 			fplConditionWait(&worker->nonEmptyCondition, &worker->lockMutex, FPL_TIMEOUT_INFINITE);
-			fplMutexUnlock(&worker->lockMutex);
 		}
+		fplMutexUnlock(&worker->lockMutex);
 		if (worker->IsStopped()) {
 			break;
 		}
-		RaytraceFromQueue(worker);
+		if (!RaytraceFromQueue(worker)) {
+			// All rows are claimed, but other workers are still busy
+			fplThreadYield();
+		}
 	}
 	worker->Stop();
 }
 
+static void PrintWorkerUtilization(const Worker *workers, const u32 workerCount, const fplSeconds renderTime, const u32 passCount) {
+	fplConsoleFormatOut("Finished %u passes in %.3f seconds with %u workers\n", passCount, renderTime, workerCount);
+	fplSeconds totalBusyTime = 0;
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		const Worker *worker = workers + workerIndex;
+		double utilization = renderTime > 0 ? (worker->busyTime / renderTime) * 100.0 : 0.0;
+		fplConsoleFormatOut("  Worker[%2u]: %5.1f%% busy, %u tiles, %u rows, %u stolen rows\n", workerIndex, utilization, worker->tileCount, worker->rowCount, worker->stolenRowCount);
+		totalBusyTime += worker->busyTime;
+	}
+	if (workerCount > 0 && renderTime > 0) {
+		fplConsoleFormatOut("  Average: %5.1f%% busy\n", (totalBusyTime / (renderTime * workerCount)) * 100.0);
+	}
+}
+
+// Creates the workers, threads are started for all workers starting at the given index.
+// Workers before that index are driven by the caller, e.g. the main thread.
+static Worker *CreateWorkers(WorkQueue &queue, const u32 workerCount, const u32 firstThreadIndex) {
+	Worker *workers = new Worker[workerCount];
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		Worker *worker = workers + workerIndex;
+		fplClearStruct(worker);
+		fplMutexInit(&worker->lockMutex);
+		fplConditionInit(&worker->nonEmptyCondition);
+		worker->queue = &queue;
+		if (workerIndex >= firstThreadIndex) {
+			worker->thread = fplThreadCreate(WorkerThreadProc, worker);
+		} else {
+			worker->Start();
+		}
+	}
+	return(workers);
+}
+
+static void SignalWorkers(Worker *workers, const u32 workerCount) {
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		Worker *worker = workers + workerIndex;
+		fplMutexLock(&worker->lockMutex);
+		fplConditionSignal(&worker->nonEmptyCondition);
+		fplMutexUnlock(&worker->lockMutex);
+	}
+}
+
+static void DestroyWorkers(Worker *workers, const u32 workerCount) {
+	// Send stop signal to all workers
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		Worker *worker = workers + workerIndex;
+		fplMutexLock(&worker->lockMutex);
+		fplAtomicStoreS32((volatile s32 *)&worker->state, (s32)WorkerState::Stopped);
+		fplConditionSignal(&worker->nonEmptyCondition);
+		fplMutexUnlock(&worker->lockMutex);
+	}
+
+	// Wait for all threads to finish and terminate unfinished threads
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		Worker *worker = workers + workerIndex;
+		if (worker->thread != fpl_null) {
+			fplThreadWaitForOne(worker->thread, FPL_TIMEOUT_INFINITE);
+			fplThreadTerminate(worker->thread);
+		}
+	}
+
+	// Release worker resources
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		Worker *worker = workers + workerIndex;
+		fplConditionDestroy(&worker->nonEmptyCondition);
+		fplMutexDestroy(&worker->lockMutex);
+	}
+	delete[] workers;
+}
+
+struct OfflineRenderSettings {
+	const char *outputFilePath;
+	u64 seed;
+	u32 width;
+	u32 height;
+	u32 tileSize;
+	u32 samplesPerPixel;
+	u32 maxBounceCount;
+	u32 threadCount;
+	u32 sphereCount;
+	b32 isAdaptive;
+};
+
+static OfflineRenderSettings MakeDefaultOfflineRenderSettings() {
+	OfflineRenderSettings result = {};
+	result.outputFilePath = "render.ppm";
+	result.seed = 1337;
+	result.width = 1280;
+	result.height = 768;
+	result.tileSize = 64;
+	result.samplesPerPixel = 128;
+	result.maxBounceCount = 4;
+	result.threadCount = fplMin(fplMax((u32)fplCPUGetCoreCount(), 1u), (u32)MAX_WORKER_COUNT);
+	result.sphereCount = 0;
+	result.isAdaptive = false;
+	return(result);
+}
+
+static bool ParseOfflineRenderCount(const char *value, u32 *outCount) {
+	s32 count = fplStringToS32(value);
+	if (count <= 0) {
+		return(false);
+	}
+	*outCount = (u32)count;
+	return(true);
+}
+
+// Returns true when the offline render mode was requested, outValid is false when any argument was invalid
+static bool ParseOfflineRenderArguments(const int argc, char **args, OfflineRenderSettings *outSettings, bool *outValid) {
+	bool isRender = false;
+	bool isValid = true;
+	u32 seed = 0;
+	for (int argIndex = 1; argIndex < argc; ++argIndex) {
+		const char *arg = args[argIndex];
+		if (fplIsStringEqual(arg, "--render")) {
+			isRender = true;
+		} else if (fplIsStringEqual(arg, "--adaptive")) {
+			outSettings->isAdaptive = true;
+		} else if (strncmp(arg, "--output=", 9) == 0) {
+			outSettings->outputFilePath = arg + 9;
+			isValid &= GetImageFileFormatFromPath(outSettings->outputFilePath) != ImageFileFormat::Unknown;
+		} else if (strncmp(arg, "--width=", 8) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 8, &outSettings->width);
+		} else if (strncmp(arg, "--height=", 9) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 9, &outSettings->height);
+		} else if (strncmp(arg, "--tile-size=", 12) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 12, &outSettings->tileSize);
+		} else if (strncmp(arg, "--spp=", 6) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 6, &outSettings->samplesPerPixel);
+		} else if (strncmp(arg, "--bounces=", 10) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 10, &outSettings->maxBounceCount);
+		} else if (strncmp(arg, "--threads=", 10) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 10, &outSettings->threadCount) && outSettings->threadCount <= MAX_WORKER_COUNT;
+		} else if (strncmp(arg, "--seed=", 7) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 7, &seed);
+			outSettings->seed = seed;
+		} else if (strncmp(arg, "--spheres=", 10) == 0) {
+			isValid &= ParseOfflineRenderCount(arg + 10, &outSettings->sphereCount);
+		} else {
+			fplConsoleFormatError("Unknown argument '%s'\n", arg);
+			isValid = false;
+		}
+	}
+	*outValid = isValid;
+	return(isRender);
+}
+
+// Renders the scene without a window and writes the image to a file.
+// The main thread is the first worker, so the thread count includes the main thread.
+static int RunOfflineRender(const OfflineRenderSettings &settings) {
+	char cpuName[256] = {};
+	if (fplCPUGetName(cpuName, fplArrayCount(cpuName)) > 0) {
+		fplConsoleFormatOut("CPU: %s\n", cpuName);
+	}
+	fplConsoleFormatOut("Rendering %u x %u with %u spp and %u threads\n", settings.width, settings.height, settings.samplesPerPixel, settings.threadCount);
+
+	TilingInfo tilingInfo = {};
+	tilingInfo.imageW = settings.width;
+	tilingInfo.imageH = settings.height;
+	tilingInfo.tileSizeX = tilingInfo.tileSizeY = settings.tileSize;
+	tilingInfo.tileCountX = (settings.width + settings.tileSize - 1) / settings.tileSize;
+	tilingInfo.tileCountY = (settings.height + settings.tileSize - 1) / settings.tileSize;
+
+	// @NOTE(final): We use the STL to make our life easier, so we need to placement-new-initialize our App structure
+	App app = {};
+	new(&app)App();
+
+	fplTimestamp sceneStartTime = fplTimestampQuery();
+	if (settings.sphereCount > 0) {
+		InitSphereFieldScene(app.scene, settings.sphereCount);
+	} else {
+		InitScene(app.scene);
+	}
+	fplSeconds sceneTime = fplTimestampElapsed(sceneStartTime, fplTimestampQuery());
+
+	fplTimestamp buildStartTime = fplTimestampQuery();
+	app.scene.BuildAccelerationStructure();
+	fplSeconds buildTime = fplTimestampElapsed(buildStartTime, fplTimestampQuery());
+
+	InitRaytracer(app.raytracer, tilingInfo);
+	app.raytracer.seed = settings.seed;
+	app.raytracer.settings.maxBounceCount = settings.maxBounceCount;
+	app.raytracer.settings.raysPerPixelCount = settings.samplesPerPixel;
+	app.raytracer.settings.isAdaptive = settings.isAdaptive;
+
+	WorkQueue queue = {};
+	queue.Init(tilingInfo.tileCountX * tilingInfo.tileCountY);
+
+	u32 workerCount = settings.threadCount;
+	Worker *workers = CreateWorkers(queue, workerCount, 1);
+	Worker *mainWorker = workers + 0;
+
+	fplTimestamp renderStartTime = fplTimestampQuery();
+	while (!IsRaytracerFinished(app.raytracer)) {
+		FillQueue(app, queue);
+		SignalWorkers(workers + 1, workerCount - 1);
+		while (!queue.IsFinished()) {
+			if (!RaytraceFromQueue(mainWorker)) {
+				fplThreadYield();
+			}
+		}
+	}
+	fplSeconds renderTime = fplTimestampElapsed(renderStartTime, fplTimestampQuery());
+
+	fplTimestamp writeStartTime = fplTimestampQuery();
+	bool isWritten = WriteImage(settings.outputFilePath, app.raytracer.image.pixels, app.raytracer.image.width, app.raytracer.image.height);
+	fplSeconds writeTime = fplTimestampElapsed(writeStartTime, fplTimestampQuery());
+
+	u64 rayCount = 0;
+	for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
+		rayCount += workers[workerIndex].rayCount;
+	}
+	const u32 tileCount = tilingInfo.tileCountX * tilingInfo.tileCountY;
+	u64 sampleCount = 0;
+	for (u32 tileIndex = 0; tileIndex < tileCount; ++tileIndex) {
+		sampleCount += app.raytracer.tiles[tileIndex].sampleCount;
+	}
+
+	fplConsoleFormatOut("Scene: %u objects, %u BVH nodes\n", (u32)app.scene.objects.size(), app.scene.bvh.nodeCount);
+	fplConsoleFormatOut("Phases:\n");
+	fplConsoleFormatOut("  Scene setup: %10.3f ms\n", sceneTime * 1000.0);
+	fplConsoleFormatOut("  BVH build:   %10.3f ms\n", buildTime * 1000.0);
+	fplConsoleFormatOut("  Render:      %10.3f ms (%u passes, %.3f ms per pass)\n", renderTime * 1000.0, app.raytracer.passIndex, (renderTime * 1000.0) / (double)fplMax(app.raytracer.passIndex, 1u));
+	fplConsoleFormatOut("  Write:       %10.3f ms\n", writeTime * 1000.0);
+	fplConsoleFormatOut("Rays: %llu total, %.3f MRays/s, average %.2f spp\n", (unsigned long long)rayCount, renderTime > 0 ? ((double)rayCount / renderTime) / 1000000.0 : 0.0, (double)sampleCount / (double)tileCount);
+	PrintWorkerUtilization(workers, workerCount, renderTime, app.raytracer.passIndex);
+
+	DestroyWorkers(workers, workerCount);
+	queue.Release();
+	ReleaseApp(app);
+
+	if (!isWritten) {
+		fplConsoleFormatError("Failed writing image '%s'\n", settings.outputFilePath);
+		return(-1);
+	}
+	fplConsoleFormatOut("Written image '%s'\n", settings.outputFilePath);
+	return(0);
+}
+
 int main(int argc, char **argv) {
+	OfflineRenderSettings offlineSettings = MakeDefaultOfflineRenderSettings();
+	bool isValidArguments = false;
+	if (ParseOfflineRenderArguments(argc, argv, &offlineSettings, &isValidArguments)) {
+		if (!isValidArguments) {
+			return -1;
+		}
+		if (!fplPlatformInit(fplInitFlags_Console, fpl_null)) {
+			return -1;
+		}
+		int result = RunOfflineRender(offlineSettings);
+		fplPlatformRelease();
+		return(result);
+	}
+
 	RandomSeries rnd = {};
 
 	const u32 tileSize = 64;
@@ -923,7 +1748,7 @@ int main(int argc, char **argv) {
 		// @NOTE(final): We use the STL to make our life easier, so we need to placement-new-initialize our App structure
 		App app = {};
 		new(&app)App();
-		InitApp(app, raytraceWidth, raytraceHeight);
+		InitApp(app, tilingInfo);
 
 		// Queue
 		u32 maxTileCount = tilingInfo.tileCountX * tilingInfo.tileCountY;
@@ -933,17 +1758,12 @@ int main(int argc, char **argv) {
 		// Init worker
 		u32 cpuCoreCount = (u32)fplCPUGetCoreCount();
 		fplAssert(cpuCoreCount > 0);
-		u32 workerCount = (u32)cpuCoreCount - 1;
-		Worker *workers = new Worker[workerCount];
-		for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
-			Worker *worker = workers + workerIndex;
-			fplClearStruct(worker);
-			fplMutexInit(&worker->lockMutex);
-			fplConditionInit(&worker->nonEmptyCondition);
-			worker->queue = &queue;
-			worker->thread = fplThreadCreate(WorkerThreadProc, worker);
-		}
+		u32 workerCount = fplMax(fplMin(cpuCoreCount - 1, (u32)MAX_WORKER_COUNT), 1u);
+		Worker *workers = CreateWorkers(queue, workerCount, 0);
 
+		fplTimestamp renderStartTime = fplTimestampQuery();
+		bool isRendering = true;
+		bool reset = false;
 		bool refresh = true;
 		while (fplWindowUpdate()) {
 			fplEvent ev;
@@ -954,53 +1774,47 @@ int main(int argc, char **argv) {
 						if (ev.keyboard.type == fplKeyboardEventType_Button) {
 							if (ev.keyboard.buttonState == fplButtonState_Release &&
 								ev.keyboard.mappedKey == fplKey_Space) {
-								refresh = true;
+								reset = true;
 							}
 						}
 					} break;
 				}
 			}
 
-			if (refresh) {
-				refresh = false;
-				if (queue.IsEmpty() || queue.IsFinished()) {
-					FillQueue(app, queue, tilingInfo);
-
+			// @NOTE(final): Each pass refines all unconverged tiles by one sample,
+			// the next pass is started as soon as the previous one is finished.
+			// A reset is only done between two passes, so no worker writes into the accumulation buffer while we clear it.
+			if (queue.IsEmpty() || queue.IsFinished()) {
+				if (reset) {
+					reset = false;
+					ResetRaytracer(app.raytracer);
 					for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
-						Worker *worker = workers + workerIndex;
-						fplConditionSignal(&worker->nonEmptyCondition);
+						workers[workerIndex].ResetStatistics();
 					}
+					renderStartTime = fplTimestampQuery();
+					isRendering = true;
+					refresh = true;
+				} else if (!IsRaytracerFinished(app.raytracer)) {
+					refresh = true;
+				} else if (isRendering) {
+					isRendering = false;
+					fplSeconds renderTime = fplTimestampElapsed(renderStartTime, fplTimestampQuery());
+					PrintWorkerUtilization(workers, workerCount, renderTime, app.raytracer.passIndex);
 				}
 			}
 
+			if (refresh) {
+				refresh = false;
+				FillQueue(app, queue);
+				SignalWorkers(workers, workerCount);
+			}
+
 			Render(app);
 
 			fplVideoFlip();
 		}
 
-		// Send stop signal to all workers
-		for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
-			Worker *worker = workers + workerIndex;
-			fplAtomicStoreS32((volatile s32 *)&worker->state, (s32)WorkerState::Stopped);
-			fplConditionSignal(&worker->nonEmptyCondition);
-		}
-
-		// Wait for all threads to finish
-		fplThreadWaitForAll(&workers[0].thread, workerCount, sizeof(Worker), FPL_TIMEOUT_INFINITE);
-
-		// Terminate unfinished threads
-		for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
-			Worker *worker = workers + workerIndex;
-			fplThreadTerminate(worker->thread);
-		}
-
-		// Release worker resources
-		for (u32 workerIndex = 0; workerIndex < workerCount; ++workerIndex) {
-			Worker *worker = workers + workerIndex;
-			fplConditionDestroy(&worker->nonEmptyCondition);
-			fplMutexDestroy(&worker->lockMutex);
-		}
-		delete[] workers;
+		DestroyWorkers(workers, workerCount);
 
 		queue.Release();
 
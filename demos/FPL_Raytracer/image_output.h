@@ -0,0 +1,211 @@
+/*
+-------------------------------------------------------------------------------
+Name:
+	FPL-Demo | Raytracer | Image Output
+
+Description:
+	Writes 32-bit pixel images as binary PPM (P6) or as PNG files.
+	PNG files are written with stored (uncompressed) deflate blocks, so no compression library is required.
+
+	Pixels are expected top-down, the alpha channel is ignored.
+
+License:
+	Copyright (c) 2017-2025 Torsten Spaete
+	MIT License (See LICENSE file)
+-------------------------------------------------------------------------------
+*/
+
+#ifndef IMAGE_OUTPUT_H
+#define IMAGE_OUTPUT_H
+
+#include <final_platform_layer.h>
+
+#include <final_math.h>
+
+enum class ImageFileFormat : int32_t {
+	Unknown = 0,
+	PPM,
+	PNG,
+};
+
+static ImageFileFormat GetImageFileFormatFromPath(const char *filePath) {
+	const char *ext = fplExtractFileExtension(filePath);
+	if (ext != fpl_null) {
+		size_t extLen = fplGetStringLength(ext);
+		if (fplIsStringEqualLen(ext, extLen, ".ppm", 4) || fplIsStringEqualLen(ext, extLen, ".PPM", 4)) {
+			return(ImageFileFormat::PPM);
+		}
+		if (fplIsStringEqualLen(ext, extLen, ".png", 4) || fplIsStringEqualLen(ext, extLen, ".PNG", 4)) {
+			return(ImageFileFormat::PNG);
+		}
+	}
+	return(ImageFileFormat::Unknown);
+}
+
+static bool WriteImagePPM(const char *filePath, const Pixel *pixels, const uint32_t width, const uint32_t height) {
+	fplAssert(pixels != fpl_null && width > 0 && height > 0);
+
+	fplFileHandle file;
+	if (!fplFileCreateBinary(filePath, &file)) {
+		return(false);
+	}
+
+	char header[64];
+	size_t headerLen = fplStringFormat(header, fplArrayCount(header), "P6\n%u %u\n255\n", width, height);
+
+	uint32_t rowSize = width * 3;
+	uint8_t *row = (uint8_t *)fplMemoryAllocate(rowSize);
+
+	bool result = fplFileWriteBlock32(&file, header, (uint32_t)headerLen) == headerLen;
+	for (uint32_t y = 0; result && y < height; ++y) {
+		const Pixel *sourceRow = pixels + y * width;
+		for (uint32_t x = 0; x < width; ++x) {
+			row[x * 3 + 0] = sourceRow[x].r;
+			row[x * 3 + 1] = sourceRow[x].g;
+			row[x * 3 + 2] = sourceRow[x].b;
+		}
+		result = fplFileWriteBlock32(&file, row, rowSize) == rowSize;
+	}
+
+	fplMemoryFree(row);
+	fplFileClose(&file);
+	return(result);
+}
+
+static uint32_t ComputePNGCrc32(uint32_t crc, const uint8_t *data, const size_t size) {
+	static uint32_t table[256];
+	static bool isTableInitialized = false;
+	if (!isTableInitialized) {
+		for (uint32_t n = 0; n < 256; ++n) {
+			uint32_t c = n;
+			for (int k = 0; k < 8; ++k) {
+				c = (c & 1) ? (0xEDB88320u ^ (c >> 1)) : (c >> 1);
+			}
+			table[n] = c;
+		}
+		isTableInitialized = true;
+	}
+	crc = ~crc;
+	for (size_t i = 0; i < size; ++i) {
+		crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+	}
+	return(~crc);
+}
+
+inline uint8_t *PutPNGU32BE(uint8_t *p, const uint32_t value) {
+	p[0] = (uint8_t)(value >> 24);
+	p[1] = (uint8_t)(value >> 16);
+	p[2] = (uint8_t)(value >> 8);
+	p[3] = (uint8_t)(value);
+	return(p + 4);
+}
+
+static bool WritePNGChunk(const fplFileHandle *file, const char type[4], uint8_t *data, const uint32_t size) {
+	uint8_t header[8];
+	PutPNGU32BE(header, size);
+	fplMemoryCopy(type, 4, header + 4);
+	uint32_t crc = ComputePNGCrc32(0, header + 4, 4);
+	crc = ComputePNGCrc32(crc, data, size);
+	uint8_t footer[4];
+	PutPNGU32BE(footer, crc);
+	bool result =
+		(fplFileWriteBlock32(file, header, sizeof(header)) == sizeof(header)) &&
+		(size == 0 || fplFileWriteBlock32(file, data, size) == size) &&
+		(fplFileWriteBlock32(file, footer, sizeof(footer)) == sizeof(footer));
+	return(result);
+}
+
+static bool WriteImagePNG(const char *filePath, const Pixel *pixels, const uint32_t width, const uint32_t height) {
+	fplAssert(pixels != fpl_null && width > 0 && height > 0);
+
+	// Raw scanlines, each starts with filter type zero (None)
+	const uint32_t rowSize = 1 + width * 3;
+	const size_t rawSize = (size_t)rowSize * height;
+
+	// Zlib stream: 2 bytes header, stored blocks with 5 bytes header each and 4 bytes adler32 checksum
+	const uint32_t maxBlockSize = 65535;
+	const size_t blockCount = (rawSize + maxBlockSize - 1) / maxBlockSize;
+	const size_t streamSize = 2 + blockCount * 5 + rawSize + 4;
+	if (streamSize > UINT32_MAX) {
+		return(false);
+	}
+
+	uint8_t *raw = (uint8_t *)fplMemoryAllocate(rawSize);
+	for (uint32_t y = 0; y < height; ++y) {
+		uint8_t *row = raw + (size_t)y * rowSize;
+		const Pixel *sourceRow = pixels + y * width;
+		row[0] = 0;
+		for (uint32_t x = 0; x < width; ++x) {
+			row[1 + x * 3 + 0] = sourceRow[x].r;
+			row[1 + x * 3 + 1] = sourceRow[x].g;
+			row[1 + x * 3 + 2] = sourceRow[x].b;
+		}
+	}
+
+	uint8_t *stream = (uint8_t *)fplMemoryAllocate(streamSize);
+	uint8_t *p = stream;
+	*p++ = 0x78;
+	*p++ = 0x01;
+	uint32_t adlerA = 1;
+	uint32_t adlerB = 0;
+	size_t remaining = rawSize;
+	const uint8_t *source = raw;
+	while (remaining > 0) {
+		uint32_t blockSize = (uint32_t)fplMin(remaining, (size_t)maxBlockSize);
+		bool isFinal = remaining == blockSize;
+		*p++ = isFinal ? 1 : 0;
+		*p++ = (uint8_t)(blockSize & 0xFF);
+		*p++ = (uint8_t)(blockSize >> 8);
+		*p++ = (uint8_t)(~blockSize & 0xFF);
+		*p++ = (uint8_t)((~blockSize >> 8) & 0xFF);
+		fplMemoryCopy(source, blockSize, p);
+		for (uint32_t i = 0; i < blockSize; ++i) {
+			adlerA = (adlerA + source[i]) % 65521;
+			adlerB = (adlerB + adlerA) % 65521;
+		}
+		p += blockSize;
+		source += blockSize;
+		remaining -= blockSize;
+	}
+	p = PutPNGU32BE(p, (adlerB << 16) | adlerA);
+	fplAssert((size_t)(p - stream) == streamSize);
+
+	fplMemoryFree(raw);
+
+	bool result = false;
+	fplFileHandle file;
+	if (fplFileCreateBinary(filePath, &file)) {
+		uint8_t signature[8] = { 0x89, 'P', 'N', 'G', 0x0D, 0x0A, 0x1A, 0x0A };
+		uint8_t ihdr[13];
+		uint8_t *h = PutPNGU32BE(ihdr, width);
+		h = PutPNGU32BE(h, height);
+		h[0] = 8; // Bit depth
+		h[1] = 2; // Color type: RGB
+		h[2] = 0; // Compression method
+		h[3] = 0; // Filter method
+		h[4] = 0; // Interlace method
+		result =
+			(fplFileWriteBlock32(&file, signature, sizeof(signature)) == sizeof(signature)) &&
+			WritePNGChunk(&file, "IHDR", ihdr, sizeof(ihdr)) &&
+			WritePNGChunk(&file, "IDAT", stream, (uint32_t)streamSize) &&
+			WritePNGChunk(&file, "IEND", fpl_null, 0);
+		fplFileClose(&file);
+	}
+
+	fplMemoryFree(stream);
+	return(result);
+}
+
+static bool WriteImage(const char *filePath, const Pixel *pixels, const uint32_t width, const uint32_t height) {
+	ImageFileFormat format = GetImageFileFormatFromPath(filePath);
+	switch (format) {
+		case ImageFileFormat::PPM:
+			return WriteImagePPM(filePath, pixels, width, height);
+		case ImageFileFormat::PNG:
+			return WriteImagePNG(filePath, pixels, width, height);
+		default:
+			return(false);
+	}
+}
+
+#endif // IMAGE_OUTPUT_H
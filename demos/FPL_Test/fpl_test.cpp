@@ -14,6 +14,9 @@ Author:
 	Torsten Spaete
 
 Changelog:
+	## 2026-10-18
+	- Added FontGlyphCache tests (final_fontloader.h)
+
 	## 2025-03-30
 	- Test available/used thread count
 
@@ -74,6 +77,10 @@ License:
 #define FT_IMPLEMENTATION
 #include "final_test.h"
 
+#define FINAL_FONTLOADER_IMPLEMENTATION
+#include <final_fontloader.h>
+#include <final_fonts.h>
+
 template<typename T>
 inline void AssertEquals(const T expected, const T actual) {}
 
@@ -999,6 +1006,18 @@ static void TestThreading() {
 	}
 }
 
+static bool CountDirectoryScanEntry(const char *fullPath, const fplFileEntry *entry, void *userData) {
+	volatile uint32_t *count = (volatile uint32_t *)userData;
+	fplAtomicIncrementU32(count);
+	return(true);
+}
+
+static bool StopDirectoryScanEntry(const char *fullPath, const fplFileEntry *entry, void *userData) {
+	volatile uint32_t *count = (volatile uint32_t *)userData;
+	fplAtomicIncrementU32(count);
+	return(false);
+}
+
 static void TestFiles() {
 #if defined(FPL_PLATFORM_WINDOWS)
 	const char *testNotExistingFile = "C:\\Windows\\i_am_not_existing.lib";
@@ -1050,6 +1069,37 @@ static void TestFiles() {
 		ftIsTrue(r);
 		fplDirectoryListEnd(&fileEntry);
 	}
+	ftMsg("Test Directory Scan matches Directory Iterations\n");
+	ftIsTrue(fplPlatformInit(fplInitFlags_None, fpl_null));
+	{
+		uint32_t listCount = 0;
+		fplFileEntry fileEntry = {};
+		for (bool r = fplDirectoryListBegin(testRootPath, "*", &fileEntry); r; r = fplDirectoryListNext(&fileEntry)) {
+			if (!fplIsStringEqual(fileEntry.name, ".") && !fplIsStringEqual(fileEntry.name, "..")) {
+				++listCount;
+			}
+		}
+		fplDirectoryListEnd(&fileEntry);
+		volatile uint32_t scanCount = 0;
+		bool r = fplDirectoryScan(testRootPath, "*", fplDirectoryScanFlags_None, 4, CountDirectoryScanEntry, (void *)&scanCount);
+		ftIsTrue(r);
+		ftAssertU32Equals(listCount, scanCount);
+	}
+	ftMsg("Test Directory Scan stopped by callback\n");
+	{
+		volatile uint32_t scanCount = 0;
+		bool r = fplDirectoryScan(testRootPath, "*", fplDirectoryScanFlags_Recursive, 1, StopDirectoryScanEntry, (void *)&scanCount);
+		ftIsTrue(r);
+		ftAssertU32Equals(1, scanCount);
+	}
+	ftMsg("Test Directory Scan for not existing path\n");
+	{
+		volatile uint32_t scanCount = 0;
+		bool r = fplDirectoryScan(testNotExistingFile, fpl_null, fplDirectoryScanFlags_None, 1, CountDirectoryScanEntry, (void *)&scanCount);
+		ftIsFalse(r);
+		ftAssertU32Equals(0, scanCount);
+	}
+	fplPlatformRelease();
 	}
 
 static void TestAtomics() {
@@ -1768,6 +1818,116 @@ static void TestLocalization() {
 	fplPlatformRelease();
 }
 
+// Compares the atlas region of the cached glyph with a new rasterization of the same glyph
+static void AssertCachedFontGlyphPixels(const FontGlyphCache *cache, const FontGlyph *glyph) {
+	FontGlyphBitmap bitmap;
+	RasterizeFontGlyph((const stbtt_fontinfo *)cache->fontInfo, cache->scale, glyph->charCode, &bitmap);
+	if (bitmap.pixels != fpl_null) {
+		uint32_t x = (uint32_t)(glyph->uvMin.x * (float)cache->atlasWidth + 0.5f);
+		uint32_t y = (uint32_t)(glyph->uvMax.y * (float)cache->atlasHeight + 0.5f);
+		ftAssertU32Equals(x + bitmap.width, (uint32_t)(glyph->uvMax.x * (float)cache->atlasWidth + 0.5f));
+		ftAssertU32Equals(y + bitmap.height, (uint32_t)(glyph->uvMin.y * (float)cache->atlasHeight + 0.5f));
+		for (int32_t row = 0; row < bitmap.height; ++row) {
+			ftAssert(memcmp(cache->atlasAlphaBitmap + (y + row) * cache->atlasWidth + x, bitmap.pixels + row * bitmap.width, bitmap.width) == 0);
+		}
+		fplMemoryFree(bitmap.pixels);
+	} else {
+		ftAssertFloatEquals(0.0f, glyph->charSize.x);
+		ftAssertFloatEquals(0.0f, glyph->charSize.y);
+	}
+}
+
+static void TestFontGlyphCache() {
+	fplPlatformInit(fplInitFlags_None, fpl_null);
+	const char *text = "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789";
+	const uint32_t textLen = (uint32_t)fplGetStringLength(text);
+	ftMsg("Test FontGlyphCache rasterizes glyphs on first use\n");
+	{
+		FontGlyphCache cache;
+		ftIsTrue(InitFontGlyphCache(&cache, ptr_fontVeraFontRegular, sizeOf_fontVeraFontRegular, 0, 24.0f, 256, 256, 64, false));
+		const FontGlyph *glyph = GetCachedFontGlyph(&cache, 'A');
+		ftIsNotNull(glyph);
+		ftAssertU32Equals('A', glyph->charCode);
+		ftIsTrue(cache.isAtlasDirty);
+		AssertCachedFontGlyphPixels(&cache, glyph);
+		ftAssertPointerEquals(glyph, GetCachedFontGlyph(&cache, 'A'));
+
+		// Glyphs without pixels still have an advance
+		const FontGlyph *space = GetCachedFontGlyph(&cache, ' ');
+		ftIsNotNull(space);
+		AssertCachedFontGlyphPixels(&cache, space);
+		ftAssert(GetCachedFontCharacterAdvance(&cache, ' ', 0) > 0.0f);
+
+		// Code points far outside of any baked range
+		const FontGlyph *cjk = GetCachedFontGlyph(&cache, 0x4E2D);
+		ftIsNotNull(cjk);
+		AssertCachedFontGlyphPixels(&cache, cjk);
+		ReleaseFontGlyphCache(&cache);
+	}
+	ftMsg("Test FontGlyphCache evicts the least recently used shelfs\n");
+	{
+		// The atlas and the glyph slots are much smaller than the text, so glyphs are evicted all the time.
+		// Two glyphs per frame always fit, because the unused shelfs above or below the first shelf are at least half of the remaining atlas.
+		FontGlyphCache cache;
+		ftIsTrue(InitFontGlyphCache(&cache, ptr_fontVeraFontRegular, sizeOf_fontVeraFontRegular, 0, 24.0f, 64, 128, 16, false));
+		const uint32_t glyphsPerFrame = 2;
+		uint32_t requestIndex = 0;
+		for (uint32_t frame = 0; frame < 1000; ++frame) {
+			const FontGlyph *frameGlyphs[glyphsPerFrame];
+			for (uint32_t i = 0; i < glyphsPerFrame; ++i) {
+				uint32_t codePoint = (uint8_t)text[requestIndex++ % textLen];
+				frameGlyphs[i] = GetCachedFontGlyph(&cache, codePoint);
+				ftIsNotNull(frameGlyphs[i]);
+				ftAssertU32Equals(codePoint, frameGlyphs[i]->charCode);
+			}
+			// Glyphs used in this frame are not evicted by the following glyphs of the same frame
+			for (uint32_t i = 0; i < glyphsPerFrame; ++i) {
+				AssertCachedFontGlyphPixels(&cache, frameGlyphs[i]);
+			}
+			UpdateFontGlyphCache(&cache);
+		}
+		ftAssertU32Equals(UINT32_MAX, FindFontCacheGlyph(&cache, (uint8_t)text[requestIndex % textLen]));
+		ReleaseFontGlyphCache(&cache);
+	}
+	ftMsg("Test FontGlyphCache with glyphs larger than the atlas\n");
+	{
+		FontGlyphCache cache;
+		ftIsTrue(InitFontGlyphCache(&cache, ptr_fontVeraFontRegular, sizeOf_fontVeraFontRegular, 0, 24.0f, 8, 8, 4, false));
+		ftIsNull(GetCachedFontGlyph(&cache, 'W'));
+		ftAssertU32Equals(UINT32_MAX, FindFontCacheGlyph(&cache, 'W'));
+		ftIsNotNull(GetCachedFontGlyph(&cache, ' '));
+		ReleaseFontGlyphCache(&cache);
+	}
+	ftMsg("Test FontGlyphCache with worker thread\n");
+	{
+		FontGlyphCache cache;
+		ftIsTrue(InitFontGlyphCache(&cache, ptr_fontVeraFontRegular, sizeOf_fontVeraFontRegular, 0, 24.0f, 256, 256, 128, true));
+		// Missing glyphs are rasterized in the background and committed by a later UpdateFontGlyphCache()
+		ftIsNull(GetCachedFontGlyph(&cache, (uint8_t)text[0]));
+		bool allReady = false;
+		for (uint32_t frame = 0; frame < 5000 && !allReady; ++frame) {
+			UpdateFontGlyphCache(&cache);
+			allReady = true;
+			for (uint32_t i = 0; i < textLen; ++i) {
+				const FontGlyph *glyph = GetCachedFontGlyph(&cache, (uint8_t)text[i]);
+				if (glyph == fpl_null) {
+					allReady = false;
+				} else {
+					ftAssertU32Equals((uint8_t)text[i], glyph->charCode);
+					AssertCachedFontGlyphPixels(&cache, glyph);
+				}
+			}
+			if (!allReady) {
+				fplThreadSleep(1);
+			}
+		}
+		ftIsTrue(allReady);
+		ftAssertU32Equals(0, cache.pendingCount);
+		ReleaseFontGlyphCache(&cache);
+	}
+	fplPlatformRelease();
+}
+
 inline void DefaultInlineTest() {
 	fplConsoleFormatOut("This should be inlined");
 }
@@ -1828,6 +1988,7 @@ int main(int argc, char *args[]) {
 	TestPaths();
 	TestFiles();
 	TestStrings();
+	TestFontGlyphCache();
 	TestThreading();
 	TestInlining();
 	return 0;
@@ -18,6 +18,15 @@ Author:
 	Torsten Spaete
 
 Changelog:
+	## 2026-10-18
+	- Uniform grid for creeps, used for the tower target detection and the bullet collisions
+	- Bullet collisions are swept along the movement of the bullet
+	- Stress test (Return in debug mode) which fills the way with thousands of creeps
+	- Creeps follow a flow field to the goal instead of the waypoints
+	- Enemies are rendered in a grouped render layer, draw calls and vertices are shown in debug mode
+	- Command line argument --software for running with the software renderer
+	- Command line argument --render-thread for rendering on a separate thread
+
 	## 2019-04-27
 	- Use Vec2Normalize instead of dividing by length
 
@@ -503,8 +512,239 @@ namespace render {
 	}
 }
 
+namespace spatial {
+	static bool InitGrid(SpatialGrid &grid, const LevelDimension &dim, const size_t itemCapacity, fmemMemoryBlock *memory) {
+		grid = {};
+		grid.origin = V2fInit(dim.gridOriginX, dim.gridOriginY);
+		grid.cellSize = V2fInit(TileWidth, TileHeight);
+		grid.cellCountX = (int)dim.tileCountX;
+		grid.cellCountY = (int)dim.tileCountY;
+		grid.itemCapacity = (uint32_t)itemCapacity;
+		size_t cellCount = dim.tileCountX * dim.tileCountY;
+		grid.items = (SpatialGridItem *)fmemPush(memory, sizeof(SpatialGridItem) * itemCapacity, fmemPushFlags_None);
+		grid.pendingItems = (SpatialGridItem *)fmemPush(memory, sizeof(SpatialGridItem) * itemCapacity, fmemPushFlags_None);
+		grid.pendingCells = (uint32_t *)fmemPush(memory, sizeof(uint32_t) * itemCapacity, fmemPushFlags_None);
+		grid.cellStarts = (uint32_t *)fmemPush(memory, sizeof(uint32_t) * (cellCount + 1), fmemPushFlags_Clear);
+		bool result = grid.items != nullptr && grid.pendingItems != nullptr && grid.pendingCells != nullptr && grid.cellStarts != nullptr;
+		return(result);
+	}
+
+	// Positions outside the grid are put into the border cells
+	inline int GetCell(const float value, const float origin, const float cellSize, const int cellCount) {
+		int result = (int)floorf((value - origin) / cellSize);
+		result = fplMax(0, fplMin(result, cellCount - 1));
+		return(result);
+	}
+
+	static void ClearGrid(SpatialGrid &grid) {
+		grid.itemCount = 0;
+		grid.maxItemRadius = 0;
+	}
+
+	static void AddItem(SpatialGrid &grid, const Vec2f &position, const float radius, const uint32_t index) {
+		assert(grid.itemCount < grid.itemCapacity);
+		uint32_t itemIndex = grid.itemCount++;
+		SpatialGridItem &item = grid.pendingItems[itemIndex];
+		item.position = position;
+		item.radius = radius;
+		item.index = index;
+		int cellX = GetCell(position.x, grid.origin.x, grid.cellSize.x, grid.cellCountX);
+		int cellY = GetCell(position.y, grid.origin.y, grid.cellSize.y, grid.cellCountY);
+		grid.pendingCells[itemIndex] = (uint32_t)(cellY * grid.cellCountX + cellX);
+		grid.maxItemRadius = fplMax(grid.maxItemRadius, radius);
+	}
+
+	// Sorts all added items by cell (Counting sort)
+	static void BuildGrid(SpatialGrid &grid) {
+		uint32_t cellCount = (uint32_t)(grid.cellCountX * grid.cellCountY);
+		fplMemoryClear(grid.cellStarts, sizeof(uint32_t) * (cellCount + 1));
+		for (uint32_t itemIndex = 0; itemIndex < grid.itemCount; ++itemIndex) {
+			++grid.cellStarts[grid.pendingCells[itemIndex] + 1];
+		}
+		for (uint32_t cellIndex = 1; cellIndex <= cellCount; ++cellIndex) {
+			grid.cellStarts[cellIndex] += grid.cellStarts[cellIndex - 1];
+		}
+		for (uint32_t itemIndex = 0; itemIndex < grid.itemCount; ++itemIndex) {
+			uint32_t cellIndex = grid.pendingCells[itemIndex];
+			grid.items[grid.cellStarts[cellIndex]++] = grid.pendingItems[itemIndex];
+		}
+		// Each start was moved to the start of the next cell, so shift back by one cell
+		for (uint32_t cellIndex = cellCount; cellIndex > 0; --cellIndex) {
+			grid.cellStarts[cellIndex] = grid.cellStarts[cellIndex - 1];
+		}
+		grid.cellStarts[0] = 0;
+	}
+
+	static SpatialGridQuery BeginQuery(const SpatialGrid &grid, const SpatialGridQueryType type, const Vec2f &start, const Vec2f &delta, const float radius) {
+		SpatialGridQuery result = {};
+		result.grid = &grid;
+		result.type = type;
+		result.start = start;
+		result.delta = delta;
+		result.radius = radius;
+		if (grid.itemCount > 0) {
+			// Items are stored in the cell of its center, so the bounds are extended by the largest item radius
+			Vec2f end = start + delta;
+			float ext = radius + grid.maxItemRadius;
+			result.minCellX = GetCell(fplMin(start.x, end.x) - ext, grid.origin.x, grid.cellSize.x, grid.cellCountX);
+			result.minCellY = GetCell(fplMin(start.y, end.y) - ext, grid.origin.y, grid.cellSize.y, grid.cellCountY);
+			result.maxCellX = GetCell(fplMax(start.x, end.x) + ext, grid.origin.x, grid.cellSize.x, grid.cellCountX);
+			result.maxCellY = GetCell(fplMax(start.y, end.y) + ext, grid.origin.y, grid.cellSize.y, grid.cellCountY);
+			result.cellY = result.minCellY;
+		} else {
+			result.cellY = result.maxCellY + 1;
+		}
+		result.cellX = result.minCellX;
+		return(result);
+	}
+
+	// Finds all items which centers are inside the circle
+	static SpatialGridQuery BeginRangeQuery(const SpatialGrid &grid, const Vec2f &center, const float radius) {
+		SpatialGridQuery result = BeginQuery(grid, SpatialGridQueryType::Range, center, V2fInit(0, 0), radius);
+		return(result);
+	}
+
+	// Finds all items which are touched by a circle moving from a to b
+	static SpatialGridQuery BeginSegmentQuery(const SpatialGrid &grid, const Vec2f &a, const Vec2f &b, const float radius) {
+		SpatialGridQuery result = BeginQuery(grid, SpatialGridQueryType::Segment, a, b - a, radius);
+		return(result);
+	}
+
+	static bool TestQueryItem(const SpatialGridQuery &query, const SpatialGridItem &item, float *outValue) {
+		if (query.type == SpatialGridQueryType::Range) {
+			Vec2f distance = item.position - query.start;
+			float d = V2fDot(distance, distance);
+			if (d <= query.radius * query.radius) {
+				*outValue = SquareRoot(d);
+				return(true);
+			}
+		} else {
+			float bothRadi = query.radius + item.radius;
+			Vec2f f = query.start - item.position;
+			float c = V2fDot(f, f) - bothRadi * bothRadi;
+			if (c <= 0) {
+				*outValue = 0.0f;
+				return(true);
+			}
+			float a = V2fDot(query.delta, query.delta);
+			float b = V2fDot(f, query.delta);
+			if (a > 0 && b < 0) {
+				float d = b * b - a * c;
+				if (d >= 0) {
+					float t = (-b - SquareRoot(d)) / a;
+					if (t <= 1.0f) {
+						*outValue = t;
+						return(true);
+					}
+				}
+			}
+		}
+		return(false);
+	}
+
+	// Returns the next item of the query, in no particular order
+	static bool NextQueryHit(SpatialGridQuery &query, SpatialGridHit &outHit) {
+		const SpatialGrid &grid = *query.grid;
+		for (;;) {
+			while (query.itemIndex < query.itemEnd) {
+				const SpatialGridItem *item = grid.items + query.itemIndex++;
+				float value;
+				if (TestQueryItem(query, *item, &value)) {
+					outHit.item = item;
+					outHit.value = value;
+					return(true);
+				}
+			}
+			if (query.cellY > query.maxCellY) {
+				return(false);
+			}
+			int cellIndex = query.cellY * grid.cellCountX + query.cellX;
+			query.itemIndex = grid.cellStarts[cellIndex];
+			query.itemEnd = grid.cellStarts[cellIndex + 1];
+			if (++query.cellX > query.maxCellX) {
+				query.cellX = query.minCellX;
+				++query.cellY;
+			}
+		}
+	}
+}
+
+namespace flowfield {
+	static bool InitFlowField(FlowField &field, const LevelDimension &dim, fmemMemoryBlock *memory) {
+		field = {};
+		size_t cellCount = dim.tileCountX * dim.tileCountY;
+		field.cells = (FlowFieldCell *)fmemPush(memory, sizeof(FlowFieldCell) * cellCount, fmemPushFlags_Clear);
+		field.queue = (uint32_t *)fmemPush(memory, sizeof(uint32_t) * cellCount, fmemPushFlags_None);
+		field.goalTilePos = V2iInit(-1, -1);
+		for (size_t cellIndex = 0; field.cells != nullptr && cellIndex < cellCount; ++cellIndex) {
+			field.cells[cellIndex].distance = FlowFieldUnreachable;
+		}
+		bool result = field.cells != nullptr && field.queue != nullptr;
+		return(result);
+	}
+
+	inline bool IsWalkableTile(const Tile &tile) {
+		bool result = !tile.isOccupied && (tile.wayType != WayType::None || tile.entityType == EntityType::Goal);
+		return(result);
+	}
+
+	static void BuildFlowField(FlowField &field, const LevelDimension &dim, const Tile *tiles) {
+		int countX = (int)dim.tileCountX;
+		int countY = (int)dim.tileCountY;
+		uint32_t cellCount = (uint32_t)(countX * countY);
+		for (uint32_t cellIndex = 0; cellIndex < cellCount; ++cellIndex) {
+			field.cells[cellIndex].distance = FlowFieldUnreachable;
+		}
+		if (!IsValidTile(dim, field.goalTilePos)) {
+			return;
+		}
+
+		uint32_t goalIndex = (uint32_t)(field.goalTilePos.y * countX + field.goalTilePos.x);
+		field.cells[goalIndex].distance = 0;
+		field.cells[goalIndex].targetPos = TileToWorld(dim, field.goalTilePos, TileExt);
+		uint32_t queueHead = 0;
+		uint32_t queueTail = 0;
+		field.queue[queueTail++] = goalIndex;
+
+		const Vec2i neighbors[] = { V2iInit(1, 0), V2iInit(-1, 0), V2iInit(0, 1), V2iInit(0, -1) };
+		while (queueHead < queueTail) {
+			uint32_t cellIndex = field.queue[queueHead++];
+			Vec2i tilePos = V2iInit((int)(cellIndex % countX), (int)(cellIndex / countX));
+			Vec2f tileCenter = TileToWorld(dim, tilePos, TileExt);
+			uint32_t nextDistance = field.cells[cellIndex].distance + 1;
+			for (size_t neighborIndex = 0; neighborIndex < fplArrayCount(neighbors); ++neighborIndex) {
+				Vec2i neighborPos = V2iInit(tilePos.x + neighbors[neighborIndex].x, tilePos.y + neighbors[neighborIndex].y);
+				if (!IsValidTile(dim, neighborPos)) {
+					continue;
+				}
+				uint32_t neighborCellIndex = (uint32_t)(neighborPos.y * countX + neighborPos.x);
+				FlowFieldCell &neighborCell = field.cells[neighborCellIndex];
+				if (neighborCell.distance == FlowFieldUnreachable && IsWalkableTile(tiles[neighborCellIndex])) {
+					neighborCell.distance = nextDistance;
+					neighborCell.targetPos = tileCenter;
+					assert(queueTail < cellCount);
+					field.queue[queueTail++] = neighborCellIndex;
+				}
+			}
+		}
+	}
+
+	// Returns the cell for the tile under the world position or null when outside of the level
+	static const FlowFieldCell *GetFlowFieldCell(const FlowField &field, const LevelDimension &dim, const Vec2f &worldPos) {
+		if (field.cells == nullptr) {
+			return(nullptr);
+		}
+		Vec2i tilePos = V2iInit((int)floorf((worldPos.x - dim.gridOriginX) / TileWidth), (int)dim.tileCountY - 1 - (int)floorf((worldPos.y - dim.gridOriginY) / TileHeight));
+		if (!IsValidTile(dim, tilePos)) {
+			return(nullptr);
+		}
+		const FlowFieldCell *result = &field.cells[tilePos.y * (int)dim.tileCountX + tilePos.x];
+		return(result);
+	}
+}
+
 namespace creeps {
-	static void SpawnEnemy(Creeps &enemies, const LevelDimension &dim, const Waypoints &waypoints, const Vec2f &spawnPos, const Vec2f &exitPos, const CreepData *data) {
+	static void SpawnEnemy(Creeps &enemies, const Level &level, const Vec2f &spawnPos, const CreepData *data) {
 		assert(enemies.count < fplArrayCount(enemies.list));
 		Creep *enemy = &enemies.list[enemies.count++];
 		fplClearStruct(enemy);
@@ -513,15 +753,11 @@ namespace creeps {
 		enemy->position = enemy->prevPosition = spawnPos;
 		enemy->speed = data->speed;
 		enemy->hp = data->hp;
-		if (waypoints.first != nullptr) {
-			enemy->targetWaypoint = waypoints.first;
-			enemy->targetPos = TileToWorld(dim, waypoints.first->tilePos, TileExt);
-		} else {
-			enemy->targetWaypoint = nullptr;
-			enemy->targetPos = exitPos;
+		enemy->facingDirection = V2fInit(1, 0);
+		const FlowFieldCell *cell = flowfield::GetFlowFieldCell(level.flowField, level.dimension, spawnPos);
+		if (cell != nullptr && cell->distance != FlowFieldUnreachable && cell->distance > 0) {
+			enemy->facingDirection = V2fNormalize(cell->targetPos - spawnPos);
 		}
-		enemy->facingDirection = V2fNormalize(enemy->targetPos - enemy->position);
-		enemy->hasTarget = true;
 	}
 
 	static void UpdateSpawner(GameState &state, CreepSpawner &spawner, const float deltaTime) {
@@ -532,7 +768,7 @@ namespace creeps {
 				spawner.spawnTimer -= deltaTime;
 			}
 			if (spawner.spawnTimer <= 0) {
-				SpawnEnemy(state.enemies, state.level.dimension, state.waypoints, spawner.spawnPosition, spawner.exitPosition, spawner.spawnTemplate);
+				SpawnEnemy(state.enemies, state.level, spawner.spawnPosition, spawner.spawnTemplate);
 				--spawner.remainingCount;
 				if (spawner.remainingCount == 0) {
 					spawner.spawnTimer = 0;
@@ -544,12 +780,11 @@ namespace creeps {
 		}
 	}
 
-	static void AddSpawner(CreepSpawners &spawners, const LevelDimension &dim, const Vec2i &spawnTilePos, const Vec2i &goalTilePos, const float initialCooldown, const float cooldown, const size_t count, const SpawnerStartMode startMode, const CreepData *spawnTemplate) {
+	static void AddSpawner(CreepSpawners &spawners, const LevelDimension &dim, const Vec2i &spawnTilePos, const float initialCooldown, const float cooldown, const size_t count, const SpawnerStartMode startMode, const CreepData *spawnTemplate) {
 		assert(spawners.count < fplArrayCount(spawners.list));
 		CreepSpawner &spawner = spawners.list[spawners.count++];
 		spawner = {};
 		spawner.spawnPosition = TileToWorld(dim, spawnTilePos, TileExt);
-		spawner.exitPosition = TileToWorld(dim, goalTilePos, TileExt);
 		spawner.cooldown = cooldown;
 		spawner.spawnTimer = initialCooldown;
 		spawner.totalCount = count;
@@ -561,8 +796,6 @@ namespace creeps {
 
 	static void CreepDead(GameState &state, Creep &enemy) {
 		enemy.id = 0;
-		enemy.hasTarget = false;
-		enemy.targetWaypoint = nullptr;
 		enemy.isDead = true;
 		enemy.hp = 0;
 	}
@@ -577,29 +810,23 @@ namespace creeps {
 		}
 	}
 
-	static void SetCreepNextTarget(GameState &state, Creep &enemy) {
-		const LevelDimension &dim = state.level.dimension;
-		Vec2i goalTilePos = level::FindTilePosByEntityType(state.level, EntityType::Goal);
-		assert(goalTilePos.x > -1 && goalTilePos.y > -1);
-		Vec2i creepTilePos = WorldToTile(dim, enemy.position);
-		if (enemy.targetWaypoint != nullptr) {
-			const Waypoint waypoint = *enemy.targetWaypoint;
-			assert(V2fLength(waypoint.direction) == 1);
-			Vec2f creepDir = waypoint.direction;
-			if (waypoint.next != nullptr) {
-				enemy.targetPos = TileToWorld(dim, waypoint.next->tilePos, TileExt);
-				enemy.targetWaypoint = waypoint.next;
-			} else {
-				enemy.targetWaypoint = nullptr;
-				enemy.targetPos = TileToWorld(dim, goalTilePos, TileExt);
+	// Moves towards the next tile of the flow field, creeps outside of the field keep their direction
+	static void MoveCreep(GameState &state, Creep &enemy, const float deltaTime) {
+		const Level &level = state.level;
+		const FlowFieldCell *cell = flowfield::GetFlowFieldCell(level.flowField, level.dimension, enemy.position);
+		if (cell != nullptr && cell->distance != FlowFieldUnreachable) {
+			Vec2f distance = cell->targetPos - enemy.position;
+			float distanceSquared = V2fDot(distance, distance);
+			float minRadius = MaxTileSize * 0.05f;
+			if (cell->distance == 0 && distanceSquared <= minRadius * minRadius) {
+				CreepReachedExit(state, enemy);
+				return;
+			}
+			if (distanceSquared > 0) {
+				enemy.facingDirection = V2fNormalize(distance);
 			}
-			enemy.hasTarget = true;
-			enemy.facingDirection = V2fNormalize(enemy.targetPos - enemy.position);
-		} else {
-			enemy.hasTarget = false;
-			assert(V2iEquals(creepTilePos, goalTilePos));
-			CreepReachedExit(state, enemy);
 		}
+		enemy.position += enemy.facingDirection * enemy.speed * deltaTime;
 	}
 
 	static const CreepData *FindEnemyById(GameState &state, const char *id) {
@@ -1207,7 +1434,15 @@ namespace level {
 								}
 							}
 
-							result = true;
+							// Creep grid and flow field
+							if (spatial::InitGrid(state.level.creepGrid, state.level.dimension, fplArrayCount(state.enemies.list), memory) &&
+								flowfield::InitFlowField(state.level.flowField, state.level.dimension, memory)) {
+								state.level.flowField.goalTilePos = FindTilePosByEntityType(state.level, EntityType::Goal);
+								flowfield::BuildFlowField(state.level.flowField, state.level.dimension, state.level.tiles);
+								result = true;
+							} else {
+								gamelog::Error("Failed allocating creep grid or flow field for level '%s'!", filePath);
+							}
 						} else {
 							gamelog::Error("Level file '%s' is not valid!", filePath);
 						}
@@ -1256,6 +1491,8 @@ namespace level {
 		if (level.tiles != nullptr) {
 			level.tiles = nullptr;
 		}
+		level.creepGrid = {};
+		level.flowField = {};
 		level.data.layerCount = 0;
 		level.data.tilesetCount = 0;
 		level.data.objectCount = 0;
@@ -1352,7 +1589,7 @@ namespace level {
 				continue;
 				gamelog::Warning("Enemy by id '%s' does not exists!", spawnerFromWave.enemyId);
 			}
-			creeps::AddSpawner(state.spawners, state.level.dimension, objTilePos, goalTilePos, spawnerFromWave.initialCooldown, spawnerFromWave.cooldown, spawnerFromWave.enemyCount, spawnerFromWave.startMode, creepData);
+			creeps::AddSpawner(state.spawners, state.level.dimension, objTilePos, spawnerFromWave.initialCooldown, spawnerFromWave.cooldown, spawnerFromWave.enemyCount, spawnerFromWave.startMode, creepData);
 			state.wave.totalEnemyCount += spawnerFromWave.enemyCount;
 		}
 
@@ -1401,8 +1638,14 @@ namespace towers {
 
 		Tile *tile = level::GetTile(state.level, tilePos);
 		assert(!tile->isOccupied);
+		bool wasWalkable = flowfield::IsWalkableTile(*tile);
 		tile->isOccupied = true;
 
+		// Only a blocked tile of the way changes the flow field
+		if (wasWalkable) {
+			flowfield::BuildFlowField(state.level.flowField, state.level.dimension, state.level.tiles);
+		}
+
 		assert(state.stats.money >= data->costs);
 		state.stats.money -= data->costs;
 
@@ -1509,18 +1752,22 @@ namespace towers {
 		// Detect a new target
 		if (!tower.hasTarget) {
 			float bestEnemyDistance = FLT_MAX;
+			uint32_t bestEnemyIndex = 0;
 			Creep *bestEnemy = nullptr;
-			for (size_t enemyIndex = 0; enemyIndex < state.enemies.count; ++enemyIndex) {
-				Creep *testEnemy = &state.enemies.list[enemyIndex];
+			SpatialGridQuery query = spatial::BeginRangeQuery(state.level.creepGrid, tower.position, tower.data->detectionRadius);
+			SpatialGridHit hit;
+			while (spatial::NextQueryHit(query, hit)) {
+				Creep *testEnemy = &state.enemies.list[hit.item->index];
 				if (!testEnemy->isDead) {
-					float distanceRadius = V2fLength(testEnemy->position - tower.position);
-					if (distanceRadius < bestEnemyDistance) {
+					// Same distance prefers the lower index, so the grid order does not matter
+					if ((hit.value < bestEnemyDistance) || (hit.value == bestEnemyDistance && hit.item->index < bestEnemyIndex)) {
 						bestEnemy = testEnemy;
-						bestEnemyDistance = distanceRadius;
+						bestEnemyDistance = hit.value;
+						bestEnemyIndex = hit.item->index;
 					}
 				}
 			}
-			if (bestEnemy != nullptr && bestEnemyDistance <= tower.data->detectionRadius) {
+			if (bestEnemy != nullptr) {
 				tower.targetEnemy = bestEnemy;
 				tower.targetId = bestEnemy->id;
 				tower.hasTarget = true;
@@ -1552,12 +1799,14 @@ namespace towers {
 		// Shoot
 		//
 		if (tower.data->enemyLockOnMode == EnemyLockTargetMode::Any) {
-			for (size_t enemyIndex = 0; enemyIndex < state.enemies.count; ++enemyIndex) {
-				Creep &enemy = state.enemies.list[enemyIndex];
-				if (!enemy.isDead) {
-					bool inFireRange = towers::InFireRange(tower, enemy, deltaTime);
-					if (inFireRange && tower.canFire) {
+			if (tower.canFire) {
+				SpatialGridQuery query = spatial::BeginRangeQuery(state.level.creepGrid, tower.position, tower.data->unlockRadius);
+				SpatialGridHit hit;
+				while (spatial::NextQueryHit(query, hit)) {
+					const Creep &enemy = state.enemies.list[hit.item->index];
+					if (!enemy.isDead && towers::InFireRange(tower, enemy, deltaTime)) {
 						ShootBullet(state.bullets, tower);
+						break;
 					}
 				}
 			}
@@ -1679,6 +1928,86 @@ namespace game {
 		level::LoadWave(state, 0);
 	}
 
+	static bool IsNextToWay(Level &level, const Vec2i &tilePos) {
+		for (int y = -1; y <= 1; ++y) {
+			for (int x = -1; x <= 1; ++x) {
+				const Tile *tile = level::GetTile(level, V2iInit(tilePos.x + x, tilePos.y + y));
+				if (tile != nullptr && tile->wayType != WayType::None) {
+					return(true);
+				}
+			}
+		}
+		return(false);
+	}
+
+	// Fills the way with thousands of creeps and places towers next to it, to measure the update with a lot of creeps and bullets
+	static void StartStressTest(GameState &state) {
+		const LevelDimension &dim = state.level.dimension;
+		if (state.assets.creepDefinitionCount == 0 || state.assets.towerDefinitionCount == 0) {
+			return;
+		}
+		const FlowField &field = state.level.flowField;
+		size_t cellCount = dim.tileCountX * dim.tileCountY;
+		size_t wayCellCount = 0;
+		for (size_t cellIndex = 0; field.cells != nullptr && cellIndex < cellCount; ++cellIndex) {
+			if (field.cells[cellIndex].distance != FlowFieldUnreachable && field.cells[cellIndex].distance > 0) {
+				++wayCellCount;
+			}
+		}
+		if (wayCellCount == 0) {
+			return;
+		}
+
+		level::ClearWave(state);
+		state.bullets.count = 0;
+
+		// Creeps evenly distributed on all tiles that leads to the goal, each one between the tile center and the next tile
+		const CreepData *creepData = &state.assets.creepDefinitions[0];
+		size_t creepCount = fplMin(StressCreepCount, fplArrayCount(state.enemies.list));
+		size_t creepsPerCell = (creepCount + wayCellCount - 1) / wayCellCount;
+		for (size_t cellIndex = 0; cellIndex < cellCount && state.enemies.count < creepCount; ++cellIndex) {
+			const FlowFieldCell &cell = field.cells[cellIndex];
+			if (cell.distance == FlowFieldUnreachable || cell.distance == 0) {
+				continue;
+			}
+			Vec2i tilePos = V2iInit((int)(cellIndex % dim.tileCountX), (int)(cellIndex / dim.tileCountX));
+			Vec2f tileCenter = TileToWorld(dim, tilePos, TileExt);
+			for (size_t creepIndex = 0; creepIndex < creepsPerCell && state.enemies.count < creepCount; ++creepIndex) {
+				float t = ((float)creepIndex + 0.5f) / (float)creepsPerCell;
+				creeps::SpawnEnemy(state.enemies, state.level, V2fLerp(tileCenter, t, cell.targetPos), creepData);
+			}
+		}
+
+		// Towers on the free tiles next to the way
+		int towerIndex = state.towers.selectedIndex > -1 ? state.towers.selectedIndex : 0;
+		const TowerData *towerData = &state.assets.towerDefinitions[towerIndex];
+		state.towers.selectedIndex = towerIndex;
+		size_t towerCount = 0;
+		for (int y = 0; y < (int)dim.tileCountY; ++y) {
+			for (int x = 0; x < (int)dim.tileCountX; ++x) {
+				if (towerCount == StressTowerCount) {
+					break;
+				}
+				Vec2i tilePos = V2iInit(x, y);
+				if (IsNextToWay(state.level, tilePos)) {
+					state.stats.money = fplMax(state.stats.money, towerData->costs);
+					if (towers::CanPlaceTower(state, tilePos, towerData) == towers::CanPlaceTowerResult::Success) {
+						towers::PlaceTower(state, tilePos, towerData);
+						++towerCount;
+					}
+				}
+			}
+		}
+
+		state.stats.lifes = fplMax(state.stats.lifes, (int)state.enemies.count);
+		state.wave.totalEnemyCount = state.enemies.count;
+		state.wave.warmupTimer = 0;
+		state.wave.state = WaveState::Running;
+		state.wave.isActive = true;
+
+		gamelog::Info("Started stress test with %zu creeps and %zu towers", state.enemies.count, state.towers.activeCount);
+	}
+
 	static bool InitGame(GameState &state, GameMemory &gameMemory) {
 		gamelog::Verbose("Initialize Game");
 
@@ -1863,6 +2192,11 @@ extern void GameInput(GameMemory &gameMemory, const Input &input) {
 	if (WasPressed(keyboardController.debugToggle)) {
 		state->isDebugRendering = !state->isDebugRendering;
 	}
+	if (state->isDebugRendering && WasPressed(keyboardController.actionStart)) {
+		if (!state->isSlowDown && (state->wave.state == WaveState::Running || state->wave.state == WaveState::Starting)) {
+			game::StartStressTest(*state);
+		}
+	}
 
 	// Camera
 	float scale = state->camera.scale;
@@ -1970,18 +2304,15 @@ extern void GameUpdate(GameMemory &gameMemory, const Input &input) {
 	bool updateGameCode = state->wave.state == WaveState::Running;
 
 	if (state->wave.state != WaveState::Stopped) {
+		fplTimestamp updateStart = fplTimestampQuery();
+
 		//
 		// Move enemies
 		//
 		for (size_t enemyIndex = 0; enemyIndex < state->enemies.count; ++enemyIndex) {
 			Creep &enemy = state->enemies.list[enemyIndex];
-			if (!enemy.isDead && enemy.hasTarget) {
-				Vec2f distance = enemy.targetPos - enemy.position;
-				float minRadius = MaxTileSize * 0.05f;
-				enemy.position += enemy.facingDirection * enemy.speed * dt;
-				if (V2fDot(distance, distance) <= minRadius * minRadius) {
-					creeps::SetCreepNextTarget(*state, enemy);
-				}
+			if (!enemy.isDead) {
+				creeps::MoveCreep(*state, enemy, dt);
 			}
 		}
 
@@ -1991,6 +2322,17 @@ extern void GameUpdate(GameMemory &gameMemory, const Input &input) {
 			creeps::UpdateSpawner(*state, spawner, dt);
 		}
 
+		// Rebuild creep grid
+		SpatialGrid &creepGrid = state->level.creepGrid;
+		spatial::ClearGrid(creepGrid);
+		for (size_t enemyIndex = 0; enemyIndex < state->enemies.count; ++enemyIndex) {
+			const Creep &enemy = state->enemies.list[enemyIndex];
+			if (!enemy.isDead) {
+				spatial::AddItem(creepGrid, enemy.position, enemy.data->collisionRadius, (uint32_t)enemyIndex);
+			}
+		}
+		spatial::BuildGrid(creepGrid);
+
 		// Update towers
 		if (updateGameCode) {
 			for (size_t towerIndex = 0; towerIndex < state->towers.activeCount; ++towerIndex) {
@@ -2005,21 +2347,25 @@ extern void GameUpdate(GameMemory &gameMemory, const Input &input) {
 		for (size_t bulletIndex = 0; bulletIndex < state->bullets.count; ++bulletIndex) {
 			Bullet &bullet = state->bullets.list[bulletIndex];
 			if (!bullet.isDestroyed) {
+				Vec2f bulletStart = bullet.position;
 				bullet.position += bullet.velocity * dt;
 				if (!bullet.hasHit) {
-					for (size_t enemyIndex = 0; enemyIndex < state->enemies.count; ++enemyIndex) {
-						Creep &enemy = state->enemies.list[enemyIndex];
-						if (!enemy.isDead) {
-							Vec2f distance = enemy.position - bullet.position;
-							float bothRadi = bullet.data->collisionRadius + enemy.data->collisionRadius;
-							float d = V2fDot(distance, distance);
-							if (d < bothRadi * bothRadi) {
-								bullet.hasHit = true;
-								if (updateGameCode) {
-									creeps::CreepHit(*state, enemy, bullet);
-								}
-								break;
-							}
+					// Sweep the movement, so fast bullets cannot pass through creeps
+					Creep *hitEnemy = nullptr;
+					float hitFraction = FLT_MAX;
+					SpatialGridQuery query = spatial::BeginSegmentQuery(creepGrid, bulletStart, bullet.position, bullet.data->collisionRadius);
+					SpatialGridHit hit;
+					while (spatial::NextQueryHit(query, hit)) {
+						Creep *enemy = &state->enemies.list[hit.item->index];
+						if (!enemy->isDead && hit.value < hitFraction) {
+							hitEnemy = enemy;
+							hitFraction = hit.value;
+						}
+					}
+					if (hitEnemy != nullptr) {
+						bullet.hasHit = true;
+						if (updateGameCode) {
+							creeps::CreepHit(*state, *hitEnemy, bullet);
 						}
 					}
 				}
@@ -2050,6 +2396,8 @@ extern void GameUpdate(GameMemory &gameMemory, const Input &input) {
 				--state->bullets.count;
 			}
 		}
+		state->updateTime = (float)fplTimestampElapsed(updateStart, fplTimestampQuery());
+
 		size_t deadEnemyCount = 0;
 		size_t nonDeadEnemyCount = 0;
 		for (size_t enemyIndex = 0; enemyIndex < state->enemies.count; ++enemyIndex) {
@@ -2246,6 +2594,8 @@ extern void GameRender(GameMemory &gameMemory, const float alpha) {
 	//
 	// Enemies
 	//
+	// Grouped by state, so that all enemy meshes, hp bars and borders are drawn with a few draw calls only
+	SetRenderLayer(renderState, 1, RenderLayerMode::GroupByState);
 	for (size_t enemyIndex = 0; enemyIndex < state->enemies.count; ++enemyIndex) {
 		Creep &enemy = state->enemies.list[enemyIndex];
 		if (!enemy.isDead && enemy.id > 0) {
@@ -2292,6 +2642,7 @@ extern void GameRender(GameMemory &gameMemory, const float alpha) {
 	//
 	// Towers
 	//
+	SetRenderLayer(renderState, 2, RenderLayerMode::Ordered);
 	for (size_t towerIndex = 0; towerIndex < state->towers.activeCount; ++towerIndex) {
 		const Tower &tower = state->towers.activeList[towerIndex];
 		towers::DrawTower(renderState, state->assets, state->camera, *tower.data, tower.position, V2fInitScalar(MaxTileRadius), tower.facingAngle, 1.0f, false);
@@ -2380,11 +2731,13 @@ extern void GameRender(GameMemory &gameMemory, const float alpha) {
 		float fontHeight = MaxTileSize * 0.5f;
 		PushText(renderState, text, fplGetStringLength(text), &font.desc, &font.texture, V2fInit(textPos.x, textPos.y), fontHeight, 1.0f, 1.0f, textColor);
 
+		fplStringFormat(text, fplArrayCount(text), "Draw Calls: %zu, Vertices: %zu", gameMemory.render->lastDrawCallCount, gameMemory.render->lastVertexCount);
+		PushText(renderState, text, fplGetStringLength(text), &font.desc, &font.texture, V2fInit(textPos.x + dim.gridWidth - padding * 2.0f, textPos.y + fontHeight * 3), fontHeight, -1.0f, 1.0f, textColor);
 		fplStringFormat(text, fplArrayCount(text), "Game Memory: %zu / %zu", gameMemory.memory->used, gameMemory.memory->size);
 		PushText(renderState, text, fplGetStringLength(text), &font.desc, &font.texture, V2fInit(textPos.x + dim.gridWidth - padding * 2.0f, textPos.y + fontHeight * 2), fontHeight, -1.0f, 1.0f, textColor);
 		fplStringFormat(text, fplArrayCount(text), "Render Memory: %zu / %zu", gameMemory.render->lastMemoryUsage, gameMemory.render->memory.size);
 		PushText(renderState, text, fplGetStringLength(text), &font.desc, &font.texture, V2fInit(textPos.x + dim.gridWidth - padding * 2.0f, textPos.y + fontHeight * 1), fontHeight, -1.0f, 1.0f, textColor);
-		fplStringFormat(text, fplArrayCount(text), "Fps: %.5f, Delta: %.5f", state->framesPerSecond, state->deltaTime);
+		fplStringFormat(text, fplArrayCount(text), "Fps: %.5f, Delta: %.5f, Update: %.3f ms", state->framesPerSecond, state->deltaTime, state->updateTime * 1000.0f);
 		PushText(renderState, text, fplGetStringLength(text), &font.desc, &font.texture, V2fInit(textPos.x + dim.gridWidth - padding * 2.0f, textPos.y), fontHeight, -1.0f, 1.0f, textColor);
 	}
 
@@ -2402,6 +2755,13 @@ int main(int argc, char *argv[]) {
 	GameConfiguration config = {};
 	config.title = "FPL Demo | Towadev";
 	config.disableInactiveDetection = true;
+	for (int argIndex = 1; argIndex < argc; ++argIndex) {
+		if (fplIsStringEqual(argv[argIndex], "--software")) {
+			config.useSoftwareRenderer = true;
+		} else if (fplIsStringEqual(argv[argIndex], "--render-thread")) {
+			config.useRenderThread = true;
+		}
+	}
 	gamelog::Verbose("Startup game application '%s'", config.title);
 	int result = GameMain(config);
 	return(result);
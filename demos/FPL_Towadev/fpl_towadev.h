@@ -35,6 +35,9 @@ constexpr float ControlsHeight = TileHeight;
 constexpr float ControlsOriginX = -WorldRadiusW;
 constexpr float ControlsOriginY = -WorldRadiusH;
 
+constexpr size_t StressCreepCount = 4000;
+constexpr size_t StressTowerCount = 48;
+
 
 const Vec4f TextBackColor = V4fInit(0.2f, 0.2f, 0.8f, 1);
 const Vec4f TextForeColor = V4fInit(1, 1, 1, 1);
@@ -299,18 +302,14 @@ struct Creep {
 	Vec2f prevPosition;
 	Vec2f position;
 	Vec2f facingDirection;
-	Vec2f targetPos;
-	const Waypoint *targetWaypoint;
 	float speed;
 	int hp;
-	bool hasTarget;
 	bool isDead;
 };
 
 struct CreepSpawner {
 	const CreepData *spawnTemplate;
 	Vec2f spawnPosition;
-	Vec2f exitPosition;
 	size_t totalCount;
 	size_t remainingCount;
 	float spawnTimer;
@@ -472,7 +471,7 @@ struct Waypoints {
 
 struct Creeps {
 	uint64_t creepIdCounter;
-	Creep list[1024];
+	Creep list[8192];
 	size_t count;
 };
 
@@ -501,8 +500,75 @@ struct LevelDimension {
 	float gridHeight;
 };
 
+struct SpatialGridItem {
+	Vec2f position;
+	float radius;
+	uint32_t index;
+};
+
+// Uniform grid aligned to the level tiles, rebuilt from scratch in every fixed update
+struct SpatialGrid {
+	// Items sorted by cell, the items of cell N are in range [cellStarts[N], cellStarts[N + 1])
+	SpatialGridItem *items;
+	SpatialGridItem *pendingItems;
+	uint32_t *pendingCells;
+	uint32_t *cellStarts;
+	Vec2f origin;
+	Vec2f cellSize;
+	float maxItemRadius;
+	int cellCountX;
+	int cellCountY;
+	uint32_t itemCount;
+	uint32_t itemCapacity;
+};
+
+enum class SpatialGridQueryType {
+	Range = 0,
+	Segment,
+};
+
+struct SpatialGridQuery {
+	const SpatialGrid *grid;
+	Vec2f start;
+	Vec2f delta;
+	float radius;
+	SpatialGridQueryType type;
+	int minCellX;
+	int minCellY;
+	int maxCellX;
+	int maxCellY;
+	int cellX;
+	int cellY;
+	uint32_t itemIndex;
+	uint32_t itemEnd;
+};
+
+struct SpatialGridHit {
+	const SpatialGridItem *item;
+	// Distance to the center for range queries, fraction of the segment for segment queries
+	float value;
+};
+
+constexpr uint32_t FlowFieldUnreachable = UINT32_MAX;
+
+struct FlowFieldCell {
+	// Center of the next tile towards the goal, the goal itself for the goal tile
+	Vec2f targetPos;
+	// Number of tiles to the goal or FlowFieldUnreachable
+	uint32_t distance;
+};
+
+// Shortest way from every tile to the goal, computed by a breadth-first search from the goal over all walkable tiles
+struct FlowField {
+	FlowFieldCell *cells;
+	uint32_t *queue;
+	Vec2i goalTilePos;
+};
+
 struct Level {
 	fmemMemoryBlock levelMem;
+	SpatialGrid creepGrid;
+	FlowField flowField;
 	LevelData data;
 	char activeId[256];
 	LevelDimension dimension;
@@ -549,6 +615,7 @@ struct GameState {
 
 	float deltaTime;
 	float framesPerSecond;
+	float updateTime;
 
 	float slowdownTimer[2];
 	float slowdownScale;
@@ -91,6 +91,9 @@ extern void LockFreeRingBufferUnitTest();
 #if defined(FINAL_BUFFER_IMPLEMENTATION) && !defined(FINAL_BUFFER_IMPLEMENTED)
 #define FINAL_BUFFER_IMPLEMENTED
 
+#include <string.h> // memcpy
+#include <assert.h> // assert
+
 #if defined(FPL_PLATFORM_WINDOWS)
 
 //
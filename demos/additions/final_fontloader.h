@@ -12,6 +12,12 @@ License:
 	Copyright 2017-2025 Torsten Spaete
 
 Changelog:
+	## 2026-10-18
+	- Added baked font assets (BakeFont, SaveBakedFont, LoadFontFromBakedMemory, LoadFontFromBakedFile)
+	- Fixed ReleaseFont did not free the default advance table
+	- Kerning is stored as a sparse pair hash table instead of a dense table
+	- Added FontGlyphCache, which rasterizes glyphs on first use into a shelf packed atlas with LRU eviction
+
 	## 2018-06-30
 	- Fixed crash on ReleaseFont when not using kerning
 
@@ -54,6 +60,20 @@ typedef struct FontInfo {
 	float spaceAdvance;
 } FontInfo;
 
+typedef struct FontKerningPair {
+	uint32_t first;
+	uint32_t second;
+	float kerning;
+	uint32_t isUsed;
+} FontKerningPair;
+
+// Kerning per code point pair, open addressing with linear probing
+typedef struct FontKerningTable {
+	FontKerningPair *pairs;
+	uint32_t capacity;
+	uint32_t count;
+} FontKerningTable;
+
 typedef struct LoadedFont {
 	uint8_t *atlasAlphaBitmap;
 	FontGlyph *glyphs;
@@ -63,10 +83,133 @@ typedef struct LoadedFont {
 	uint32_t charCount;
 	FontInfo info;
 	float *defaultAdvance;
-	float *kerningTable;
+	// Contains non-zero pairs only
+	FontKerningTable kerningTable;
+	// File data of a baked font loaded from a file, freed on ReleaseFont
+	void *bakedFileData;
 	bool hasKerningTable;
+	// All pointers point into the baked font data, so nothing except bakedFileData is freed on ReleaseFont
+	bool isBaked;
 } LoadedFont;
 
+//
+// Baked font
+//
+// A baked font contains everything of a LoadedFont, so it can be used without any parsing or rasterization:
+// [Header] [Glyphs] [Default advances] [Kerning pairs] [Atlas alpha bitmap]
+// Each section starts at a multiple of FONT_BAKED_ALIGNMENT and the kerning pairs are stored as the hash table itself.
+// The data is written in native byte order and must be aligned to at least 8 bytes (fplMemoryAllocate or a uint64_t array made by the staticdatamaker).
+//
+#define FONT_BAKED_MAGIC 0x4B424E46 // FNBK
+#define FONT_BAKED_VERSION 1
+#define FONT_BAKED_ALIGNMENT 16
+
+typedef struct FontBakedHeader {
+	uint32_t magic;
+	uint32_t version;
+	uint64_t totalSize;
+	FontInfo info;
+	uint32_t firstChar;
+	uint32_t charCount;
+	uint32_t atlasWidth;
+	uint32_t atlasHeight;
+	uint32_t kerningCapacity;
+	uint32_t kerningCount;
+	uint32_t hasKerningTable;
+	uint32_t reserved;
+	uint64_t glyphsOffset;
+	uint64_t defaultAdvanceOffset;
+	uint64_t kerningOffset;
+	uint64_t atlasOffset;
+} FontBakedHeader;
+
+//
+// Glyph cache
+//
+// Glyphs are rasterized on first use and packed into shelfs (rows with a fixed height) of a single alpha atlas.
+// When the atlas is full, the least recently used shelf is cleared, except for shelfs used in the current frame.
+// With a worker thread, missing glyphs are rasterized in the background and are available after the next UpdateFontGlyphCache().
+//
+#define FONT_GLYPH_CACHE_MAX_PENDING 64
+
+typedef enum FontCacheGlyphState {
+	FontCacheGlyphState_Free = 0,
+	FontCacheGlyphState_Pending,
+	FontCacheGlyphState_Ready,
+} FontCacheGlyphState;
+
+typedef struct FontCacheGlyph {
+	FontGlyph glyph;
+	float advance;
+	uint32_t lastUsedFrame;
+	// -1 when the glyph has no pixels
+	int32_t shelfIndex;
+	uint32_t nextFree;
+	FontCacheGlyphState state;
+} FontCacheGlyph;
+
+typedef struct FontCacheShelf {
+	uint32_t y;
+	uint32_t height;
+	uint32_t usedWidth;
+	uint32_t lastUsedFrame;
+} FontCacheShelf;
+
+typedef struct FontGlyphBitmap {
+	uint8_t *pixels;
+	uint32_t codePoint;
+	int32_t width;
+	int32_t height;
+	int32_t xoff;
+	int32_t yoff;
+	float advance;
+} FontGlyphBitmap;
+
+typedef struct FontGlyphCache {
+	uint8_t *fontData;
+	// stbtt_fontinfo
+	void *fontInfo;
+	float fontSize;
+	float scale;
+	FontInfo info;
+
+	uint8_t *atlasAlphaBitmap;
+	uint32_t atlasWidth;
+	uint32_t atlasHeight;
+	// Set when the atlas was changed, the caller uploads the atlas and clears the flag
+	bool isAtlasDirty;
+
+	FontCacheShelf *shelfs;
+	uint32_t shelfCount;
+	uint32_t maxShelfCount;
+	uint32_t nextShelfY;
+
+	FontCacheGlyph *glyphs;
+	// Glyph index + 1 per slot, zero is empty
+	uint32_t *glyphMap;
+	uint32_t glyphCapacity;
+	uint32_t glyphMapCapacity;
+	uint32_t firstFreeGlyph;
+
+	// Contains zero pairs as well, so that each pair is only looked up once
+	FontKerningTable kerningTable;
+
+	uint32_t frameIndex;
+
+	// Worker thread only
+	fplThreadHandle *worker;
+	fplMutexHandle queueLock;
+	fplSemaphoreHandle requestSignal;
+	uint32_t requests[FONT_GLYPH_CACHE_MAX_PENDING];
+	FontGlyphBitmap results[FONT_GLYPH_CACHE_MAX_PENDING];
+	uint32_t requestHead;
+	uint32_t requestTail;
+	uint32_t resultHead;
+	uint32_t resultTail;
+	uint32_t pendingCount;
+	volatile int32_t isStopping;
+} FontGlyphCache;
+
 inline const FontGlyph *GetFontGlyph(const LoadedFont *font, const uint32_t codePoint) {
 	if(font == fpl_null) {
 		return(fpl_null);
@@ -99,6 +242,24 @@ extern float GetFontCharacterAdvance(const LoadedFont *font, const uint32_t this
 extern bool LoadFontFromFile(const char *dataPath, const char *filename, const uint32_t fontIndex, const float fontSize, const uint32_t firstChar, const uint32_t lastChar, const uint32_t atlasWidth, const uint32_t atlasHeight, const bool loadKerning, LoadedFont *outFont);
 extern bool LoadFontFromMemory(const void *data, const size_t dataSize, const uint32_t fontIndex, const float fontSize, const uint32_t firstChar, const uint32_t lastChar, const uint32_t  atlasWidth, const uint32_t atlasHeight, const bool loadKerning, LoadedFont *outFont);
 extern void ReleaseFont(LoadedFont *font);
+extern bool GetFontKerning(const FontKerningTable *table, const uint32_t first, const uint32_t second, float *outKerning);
+
+// Returns the number of bytes required to bake the font
+extern size_t GetBakedFontSize(const LoadedFont *font);
+// Writes the font into the data and returns the number of bytes written or zero when the data is too small
+extern size_t BakeFont(const LoadedFont *font, void *outData, const size_t maxDataSize);
+extern bool SaveBakedFont(const LoadedFont *font, const char *filePath);
+// The font points directly into the data, so the data must stay alive until the font is released
+extern bool LoadFontFromBakedMemory(const void *data, const size_t dataSize, LoadedFont *outFont);
+extern bool LoadFontFromBakedFile(const char *dataPath, const char *filename, LoadedFont *outFont);
+
+extern bool InitFontGlyphCache(FontGlyphCache *cache, const void *data, const size_t dataSize, const uint32_t fontIndex, const float fontSize, const uint32_t atlasWidth, const uint32_t atlasHeight, const uint32_t maxGlyphCount, const bool useWorkerThread);
+extern void ReleaseFontGlyphCache(FontGlyphCache *cache);
+// Commits the glyphs rasterized by the worker thread and starts a new frame, call once per frame
+extern void UpdateFontGlyphCache(FontGlyphCache *cache);
+// Returns null when the glyph is not rasterized yet or does not fit into the atlas
+extern const FontGlyph *GetCachedFontGlyph(FontGlyphCache *cache, const uint32_t codePoint);
+extern float GetCachedFontCharacterAdvance(FontGlyphCache *cache, const uint32_t thisCodePoint, const uint32_t nextCodePoint);
 
 #endif // FINAL_FONTLOADER_H
 
@@ -169,9 +330,8 @@ extern float GetFontCharacterAdvance(const LoadedFont *font, const uint32_t this
 		const FontGlyph *glyph = font->glyphs + thisIndex;
 		result = font->defaultAdvance[thisIndex];
 		if(font->hasKerningTable) {
-			if(nextCodePoint >= font->firstChar && nextCodePoint < (font->firstChar - font->charCount)) {
-				uint32_t nextIndex = nextCodePoint - font->firstChar;
-				float kerning = font->kerningTable[thisIndex * font->charCount + nextIndex];
+			float kerning;
+			if(GetFontKerning(&font->kerningTable, thisCodePoint, nextCodePoint, &kerning)) {
 				result += kerning;
 			}
 		}
@@ -179,6 +339,76 @@ extern float GetFontCharacterAdvance(const LoadedFont *font, const uint32_t this
 	return(result);
 }
 
+static uint32_t HashFontKerningPair(const uint32_t first, const uint32_t second) {
+	uint32_t result = first * 0x9E3779B1u ^ (second + 0x7F4A7C15u + (first << 6) + (first >> 2));
+	return(result);
+}
+
+static bool AddFontKerning(FontKerningTable *table, const uint32_t first, const uint32_t second, const float kerning) {
+	// Keep the load factor below 3/4
+	if((table->count + 1) * 4 > table->capacity * 3) {
+		uint32_t newCapacity = table->capacity > 0 ? table->capacity * 2 : 64;
+		FontKerningPair *newPairs = (FontKerningPair *)fplMemoryAllocate(sizeof(FontKerningPair) * newCapacity);
+		if(newPairs == fpl_null) {
+			return false;
+		}
+		for(uint32_t i = 0; i < table->capacity; ++i) {
+			const FontKerningPair *pair = table->pairs + i;
+			if(pair->isUsed) {
+				uint32_t slot = HashFontKerningPair(pair->first, pair->second) & (newCapacity - 1);
+				while(newPairs[slot].isUsed) {
+					slot = (slot + 1) & (newCapacity - 1);
+				}
+				newPairs[slot] = *pair;
+			}
+		}
+		if(table->pairs != fpl_null) {
+			fplMemoryFree(table->pairs);
+		}
+		table->pairs = newPairs;
+		table->capacity = newCapacity;
+	}
+	uint32_t slot = HashFontKerningPair(first, second) & (table->capacity - 1);
+	while(table->pairs[slot].isUsed) {
+		FontKerningPair *pair = table->pairs + slot;
+		if(pair->first == first && pair->second == second) {
+			pair->kerning = kerning;
+			return true;
+		}
+		slot = (slot + 1) & (table->capacity - 1);
+	}
+	FontKerningPair *pair = table->pairs + slot;
+	pair->first = first;
+	pair->second = second;
+	pair->kerning = kerning;
+	pair->isUsed = 1;
+	++table->count;
+	return true;
+}
+
+static void ReleaseFontKerningTable(FontKerningTable *table) {
+	if(table->pairs != fpl_null) {
+		fplMemoryFree(table->pairs);
+	}
+	fplClearStruct(table);
+}
+
+extern bool GetFontKerning(const FontKerningTable *table, const uint32_t first, const uint32_t second, float *outKerning) {
+	if(table == fpl_null || table->count == 0) {
+		return false;
+	}
+	uint32_t slot = HashFontKerningPair(first, second) & (table->capacity - 1);
+	while(table->pairs[slot].isUsed) {
+		const FontKerningPair *pair = table->pairs + slot;
+		if(pair->first == first && pair->second == second) {
+			*outKerning = pair->kerning;
+			return true;
+		}
+		slot = (slot + 1) & (table->capacity - 1);
+	}
+	return false;
+}
+
 extern bool LoadFontFromMemory(const void *data, const size_t dataSize, const uint32_t fontIndex, const float fontSize, const uint32_t firstChar, const uint32_t lastChar, const uint32_t  atlasWidth, const uint32_t atlasHeight, const bool loadKerning, LoadedFont *outFont) {
 	if(data == fpl_null || dataSize == 0) {
 		return false;
@@ -279,15 +509,7 @@ extern bool LoadFontFromMemory(const void *data, const size_t dataSize, const ui
 	}
 
 	// Build kerning table & default advance table
-	size_t kerningTableSize;
-	float *kerningTable;
-	if(loadKerning) {
-		kerningTableSize = sizeof(float) * charCount * charCount;
-		kerningTable = (float *)fplMemoryAllocate(kerningTableSize);
-	} else {
-		kerningTableSize = 0;
-		kerningTable = fpl_null;
-	}
+	FontKerningTable kerningTable = fplZeroInit;
 
 	size_t defaultAdvanceSize = charCount * sizeof(float);
 	float *defaultAdvance = (float *)fplMemoryAllocate(defaultAdvanceSize);
@@ -307,9 +529,7 @@ extern bool LoadFontFromMemory(const void *data, const size_t dataSize, const ui
 					int widthPx = leftInfo->x1 - leftInfo->x0;
 					if(widthPx > 0) {
 						float kerning = kerningPx / (float)widthPx;
-						uint32_t a = (uint32_t)(charIndex - firstChar);
-						uint32_t b = (uint32_t)(nextCharIndex - firstChar);
-						kerningTable[a * charCount + b] = kerning;
+						AddFontKerning(&kerningTable, charIndex, nextCharIndex, kerning);
 					}
 				}
 			}
@@ -372,13 +592,688 @@ extern bool LoadFontFromFile(const char *dataPath, const char *filename, const u
 
 extern void ReleaseFont(LoadedFont *font) {
 	if(font != fpl_null) {
-		if(font->hasKerningTable) {
-			fplMemoryFree(font->kerningTable);
+		if(font->isBaked) {
+			if(font->bakedFileData != fpl_null) {
+				fplMemoryFree(font->bakedFileData);
+			}
+		} else {
+			ReleaseFontKerningTable(&font->kerningTable);
+			if(font->defaultAdvance != fpl_null) {
+				fplMemoryFree(font->defaultAdvance);
+			}
+			fplMemoryFree(font->glyphs);
+			fplMemoryFree(font->atlasAlphaBitmap);
 		}
-		fplMemoryFree(font->glyphs);
-		fplMemoryFree(font->atlasAlphaBitmap);
 		fplClearStruct(font);
 	}
 }
 
+//
+// Baked font
+//
+static FontBakedHeader ComputeBakedFontLayout(const LoadedFont *font) {
+	FontBakedHeader result = fplZeroInit;
+	result.magic = FONT_BAKED_MAGIC;
+	result.version = FONT_BAKED_VERSION;
+	result.info = font->info;
+	result.firstChar = font->firstChar;
+	result.charCount = font->charCount;
+	result.atlasWidth = font->atlasWidth;
+	result.atlasHeight = font->atlasHeight;
+	result.kerningCapacity = font->kerningTable.capacity;
+	result.kerningCount = font->kerningTable.count;
+	result.hasKerningTable = font->hasKerningTable ? 1 : 0;
+
+	uint64_t offset = fplGetAlignedSize(sizeof(FontBakedHeader), FONT_BAKED_ALIGNMENT);
+	result.glyphsOffset = offset;
+	offset += fplGetAlignedSize(sizeof(FontGlyph) * (uint64_t)font->charCount, FONT_BAKED_ALIGNMENT);
+	result.defaultAdvanceOffset = offset;
+	offset += fplGetAlignedSize(sizeof(float) * (uint64_t)font->charCount, FONT_BAKED_ALIGNMENT);
+	result.kerningOffset = offset;
+	offset += fplGetAlignedSize(sizeof(FontKerningPair) * (uint64_t)font->kerningTable.capacity, FONT_BAKED_ALIGNMENT);
+	result.atlasOffset = offset;
+	offset += fplGetAlignedSize((uint64_t)font->atlasWidth * font->atlasHeight, FONT_BAKED_ALIGNMENT);
+	result.totalSize = offset;
+	return(result);
+}
+
+extern size_t GetBakedFontSize(const LoadedFont *font) {
+	if(font == fpl_null) {
+		return(0);
+	}
+	FontBakedHeader header = ComputeBakedFontLayout(font);
+	size_t result = (size_t)header.totalSize;
+	return(result);
+}
+
+extern size_t BakeFont(const LoadedFont *font, void *outData, const size_t maxDataSize) {
+	if(font == fpl_null || outData == fpl_null) {
+		return(0);
+	}
+	FontBakedHeader header = ComputeBakedFontLayout(font);
+	if(header.totalSize > maxDataSize) {
+		return(0);
+	}
+	uint8_t *data = (uint8_t *)outData;
+	fplMemoryClear(data, (size_t)header.totalSize);
+	fplMemoryCopy(&header, sizeof(header), data);
+	if(font->charCount > 0) {
+		fplMemoryCopy(font->glyphs, sizeof(FontGlyph) * font->charCount, data + header.glyphsOffset);
+		if(font->defaultAdvance != fpl_null) {
+			fplMemoryCopy(font->defaultAdvance, sizeof(float) * font->charCount, data + header.defaultAdvanceOffset);
+		}
+	}
+	if(font->kerningTable.capacity > 0) {
+		fplMemoryCopy(font->kerningTable.pairs, sizeof(FontKerningPair) * font->kerningTable.capacity, data + header.kerningOffset);
+	}
+	fplMemoryCopy(font->atlasAlphaBitmap, (size_t)font->atlasWidth * font->atlasHeight, data + header.atlasOffset);
+	size_t result = (size_t)header.totalSize;
+	return(result);
+}
+
+extern bool SaveBakedFont(const LoadedFont *font, const char *filePath) {
+	if(font == fpl_null || filePath == fpl_null) {
+		return false;
+	}
+	size_t dataSize = GetBakedFontSize(font);
+	void *data = fplMemoryAllocate(dataSize);
+	if(data == fpl_null) {
+		return false;
+	}
+	bool result = false;
+	if(BakeFont(font, data, dataSize) == dataSize) {
+		fplFileHandle file;
+		if(fplFileCreateBinary(filePath, &file)) {
+			result = fplFileWriteBlock64(&file, data, dataSize) == dataSize;
+			fplFileClose(&file);
+		}
+	}
+	fplMemoryFree(data);
+	return(result);
+}
+
+extern bool LoadFontFromBakedMemory(const void *data, const size_t dataSize, LoadedFont *outFont) {
+	if(data == fpl_null || outFont == fpl_null || dataSize < sizeof(FontBakedHeader)) {
+		return false;
+	}
+	if(!fplIsAligned(data, 8)) {
+		return false;
+	}
+
+	const uint8_t *bytes = (const uint8_t *)data;
+	const FontBakedHeader *header = (const FontBakedHeader *)bytes;
+	if(header->magic != FONT_BAKED_MAGIC || header->version != FONT_BAKED_VERSION || header->totalSize > dataSize) {
+		return false;
+	}
+	if(header->kerningCapacity & (header->kerningCapacity - 1)) {
+		return false;
+	}
+
+	// The layout is not trusted, so all sections are validated against the size
+	uint64_t glyphsSize = sizeof(FontGlyph) * (uint64_t)header->charCount;
+	uint64_t defaultAdvanceSize = sizeof(float) * (uint64_t)header->charCount;
+	uint64_t kerningSize = sizeof(FontKerningPair) * (uint64_t)header->kerningCapacity;
+	uint64_t atlasSize = (uint64_t)header->atlasWidth * header->atlasHeight;
+	if((header->glyphsOffset + glyphsSize) > header->totalSize ||
+		(header->defaultAdvanceOffset + defaultAdvanceSize) > header->totalSize ||
+		(header->kerningOffset + kerningSize) > header->totalSize ||
+		(header->atlasOffset + atlasSize) > header->totalSize) {
+		return false;
+	}
+	if((header->glyphsOffset | header->defaultAdvanceOffset | header->kerningOffset | header->atlasOffset) % FONT_BAKED_ALIGNMENT) {
+		return false;
+	}
+
+	fplClearStruct(outFont);
+	outFont->isBaked = true;
+	outFont->info = header->info;
+	outFont->firstChar = header->firstChar;
+	outFont->charCount = header->charCount;
+	outFont->atlasWidth = header->atlasWidth;
+	outFont->atlasHeight = header->atlasHeight;
+	outFont->glyphs = (FontGlyph *)(bytes + header->glyphsOffset);
+	outFont->defaultAdvance = (float *)(bytes + header->defaultAdvanceOffset);
+	outFont->atlasAlphaBitmap = (uint8_t *)(bytes + header->atlasOffset);
+	if(header->kerningCapacity > 0) {
+		outFont->kerningTable.pairs = (FontKerningPair *)(bytes + header->kerningOffset);
+		outFont->kerningTable.capacity = header->kerningCapacity;
+		outFont->kerningTable.count = header->kerningCount;
+	}
+	outFont->hasKerningTable = header->hasKerningTable != 0;
+	return true;
+}
+
+extern bool LoadFontFromBakedFile(const char *dataPath, const char *filename, LoadedFont *outFont) {
+	if(filename == fpl_null || outFont == fpl_null) {
+		return false;
+	}
+
+	char filePath[FPL_MAX_PATH_LENGTH];
+	if(dataPath != fpl_null) {
+		fplPathCombine(filePath, fplArrayCount(filePath), 2, dataPath, filename);
+	} else {
+		fplCopyString(filename, filePath, fplArrayCount(filePath));
+	}
+
+	fplFileHandle file;
+	if(!fplFileOpenBinary(filePath, &file)) {
+		return false;
+	}
+	size_t dataSize = (size_t)fplFileGetSizeFromHandle64(&file);
+	void *data = dataSize > 0 ? fplMemoryAllocate(dataSize) : fpl_null;
+	bool result = false;
+	if(data != fpl_null) {
+		if(fplFileReadBlock64(&file, dataSize, data, dataSize) == dataSize) {
+			result = LoadFontFromBakedMemory(data, dataSize, outFont);
+		}
+		if(result) {
+			outFont->bakedFileData = data;
+		} else {
+			fplMemoryFree(data);
+		}
+	}
+	fplFileClose(&file);
+	return(result);
+}
+
+//
+// Glyph cache
+//
+static void RasterizeFontGlyph(const stbtt_fontinfo *fontInfo, const float scale, const uint32_t codePoint, FontGlyphBitmap *outBitmap) {
+	fplClearStruct(outBitmap);
+	outBitmap->codePoint = codePoint;
+
+	int advanceRaw, leftSideBearing;
+	stbtt_GetCodepointHMetrics(fontInfo, (int)codePoint, &advanceRaw, &leftSideBearing);
+	outBitmap->advance = advanceRaw * scale;
+
+	int x0, y0, x1, y1;
+	stbtt_GetCodepointBitmapBox(fontInfo, (int)codePoint, scale, scale, &x0, &y0, &x1, &y1);
+	int width = x1 - x0;
+	int height = y1 - y0;
+	if(width > 0 && height > 0) {
+		outBitmap->pixels = (uint8_t *)fplMemoryAllocate(width * height);
+		if(outBitmap->pixels != fpl_null) {
+			stbtt_MakeCodepointBitmap(fontInfo, outBitmap->pixels, width, height, width, scale, scale, (int)codePoint);
+			outBitmap->width = width;
+			outBitmap->height = height;
+		}
+	}
+	outBitmap->xoff = x0;
+	outBitmap->yoff = y0;
+}
+
+static uint32_t HashFontCodePoint(const uint32_t codePoint) {
+	uint32_t result = codePoint * 0x9E3779B1u;
+	return(result);
+}
+
+static uint32_t FindFontCacheGlyph(const FontGlyphCache *cache, const uint32_t codePoint) {
+	uint32_t mask = cache->glyphMapCapacity - 1;
+	uint32_t slot = HashFontCodePoint(codePoint) & mask;
+	while(cache->glyphMap[slot] > 0) {
+		uint32_t glyphIndex = cache->glyphMap[slot] - 1;
+		if(cache->glyphs[glyphIndex].glyph.charCode == codePoint) {
+			return(glyphIndex);
+		}
+		slot = (slot + 1) & mask;
+	}
+	return(UINT32_MAX);
+}
+
+static void InsertFontCacheGlyph(FontGlyphCache *cache, const uint32_t glyphIndex) {
+	uint32_t mask = cache->glyphMapCapacity - 1;
+	uint32_t slot = HashFontCodePoint(cache->glyphs[glyphIndex].glyph.charCode) & mask;
+	while(cache->glyphMap[slot] > 0) {
+		slot = (slot + 1) & mask;
+	}
+	cache->glyphMap[slot] = glyphIndex + 1;
+}
+
+// Removes the glyph from the map with backward shift deletion and puts it into the free list
+static void RemoveFontCacheGlyph(FontGlyphCache *cache, const uint32_t glyphIndex) {
+	uint32_t mask = cache->glyphMapCapacity - 1;
+	uint32_t slot = HashFontCodePoint(cache->glyphs[glyphIndex].glyph.charCode) & mask;
+	while(cache->glyphMap[slot] != glyphIndex + 1) {
+		fplAssert(cache->glyphMap[slot] > 0);
+		slot = (slot + 1) & mask;
+	}
+	uint32_t hole = slot;
+	for(;;) {
+		slot = (slot + 1) & mask;
+		if(cache->glyphMap[slot] == 0) {
+			break;
+		}
+		uint32_t home = HashFontCodePoint(cache->glyphs[cache->glyphMap[slot] - 1].glyph.charCode) & mask;
+		// Move the entry into the hole, when its home slot is not between the hole and its current slot
+		if(((slot - home) & mask) >= ((slot - hole) & mask)) {
+			cache->glyphMap[hole] = cache->glyphMap[slot];
+			hole = slot;
+		}
+	}
+	cache->glyphMap[hole] = 0;
+
+	FontCacheGlyph *glyph = cache->glyphs + glyphIndex;
+	fplClearStruct(glyph);
+	glyph->nextFree = cache->firstFreeGlyph;
+	cache->firstFreeGlyph = glyphIndex;
+}
+
+// Removes all glyphs of the shelf and clears its pixels
+static void ClearFontCacheShelf(FontGlyphCache *cache, const uint32_t shelfIndex) {
+	for(uint32_t glyphIndex = 0; glyphIndex < cache->glyphCapacity; ++glyphIndex) {
+		const FontCacheGlyph *glyph = cache->glyphs + glyphIndex;
+		if(glyph->state == FontCacheGlyphState_Ready && glyph->shelfIndex == (int32_t)shelfIndex) {
+			RemoveFontCacheGlyph(cache, glyphIndex);
+		}
+	}
+	FontCacheShelf *shelf = cache->shelfs + shelfIndex;
+	fplMemoryClear(cache->atlasAlphaBitmap + shelf->y * cache->atlasWidth, shelf->height * cache->atlasWidth);
+	shelf->usedWidth = 0;
+	cache->isAtlasDirty = true;
+}
+
+// Clears the least recently used shelf which is at least minHeight tall and was not used in the current frame
+static bool EvictFontCacheShelf(FontGlyphCache *cache, const uint32_t minHeight) {
+	int32_t victim = -1;
+	for(uint32_t shelfIndex = 0; shelfIndex < cache->shelfCount; ++shelfIndex) {
+		const FontCacheShelf *shelf = cache->shelfs + shelfIndex;
+		if(shelf->height >= minHeight && shelf->lastUsedFrame < cache->frameIndex && shelf->usedWidth > 0) {
+			if(victim == -1 || shelf->lastUsedFrame < cache->shelfs[victim].lastUsedFrame) {
+				victim = (int32_t)shelfIndex;
+			}
+		}
+	}
+	if(victim == -1) {
+		return false;
+	}
+	ClearFontCacheShelf(cache, (uint32_t)victim);
+	return true;
+}
+
+// Merges neighbouring shelfs which was not used in the current frame into a single cleared shelf, which is at least the given height tall.
+// Otherwise a glyph taller than all shelfs would never fit, once the atlas is filled with smaller shelfs.
+static bool MergeFontCacheShelfs(FontGlyphCache *cache, const uint32_t height) {
+	// Shelfs are sorted by y without any gaps, the space below the last shelf is free
+	uint32_t runStart = 0;
+	uint32_t runCount = 0;
+	uint32_t runHeight = 0;
+	for(uint32_t first = 0; first < cache->shelfCount && runCount == 0; ++first) {
+		uint32_t totalHeight = 0;
+		for(uint32_t last = first; last < cache->shelfCount && cache->shelfs[last].lastUsedFrame < cache->frameIndex; ++last) {
+			totalHeight += cache->shelfs[last].height;
+			uint32_t freeBelow = (last + 1) == cache->shelfCount ? cache->atlasHeight - cache->nextShelfY : 0;
+			if((totalHeight + freeBelow) >= height) {
+				runStart = first;
+				runCount = last - first + 1;
+				runHeight = totalHeight;
+				break;
+			}
+		}
+	}
+	if(runCount == 0) {
+		return false;
+	}
+	for(uint32_t shelfIndex = runStart; shelfIndex < runStart + runCount; ++shelfIndex) {
+		ClearFontCacheShelf(cache, shelfIndex);
+	}
+	if((runStart + runCount) == cache->shelfCount) {
+		// The last shelfs are given back to the free space below
+		cache->nextShelfY = cache->shelfs[runStart].y;
+		cache->shelfCount = runStart;
+		return true;
+	}
+	cache->shelfs[runStart].height = runHeight;
+	// The following shelfs are moved down, so the glyphs on these shelfs get the new shelf index
+	uint32_t removeCount = runCount - 1;
+	for(uint32_t shelfIndex = runStart + runCount; shelfIndex < cache->shelfCount; ++shelfIndex) {
+		cache->shelfs[shelfIndex - removeCount] = cache->shelfs[shelfIndex];
+	}
+	for(uint32_t glyphIndex = 0; glyphIndex < cache->glyphCapacity; ++glyphIndex) {
+		FontCacheGlyph *glyph = cache->glyphs + glyphIndex;
+		if(glyph->state == FontCacheGlyphState_Ready && glyph->shelfIndex > (int32_t)runStart) {
+			glyph->shelfIndex -= (int32_t)removeCount;
+		}
+	}
+	cache->shelfCount -= removeCount;
+	return true;
+}
+
+static uint32_t AllocateFontCacheGlyph(FontGlyphCache *cache) {
+	if(cache->firstFreeGlyph == UINT32_MAX) {
+		// Glyphs without pixels are never evicted, so any shelf will do
+		if(!EvictFontCacheShelf(cache, 0)) {
+			return(UINT32_MAX);
+		}
+	}
+	uint32_t result = cache->firstFreeGlyph;
+	if(result != UINT32_MAX) {
+		cache->firstFreeGlyph = cache->glyphs[result].nextFree;
+	}
+	return(result);
+}
+
+// Finds space for the given size in pixels (including padding) and returns the shelf index or -1
+static int32_t AllocateFontCacheRegion(FontGlyphCache *cache, const uint32_t width, const uint32_t height, uint32_t *outX, uint32_t *outY) {
+	if(width > cache->atlasWidth || height > cache->atlasHeight) {
+		return(-1);
+	}
+	for(int pass = 0; pass < 2; ++pass) {
+		// Existing shelf, that does not waste too much height
+		for(uint32_t shelfIndex = 0; shelfIndex < cache->shelfCount; ++shelfIndex) {
+			FontCacheShelf *shelf = cache->shelfs + shelfIndex;
+			if(shelf->height >= height && shelf->height <= height + height / 2 + 2 && (cache->atlasWidth - shelf->usedWidth) >= width) {
+				*outX = shelf->usedWidth;
+				*outY = shelf->y;
+				shelf->usedWidth += width;
+				return((int32_t)shelfIndex);
+			}
+		}
+
+		// New shelf
+		if(cache->shelfCount < cache->maxShelfCount && (cache->nextShelfY + height) <= cache->atlasHeight) {
+			FontCacheShelf *shelf = cache->shelfs + cache->shelfCount;
+			shelf->y = cache->nextShelfY;
+			shelf->height = height;
+			shelf->usedWidth = width;
+			shelf->lastUsedFrame = cache->frameIndex;
+			cache->nextShelfY += height;
+			*outX = 0;
+			*outY = shelf->y;
+			return((int32_t)cache->shelfCount++);
+		}
+
+		if(pass == 0 && !EvictFontCacheShelf(cache, height) && !MergeFontCacheShelfs(cache, height)) {
+			break;
+		}
+	}
+
+	// Any cleared shelf which is tall enough
+	for(uint32_t shelfIndex = 0; shelfIndex < cache->shelfCount; ++shelfIndex) {
+		FontCacheShelf *shelf = cache->shelfs + shelfIndex;
+		if(shelf->height >= height && (cache->atlasWidth - shelf->usedWidth) >= width) {
+			*outX = shelf->usedWidth;
+			*outY = shelf->y;
+			shelf->usedWidth += width;
+			return((int32_t)shelfIndex);
+		}
+	}
+	return(-1);
+}
+
+// Copies the rasterized glyph into the atlas and makes it ready, the glyph is freed when it does not fit
+static void CommitFontCacheGlyph(FontGlyphCache *cache, const uint32_t glyphIndex, const FontGlyphBitmap *bitmap) {
+	FontCacheGlyph *entry = cache->glyphs + glyphIndex;
+	fplAssert(entry->state == FontCacheGlyphState_Pending);
+	fplAssert(entry->glyph.charCode == bitmap->codePoint);
+
+	const float pixelsToUnits = 1.0f / cache->fontSize;
+	entry->shelfIndex = -1;
+	if(bitmap->pixels != fpl_null) {
+		// One pixel padding to the right and bottom, so that filtering does not bleed into neighbours
+		uint32_t x, y;
+		int32_t shelfIndex = AllocateFontCacheRegion(cache, bitmap->width + 1, bitmap->height + 1, &x, &y);
+		if(shelfIndex == -1) {
+			RemoveFontCacheGlyph(cache, glyphIndex);
+			return;
+		}
+		for(int32_t row = 0; row < bitmap->height; ++row) {
+			fplMemoryCopy(bitmap->pixels + row * bitmap->width, bitmap->width, cache->atlasAlphaBitmap + (y + row) * cache->atlasWidth + x);
+		}
+		cache->isAtlasDirty = true;
+
+		float texelU = 1.0f / (float)cache->atlasWidth;
+		float texelV = 1.0f / (float)cache->atlasHeight;
+		entry->shelfIndex = shelfIndex;
+		entry->glyph.uvMin = V2fInit(x * texelU, (y + bitmap->height) * texelV);
+		entry->glyph.uvMax = V2fInit((x + bitmap->width) * texelU, y * texelV);
+		entry->glyph.charSize = V2fMultScalar(V2fInit((float)bitmap->width, (float)bitmap->height), pixelsToUnits);
+	}
+	entry->glyph.offset = V2fMultScalar(V2fInit((float)bitmap->xoff, (float)-bitmap->yoff), pixelsToUnits);
+	entry->advance = bitmap->advance * pixelsToUnits;
+	entry->state = FontCacheGlyphState_Ready;
+}
+
+static void FontGlyphCacheWorkerProc(const fplThreadHandle *thread, void *userData) {
+	FontGlyphCache *cache = (FontGlyphCache *)userData;
+	for(;;) {
+		fplSemaphoreWait(&cache->requestSignal, FPL_TIMEOUT_INFINITE);
+		if(fplAtomicLoadS32(&cache->isStopping)) {
+			break;
+		}
+		fplMutexLock(&cache->queueLock);
+		fplAssert(cache->requestTail != cache->requestHead);
+		uint32_t codePoint = cache->requests[cache->requestTail++ % FONT_GLYPH_CACHE_MAX_PENDING];
+		fplMutexUnlock(&cache->queueLock);
+
+		FontGlyphBitmap bitmap;
+		RasterizeFontGlyph((const stbtt_fontinfo *)cache->fontInfo, cache->scale, codePoint, &bitmap);
+
+		fplMutexLock(&cache->queueLock);
+		cache->results[cache->resultHead++ % FONT_GLYPH_CACHE_MAX_PENDING] = bitmap;
+		fplMutexUnlock(&cache->queueLock);
+	}
+}
+
+extern bool InitFontGlyphCache(FontGlyphCache *cache, const void *data, const size_t dataSize, const uint32_t fontIndex, const float fontSize, const uint32_t atlasWidth, const uint32_t atlasHeight, const uint32_t maxGlyphCount, const bool useWorkerThread) {
+	if(cache == fpl_null || data == fpl_null || dataSize == 0 || maxGlyphCount == 0 || atlasWidth == 0 || atlasHeight == 0) {
+		return false;
+	}
+
+	fplClearStruct(cache);
+
+	// The font data is used for the entire lifetime of the cache
+	cache->fontData = (uint8_t *)fplMemoryAllocate(dataSize);
+	cache->fontInfo = fplMemoryAllocate(sizeof(stbtt_fontinfo));
+	if(cache->fontData == fpl_null || cache->fontInfo == fpl_null) {
+		ReleaseFontGlyphCache(cache);
+		return false;
+	}
+	fplMemoryCopy(data, dataSize, cache->fontData);
+	stbtt_fontinfo *fontInfo = (stbtt_fontinfo *)cache->fontInfo;
+	int fontOffset = stbtt_GetFontOffsetForIndex(cache->fontData, fontIndex);
+	if(fontOffset < 0 || !stbtt_InitFont(fontInfo, cache->fontData, fontOffset)) {
+		ReleaseFontGlyphCache(cache);
+		return false;
+	}
+
+	cache->fontSize = fontSize;
+	cache->scale = stbtt_ScaleForPixelHeight(fontInfo, fontSize);
+
+	int ascentRaw, descentRaw, lineGapRaw;
+	int spaceAdvanceRaw, spaceLeftSideBearing;
+	stbtt_GetFontVMetrics(fontInfo, &ascentRaw, &descentRaw, &lineGapRaw);
+	stbtt_GetCodepointHMetrics(fontInfo, ' ', &spaceAdvanceRaw, &spaceLeftSideBearing);
+	float rawToUnits = cache->scale / fontSize;
+	cache->info.ascent = fabsf((float)ascentRaw) * rawToUnits;
+	cache->info.descent = fabsf((float)descentRaw) * rawToUnits;
+	cache->info.lineHeight = (fabsf((float)ascentRaw) + fabsf((float)descentRaw) + lineGapRaw) * rawToUnits;
+	cache->info.spaceAdvance = spaceAdvanceRaw * rawToUnits;
+
+	cache->atlasWidth = atlasWidth;
+	cache->atlasHeight = atlasHeight;
+	cache->atlasAlphaBitmap = (uint8_t *)fplMemoryAllocate(atlasWidth * atlasHeight);
+
+	// Shelfs are at least 4 pixels tall
+	cache->maxShelfCount = fplMax(1u, atlasHeight / 4);
+	cache->shelfs = (FontCacheShelf *)fplMemoryAllocate(sizeof(FontCacheShelf) * cache->maxShelfCount);
+
+	cache->glyphCapacity = maxGlyphCount;
+	cache->glyphs = (FontCacheGlyph *)fplMemoryAllocate(sizeof(FontCacheGlyph) * maxGlyphCount);
+	cache->glyphMapCapacity = 16;
+	while(cache->glyphMapCapacity < maxGlyphCount * 2) {
+		cache->glyphMapCapacity *= 2;
+	}
+	cache->glyphMap = (uint32_t *)fplMemoryAllocate(sizeof(uint32_t) * cache->glyphMapCapacity);
+	if(cache->atlasAlphaBitmap == fpl_null || cache->shelfs == fpl_null || cache->glyphs == fpl_null || cache->glyphMap == fpl_null) {
+		ReleaseFontGlyphCache(cache);
+		return false;
+	}
+	for(uint32_t glyphIndex = 0; glyphIndex < maxGlyphCount; ++glyphIndex) {
+		cache->glyphs[glyphIndex].nextFree = (glyphIndex + 1) < maxGlyphCount ? (glyphIndex + 1) : UINT32_MAX;
+	}
+	cache->firstFreeGlyph = 0;
+	cache->frameIndex = 1;
+
+	if(useWorkerThread) {
+		if(!fplMutexInit(&cache->queueLock)) {
+			ReleaseFontGlyphCache(cache);
+			return false;
+		}
+		if(!fplSemaphoreInit(&cache->requestSignal, 0)) {
+			fplMutexDestroy(&cache->queueLock);
+			ReleaseFontGlyphCache(cache);
+			return false;
+		}
+		cache->worker = fplThreadCreate(FontGlyphCacheWorkerProc, cache);
+		if(cache->worker == fpl_null) {
+			fplSemaphoreDestroy(&cache->requestSignal);
+			fplMutexDestroy(&cache->queueLock);
+			ReleaseFontGlyphCache(cache);
+			return false;
+		}
+	}
+
+	return true;
+}
+
+extern void ReleaseFontGlyphCache(FontGlyphCache *cache) {
+	if(cache == fpl_null) {
+		return;
+	}
+	if(cache->worker != fpl_null) {
+		fplAtomicStoreS32(&cache->isStopping, 1);
+		fplSemaphoreRelease(&cache->requestSignal);
+		fplThreadWaitForOne(cache->worker, FPL_TIMEOUT_INFINITE);
+		while(cache->resultTail != cache->resultHead) {
+			FontGlyphBitmap *bitmap = cache->results + (cache->resultTail++ % FONT_GLYPH_CACHE_MAX_PENDING);
+			if(bitmap->pixels != fpl_null) {
+				fplMemoryFree(bitmap->pixels);
+			}
+		}
+		fplSemaphoreDestroy(&cache->requestSignal);
+		fplMutexDestroy(&cache->queueLock);
+	}
+	ReleaseFontKerningTable(&cache->kerningTable);
+	if(cache->glyphMap != fpl_null) {
+		fplMemoryFree(cache->glyphMap);
+	}
+	if(cache->glyphs != fpl_null) {
+		fplMemoryFree(cache->glyphs);
+	}
+	if(cache->shelfs != fpl_null) {
+		fplMemoryFree(cache->shelfs);
+	}
+	if(cache->atlasAlphaBitmap != fpl_null) {
+		fplMemoryFree(cache->atlasAlphaBitmap);
+	}
+	if(cache->fontInfo != fpl_null) {
+		fplMemoryFree(cache->fontInfo);
+	}
+	if(cache->fontData != fpl_null) {
+		fplMemoryFree(cache->fontData);
+	}
+	fplClearStruct(cache);
+}
+
+extern void UpdateFontGlyphCache(FontGlyphCache *cache) {
+	if(cache == fpl_null) {
+		return;
+	}
+	if(cache->worker != fpl_null) {
+		FontGlyphBitmap finished[FONT_GLYPH_CACHE_MAX_PENDING];
+		uint32_t finishedCount = 0;
+		fplMutexLock(&cache->queueLock);
+		while(cache->resultTail != cache->resultHead) {
+			finished[finishedCount++] = cache->results[cache->resultTail++ % FONT_GLYPH_CACHE_MAX_PENDING];
+		}
+		fplMutexUnlock(&cache->queueLock);
+		for(uint32_t i = 0; i < finishedCount; ++i) {
+			const FontGlyphBitmap *bitmap = finished + i;
+			uint32_t glyphIndex = FindFontCacheGlyph(cache, bitmap->codePoint);
+			fplAssert(glyphIndex != UINT32_MAX);
+			CommitFontCacheGlyph(cache, glyphIndex, bitmap);
+			if(bitmap->pixels != fpl_null) {
+				fplMemoryFree(bitmap->pixels);
+			}
+			fplAssert(cache->pendingCount > 0);
+			--cache->pendingCount;
+		}
+	}
+	++cache->frameIndex;
+}
+
+extern const FontGlyph *GetCachedFontGlyph(FontGlyphCache *cache, const uint32_t codePoint) {
+	if(cache == fpl_null || cache->glyphs == fpl_null) {
+		return(fpl_null);
+	}
+	uint32_t glyphIndex = FindFontCacheGlyph(cache, codePoint);
+	if(glyphIndex == UINT32_MAX) {
+		if(cache->worker != fpl_null && cache->pendingCount == FONT_GLYPH_CACHE_MAX_PENDING) {
+			return(fpl_null);
+		}
+		glyphIndex = AllocateFontCacheGlyph(cache);
+		if(glyphIndex == UINT32_MAX) {
+			return(fpl_null);
+		}
+		FontCacheGlyph *entry = cache->glyphs + glyphIndex;
+		fplClearStruct(entry);
+		entry->glyph.charCode = codePoint;
+		entry->state = FontCacheGlyphState_Pending;
+		entry->shelfIndex = -1;
+		InsertFontCacheGlyph(cache, glyphIndex);
+		if(cache->worker != fpl_null) {
+			fplMutexLock(&cache->queueLock);
+			cache->requests[cache->requestHead++ % FONT_GLYPH_CACHE_MAX_PENDING] = codePoint;
+			fplMutexUnlock(&cache->queueLock);
+			++cache->pendingCount;
+			fplSemaphoreRelease(&cache->requestSignal);
+			return(fpl_null);
+		}
+		FontGlyphBitmap bitmap;
+		RasterizeFontGlyph((const stbtt_fontinfo *)cache->fontInfo, cache->scale, codePoint, &bitmap);
+		CommitFontCacheGlyph(cache, glyphIndex, &bitmap);
+		if(bitmap.pixels != fpl_null) {
+			fplMemoryFree(bitmap.pixels);
+		}
+		glyphIndex = FindFontCacheGlyph(cache, codePoint);
+		if(glyphIndex == UINT32_MAX) {
+			return(fpl_null);
+		}
+	}
+	FontCacheGlyph *entry = cache->glyphs + glyphIndex;
+	if(entry->state != FontCacheGlyphState_Ready) {
+		return(fpl_null);
+	}
+	entry->lastUsedFrame = cache->frameIndex;
+	if(entry->shelfIndex >= 0) {
+		cache->shelfs[entry->shelfIndex].lastUsedFrame = cache->frameIndex;
+	}
+	return(&entry->glyph);
+}
+
+extern float GetCachedFontCharacterAdvance(FontGlyphCache *cache, const uint32_t thisCodePoint, const uint32_t nextCodePoint) {
+	float result = 0;
+	if(cache == fpl_null || cache->fontInfo == fpl_null) {
+		return(result);
+	}
+	uint32_t glyphIndex = FindFontCacheGlyph(cache, thisCodePoint);
+	if(glyphIndex != UINT32_MAX && cache->glyphs[glyphIndex].state == FontCacheGlyphState_Ready) {
+		result = cache->glyphs[glyphIndex].advance;
+	} else {
+		int advanceRaw, leftSideBearing;
+		stbtt_GetCodepointHMetrics((const stbtt_fontinfo *)cache->fontInfo, (int)thisCodePoint, &advanceRaw, &leftSideBearing);
+		result = advanceRaw * cache->scale / cache->fontSize;
+	}
+	if(nextCodePoint > 0) {
+		float kerning;
+		if(!GetFontKerning(&cache->kerningTable, thisCodePoint, nextCodePoint, &kerning)) {
+			kerning = stbtt_GetCodepointKernAdvance((const stbtt_fontinfo *)cache->fontInfo, (int)thisCodePoint, (int)nextCodePoint) * cache->scale / cache->fontSize;
+			AddFontKerning(&cache->kerningTable, thisCodePoint, nextCodePoint, kerning);
+		}
+		result += kerning;
+	}
+	return(result);
+}
+
 #endif // FINAL_FONTLOADER_IMPLEMENTATION && !FINAL_FONTLOADER_IMPLEMENTED
\ No newline at end of file
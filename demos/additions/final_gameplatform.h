@@ -9,6 +9,11 @@ Description:
 	This file is part of the final_framework.
 
 Changelog:
+	## 2026-10-18
+	- Optional software renderer (GameConfiguration::useSoftwareRenderer), which renders into the backbuffer of the software video backend
+	- Optional render thread (GameConfiguration::useRenderThread), which executes the render commands of the last frame while the game builds the next one
+	- Texture handles are written by the game thread when the renderer has finished the frame of the texture operation
+
 	## 2022-01-23
 	- Proper game timing is accumulated delta time method
 	- Configurable vsync
@@ -45,6 +50,13 @@ struct GameConfiguration {
 	bool hideMouseCursor;
 	bool disableInactiveDetection;
 	bool disableVerticalSync;
+	// Renders and flips on a separate thread that owns the OpenGL context, while the game thread builds the next frame.
+	// All render commands must own their data, because the game memory is changed while the previous frame is rendered.
+	// Uploaded textures are available in the handle one frame later than without the render thread.
+	bool useRenderThread;
+	// Uses the software video backend and executes the render commands on the CPU, no OpenGL is loaded.
+	// The render thread is not used, because the software renderer has its own worker threads.
+	bool useSoftwareRenderer;
 };
 
 extern int GameMain(const GameConfiguration &config);
@@ -71,6 +83,9 @@ extern int GameMain(const GameConfiguration &config);
 #define FINAL_OPENGL_RENDER_IMPLEMENTATION
 #include "final_opengl_render.h"
 
+#define FINAL_SOFTWARE_RENDER_IMPLEMENTATION
+#include "final_software_render.h"
+
 static void UpdateKeyboardButtonState(ButtonState &newState, const fpl_b32 isDown) {
 	newState.endedDown = isDown;
 	++newState.halfTransitionCount;
@@ -272,6 +287,107 @@ static void ProcessEvents(Input *currentInput, Input *prevInput, GameWindowActiv
 	}
 }
 
+// Binds the OpenGL context of the window to the calling thread or unbinds it from the calling thread
+static bool MakeVideoContextCurrent(const bool isCurrent) {
+	const fplVideoSurface *surface = fplGetVideoSurface();
+	if(surface == fpl_null || surface->opengl.renderingContext == fpl_null) {
+		return(false);
+	}
+	bool result = false;
+#if defined(FPL_PLATFORM_WINDOWS)
+	typedef BOOL WINAPI wglMakeCurrentFunc(HDC deviceContext, HGLRC renderingContext);
+	wglMakeCurrentFunc *makeCurrent = (wglMakeCurrentFunc *)fplGetVideoProcedure("wglMakeCurrent");
+	if(makeCurrent != fpl_null) {
+		if(isCurrent) {
+			result = makeCurrent(surface->window.win32.deviceContext, (HGLRC)surface->opengl.renderingContext) == TRUE;
+		} else {
+			result = makeCurrent(fpl_null, fpl_null) == TRUE;
+		}
+	}
+#elif defined(FPL_SUBPLATFORM_X11)
+	typedef int (glXMakeCurrentFunc)(fpl__X11Display display, fpl__X11Window drawable, void *context);
+	glXMakeCurrentFunc *makeCurrent = (glXMakeCurrentFunc *)fplGetVideoProcedure("glXMakeCurrent");
+	if(makeCurrent != fpl_null) {
+		if(isCurrent) {
+			result = makeCurrent(surface->window.x11.display, surface->window.x11.window, surface->opengl.renderingContext) != 0;
+		} else {
+			result = makeCurrent(surface->window.x11.display, 0, fpl_null) != 0;
+		}
+	}
+#endif
+	return(result);
+}
+
+// Executes one render state after another, the game thread waits for frameDone before it hands over the next one
+struct RenderThread {
+	fplSemaphoreHandle frameReady;
+	fplSemaphoreHandle frameDone;
+	fplThreadHandle *thread;
+	// Null stops the thread
+	RenderState *frame;
+	bool isContextCurrent;
+};
+
+static void RenderThreadProc(const fplThreadHandle *thread, void *userData) {
+	RenderThread *renderThread = (RenderThread *)userData;
+	renderThread->isContextCurrent = MakeVideoContextCurrent(true);
+	fplSemaphoreRelease(&renderThread->frameDone);
+	if(!renderThread->isContextCurrent) {
+		return;
+	}
+	for(;;) {
+		fplSemaphoreWait(&renderThread->frameReady, FPL_TIMEOUT_INFINITE);
+		RenderState *frame = renderThread->frame;
+		if(frame == fpl_null) {
+			break;
+		}
+		RenderWithOpenGL(*frame);
+		fplVideoFlip();
+		fplSemaphoreRelease(&renderThread->frameDone);
+	}
+	MakeVideoContextCurrent(false);
+}
+
+static bool StartRenderThread(RenderThread &renderThread) {
+	renderThread = {};
+	if(!fplSemaphoreInit(&renderThread.frameReady, 0)) {
+		return(false);
+	}
+	if(!fplSemaphoreInit(&renderThread.frameDone, 0)) {
+		fplSemaphoreDestroy(&renderThread.frameReady);
+		return(false);
+	}
+
+	// The context can only be current on one thread
+	MakeVideoContextCurrent(false);
+	renderThread.thread = fplThreadCreate(RenderThreadProc, &renderThread);
+	if(renderThread.thread != fpl_null) {
+		fplSemaphoreWait(&renderThread.frameDone, FPL_TIMEOUT_INFINITE);
+		if(renderThread.isContextCurrent) {
+			fplSemaphoreRelease(&renderThread.frameDone);
+			return(true);
+		}
+		fplThreadWaitForOne(renderThread.thread, FPL_TIMEOUT_INFINITE);
+	}
+
+	MakeVideoContextCurrent(true);
+	fplSemaphoreDestroy(&renderThread.frameDone);
+	fplSemaphoreDestroy(&renderThread.frameReady);
+	renderThread = {};
+	return(false);
+}
+
+static void StopRenderThread(RenderThread &renderThread) {
+	fplSemaphoreWait(&renderThread.frameDone, FPL_TIMEOUT_INFINITE);
+	renderThread.frame = fpl_null;
+	fplSemaphoreRelease(&renderThread.frameReady);
+	fplThreadWaitForOne(renderThread.thread, FPL_TIMEOUT_INFINITE);
+	MakeVideoContextCurrent(true);
+	fplSemaphoreDestroy(&renderThread.frameDone);
+	fplSemaphoreDestroy(&renderThread.frameReady);
+	renderThread = {};
+}
+
 static uint32_t GameAudioPlayback(const fplAudioFormat *outFormat, const uint32_t frameCount, void *outputSamples, void *userData) {
 	AudioSystem *audioSys = (AudioSystem *)userData;
 	uint32_t result = AudioSystemWriteFrames(audioSys, outputSamples, outFormat, frameCount, true);
@@ -280,8 +396,13 @@ static uint32_t GameAudioPlayback(const fplAudioFormat *outFormat, const uint32_
 
 extern int GameMain(const GameConfiguration &config) {
 	fplSettings settings = fplMakeDefaultSettings();
-	settings.video.backend = fplVideoBackendType_OpenGL;
-	settings.video.graphics.opengl.compabilityFlags = fplOpenGLCompabilityFlags_Legacy;
+	if(config.useSoftwareRenderer) {
+		settings.video.backend = fplVideoBackendType_Software;
+		settings.video.isAutoSize = true;
+	} else {
+		settings.video.backend = fplVideoBackendType_OpenGL;
+		settings.video.graphics.opengl.compabilityFlags = fplOpenGLCompabilityFlags_Legacy;
+	}
 	settings.video.isVSync = !config.disableVerticalSync;
 	if (config.audioSampleRate > 0) {
 		settings.audio.targetFormat.sampleRate = config.audioSampleRate;
@@ -314,7 +435,7 @@ extern int GameMain(const GameConfiguration &config) {
 		}
 	}
 
-	if(!fglLoadOpenGL(true)) {
+	if(!config.useSoftwareRenderer && !fglLoadOpenGL(true)) {
 		fplPlatformRelease();
 		return -1;
 	}
@@ -325,9 +446,12 @@ extern int GameMain(const GameConfiguration &config) {
 	if(!fmemInit(&gameMemoryBlock, fmemType_Growable, FMEM_MEGABYTES(128))) {
 		wasError = true;
 	}
-	fmemMemoryBlock renderMemoryBlock = {};
-	if(!fmemInit(&renderMemoryBlock, fmemType_Growable, FMEM_MEGABYTES(32))) {
-		wasError = true;
+	// The second render memory is only used by the render thread
+	fmemMemoryBlock renderMemoryBlocks[2] = {};
+	for(size_t renderIndex = 0; renderIndex < (config.useRenderThread ? 2 : 1); ++renderIndex) {
+		if(!fmemInit(&renderMemoryBlocks[renderIndex], fmemType_Growable, FMEM_MEGABYTES(32))) {
+			wasError = true;
+		}
 	}
 
 	AudioSystem *audioSys = fmemPushStruct(&gameMemoryBlock, AudioSystem, fmemPushFlags_Clear);
@@ -348,14 +472,21 @@ extern int GameMain(const GameConfiguration &config) {
 		wasError = true;
 	}
 
-	RenderState renderState = {};
-	InitRenderState(renderState, renderMemoryBlock);
-	InitOpenGLRenderer();
+	RenderState renderStates[2] = {};
+	InitRenderState(renderStates[0], renderMemoryBlocks[0]);
+	InitRenderState(renderStates[1], renderMemoryBlocks[1]);
+	if(config.useSoftwareRenderer) {
+		if(!InitSoftwareRenderer()) {
+			wasError = true;
+		}
+	} else {
+		InitOpenGLRenderer();
+	}
 
 	GameMemory gameMem = {};
 	gameMem.audio = audioSys;
 	gameMem.memory = &gameMemoryBlock;
-	gameMem.render = &renderState;
+	gameMem.render = &renderStates[0];
 	if(!GameInit(gameMem)) {
 		wasError = true;
 	}
@@ -388,6 +519,13 @@ extern int GameMain(const GameConfiguration &config) {
 		double framesPerSecond = 0.0;
 		int frameIndex = 0;
 
+		// The game builds frame N + 1 into one render state, while the render thread executes frame N from the other one
+		RenderThread renderThread = {};
+		bool isRenderThreaded = config.useRenderThread && !config.useSoftwareRenderer && StartRenderThread(renderThread);
+		if(isRenderThreaded) {
+			renderThread.frame = &renderStates[1];
+		}
+
 		while(!IsGameExiting(gameMem) && fplWindowUpdate()) {
 			// Get window size
 			fplWindowSize winArea;
@@ -494,13 +632,36 @@ extern int GameMain(const GameConfiguration &config) {
 			//
 			// Game Render
 			//
-			ResetRenderState(renderState);
+			ResetRenderState(*gameMem.render);
 
 			float alpha = (float)frameAccumulator / (float)TargetDeltaTime;
 			GameRender(gameMem, alpha);
 
-			RenderWithOpenGL(renderState);
-			fplVideoFlip();
+			if(isRenderThreaded) {
+				// Swap the render states when the previous frame is done
+				fplSemaphoreWait(&renderThread.frameDone, FPL_TIMEOUT_INFINITE);
+				RenderState *nextFrame = gameMem.render;
+				gameMem.render = renderThread.frame;
+				renderThread.frame = nextFrame;
+				fplSemaphoreRelease(&renderThread.frameReady);
+
+				// The render thread is finished with the previous frame, so its textures can be handed over to the game
+				PublishTextureOperations(*gameMem.render);
+			} else if(config.useSoftwareRenderer) {
+				fplVideoBackBuffer *backBuffer = fplGetVideoBackBuffer();
+				SoftwareRenderTarget target = {};
+				target.pixels = backBuffer->pixels;
+				target.width = backBuffer->width;
+				target.height = backBuffer->height;
+				target.lineWidth = backBuffer->lineWidth;
+				RenderWithSoftware(*gameMem.render, target);
+				PublishTextureOperations(*gameMem.render);
+				fplVideoFlip();
+			} else {
+				RenderWithOpenGL(*gameMem.render);
+				PublishTextureOperations(*gameMem.render);
+				fplVideoFlip();
+			}
 			++frameCount;
 
 			//
@@ -525,6 +686,12 @@ extern int GameMain(const GameConfiguration &config) {
 			}
 		}
 
+		if(isRenderThreaded) {
+			RenderState *lastFrame = renderThread.frame;
+			StopRenderThread(renderThread);
+			PublishTextureOperations(*lastFrame);
+		}
+
 		if(config.hideMouseCursor) {
 			fplSetWindowCursorEnabled(true);
 		}
@@ -532,12 +699,19 @@ extern int GameMain(const GameConfiguration &config) {
 		GameRelease(gameMem);
 	}
 
+	if(config.useSoftwareRenderer) {
+		ReleaseSoftwareRenderer();
+	} else {
+		ReleaseOpenGLRenderer();
+	}
+
 	fplStopAudio();
 
 	AudioSystemShutdown(audioSys);
 
 	fmemFree(&gameMemoryBlock);
-	fmemFree(&renderMemoryBlock);
+	fmemFree(&renderMemoryBlocks[0]);
+	fmemFree(&renderMemoryBlocks[1]);
 
 	fglUnloadOpenGL();
 
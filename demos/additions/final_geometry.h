@@ -37,6 +37,12 @@ struct Sphere3f {
 	float radius;
 };
 
+struct Triangle3f {
+	Vec3f a;
+	Vec3f b;
+	Vec3f c;
+};
+
 struct LineCastInput {
 	Vec2f p1;
 	Vec2f p2;
@@ -15,6 +15,7 @@ Temporary: Remove it when render commands are fully implemented
 #include <final_dynamic_opengl.h>
 
 #include <stdint.h>
+#include <stddef.h> // offsetof
 
 extern void DrawSprite(const GLuint texId, const float rx, const float ry, const float uMin = 0.0f, const float vMin = 0.0f, const float uMax = 1.0f, const float vMax = 1.0f, const float xoffset = 0, const float yoffset = 0);
 extern void DrawSprite(const GLuint texId, const float rx, const float ry, const UVRect &uv, const float xoffset = 0, const float yoffset = 0);
@@ -24,6 +25,7 @@ extern void DrawCircle(const float centerX, const float centerY, const float rad
 extern void DrawNormal(const Vec2f &pos, const Vec2f &normal, const float length, const Vec4f &color);
 extern GLuint AllocateTexture(const uint32_t width, const uint32_t height, const void *data, const bool repeatable, const GLint filter, const bool isAlphaOnly = false);
 extern void InitOpenGLRenderer();
+extern void ReleaseOpenGLRenderer();
 extern void RenderWithOpenGL(RenderState &renderState);
 
 #endif // FINAL_OPENGL_RENDER_H
@@ -33,6 +35,188 @@ extern void RenderWithOpenGL(RenderState &renderState);
 
 #include <final_utils.h>
 
+#include <stdlib.h> // qsort
+
+//
+// Command batching
+//
+// All commands are expanded into vertices (already transformed into clip space) and one item per command.
+// The items are sorted by a 64-bit key and adjacent items with the same primitive, texture and size are drawn with a single glDrawArrays() call.
+//
+// Key layout (High to Low):
+// [8 bits pass] [8 bits layer] [16 bits state] [32 bits sequence]
+//
+// The pass is increased on every clear or viewport command, so that no command is moved across them.
+// The state is only used for layers with RenderLayerMode::GroupByState, for ordered layers the submission sequence decides.
+//
+struct OpenGLBatchVertex {
+	Vec4f pos;
+	Vec4f color;
+	Vec2f uv;
+};
+
+enum class OpenGLBatchType : uint8_t {
+	Triangles = 0,
+	Lines,
+	Points,
+	Clear,
+	Viewport,
+};
+
+struct OpenGLBatchItem {
+	uint64_t key;
+	// Clear or viewport command only
+	const void *command;
+	size_t firstVertex;
+	size_t vertexCount;
+	GLuint texture;
+	float size;
+	OpenGLBatchType type;
+};
+
+struct OpenGLBatchRenderer {
+	OpenGLBatchVertex *vertices;
+	OpenGLBatchVertex *sortedVertices;
+	OpenGLBatchItem *items;
+	size_t vertexCount;
+	size_t vertexCapacity;
+	size_t itemCount;
+	size_t itemCapacity;
+	GLuint vertexBuffer;
+	uint32_t pass;
+};
+
+constexpr uint32_t MAX_BATCH_PASS = 0xFF;
+constexpr size_t MIN_BATCH_VERTEX_CAPACITY = 4096;
+constexpr size_t MIN_BATCH_ITEM_CAPACITY = 1024;
+
+static OpenGLBatchRenderer globalOpenGLBatch = {};
+
+static bool GrowBatchArray(void **items, size_t *capacity, const size_t count, const size_t required, const size_t elementSize, const size_t minCapacity) {
+	if(*capacity >= required) {
+		return true;
+	}
+	size_t newCapacity = fplMax(*capacity * 2, minCapacity);
+	while(newCapacity < required) {
+		newCapacity *= 2;
+	}
+	void *newItems = fplMemoryAllocate(newCapacity * elementSize);
+	if(newItems == nullptr) {
+		return false;
+	}
+	if(*items != nullptr) {
+		fplMemoryCopy(*items, count * elementSize, newItems);
+		fplMemoryFree(*items);
+	}
+	*items = newItems;
+	*capacity = newCapacity;
+	return true;
+}
+
+static OpenGLBatchItem *PushBatchItem(OpenGLBatchRenderer &batch, const CommandHeader *header, const OpenGLBatchType type, const GLuint texture, const float size) {
+	if(!GrowBatchArray((void **)&batch.items, &batch.itemCapacity, batch.itemCount, batch.itemCount + 1, sizeof(OpenGLBatchItem), MIN_BATCH_ITEM_CAPACITY)) {
+		return nullptr;
+	}
+	uint32_t sequence = (uint32_t)batch.itemCount;
+	uint64_t state = 0;
+	uint64_t layer = 0;
+	if(type == OpenGLBatchType::Clear || type == OpenGLBatchType::Viewport) {
+		// Starts a new pass and always comes first in it
+		if(batch.pass < MAX_BATCH_PASS) {
+			++batch.pass;
+		}
+	} else {
+		layer = header->layer;
+		if(header->layerMode == RenderLayerMode::GroupByState) {
+			state = ((uint64_t)type << 14) | ((uint64_t)texture & 0x3FFF);
+		}
+	}
+	OpenGLBatchItem *result = &batch.items[batch.itemCount++];
+	*result = {};
+	result->key = ((uint64_t)batch.pass << 56) | (layer << 48) | (state << 32) | (uint64_t)sequence;
+	result->firstVertex = batch.vertexCount;
+	result->texture = texture;
+	result->size = size;
+	result->type = type;
+	return(result);
+}
+
+static OpenGLBatchVertex *PushBatchVertices(OpenGLBatchRenderer &batch, OpenGLBatchItem *item, const size_t count) {
+	fplAssert(item->firstVertex + item->vertexCount == batch.vertexCount);
+	size_t required = batch.vertexCount + count;
+	if(required > batch.vertexCapacity) {
+		size_t sortedCapacity = batch.vertexCapacity;
+		if(!GrowBatchArray((void **)&batch.vertices, &batch.vertexCapacity, batch.vertexCount, required, sizeof(OpenGLBatchVertex), MIN_BATCH_VERTEX_CAPACITY)) {
+			return nullptr;
+		}
+		// Sorted vertices are filled on every frame, so there is nothing to copy
+		if(batch.sortedVertices != nullptr) {
+			fplMemoryFree(batch.sortedVertices);
+		}
+		batch.sortedVertices = (OpenGLBatchVertex *)fplMemoryAllocate(batch.vertexCapacity * sizeof(OpenGLBatchVertex));
+		if(batch.sortedVertices == nullptr) {
+			batch.vertexCapacity = sortedCapacity;
+			return nullptr;
+		}
+	}
+	OpenGLBatchVertex *result = &batch.vertices[batch.vertexCount];
+	batch.vertexCount += count;
+	item->vertexCount += count;
+	return(result);
+}
+
+inline Vec4f TransformBatchPosition(const Mat4f &mvp, const float x, const float y) {
+	Vec4f result;
+	result.x = mvp.col1.x * x + mvp.col2.x * y + mvp.col4.x;
+	result.y = mvp.col1.y * x + mvp.col2.y * y + mvp.col4.y;
+	result.z = mvp.col1.z * x + mvp.col2.z * y + mvp.col4.z;
+	result.w = mvp.col1.w * x + mvp.col2.w * y + mvp.col4.w;
+	return(result);
+}
+
+inline void SetBatchVertex(OpenGLBatchVertex &vertex, const Mat4f &mvp, const float x, const float y, const Vec4f &color, const float u = 0.0f, const float v = 0.0f) {
+	vertex.pos = TransformBatchPosition(mvp, x, y);
+	vertex.color = color;
+	vertex.uv = V2fInit(u, v);
+}
+
+// Pushes two triangles for the quad (Top-Right, Top-Left, Bottom-Left, Bottom-Right), same as GL_QUADS would do
+static void PushBatchQuad(OpenGLBatchRenderer &batch, OpenGLBatchItem *item, const Mat4f &mvp, const Vec2f &min, const Vec2f &max, const Vec4f &color, const Vec2f &uvMin, const Vec2f &uvMax) {
+	OpenGLBatchVertex *verts = PushBatchVertices(batch, item, 6);
+	if(verts != nullptr) {
+		OpenGLBatchVertex quad[4];
+		SetBatchVertex(quad[0], mvp, max.x, max.y, color, uvMax.x, uvMax.y);
+		SetBatchVertex(quad[1], mvp, min.x, max.y, color, uvMin.x, uvMax.y);
+		SetBatchVertex(quad[2], mvp, min.x, min.y, color, uvMin.x, uvMin.y);
+		SetBatchVertex(quad[3], mvp, max.x, min.y, color, uvMax.x, uvMin.y);
+		verts[0] = quad[0];
+		verts[1] = quad[1];
+		verts[2] = quad[2];
+		verts[3] = quad[0];
+		verts[4] = quad[2];
+		verts[5] = quad[3];
+	}
+}
+
+static int CompareBatchItems(const void *a, const void *b) {
+	const OpenGLBatchItem *itemA = (const OpenGLBatchItem *)a;
+	const OpenGLBatchItem *itemB = (const OpenGLBatchItem *)b;
+	if(itemA->key < itemB->key) return -1;
+	if(itemA->key > itemB->key) return 1;
+	return 0;
+}
+
+static GLenum GetBatchDrawMode(const OpenGLBatchType type) {
+	switch(type) {
+		case OpenGLBatchType::Lines:
+			return GL_LINES;
+		case OpenGLBatchType::Points:
+			return GL_POINTS;
+		default:
+			return GL_TRIANGLES;
+	}
+}
+
 extern void DrawSprite(const GLuint texId, const float rx, const float ry, const float uMin, const float vMin, const float uMax, const float vMax, const float xoffset, const float yoffset) {
 	glEnable(GL_TEXTURE_2D);
 	glBindTexture(GL_TEXTURE_2D, texId);
@@ -152,31 +336,52 @@ extern void InitOpenGLRenderer() {
 	glEnable(GL_LINE_SMOOTH);
 }
 
+extern void ReleaseOpenGLRenderer() {
+	OpenGLBatchRenderer &batch = globalOpenGLBatch;
+	if(batch.vertexBuffer > 0) {
+		glDeleteBuffers(1, &batch.vertexBuffer);
+	}
+	if(batch.sortedVertices != nullptr) {
+		fplMemoryFree(batch.sortedVertices);
+	}
+	if(batch.vertices != nullptr) {
+		fplMemoryFree(batch.vertices);
+	}
+	if(batch.items != nullptr) {
+		fplMemoryFree(batch.items);
+	}
+	batch = {};
+}
+
 extern void RenderWithOpenGL(RenderState &renderState) {
-	size_t index = 0;
-	while(renderState.textureOperationCount > 0) {
+	for(size_t index = 0; index < renderState.textureOperationCount; ++index) {
 		TextureOperation &op = renderState.textureOperations[index];
 		if(op.type == TextureOperationType::Upload) {
 			bool isAlphaOnly = op.bytesPerPixel == 1;
 			GLuint texId = AllocateTexture(op.width, op.height, op.data, false, GL_LINEAR, isAlphaOnly);
-			*op.handle = ValueToPointer<GLuint>(texId);
+			op.texture = ValueToPointer<GLuint>(texId);
 		} else if(op.type == TextureOperationType::Release) {
-			GLuint texId = PointerToValue<GLuint>(op.handle);
+			GLuint texId = PointerToValue<GLuint>(op.texture);
 			if(texId > 0) {
 				glDeleteTextures(1, &texId);
-				*op.handle = nullptr;
 			}
+			op.texture = nullptr;
 		}
-		--renderState.textureOperationCount;
-		++index;
 	}
-	fplAssert(renderState.textureOperationCount == 0);
 
 	glMatrixMode(GL_PROJECTION);
 	glLoadIdentity();
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
 
+	OpenGLBatchRenderer &batch = globalOpenGLBatch;
+	batch.vertexCount = 0;
+	batch.itemCount = 0;
+	batch.pass = 0;
+
+	renderState.lastDrawCallCount = 0;
+	renderState.lastVertexCount = 0;
+
 	if(renderState.memory.size > sizeof(CommandHeader)) {
 		uint8_t *mem = (uint8_t *)renderState.memory.base;
 		size_t remaining = renderState.memory.used;
@@ -192,23 +397,19 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 				case CommandType::Viewport:
 				{
 					fplAssert(dataSize == sizeof(ViewportCommand));
-					ViewportCommand *cmd = (ViewportCommand *)dataStart;
-					glViewport(cmd->x, cmd->y, cmd->w, cmd->h);
+					OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Viewport, 0, 0.0f);
+					if(item != nullptr) {
+						item->command = dataStart;
+					}
 				} break;
 
 				case CommandType::Clear:
 				{
 					fplAssert(dataSize == sizeof(ClearCommand));
-					ClearCommand *cmd = (ClearCommand *)dataStart;
-					GLbitfield mask = 0;
-					if((cmd->flags & ClearFlags::Color) == ClearFlags::Color) {
-						mask |= GL_COLOR_BUFFER_BIT;
+					OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Clear, 0, 0.0f);
+					if(item != nullptr) {
+						item->command = dataStart;
 					}
-					if((cmd->flags & ClearFlags::Depth) == ClearFlags::Depth) {
-						mask |= GL_DEPTH_BUFFER_BIT;
-					}
-					glClearColor(cmd->color.r, cmd->color.g, cmd->color.g, cmd->color.a);
-					glClear(mask);
 				} break;
 
 				case CommandType::Matrix:
@@ -227,24 +428,32 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 						fplAssert(renderState.matrixTop > 0);
 						mvpCur = renderState.matrixStack[--renderState.matrixTop];
 					}
-					glMatrixMode(GL_MODELVIEW);
-					glLoadMatrixf(&mvpCur.m[0]);
 				} break;
 
 				case CommandType::Rectangle:
 				{
 					fplAssert(dataSize == sizeof(RectangleCommand));
 					RectangleCommand *cmd = (RectangleCommand *)dataStart;
-					if(!cmd->isFilled) {
-						glLineWidth(cmd->lineWidth);
+					Vec2f min = cmd->bottomLeft;
+					Vec2f max = cmd->bottomLeft + cmd->size;
+					if(cmd->isFilled) {
+						OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Triangles, 0, 0.0f);
+						if(item != nullptr) {
+							PushBatchQuad(batch, item, mvpCur, min, max, cmd->color, V2fInit(0, 0), V2fInit(0, 0));
+						}
+					} else {
+						OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Lines, 0, cmd->lineWidth);
+						OpenGLBatchVertex *verts = item != nullptr ? PushBatchVertices(batch, item, 8) : nullptr;
+						if(verts != nullptr) {
+							Vec2f corners[4] = { V2fInit(max.x, max.y), V2fInit(min.x, max.y), V2fInit(min.x, min.y), V2fInit(max.x, min.y) };
+							for(int i = 0; i < 4; ++i) {
+								const Vec2f &a = corners[i];
+								const Vec2f &b = corners[(i + 1) % 4];
+								SetBatchVertex(verts[i * 2 + 0], mvpCur, a.x, a.y, cmd->color);
+								SetBatchVertex(verts[i * 2 + 1], mvpCur, b.x, b.y, cmd->color);
+							}
+						}
 					}
-					glColor4fv(&cmd->color.m[0]);
-					glBegin(cmd->isFilled ? GL_QUADS : GL_LINE_LOOP);
-					glVertex2f(cmd->bottomLeft.x + cmd->size.w, cmd->bottomLeft.y + cmd->size.h);
-					glVertex2f(cmd->bottomLeft.x, cmd->bottomLeft.y + cmd->size.h);
-					glVertex2f(cmd->bottomLeft.x, cmd->bottomLeft.y);
-					glVertex2f(cmd->bottomLeft.x + cmd->size.w, cmd->bottomLeft.y);
-					glEnd();
 				} break;
 
 				case CommandType::Sprite:
@@ -252,56 +461,61 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 					fplAssert(dataSize == sizeof(SpriteCommand));
 					SpriteCommand *cmd = (SpriteCommand *)dataStart;
 					GLuint texId = PointerToValue<GLuint>(cmd->texture);
-					glEnable(GL_TEXTURE_2D);
-					glBindTexture(GL_TEXTURE_2D, texId);
-					glColor4fv(&cmd->color.m[0]);
-					glBegin(GL_QUADS);
-					glTexCoord2f(cmd->uvMax.x, cmd->uvMax.y); glVertex2f(cmd->position.x + cmd->ext.w, cmd->position.y + cmd->ext.h);
-					glTexCoord2f(cmd->uvMin.x, cmd->uvMax.y); glVertex2f(cmd->position.x - cmd->ext.w, cmd->position.y + cmd->ext.h);
-					glTexCoord2f(cmd->uvMin.x, cmd->uvMin.y); glVertex2f(cmd->position.x - cmd->ext.w, cmd->position.y - cmd->ext.h);
-					glTexCoord2f(cmd->uvMax.x, cmd->uvMin.y); glVertex2f(cmd->position.x + cmd->ext.w, cmd->position.y - cmd->ext.h);
-					glEnd();
-					glBindTexture(GL_TEXTURE_2D, 0);
-					glDisable(GL_TEXTURE_2D);
+					OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Triangles, texId, 0.0f);
+					if(item != nullptr) {
+						PushBatchQuad(batch, item, mvpCur, cmd->position - cmd->ext, cmd->position + cmd->ext, cmd->color, cmd->uvMin, cmd->uvMax);
+					}
 				} break;
 
 				case CommandType::Vertices:
 				{
 					fplAssert(dataSize >= sizeof(VerticesCommand));
 					VerticesCommand *cmd = (VerticesCommand *)dataStart;
-					glColor4fv(&cmd->color.m[0]);
-					GLenum drawMode;
+					const Vec2f *src = cmd->verts;
+					const size_t count = cmd->count;
 					switch(cmd->drawMode) {
 						case DrawMode::Lines:
 						{
-							glLineWidth(cmd->thickness);
-							drawMode = cmd->isLoop ? GL_LINE_LOOP : GL_LINES;
+							// Line loops and line lists are both converted into separated segments
+							size_t segmentCount = cmd->isLoop ? (count > 1 ? count : 0) : count / 2;
+							OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Lines, 0, cmd->thickness);
+							OpenGLBatchVertex *verts = item != nullptr ? PushBatchVertices(batch, item, segmentCount * 2) : nullptr;
+							if(verts != nullptr) {
+								for(size_t i = 0; i < segmentCount; ++i) {
+									size_t a = cmd->isLoop ? i : i * 2;
+									size_t b = cmd->isLoop ? (i + 1) % count : i * 2 + 1;
+									SetBatchVertex(verts[i * 2 + 0], mvpCur, src[a].x, src[a].y, cmd->color);
+									SetBatchVertex(verts[i * 2 + 1], mvpCur, src[b].x, src[b].y, cmd->color);
+								}
+							}
 						} break;
 
 						case DrawMode::Points:
 						{
-							glPointSize(cmd->thickness);
-							drawMode = GL_POINTS;
-						} break;
-
-						case DrawMode::Polygon:
-						{
-							drawMode = GL_POLYGON;
+							OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Points, 0, cmd->thickness);
+							OpenGLBatchVertex *verts = item != nullptr ? PushBatchVertices(batch, item, count) : nullptr;
+							if(verts != nullptr) {
+								for(size_t i = 0; i < count; ++i) {
+									SetBatchVertex(verts[i], mvpCur, src[i].x, src[i].y, cmd->color);
+								}
+							}
 						} break;
 
-						case DrawMode::Triangles:
+						default:
 						{
-							drawMode = cmd->isLoop ? GL_TRIANGLE_FAN : GL_POLYGON;
+							// Polygons and triangle fans are always convex, so both are converted into a triangle fan
+							size_t triangleCount = count > 2 ? count - 2 : 0;
+							OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Triangles, 0, 0.0f);
+							OpenGLBatchVertex *verts = item != nullptr ? PushBatchVertices(batch, item, triangleCount * 3) : nullptr;
+							if(verts != nullptr) {
+								for(size_t i = 0; i < triangleCount; ++i) {
+									SetBatchVertex(verts[i * 3 + 0], mvpCur, src[0].x, src[0].y, cmd->color);
+									SetBatchVertex(verts[i * 3 + 1], mvpCur, src[i + 1].x, src[i + 1].y, cmd->color);
+									SetBatchVertex(verts[i * 3 + 2], mvpCur, src[i + 2].x, src[i + 2].y, cmd->color);
+								}
+							}
 						} break;
-
-						default:
-							drawMode = GL_POLYGON;
-					}
-					glBegin(drawMode);
-					for(size_t i = 0; i < cmd->count; ++i) {
-						glVertex2fv(&cmd->verts[i].m[0]);
 					}
-					glEnd();
 				} break;
 
 				case CommandType::Text:
@@ -312,7 +526,7 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 					const char *text = (const char *)(dataStart + sizeof(TextCommand));
 					const size_t textLen = cmd->textLength;
 					const LoadedFont *fontDesc = cmd->font;
-					const TextureHandle *texture = cmd->texture;
+					const TextureHandle texture = cmd->texture;
 					if(fontDesc != nullptr && fontDesc->charCount > 0 && texture != nullptr) {
 						const float maxHeight = cmd->maxHeight;
 						const float ax = cmd->horizontalAlignment;
@@ -322,11 +536,12 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 						float ypos = cmd->position.y - textSize.h * 0.5f + (textSize.h * 0.5f * ay);
 						uint32_t lastChar = fontDesc->firstChar + (fontDesc->charCount - 1);
 
-						GLuint texId = PointerToValue<GLuint>(*texture);
+						GLuint texId = PointerToValue<GLuint>(texture);
 
-						glColor4fv(&cmd->color.m[0]);
-						glEnable(GL_TEXTURE_2D);
-						glBindTexture(GL_TEXTURE_2D, texId);
+						OpenGLBatchItem *item = PushBatchItem(batch, header, OpenGLBatchType::Triangles, texId, 0.0f);
+						if(item == nullptr) {
+							break;
+						}
 						for(uint32_t textPos = 0; textPos < textLen; ++textPos) {
 							char at = text[textPos];
 							char atNext = textPos < (textLen - 1) ? (text[textPos + 1]) : 0;
@@ -339,15 +554,8 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 								offset += glyph->offset * maxHeight;
 								offset += V2fInit(size.x, -size.y) * 0.5f;
 
-								float extW = size.w * 0.5f;
-								float extH = size.h * 0.5f;
-
-								glBegin(GL_QUADS);
-								glTexCoord2f(glyph->uvMax.x, glyph->uvMax.y); glVertex2f(offset.x + extW, offset.y + extH);
-								glTexCoord2f(glyph->uvMin.x, glyph->uvMax.y); glVertex2f(offset.x + -extW, offset.y + extH);
-								glTexCoord2f(glyph->uvMin.x, glyph->uvMin.y); glVertex2f(offset.x + -extW, offset.y + -extH);
-								glTexCoord2f(glyph->uvMax.x, glyph->uvMin.y); glVertex2f(offset.x + extW, offset.y + -extH);
-								glEnd();
+								Vec2f ext = size * 0.5f;
+								PushBatchQuad(batch, item, mvpCur, offset - ext, offset + ext, cmd->color, glyph->uvMin, glyph->uvMax);
 
 								advance = GetFontCharacterAdvance(fontDesc, at, atNext) * maxHeight;
 							} else {
@@ -355,8 +563,6 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 							}
 							xpos += advance;
 						}
-						glBindTexture(GL_TEXTURE_2D, 0);
-						glDisable(GL_TEXTURE_2D);
 					}
 				} break;
 
@@ -369,6 +575,109 @@ extern void RenderWithOpenGL(RenderState &renderState) {
 		}
 	}
 
+	if(batch.itemCount > 0) {
+		qsort(batch.items, batch.itemCount, sizeof(OpenGLBatchItem), CompareBatchItems);
+
+		// Vertices are stored in sorted order, so that merged items are contiguous
+		size_t sortedVertexCount = 0;
+		for(size_t itemIndex = 0; itemIndex < batch.itemCount; ++itemIndex) {
+			OpenGLBatchItem &item = batch.items[itemIndex];
+			if(item.vertexCount > 0) {
+				fplMemoryCopy(batch.vertices + item.firstVertex, item.vertexCount * sizeof(OpenGLBatchVertex), batch.sortedVertices + sortedVertexCount);
+			}
+			item.firstVertex = sortedVertexCount;
+			sortedVertexCount += item.vertexCount;
+		}
+		fplAssert(sortedVertexCount == batch.vertexCount);
+
+		const uint8_t *vertexBase = (const uint8_t *)batch.sortedVertices;
+		if(batch.vertexBuffer == 0 && glGenBuffers != nullptr) {
+			glGenBuffers(1, &batch.vertexBuffer);
+		}
+		if(batch.vertexBuffer > 0) {
+			// Streamed once per frame, the vertex arrays are offsets into the buffer
+			glBindBuffer(GL_ARRAY_BUFFER, batch.vertexBuffer);
+			glBufferData(GL_ARRAY_BUFFER, sortedVertexCount * sizeof(OpenGLBatchVertex), batch.sortedVertices, GL_STREAM_DRAW);
+			vertexBase = nullptr;
+		}
+		glEnableClientState(GL_VERTEX_ARRAY);
+		glEnableClientState(GL_COLOR_ARRAY);
+		glEnableClientState(GL_TEXTURE_COORD_ARRAY);
+		glVertexPointer(4, GL_FLOAT, sizeof(OpenGLBatchVertex), vertexBase + offsetof(OpenGLBatchVertex, pos));
+		glColorPointer(4, GL_FLOAT, sizeof(OpenGLBatchVertex), vertexBase + offsetof(OpenGLBatchVertex, color));
+		glTexCoordPointer(2, GL_FLOAT, sizeof(OpenGLBatchVertex), vertexBase + offsetof(OpenGLBatchVertex, uv));
+
+		GLuint boundTexture = 0;
+		size_t itemIndex = 0;
+		while(itemIndex < batch.itemCount) {
+			const OpenGLBatchItem &first = batch.items[itemIndex++];
+			if(first.type == OpenGLBatchType::Viewport) {
+				const ViewportCommand *cmd = (const ViewportCommand *)first.command;
+				glViewport(cmd->x, cmd->y, cmd->w, cmd->h);
+				continue;
+			} else if(first.type == OpenGLBatchType::Clear) {
+				const ClearCommand *cmd = (const ClearCommand *)first.command;
+				GLbitfield mask = 0;
+				if((cmd->flags & ClearFlags::Color) == ClearFlags::Color) {
+					mask |= GL_COLOR_BUFFER_BIT;
+				}
+				if((cmd->flags & ClearFlags::Depth) == ClearFlags::Depth) {
+					mask |= GL_DEPTH_BUFFER_BIT;
+				}
+				glClearColor(cmd->color.r, cmd->color.g, cmd->color.g, cmd->color.a);
+				glClear(mask);
+				continue;
+			}
+
+			// Merge all following items with the same state
+			size_t vertexCount = first.vertexCount;
+			while(itemIndex < batch.itemCount) {
+				const OpenGLBatchItem &next = batch.items[itemIndex];
+				if(next.type != first.type || next.texture != first.texture || next.size != first.size) {
+					break;
+				}
+				vertexCount += next.vertexCount;
+				++itemIndex;
+			}
+			if(vertexCount == 0) {
+				continue;
+			}
+
+			if(first.texture != boundTexture) {
+				if(first.texture > 0) {
+					glEnable(GL_TEXTURE_2D);
+					glBindTexture(GL_TEXTURE_2D, first.texture);
+				} else {
+					glBindTexture(GL_TEXTURE_2D, 0);
+					glDisable(GL_TEXTURE_2D);
+				}
+				boundTexture = first.texture;
+			}
+			if(first.size > 0) {
+				if(first.type == OpenGLBatchType::Lines) {
+					glLineWidth(first.size);
+				} else if(first.type == OpenGLBatchType::Points) {
+					glPointSize(first.size);
+				}
+			}
+
+			glDrawArrays(GetBatchDrawMode(first.type), (GLint)first.firstVertex, (GLsizei)vertexCount);
+			++renderState.lastDrawCallCount;
+			renderState.lastVertexCount += vertexCount;
+		}
+
+		if(boundTexture > 0) {
+			glBindTexture(GL_TEXTURE_2D, 0);
+			glDisable(GL_TEXTURE_2D);
+		}
+		glDisableClientState(GL_TEXTURE_COORD_ARRAY);
+		glDisableClientState(GL_COLOR_ARRAY);
+		glDisableClientState(GL_VERTEX_ARRAY);
+		if(batch.vertexBuffer > 0) {
+			glBindBuffer(GL_ARRAY_BUFFER, 0);
+		}
+	}
+
 #if 0
 	glMatrixMode(GL_MODELVIEW);
 	glLoadIdentity();
@@ -89,8 +89,12 @@ enum class TextureWrapMode {
 	ClampToBorder,
 };
 
+// Texture operations are executed by the renderer before the commands of the frame.
+// The renderer writes the uploaded texture into the operation only, the handle is written by PublishTextureOperations() when the frame is finished.
 struct TextureOperation {
 	TextureHandle *handle;
+	// Uploaded texture (Written by the renderer) or the texture to release
+	TextureHandle texture;
 	const void *data;
 	TextureOperationType type;
 	TextureFilterType filter;
@@ -102,6 +106,14 @@ struct TextureOperation {
 	bool isPreMultiplied;
 };
 
+// Commands are executed layer by layer (Lower first) and in submission order inside a layer.
+// GroupByState layers are grouped by texture and primitive, which is only valid when the commands with different states does not overlap.
+// Clear and viewport commands are not part of any layer, they always separate the commands before and after.
+enum class RenderLayerMode : uint8_t {
+	Ordered = 0,
+	GroupByState,
+};
+
 constexpr size_t MAX_TEXTURE_OPERATION_COUNT = 1024;
 constexpr size_t MAX_MATRIX_STACK_COUNT = 32;
 struct RenderState {
@@ -111,6 +123,11 @@ struct RenderState {
 	fmemMemoryBlock memory;
 	size_t textureOperationCount;
 	size_t lastMemoryUsage;
+	// Written by the renderer after the commands are executed
+	size_t lastDrawCallCount;
+	size_t lastVertexCount;
+	uint8_t layer;
+	RenderLayerMode layerMode;
 };
 
 enum class CommandType {
@@ -127,6 +144,8 @@ enum class CommandType {
 struct CommandHeader {
 	size_t dataSize;
 	CommandType type;
+	uint8_t layer;
+	RenderLayerMode layerMode;
 };
 
 enum class MatrixMode {
@@ -202,7 +221,7 @@ struct SpriteCommand {
 struct TextCommand {
 	Vec4f color;
 	Vec2f position;
-	const TextureHandle *texture;
+	TextureHandle texture;
 	const LoadedFont *font;
 	float horizontalAlignment;
 	float verticalAlignment;
@@ -212,6 +231,7 @@ struct TextCommand {
 
 extern void InitRenderState(RenderState &state, fmemMemoryBlock block);
 extern void ResetRenderState(RenderState &state);
+extern void SetRenderLayer(RenderState &state, const uint8_t layer, const RenderLayerMode mode = RenderLayerMode::Ordered);
 extern void PushClear(RenderState &state, const Vec4f &color, const ClearFlags flags);
 extern void PushViewport(RenderState &state, const int x, const int y, const int w, const int h);
 extern void PushMatrix(RenderState &state, const Mat4f &mat, const MatrixMode mode = MatrixMode::Push);
@@ -225,6 +245,7 @@ extern void PushSprite(RenderState &state, const Vec2f &position, const Vec2f &e
 extern void PushSprite(RenderState &state, const Vec2f &position, const Vec2f &ext, const TextureHandle texture, const Vec4f &color, const UVRect &uvRect);
 extern void PushTexture(RenderState &state, TextureHandle *targetTexture, const void *data, const uint32_t width, const uint32_t height, const uint32_t bytesPerPixel, const TextureFilterType filter, const TextureWrapMode wrap, const bool isTopDown, const bool isPreMultiplied);
 extern void PopTexture(RenderState &state, TextureHandle *targetTexture);
+extern void PublishTextureOperations(RenderState &state);
 extern void PushText(RenderState &state, const char *text, const size_t textLen, const LoadedFont *font, const TextureHandle *texture, const Vec2f &position, const float maxHeight, const float horizontalAlignment, const float verticalAlignment, const Vec4f &color);
 extern void PushCircle(RenderState &state, const Vec2f &position, const float radius, const size_t segmentCount, const Vec4f &color, const bool isFilled, const float lineWidth);
 extern void PushLine(RenderState &state, const Vec2f &a, const Vec2f &b, const Vec4f &color, const float lineWidth);
@@ -242,6 +263,13 @@ extern void InitRenderState(RenderState &state, fmemMemoryBlock block) {
 extern void ResetRenderState(RenderState &state) {
 	state.lastMemoryUsage = state.memory.used;
 	state.memory.used = 0;
+	state.layer = 0;
+	state.layerMode = RenderLayerMode::Ordered;
+}
+
+extern void SetRenderLayer(RenderState &state, const uint8_t layer, const RenderLayerMode mode) {
+	state.layer = layer;
+	state.layerMode = mode;
 }
 
 static CommandHeader *PushHeader(RenderState &state, const CommandType type) {
@@ -249,6 +277,8 @@ static CommandHeader *PushHeader(RenderState &state, const CommandType type) {
 	if(result != nullptr) {
 		result->type = type;
 		result->dataSize = 0;
+		result->layer = state.layer;
+		result->layerMode = state.layerMode;
 	}
 	return(result);
 }
@@ -401,10 +431,24 @@ extern void PopTexture(RenderState &state, TextureHandle *targetTexture) {
 		TextureOperation *op = &state.textureOperations[state.textureOperationCount++];
 		*op = {};
 		op->handle = targetTexture;
+		op->texture = *targetTexture;
 		op->type = TextureOperationType::Release;
+		// Commands recorded after this must not use the texture anymore
+		*targetTexture = nullptr;
 	}
 }
 
+// Writes the uploaded textures into the target handles, must be called from the game thread when the renderer is finished with the frame
+extern void PublishTextureOperations(RenderState &state) {
+	for(size_t index = 0; index < state.textureOperationCount; ++index) {
+		TextureOperation &op = state.textureOperations[index];
+		if(op.type == TextureOperationType::Upload) {
+			*op.handle = op.texture;
+		}
+	}
+	state.textureOperationCount = 0;
+}
+
 extern void PushCircle(RenderState &state, const Vec2f &position, const float radius, const size_t segmentCount, const Vec4f &color, const bool isFilled, const float lineWidth) {
 	fplAssert(segmentCount >= 3);
 	float seg = Tau32 / (float)segmentCount;
@@ -432,7 +476,7 @@ extern void PushText(RenderState &state, const char *text, const size_t textLen,
 	TextCommand *cmd = PushTypes<TextCommand>(state, header);
 	if(cmd != nullptr) {
 		cmd->position = position;
-		cmd->texture = texture;
+		cmd->texture = texture != nullptr ? *texture : nullptr;
 		cmd->font = font;
 		cmd->color = color;
 		cmd->textLength = textLen;
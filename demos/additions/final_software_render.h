@@ -0,0 +1,889 @@
+/*
+Name:
+	Final Software Render
+
+Description:
+	Executes the render commands from final_render.h on the CPU into a 32-bit pixel buffer.
+
+	All commands are converted into screen space triangles first, which are binned into tiles of 64x64 pixels.
+	The tiles are rasterized by a pool of worker threads, each tile is rasterized by one thread only and in command order.
+	Spans of four pixels are tested and blended at once with SSE2 (x86/x64 only, scalar otherwise).
+
+	Differences to the OpenGL renderer:
+	- Textures are sampled with the nearest filter
+	- Depth is ignored, all commands are drawn in order
+	- Positions are clamped to a guard band of +/- 16384 pixels, so triangles which are much bigger than the screen may be distorted
+
+	This file is part of the final_framework.
+
+Changelog:
+	## 2026-10-18
+	- Initial version
+
+License:
+	MIT License
+	Copyright 2017-2025 Torsten Spaete
+*/
+
+#ifndef FINAL_SOFTWARE_RENDER_H
+#define FINAL_SOFTWARE_RENDER_H
+
+#if !(defined(__cplusplus) && ((__cplusplus >= 201103L) || (defined(_MSC_VER) && _MSC_VER >= 1900)))
+#error "C++/11 compiler not detected!"
+#endif
+
+#include <final_platform_layer.h>
+#include <final_math.h>
+#include <final_render.h>
+#include <final_fontloader.h>
+
+#include <stdint.h>
+
+// Pixels are 32-bit BGRA (0xAARRGGBB), top-down, same as the backbuffer of the software video backend
+struct SoftwareRenderTarget {
+	uint32_t *pixels;
+	uint32_t width;
+	uint32_t height;
+	// Size of one line in bytes
+	size_t lineWidth;
+};
+
+// Starts the given number of worker threads in addition to the calling thread, zero uses one thread per core
+extern bool InitSoftwareRenderer(const uint32_t threadCount = 0);
+extern void ReleaseSoftwareRenderer();
+extern void RenderWithSoftware(RenderState &renderState, const SoftwareRenderTarget &target);
+
+#endif // FINAL_SOFTWARE_RENDER_H
+
+#if defined(FINAL_SOFTWARE_RENDER_IMPLEMENTATION) && !defined(FINAL_SOFTWARE_RENDER_IMPLEMENTED)
+#define FINAL_SOFTWARE_RENDER_IMPLEMENTED
+
+#if defined(FPL_ARCH_X64) || defined(FPL_ARCH_X86)
+#	include <emmintrin.h>
+#	define FINAL_SOFTWARE_RENDER_SSE2 1
+#endif
+
+constexpr int32_t SOFTWARE_TILE_SIZE = 64;
+constexpr int32_t SOFTWARE_SUBPIXEL_BITS = 4;
+constexpr int32_t SOFTWARE_SUBPIXEL_SCALE = 1 << SOFTWARE_SUBPIXEL_BITS;
+// Keeps the edge functions and their steps over one tile in 32-bit
+constexpr float SOFTWARE_GUARD_BAND = 16384.0f;
+constexpr uint32_t MAX_SOFTWARE_RENDER_THREADS = 16;
+constexpr size_t MIN_SOFTWARE_PRIMITIVE_CAPACITY = 1024;
+
+struct SoftwareTexture {
+	// BGRA, alpha-only textures are stored as white with alpha
+	uint32_t *pixels;
+	uint32_t width;
+	uint32_t height;
+};
+
+enum class SoftwarePrimitiveType : uint32_t {
+	Triangle = 0,
+	Clear,
+};
+
+struct SoftwarePrimitive {
+	// Counter-clockwise in fixed point (SOFTWARE_SUBPIXEL_BITS)
+	int32_t x[3];
+	int32_t y[3];
+	// Texture coordinate planes in pixel space: u = c + dx * x + dy * y
+	float uPlane[3];
+	float vPlane[3];
+	const SoftwareTexture *texture;
+	// Pixel bounds, max is exclusive
+	int32_t minX, minY, maxX, maxY;
+	uint32_t color;
+	SoftwarePrimitiveType type;
+};
+
+struct SoftwareRenderer {
+	SoftwarePrimitive *primitives;
+	size_t primitiveCount;
+	size_t primitiveCapacity;
+
+	// Primitive indices per tile, in command order
+	uint32_t *tileStarts;
+	uint32_t *tileCursors;
+	uint32_t *tilePrimitives;
+	size_t tileCapacity;
+	size_t tilePrimitiveCapacity;
+
+	SoftwareRenderTarget target;
+	int32_t tileCountX;
+	int32_t tileCountY;
+	volatile int32_t nextTile;
+
+	fplSemaphoreHandle workReady;
+	fplSemaphoreHandle workDone;
+	fplThreadHandle *threads[MAX_SOFTWARE_RENDER_THREADS];
+	uint32_t threadCount;
+	volatile int32_t isStopping;
+	bool isInitialized;
+};
+
+static SoftwareRenderer globalSoftwareRenderer = {};
+
+static bool GrowSoftwareArray(void **items, size_t *capacity, const size_t count, const size_t required, const size_t elementSize, const size_t minCapacity) {
+	if(*capacity >= required) {
+		return true;
+	}
+	size_t newCapacity = fplMax(*capacity * 2, minCapacity);
+	while(newCapacity < required) {
+		newCapacity *= 2;
+	}
+	void *newItems = fplMemoryAllocate(newCapacity * elementSize);
+	if(newItems == nullptr) {
+		return false;
+	}
+	if(*items != nullptr) {
+		fplMemoryCopy(*items, count * elementSize, newItems);
+		fplMemoryFree(*items);
+	}
+	*items = newItems;
+	*capacity = newCapacity;
+	return true;
+}
+
+inline uint32_t PackSoftwareColor(const Vec4f &color) {
+	uint32_t r = (uint32_t)(fplMax(0.0f, fplMin(1.0f, color.r)) * 255.0f + 0.5f);
+	uint32_t g = (uint32_t)(fplMax(0.0f, fplMin(1.0f, color.g)) * 255.0f + 0.5f);
+	uint32_t b = (uint32_t)(fplMax(0.0f, fplMin(1.0f, color.b)) * 255.0f + 0.5f);
+	uint32_t a = (uint32_t)(fplMax(0.0f, fplMin(1.0f, color.a)) * 255.0f + 0.5f);
+	uint32_t result = (a << 24) | (r << 16) | (g << 8) | b;
+	return(result);
+}
+
+// Exact a * b / 255 for 8-bit values
+inline uint32_t MulSoftwareChannel(const uint32_t a, const uint32_t b) {
+	uint32_t t = a * b + 128;
+	uint32_t result = (t + (t >> 8)) >> 8;
+	return(result);
+}
+
+inline uint32_t ModulateSoftwareColor(const uint32_t a, const uint32_t b) {
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 32; shift += 8) {
+		result |= MulSoftwareChannel((a >> shift) & 0xFF, (b >> shift) & 0xFF) << shift;
+	}
+	return(result);
+}
+
+// Source alpha blending for all channels including alpha, same as glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+inline uint32_t BlendSoftwareColor(const uint32_t dst, const uint32_t src) {
+	uint32_t alpha = src >> 24;
+	uint32_t srcFactor = alpha + (alpha >> 7);
+	uint32_t dstFactor = 256 - srcFactor;
+	uint32_t result = 0;
+	for(uint32_t shift = 0; shift < 32; shift += 8) {
+		uint32_t c = (((src >> shift) & 0xFF) * srcFactor + ((dst >> shift) & 0xFF) * dstFactor) >> 8;
+		result |= c << shift;
+	}
+	return(result);
+}
+
+//
+// Primitive setup
+//
+struct SoftwareViewport {
+	float x, y, w, h;
+};
+
+static Vec2f TransformSoftwarePosition(const Mat4f &mvp, const SoftwareViewport &viewport, const float targetHeight, const Vec2f &p) {
+	float cx = mvp.col1.x * p.x + mvp.col2.x * p.y + mvp.col4.x;
+	float cy = mvp.col1.y * p.x + mvp.col2.y * p.y + mvp.col4.y;
+	float cw = mvp.col1.w * p.x + mvp.col2.w * p.y + mvp.col4.w;
+	float invW = cw != 0.0f ? 1.0f / cw : 0.0f;
+	float windowX = viewport.x + (cx * invW * 0.5f + 0.5f) * viewport.w;
+	float windowY = viewport.y + (cy * invW * 0.5f + 0.5f) * viewport.h;
+	// Window space is bottom-up, pixels are top-down
+	Vec2f result = V2fInit(windowX, targetHeight - windowY);
+	result.x = fplMax(-SOFTWARE_GUARD_BAND, fplMin(SOFTWARE_GUARD_BAND, result.x));
+	result.y = fplMax(-SOFTWARE_GUARD_BAND, fplMin(SOFTWARE_GUARD_BAND, result.y));
+	return(result);
+}
+
+static SoftwarePrimitive *PushSoftwarePrimitive(SoftwareRenderer &renderer) {
+	if(!GrowSoftwareArray((void **)&renderer.primitives, &renderer.primitiveCapacity, renderer.primitiveCount, renderer.primitiveCount + 1, sizeof(SoftwarePrimitive), MIN_SOFTWARE_PRIMITIVE_CAPACITY)) {
+		return nullptr;
+	}
+	SoftwarePrimitive *result = &renderer.primitives[renderer.primitiveCount++];
+	*result = {};
+	return(result);
+}
+
+static void PushSoftwareClear(SoftwareRenderer &renderer, const Vec4f &color) {
+	SoftwarePrimitive *prim = PushSoftwarePrimitive(renderer);
+	if(prim != nullptr) {
+		prim->type = SoftwarePrimitiveType::Clear;
+		prim->color = PackSoftwareColor(color);
+		prim->minX = 0;
+		prim->minY = 0;
+		prim->maxX = (int32_t)renderer.target.width;
+		prim->maxY = (int32_t)renderer.target.height;
+	}
+}
+
+// Positions are in pixels, uvs are only used when a texture is given
+static void PushSoftwareTriangle(SoftwareRenderer &renderer, const Vec2f *positions, const Vec2f *uvs, const uint32_t color, const SoftwareTexture *texture) {
+	int32_t x[3], y[3];
+	for(int i = 0; i < 3; ++i) {
+		x[i] = (int32_t)floorf(positions[i].x * SOFTWARE_SUBPIXEL_SCALE + 0.5f);
+		y[i] = (int32_t)floorf(positions[i].y * SOFTWARE_SUBPIXEL_SCALE + 0.5f);
+	}
+	int64_t area = (int64_t)(x[1] - x[0]) * (y[2] - y[0]) - (int64_t)(y[1] - y[0]) * (x[2] - x[0]);
+	if(area == 0) {
+		return;
+	}
+	int order[3] = { 0, 1, 2 };
+	if(area < 0) {
+		order[1] = 2;
+		order[2] = 1;
+	}
+
+	int32_t minX = fplMin(x[0], fplMin(x[1], x[2]));
+	int32_t minY = fplMin(y[0], fplMin(y[1], y[2]));
+	int32_t maxX = fplMax(x[0], fplMax(x[1], x[2]));
+	int32_t maxY = fplMax(y[0], fplMax(y[1], y[2]));
+	int32_t pixelMinX = fplMax(0, minX >> SOFTWARE_SUBPIXEL_BITS);
+	int32_t pixelMinY = fplMax(0, minY >> SOFTWARE_SUBPIXEL_BITS);
+	int32_t pixelMaxX = fplMin((int32_t)renderer.target.width, (maxX >> SOFTWARE_SUBPIXEL_BITS) + 1);
+	int32_t pixelMaxY = fplMin((int32_t)renderer.target.height, (maxY >> SOFTWARE_SUBPIXEL_BITS) + 1);
+	if(pixelMinX >= pixelMaxX || pixelMinY >= pixelMaxY) {
+		return;
+	}
+
+	SoftwarePrimitive *prim = PushSoftwarePrimitive(renderer);
+	if(prim == nullptr) {
+		return;
+	}
+	prim->type = SoftwarePrimitiveType::Triangle;
+	prim->color = color;
+	prim->texture = texture;
+	prim->minX = pixelMinX;
+	prim->minY = pixelMinY;
+	prim->maxX = pixelMaxX;
+	prim->maxY = pixelMaxY;
+	for(int i = 0; i < 3; ++i) {
+		prim->x[i] = x[order[i]];
+		prim->y[i] = y[order[i]];
+	}
+
+	if(texture != nullptr) {
+		const Vec2f &p0 = positions[0];
+		const Vec2f &p1 = positions[1];
+		const Vec2f &p2 = positions[2];
+		float det = (p1.x - p0.x) * (p2.y - p0.y) - (p2.x - p0.x) * (p1.y - p0.y);
+		float invDet = det != 0.0f ? 1.0f / det : 0.0f;
+		float du1 = uvs[1].x - uvs[0].x, du2 = uvs[2].x - uvs[0].x;
+		float dv1 = uvs[1].y - uvs[0].y, dv2 = uvs[2].y - uvs[0].y;
+		float dudx = (du1 * (p2.y - p0.y) - du2 * (p1.y - p0.y)) * invDet;
+		float dudy = (du2 * (p1.x - p0.x) - du1 * (p2.x - p0.x)) * invDet;
+		float dvdx = (dv1 * (p2.y - p0.y) - dv2 * (p1.y - p0.y)) * invDet;
+		float dvdy = (dv2 * (p1.x - p0.x) - dv1 * (p2.x - p0.x)) * invDet;
+		prim->uPlane[0] = uvs[0].x - dudx * p0.x - dudy * p0.y;
+		prim->uPlane[1] = dudx;
+		prim->uPlane[2] = dudy;
+		prim->vPlane[0] = uvs[0].y - dvdx * p0.x - dvdy * p0.y;
+		prim->vPlane[1] = dvdx;
+		prim->vPlane[2] = dvdy;
+	}
+}
+
+// Pushes two triangles for the quad (Top-Right, Top-Left, Bottom-Left, Bottom-Right)
+static void PushSoftwareQuad(SoftwareRenderer &renderer, const Vec2f *positions, const Vec2f *uvs, const uint32_t color, const SoftwareTexture *texture) {
+	Vec2f p0[3] = { positions[0], positions[1], positions[2] };
+	Vec2f p1[3] = { positions[0], positions[2], positions[3] };
+	if(texture != nullptr) {
+		Vec2f uv0[3] = { uvs[0], uvs[1], uvs[2] };
+		Vec2f uv1[3] = { uvs[0], uvs[2], uvs[3] };
+		PushSoftwareTriangle(renderer, p0, uv0, color, texture);
+		PushSoftwareTriangle(renderer, p1, uv1, color, texture);
+	} else {
+		PushSoftwareTriangle(renderer, p0, nullptr, color, nullptr);
+		PushSoftwareTriangle(renderer, p1, nullptr, color, nullptr);
+	}
+}
+
+static void PushSoftwareRect(SoftwareRenderer &renderer, const Mat4f &mvp, const SoftwareViewport &viewport, const Vec2f &min, const Vec2f &max, const uint32_t color, const Vec2f &uvMin, const Vec2f &uvMax, const SoftwareTexture *texture) {
+	float targetHeight = (float)renderer.target.height;
+	Vec2f positions[4] = {
+		TransformSoftwarePosition(mvp, viewport, targetHeight, V2fInit(max.x, max.y)),
+		TransformSoftwarePosition(mvp, viewport, targetHeight, V2fInit(min.x, max.y)),
+		TransformSoftwarePosition(mvp, viewport, targetHeight, V2fInit(min.x, min.y)),
+		TransformSoftwarePosition(mvp, viewport, targetHeight, V2fInit(max.x, min.y)),
+	};
+	Vec2f uvs[4] = {
+		V2fInit(uvMax.x, uvMax.y),
+		V2fInit(uvMin.x, uvMax.y),
+		V2fInit(uvMin.x, uvMin.y),
+		V2fInit(uvMax.x, uvMin.y),
+	};
+	PushSoftwareQuad(renderer, positions, uvs, color, texture);
+}
+
+// Lines are quads with the line width in pixels, same as glLineWidth()
+static void PushSoftwareLine(SoftwareRenderer &renderer, const Vec2f &a, const Vec2f &b, const float lineWidth, const uint32_t color) {
+	Vec2f d = b - a;
+	float len = V2fLength(d);
+	if(len <= 0.0f) {
+		return;
+	}
+	float ext = fplMax(1.0f, lineWidth) * 0.5f;
+	Vec2f n = V2fInit(-d.y, d.x) * (ext / len);
+	Vec2f positions[4] = { b + n, a + n, a - n, b - n };
+	PushSoftwareQuad(renderer, positions, nullptr, color, nullptr);
+}
+
+static void PushSoftwarePoint(SoftwareRenderer &renderer, const Vec2f &p, const float pointSize, const uint32_t color) {
+	float ext = fplMax(1.0f, pointSize) * 0.5f;
+	Vec2f positions[4] = { V2fInit(p.x + ext, p.y - ext), V2fInit(p.x - ext, p.y - ext), V2fInit(p.x - ext, p.y + ext), V2fInit(p.x + ext, p.y + ext) };
+	PushSoftwareQuad(renderer, positions, nullptr, color, nullptr);
+}
+
+//
+// Rasterization
+//
+static void ClearSoftwareTile(const SoftwareRenderTarget &target, const int32_t x0, const int32_t y0, const int32_t x1, const int32_t y1, const uint32_t color) {
+	for(int32_t y = y0; y < y1; ++y) {
+		uint32_t *row = (uint32_t *)((uint8_t *)target.pixels + y * target.lineWidth);
+		for(int32_t x = x0; x < x1; ++x) {
+			row[x] = color;
+		}
+	}
+}
+
+inline uint32_t ShadeSoftwarePixel(const SoftwarePrimitive &prim, const int32_t x, const int32_t y) {
+	const SoftwareTexture *texture = prim.texture;
+	float px = (float)x + 0.5f;
+	float py = (float)y + 0.5f;
+	float u = prim.uPlane[0] + prim.uPlane[1] * px + prim.uPlane[2] * py;
+	float v = prim.vPlane[0] + prim.vPlane[1] * px + prim.vPlane[2] * py;
+	int32_t tx = fplMax(0, fplMin((int32_t)texture->width - 1, (int32_t)(u * texture->width)));
+	int32_t ty = fplMax(0, fplMin((int32_t)texture->height - 1, (int32_t)(v * texture->height)));
+	uint32_t texel = texture->pixels[ty * texture->width + tx];
+	uint32_t result = ModulateSoftwareColor(texel, prim.color);
+	return(result);
+}
+
+static void RasterizeSoftwareTriangle(const SoftwareRenderTarget &target, const SoftwarePrimitive &prim, const int32_t tileX0, const int32_t tileY0, const int32_t tileX1, const int32_t tileY1) {
+	int32_t x0 = fplMax(prim.minX, tileX0);
+	int32_t y0 = fplMax(prim.minY, tileY0);
+	int32_t x1 = fplMin(prim.maxX, tileX1);
+	int32_t y1 = fplMin(prim.maxY, tileY1);
+	if(x0 >= x1 || y0 >= y1) {
+		return;
+	}
+
+	// Edge functions at the pixel centers, the top-left rule is applied as a bias
+	int32_t edgeStart[3];
+	int32_t edgeStepX[3];
+	int32_t edgeStepY[3];
+	const int64_t half = SOFTWARE_SUBPIXEL_SCALE / 2;
+	for(int i = 0; i < 3; ++i) {
+		int32_t ax = prim.x[i], ay = prim.y[i];
+		int32_t bx = prim.x[(i + 1) % 3], by = prim.y[(i + 1) % 3];
+		int64_t dx = bx - ax;
+		int64_t dy = by - ay;
+		int64_t bias = (dy < 0 || (dy == 0 && dx > 0)) ? 0 : -1;
+		int64_t stepX = -dy * SOFTWARE_SUBPIXEL_SCALE;
+		int64_t stepY = dx * SOFTWARE_SUBPIXEL_SCALE;
+		int64_t px = (int64_t)x0 * SOFTWARE_SUBPIXEL_SCALE + half;
+		int64_t py = (int64_t)y0 * SOFTWARE_SUBPIXEL_SCALE + half;
+		int64_t e00 = dx * (py - ay) - dy * (px - ax) + bias;
+		int64_t e10 = e00 + stepX * (x1 - 1 - x0);
+		int64_t e01 = e00 + stepY * (y1 - 1 - y0);
+		int64_t e11 = e10 + stepY * (y1 - 1 - y0);
+		int64_t minE = fplMin(fplMin(e00, e10), fplMin(e01, e11));
+		int64_t maxE = fplMax(fplMax(e00, e10), fplMax(e01, e11));
+		if(maxE < 0) {
+			return;
+		}
+		if(minE >= 0) {
+			// Inside for the entire region
+			edgeStart[i] = 0;
+			edgeStepX[i] = 0;
+			edgeStepY[i] = 0;
+		} else {
+			edgeStart[i] = (int32_t)e00;
+			edgeStepX[i] = (int32_t)stepX;
+			edgeStepY[i] = (int32_t)stepY;
+		}
+	}
+
+	const bool isTextured = prim.texture != nullptr;
+	const uint32_t color = prim.color;
+	const int32_t groupX0 = x0 & ~3;
+
+#if FINAL_SOFTWARE_RENDER_SSE2
+	const __m128i laneOffsets = _mm_setr_epi32(0, 1, 2, 3);
+	const __m128i zero = _mm_setzero_si128();
+	const __m128i minXLanes = _mm_set1_epi32(x0 - 1);
+	const __m128i maxXLanes = _mm_set1_epi32(x1);
+	__m128i laneStepX[3];
+	__m128i groupStepX[3];
+	for(int i = 0; i < 3; ++i) {
+		laneStepX[i] = _mm_setr_epi32(0, edgeStepX[i], edgeStepX[i] * 2, edgeStepX[i] * 3);
+		groupStepX[i] = _mm_set1_epi32(edgeStepX[i] * 4);
+	}
+	uint32_t alpha = color >> 24;
+	uint32_t srcFactor = alpha + (alpha >> 7);
+	const __m128i srcColor = _mm_unpacklo_epi8(_mm_cvtsi32_si128((int)color), zero);
+	const __m128i srcMul = _mm_mullo_epi16(_mm_unpacklo_epi64(srcColor, srcColor), _mm_set1_epi16((short)srcFactor));
+	const __m128i dstFactor = _mm_set1_epi16((short)(256 - srcFactor));
+#endif
+
+	for(int32_t y = y0; y < y1; ++y) {
+		uint32_t *row = (uint32_t *)((uint8_t *)target.pixels + y * target.lineWidth);
+		int32_t rowY = y - y0;
+		int32_t e[3];
+		for(int i = 0; i < 3; ++i) {
+			e[i] = edgeStart[i] + edgeStepY[i] * rowY + edgeStepX[i] * (groupX0 - x0);
+		}
+#if FINAL_SOFTWARE_RENDER_SSE2
+		__m128i e0 = _mm_add_epi32(_mm_set1_epi32(e[0]), laneStepX[0]);
+		__m128i e1 = _mm_add_epi32(_mm_set1_epi32(e[1]), laneStepX[1]);
+		__m128i e2 = _mm_add_epi32(_mm_set1_epi32(e[2]), laneStepX[2]);
+		for(int32_t x = groupX0; x < x1; x += 4) {
+			__m128i xLanes = _mm_add_epi32(_mm_set1_epi32(x), laneOffsets);
+			__m128i inside = _mm_andnot_si128(_mm_srai_epi32(_mm_or_si128(_mm_or_si128(e0, e1), e2), 31), _mm_and_si128(_mm_cmpgt_epi32(xLanes, minXLanes), _mm_cmplt_epi32(xLanes, maxXLanes)));
+			int mask = _mm_movemask_ps(_mm_castsi128_ps(inside));
+			if(mask != 0) {
+				// Groups never cross a tile, because tiles starts at a multiple of four
+				if(!isTextured && (x + 4) <= (int32_t)target.width) {
+					__m128i *p = (__m128i *)(row + x);
+					__m128i dst = _mm_loadu_si128(p);
+					__m128i lo = _mm_srli_epi16(_mm_add_epi16(srcMul, _mm_mullo_epi16(_mm_unpacklo_epi8(dst, zero), dstFactor)), 8);
+					__m128i hi = _mm_srli_epi16(_mm_add_epi16(srcMul, _mm_mullo_epi16(_mm_unpackhi_epi8(dst, zero), dstFactor)), 8);
+					__m128i blended = _mm_packus_epi16(lo, hi);
+					_mm_storeu_si128(p, _mm_or_si128(_mm_and_si128(inside, blended), _mm_andnot_si128(inside, dst)));
+				} else {
+					for(int lane = 0; lane < 4; ++lane) {
+						if(mask & (1 << lane)) {
+							uint32_t src = isTextured ? ShadeSoftwarePixel(prim, x + lane, y) : color;
+							row[x + lane] = BlendSoftwareColor(row[x + lane], src);
+						}
+					}
+				}
+			}
+			e0 = _mm_add_epi32(e0, groupStepX[0]);
+			e1 = _mm_add_epi32(e1, groupStepX[1]);
+			e2 = _mm_add_epi32(e2, groupStepX[2]);
+		}
+#else
+		for(int32_t x = groupX0; x < x1; ++x) {
+			if(x >= x0 && (e[0] | e[1] | e[2]) >= 0) {
+				uint32_t src = isTextured ? ShadeSoftwarePixel(prim, x, y) : color;
+				row[x] = BlendSoftwareColor(row[x], src);
+			}
+			e[0] += edgeStepX[0];
+			e[1] += edgeStepX[1];
+			e[2] += edgeStepX[2];
+		}
+#endif
+	}
+}
+
+static void RasterizeSoftwareTile(SoftwareRenderer &renderer, const int32_t tileIndex) {
+	const SoftwareRenderTarget &target = renderer.target;
+	int32_t tileX0 = (tileIndex % renderer.tileCountX) * SOFTWARE_TILE_SIZE;
+	int32_t tileY0 = (tileIndex / renderer.tileCountX) * SOFTWARE_TILE_SIZE;
+	int32_t tileX1 = fplMin(tileX0 + SOFTWARE_TILE_SIZE, (int32_t)target.width);
+	int32_t tileY1 = fplMin(tileY0 + SOFTWARE_TILE_SIZE, (int32_t)target.height);
+	uint32_t first = renderer.tileStarts[tileIndex];
+	uint32_t last = renderer.tileStarts[tileIndex + 1];
+	for(uint32_t i = first; i < last; ++i) {
+		const SoftwarePrimitive &prim = renderer.primitives[renderer.tilePrimitives[i]];
+		if(prim.type == SoftwarePrimitiveType::Clear) {
+			ClearSoftwareTile(target, tileX0, tileY0, tileX1, tileY1, prim.color);
+		} else {
+			RasterizeSoftwareTriangle(target, prim, tileX0, tileY0, tileX1, tileY1);
+		}
+	}
+}
+
+static void RasterizeSoftwareTiles(SoftwareRenderer &renderer) {
+	int32_t tileCount = renderer.tileCountX * renderer.tileCountY;
+	for(;;) {
+		int32_t tileIndex = fplAtomicFetchAndAddS32(&renderer.nextTile, 1);
+		if(tileIndex >= tileCount) {
+			break;
+		}
+		RasterizeSoftwareTile(renderer, tileIndex);
+	}
+}
+
+static void SoftwareRenderWorkerProc(const fplThreadHandle *thread, void *userData) {
+	SoftwareRenderer *renderer = (SoftwareRenderer *)userData;
+	for(;;) {
+		fplSemaphoreWait(&renderer->workReady, FPL_TIMEOUT_INFINITE);
+		if(fplAtomicLoadS32(&renderer->isStopping)) {
+			break;
+		}
+		RasterizeSoftwareTiles(*renderer);
+		fplSemaphoreRelease(&renderer->workDone);
+	}
+}
+
+static bool BinSoftwarePrimitives(SoftwareRenderer &renderer) {
+	size_t tileCount = (size_t)renderer.tileCountX * (size_t)renderer.tileCountY;
+	if(renderer.tileCapacity < tileCount + 1) {
+		if(renderer.tileStarts != nullptr) {
+			fplMemoryFree(renderer.tileStarts);
+			fplMemoryFree(renderer.tileCursors);
+		}
+		renderer.tileCapacity = tileCount + 1;
+		renderer.tileStarts = (uint32_t *)fplMemoryAllocate(sizeof(uint32_t) * renderer.tileCapacity);
+		renderer.tileCursors = (uint32_t *)fplMemoryAllocate(sizeof(uint32_t) * renderer.tileCapacity);
+		if(renderer.tileStarts == nullptr || renderer.tileCursors == nullptr) {
+			renderer.tileCapacity = 0;
+			return false;
+		}
+	}
+
+	// Count, prefix sum and fill, so that each tile has its primitives in command order
+	fplMemoryClear(renderer.tileStarts, sizeof(uint32_t) * (tileCount + 1));
+	for(size_t primIndex = 0; primIndex < renderer.primitiveCount; ++primIndex) {
+		const SoftwarePrimitive &prim = renderer.primitives[primIndex];
+		int32_t tx0 = prim.minX / SOFTWARE_TILE_SIZE, tx1 = (prim.maxX - 1) / SOFTWARE_TILE_SIZE;
+		int32_t ty0 = prim.minY / SOFTWARE_TILE_SIZE, ty1 = (prim.maxY - 1) / SOFTWARE_TILE_SIZE;
+		for(int32_t ty = ty0; ty <= ty1; ++ty) {
+			for(int32_t tx = tx0; tx <= tx1; ++tx) {
+				++renderer.tileStarts[ty * renderer.tileCountX + tx + 1];
+			}
+		}
+	}
+	for(size_t tileIndex = 0; tileIndex < tileCount; ++tileIndex) {
+		renderer.tileStarts[tileIndex + 1] += renderer.tileStarts[tileIndex];
+		renderer.tileCursors[tileIndex] = renderer.tileStarts[tileIndex];
+	}
+	size_t totalCount = renderer.tileStarts[tileCount];
+	if(renderer.tilePrimitiveCapacity < totalCount) {
+		if(renderer.tilePrimitives != nullptr) {
+			fplMemoryFree(renderer.tilePrimitives);
+		}
+		renderer.tilePrimitiveCapacity = fplMax(totalCount, renderer.tilePrimitiveCapacity * 2);
+		renderer.tilePrimitives = (uint32_t *)fplMemoryAllocate(sizeof(uint32_t) * renderer.tilePrimitiveCapacity);
+		if(renderer.tilePrimitives == nullptr) {
+			renderer.tilePrimitiveCapacity = 0;
+			return false;
+		}
+	}
+	for(size_t primIndex = 0; primIndex < renderer.primitiveCount; ++primIndex) {
+		const SoftwarePrimitive &prim = renderer.primitives[primIndex];
+		int32_t tx0 = prim.minX / SOFTWARE_TILE_SIZE, tx1 = (prim.maxX - 1) / SOFTWARE_TILE_SIZE;
+		int32_t ty0 = prim.minY / SOFTWARE_TILE_SIZE, ty1 = (prim.maxY - 1) / SOFTWARE_TILE_SIZE;
+		for(int32_t ty = ty0; ty <= ty1; ++ty) {
+			for(int32_t tx = tx0; tx <= tx1; ++tx) {
+				renderer.tilePrimitives[renderer.tileCursors[ty * renderer.tileCountX + tx]++] = (uint32_t)primIndex;
+			}
+		}
+	}
+	return true;
+}
+
+static SoftwareTexture *AllocateSoftwareTexture(const uint32_t width, const uint32_t height, const uint8_t *data, const uint32_t bytesPerPixel) {
+	SoftwareTexture *result = (SoftwareTexture *)fplMemoryAllocate(sizeof(SoftwareTexture) + sizeof(uint32_t) * width * height);
+	if(result == nullptr) {
+		return nullptr;
+	}
+	result->pixels = (uint32_t *)(result + 1);
+	result->width = width;
+	result->height = height;
+	for(uint32_t i = 0; i < width * height; ++i) {
+		if(bytesPerPixel == 1) {
+			result->pixels[i] = ((uint32_t)data[i] << 24) | 0x00FFFFFF;
+		} else {
+			const uint8_t *rgba = data + i * 4;
+			result->pixels[i] = ((uint32_t)rgba[3] << 24) | ((uint32_t)rgba[0] << 16) | ((uint32_t)rgba[1] << 8) | (uint32_t)rgba[2];
+		}
+	}
+	return(result);
+}
+
+extern bool InitSoftwareRenderer(const uint32_t threadCount) {
+	SoftwareRenderer &renderer = globalSoftwareRenderer;
+	if(renderer.isInitialized) {
+		return true;
+	}
+	renderer = {};
+	uint32_t workerCount = threadCount;
+	if(workerCount == 0) {
+		size_t coreCount = fplCPUGetCoreCount();
+		workerCount = coreCount > 1 ? (uint32_t)(coreCount - 1) : 0;
+	}
+	workerCount = fplMin(workerCount, MAX_SOFTWARE_RENDER_THREADS);
+	if(!fplSemaphoreInit(&renderer.workReady, 0)) {
+		return false;
+	}
+	if(!fplSemaphoreInit(&renderer.workDone, 0)) {
+		fplSemaphoreDestroy(&renderer.workReady);
+		return false;
+	}
+	for(uint32_t threadIndex = 0; threadIndex < workerCount; ++threadIndex) {
+		fplThreadHandle *thread = fplThreadCreate(SoftwareRenderWorkerProc, &renderer);
+		if(thread == nullptr) {
+			break;
+		}
+		renderer.threads[renderer.threadCount++] = thread;
+	}
+	renderer.isInitialized = true;
+	return true;
+}
+
+extern void ReleaseSoftwareRenderer() {
+	SoftwareRenderer &renderer = globalSoftwareRenderer;
+	if(!renderer.isInitialized) {
+		return;
+	}
+	fplAtomicStoreS32(&renderer.isStopping, 1);
+	for(uint32_t threadIndex = 0; threadIndex < renderer.threadCount; ++threadIndex) {
+		fplSemaphoreRelease(&renderer.workReady);
+	}
+	if(renderer.threadCount > 0) {
+		fplThreadWaitForAll(renderer.threads, renderer.threadCount, sizeof(fplThreadHandle *), FPL_TIMEOUT_INFINITE);
+	}
+	fplSemaphoreDestroy(&renderer.workDone);
+	fplSemaphoreDestroy(&renderer.workReady);
+	if(renderer.tilePrimitives != nullptr) {
+		fplMemoryFree(renderer.tilePrimitives);
+	}
+	if(renderer.tileStarts != nullptr) {
+		fplMemoryFree(renderer.tileStarts);
+		fplMemoryFree(renderer.tileCursors);
+	}
+	if(renderer.primitives != nullptr) {
+		fplMemoryFree(renderer.primitives);
+	}
+	renderer = {};
+}
+
+extern void RenderWithSoftware(RenderState &renderState, const SoftwareRenderTarget &target) {
+	for(size_t index = 0; index < renderState.textureOperationCount; ++index) {
+		TextureOperation &op = renderState.textureOperations[index];
+		if(op.type == TextureOperationType::Upload) {
+			op.texture = AllocateSoftwareTexture(op.width, op.height, (const uint8_t *)op.data, op.bytesPerPixel);
+		} else if(op.type == TextureOperationType::Release) {
+			if(op.texture != nullptr) {
+				fplMemoryFree(op.texture);
+			}
+			op.texture = nullptr;
+		}
+	}
+
+	renderState.lastDrawCallCount = 0;
+	renderState.lastVertexCount = 0;
+
+	SoftwareRenderer &renderer = globalSoftwareRenderer;
+	fplAssert(renderer.isInitialized);
+	if(target.pixels == nullptr || target.width == 0 || target.height == 0) {
+		return;
+	}
+	renderer.target = target;
+	renderer.tileCountX = ((int32_t)target.width + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	renderer.tileCountY = ((int32_t)target.height + SOFTWARE_TILE_SIZE - 1) / SOFTWARE_TILE_SIZE;
+	renderer.primitiveCount = 0;
+
+	const float targetHeight = (float)target.height;
+	SoftwareViewport viewport = { 0.0f, 0.0f, (float)target.width, (float)target.height };
+
+	if(renderState.memory.size > sizeof(CommandHeader)) {
+		uint8_t *mem = (uint8_t *)renderState.memory.base;
+		size_t remaining = renderState.memory.used;
+		Mat4f mvpCur = M4fInit(1.0f);
+		renderState.matrixTop = 0;
+		while(remaining > 0) {
+			uint8_t *startMem = mem;
+			CommandHeader *header = (CommandHeader *)mem;
+			mem += sizeof(*header);
+			uint8_t *dataStart = mem;
+			size_t dataSize = header->dataSize;
+			switch(header->type) {
+				case CommandType::Viewport:
+				{
+					fplAssert(dataSize == sizeof(ViewportCommand));
+					ViewportCommand *cmd = (ViewportCommand *)dataStart;
+					viewport.x = (float)cmd->x;
+					viewport.y = (float)cmd->y;
+					viewport.w = (float)cmd->w;
+					viewport.h = (float)cmd->h;
+				} break;
+
+				case CommandType::Clear:
+				{
+					fplAssert(dataSize == sizeof(ClearCommand));
+					ClearCommand *cmd = (ClearCommand *)dataStart;
+					if((cmd->flags & ClearFlags::Color) == ClearFlags::Color) {
+						PushSoftwareClear(renderer, cmd->color);
+					}
+				} break;
+
+				case CommandType::Matrix:
+				{
+					fplAssert(dataSize == sizeof(MatrixCommand));
+					MatrixCommand *cmd = (MatrixCommand *)dataStart;
+					if(cmd->mode == MatrixMode::Set) {
+						renderState.matrixTop = 0;
+						mvpCur = cmd->mat;
+					} else if(cmd->mode == MatrixMode::Push) {
+						fplAssert(renderState.matrixTop < fplArrayCount(renderState.matrixStack));
+						Mat4f *newMatrix = &renderState.matrixStack[renderState.matrixTop++];
+						*newMatrix = mvpCur;
+						mvpCur = *newMatrix * cmd->mat;
+					} else if(cmd->mode == MatrixMode::Pop) {
+						fplAssert(renderState.matrixTop > 0);
+						mvpCur = renderState.matrixStack[--renderState.matrixTop];
+					}
+				} break;
+
+				case CommandType::Rectangle:
+				{
+					fplAssert(dataSize == sizeof(RectangleCommand));
+					RectangleCommand *cmd = (RectangleCommand *)dataStart;
+					uint32_t color = PackSoftwareColor(cmd->color);
+					Vec2f min = cmd->bottomLeft;
+					Vec2f max = cmd->bottomLeft + cmd->size;
+					if(cmd->isFilled) {
+						PushSoftwareRect(renderer, mvpCur, viewport, min, max, color, V2fInit(0, 0), V2fInit(0, 0), nullptr);
+					} else {
+						Vec2f corners[4] = {
+							TransformSoftwarePosition(mvpCur, viewport, targetHeight, V2fInit(max.x, max.y)),
+							TransformSoftwarePosition(mvpCur, viewport, targetHeight, V2fInit(min.x, max.y)),
+							TransformSoftwarePosition(mvpCur, viewport, targetHeight, V2fInit(min.x, min.y)),
+							TransformSoftwarePosition(mvpCur, viewport, targetHeight, V2fInit(max.x, min.y)),
+						};
+						for(int i = 0; i < 4; ++i) {
+							PushSoftwareLine(renderer, corners[i], corners[(i + 1) % 4], cmd->lineWidth, color);
+						}
+					}
+				} break;
+
+				case CommandType::Sprite:
+				{
+					fplAssert(dataSize == sizeof(SpriteCommand));
+					SpriteCommand *cmd = (SpriteCommand *)dataStart;
+					const SoftwareTexture *texture = (const SoftwareTexture *)cmd->texture;
+					if(texture != nullptr) {
+						PushSoftwareRect(renderer, mvpCur, viewport, cmd->position - cmd->ext, cmd->position + cmd->ext, PackSoftwareColor(cmd->color), cmd->uvMin, cmd->uvMax, texture);
+					}
+				} break;
+
+				case CommandType::Vertices:
+				{
+					fplAssert(dataSize >= sizeof(VerticesCommand));
+					VerticesCommand *cmd = (VerticesCommand *)dataStart;
+					uint32_t color = PackSoftwareColor(cmd->color);
+					const Vec2f *src = cmd->verts;
+					const size_t count = cmd->count;
+					switch(cmd->drawMode) {
+						case DrawMode::Lines:
+						{
+							size_t segmentCount = cmd->isLoop ? (count > 1 ? count : 0) : count / 2;
+							for(size_t i = 0; i < segmentCount; ++i) {
+								size_t a = cmd->isLoop ? i : i * 2;
+								size_t b = cmd->isLoop ? (i + 1) % count : i * 2 + 1;
+								Vec2f pa = TransformSoftwarePosition(mvpCur, viewport, targetHeight, src[a]);
+								Vec2f pb = TransformSoftwarePosition(mvpCur, viewport, targetHeight, src[b]);
+								PushSoftwareLine(renderer, pa, pb, cmd->thickness, color);
+							}
+						} break;
+
+						case DrawMode::Points:
+						{
+							for(size_t i = 0; i < count; ++i) {
+								Vec2f p = TransformSoftwarePosition(mvpCur, viewport, targetHeight, src[i]);
+								PushSoftwarePoint(renderer, p, cmd->thickness, color);
+							}
+						} break;
+
+						default:
+						{
+							// Polygons and triangle fans are always convex, so both are converted into a triangle fan
+							if(count > 2) {
+								Vec2f positions[3];
+								positions[0] = TransformSoftwarePosition(mvpCur, viewport, targetHeight, src[0]);
+								positions[2] = TransformSoftwarePosition(mvpCur, viewport, targetHeight, src[1]);
+								for(size_t i = 2; i < count; ++i) {
+									positions[1] = positions[2];
+									positions[2] = TransformSoftwarePosition(mvpCur, viewport, targetHeight, src[i]);
+									PushSoftwareTriangle(renderer, positions, nullptr, color, nullptr);
+								}
+							}
+						} break;
+					}
+				} break;
+
+				case CommandType::Text:
+				{
+					fplAssert(dataSize >= sizeof(TextCommand));
+					TextCommand *cmd = (TextCommand *)dataStart;
+					fplAssert(dataSize == (sizeof(TextCommand) + cmd->textLength + 1));
+					const char *text = (const char *)(dataStart + sizeof(TextCommand));
+					const size_t textLen = cmd->textLength;
+					const LoadedFont *fontDesc = cmd->font;
+					const TextureHandle texture = cmd->texture;
+					if(fontDesc != nullptr && fontDesc->charCount > 0 && texture != nullptr) {
+						const float maxHeight = cmd->maxHeight;
+						const float ax = cmd->horizontalAlignment;
+						const float ay = cmd->verticalAlignment;
+						Vec2f textSize = GetTextSize(text, cmd->textLength, fontDesc, maxHeight);
+						float xpos = cmd->position.x - textSize.w * 0.5f + (textSize.w * 0.5f * ax);
+						float ypos = cmd->position.y - textSize.h * 0.5f + (textSize.h * 0.5f * ay);
+						uint32_t lastChar = fontDesc->firstChar + (fontDesc->charCount - 1);
+						uint32_t color = PackSoftwareColor(cmd->color);
+						const SoftwareTexture *fontTexture = (const SoftwareTexture *)texture;
+						for(uint32_t textPos = 0; textPos < textLen; ++textPos) {
+							char at = text[textPos];
+							char atNext = textPos < (textLen - 1) ? (text[textPos + 1]) : 0;
+							float advance;
+							if((uint32_t)at >= fontDesc->firstChar && (uint32_t)at <= lastChar) {
+								uint32_t codePoint = at - fontDesc->firstChar;
+								const FontGlyph *glyph = &fontDesc->glyphs[codePoint];
+								Vec2f size = glyph->charSize * maxHeight;
+								Vec2f offset = V2fInit(xpos, ypos);
+								offset += glyph->offset * maxHeight;
+								offset += V2fInit(size.x, -size.y) * 0.5f;
+
+								Vec2f ext = size * 0.5f;
+								PushSoftwareRect(renderer, mvpCur, viewport, offset - ext, offset + ext, color, glyph->uvMin, glyph->uvMax, fontTexture);
+
+								advance = GetFontCharacterAdvance(fontDesc, at, atNext) * maxHeight;
+							} else {
+								advance = fontDesc->info.spaceAdvance * maxHeight;
+							}
+							xpos += advance;
+						}
+					}
+				} break;
+
+				default:
+					fplAssert(!"Invalid default case!");
+			}
+			mem += dataSize;
+			size_t consumed = (size_t)(mem - startMem);
+			remaining -= consumed;
+		}
+	}
+
+	if(renderer.primitiveCount == 0 || !BinSoftwarePrimitives(renderer)) {
+		return;
+	}
+
+	// The calling thread rasterizes tiles as well, until all tiles are taken
+	fplAtomicStoreS32(&renderer.nextTile, 0);
+	for(uint32_t threadIndex = 0; threadIndex < renderer.threadCount; ++threadIndex) {
+		fplSemaphoreRelease(&renderer.workReady);
+	}
+	RasterizeSoftwareTiles(renderer);
+	for(uint32_t threadIndex = 0; threadIndex < renderer.threadCount; ++threadIndex) {
+		fplSemaphoreWait(&renderer.workDone, FPL_TIMEOUT_INFINITE);
+	}
+
+	for(size_t primIndex = 0; primIndex < renderer.primitiveCount; ++primIndex) {
+		if(renderer.primitives[primIndex].type == SoftwarePrimitiveType::Triangle) {
+			renderState.lastVertexCount += 3;
+		}
+	}
+}
+
+#endif // FINAL_SOFTWARE_RENDER_IMPLEMENTATION
@@ -117,6 +117,55 @@ if (fmemInit(&myMem, fmemFlags_Growable, FMEM_MEGABYTES(16))) {
 	fmemRelease(&myMem);
 }
 
+-------------------------------------------------------------------------------
+	Usage concurrent memory
+-------------------------------------------------------------------------------
+
+#define FMEM_IMPLEMENTATION
+#include <final_mem.h>
+
+// Shared by all threads, pushing is thread-safe
+fmemMemoryBlock frameMem;
+if (fmemInit(&frameMem, fmemType_Concurrent, FMEM_MEGABYTES(64))) {
+	// On any thread
+	uint8_t *sharedData = fmemPush(&frameMem, 256, fmemPushFlags_None);
+
+	// Per thread sub arena, gets chunks from the concurrent block and pushes without any atomics
+	fmemMemoryBlock threadMem;
+	fmemInitSubArena(&threadMem, &frameMem, FMEM_KILOBYTES(64));
+	uint8_t *threadData = fmemPush(&threadMem, 128, fmemPushFlags_None);
+
+	// At frame end, when no thread is pushing anymore
+	fmemReset(&threadMem);
+	fmemReset(&frameMem);
+
+	fmemFree(&frameMem);
+}
+
+-------------------------------------------------------------------------------
+	Usage virtual memory
+-------------------------------------------------------------------------------
+
+#define FMEM_IMPLEMENTATION
+#include <final_mem.h>
+
+// Reserves the address range only, pages are committed when they are pushed on
+fmemMemoryBlock myMem;
+if (fmemInit(&myMem, fmemType_Virtual, FMEM_GIGABYTES(1))) {
+	uint8_t *first = fmemPush(&myMem, FMEM_MEGABYTES(3), fmemPushFlags_None);
+
+	// Always contiguous to the previous push
+	uint8_t *second = fmemPush(&myMem, FMEM_MEGABYTES(5), fmemPushFlags_None);
+
+	// The used range can be copied as a whole
+	memcpy(snapshot, myMem.base, myMem.used);
+
+	// Gives the committed pages back to the system
+	fmemReset(&myMem);
+
+	fmemFree(&myMem);
+}
+
 -------------------------------------------------------------------------------
 	License
 -------------------------------------------------------------------------------
@@ -148,7 +197,7 @@ SOFTWARE.
 
 /*!
 	\file final_memory.h
-	\version v0.3.0 alpha
+	\version v0.4.0 alpha
 	\author Torsten Spaete
 	\brief Final Memory (FMEM) - A open source C99 single file header memory library.
 */
@@ -157,6 +206,15 @@ SOFTWARE.
 	\page page_changelog Changelog
 	\tableofcontents
 
+	## v0.4.0 alpha:
+	- New: Added fmemType_Virtual for contiguous blocks with reserved address range, that commits pages on demand
+	- New: Added fmemType_Concurrent for thread-safe pushing with an atomic bump pointer
+	- New: Added fmemType_SubArena and fmemInitSubArena() for per-thread arenas carved from a concurrent parent block
+	- New: Added fixed-size pool allocator fmemPool with an intrusive free list
+	- Changed: fmemPush bumps on the current block and searches the best fitting block on overflow only
+	- Fixed: fmemFree did not release any memory
+	- Fixed: Appended blocks reported a size bigger than the allocated memory
+
 	## v0.3.0 alpha:
 	- New: Added macro fmemPushStruct()
 	- New: Added function fmemCreate()
@@ -180,7 +238,7 @@ SOFTWARE.
 	\page page_todo Todo
 	\tableofcontents
 
-	- Removal of single memory blocks
+	- Removal of single memory blocks (Use fmemPool for fixed-size items)
 	- Array allocation and pushing
 	- Memory partitions
 		- Separated but linked, not able to free linked block
@@ -188,6 +246,12 @@ SOFTWARE.
 
 */
 
+// The implementation requires POSIX extensions (MAP_ANONYMOUS, madvise), which must be enabled before the first system header is included.
+// Either include the implementation before any other header or define _DEFAULT_SOURCE in the build.
+#if defined(FMEM_IMPLEMENTATION) && !defined(FMEM_IMPLEMENTED) && !defined(_WIN32) && !defined(_DEFAULT_SOURCE)
+#	define _DEFAULT_SOURCE 1
+#endif
+
 #ifndef FMEM_H
 #define FMEM_H
 
@@ -235,6 +299,27 @@ SOFTWARE.
 #	define FMEM_ASSERT(exp) assert(exp)
 #	define FMEM_STATIC_ASSERT(exp) static_assert(exp)
 #endif
+#ifndef FMEM_ATOMIC_CAS_SIZE
+	// Atomics for concurrent blocks, compare and swap returns the previous value
+#	if defined(_MSC_VER)
+#		include <intrin.h>
+#		if defined(_WIN64)
+#			define FMEM_ATOMIC_CAS_SIZE(dest, exchange, comparand) (size_t)_InterlockedCompareExchange64((volatile __int64 *)(dest), (__int64)(exchange), (__int64)(comparand))
+#		else
+#			define FMEM_ATOMIC_CAS_SIZE(dest, exchange, comparand) (size_t)_InterlockedCompareExchange((volatile long *)(dest), (long)(exchange), (long)(comparand))
+#		endif
+#		define FMEM_ATOMIC_LOAD_SIZE(src) (*(volatile size_t *)(src))
+#		define FMEM_ATOMIC_LOAD_PTR(src) (*(void *volatile *)(src))
+#		define FMEM_ATOMIC_STORE_PTR(dest, value) _InterlockedExchangePointer((void *volatile *)(dest), (void *)(value))
+#	elif defined(__GNUC__) || defined(__clang__)
+#		define FMEM_ATOMIC_CAS_SIZE(dest, exchange, comparand) __sync_val_compare_and_swap((volatile size_t *)(dest), (size_t)(comparand), (size_t)(exchange))
+#		define FMEM_ATOMIC_LOAD_SIZE(src) __atomic_load_n((volatile size_t *)(src), __ATOMIC_ACQUIRE)
+#		define FMEM_ATOMIC_LOAD_PTR(src) __atomic_load_n((void *volatile *)(src), __ATOMIC_ACQUIRE)
+#		define FMEM_ATOMIC_STORE_PTR(dest, value) __atomic_store_n((void *volatile *)(dest), (void *)(value), __ATOMIC_RELEASE)
+#	else
+#		error "Atomics are not supported for this compiler, please define FMEM_ATOMIC_CAS_SIZE, FMEM_ATOMIC_LOAD_SIZE, FMEM_ATOMIC_LOAD_PTR and FMEM_ATOMIC_STORE_PTR!"
+#	endif
+#endif
 
 //! Null pointer
 #define fmem_null NULL
@@ -262,6 +347,12 @@ typedef enum fmemType {
 	fmemType_Fixed,
 	//! Temporary memory
 	fmemType_Temporary,
+	//! Unlimited size like growable, but pushing is thread-safe
+	fmemType_Concurrent,
+	//! Gets chunks from the source block when full, not thread-safe
+	fmemType_SubArena,
+	//! Contiguous address range of the given size, that is reserved once and committed on demand
+	fmemType_Virtual,
 } fmemType;
 
 typedef enum fmemSizeFlags {
@@ -291,16 +382,43 @@ typedef struct fmemMemoryBlock {
 	size_t size;
 	//! Used size in bytes
 	size_t used;
+	//! Appended block used for pushing or null for this block (Growable and concurrent only)
+	struct fmemMemoryBlock *current;
+	//! Minimum size of the chunks taken from the source block (Sub arena only)
+	size_t chunkSize;
+	//! Lock for switching to the next block (Concurrent only)
+	volatile size_t lock;
+	//! Committed size in bytes (Virtual only)
+	size_t committed;
 	//! Type
 	fmemType type;
 } fmemMemoryBlock;
 
+typedef struct fmemPool {
+	//! Growable memory for the chunks
+	fmemMemoryBlock memory;
+	//! First free item, the next free item is stored in the item itself
+	void *firstFree;
+	//! Next unused item in the current chunk
+	uint8_t *chunkCursor;
+	//! End of the current chunk
+	uint8_t *chunkEnd;
+	//! Size of a single item in bytes, at least the size of a pointer
+	size_t itemSize;
+	//! Number of items per chunk
+	size_t itemsPerChunk;
+	//! Number of items in use
+	size_t usedCount;
+} fmemPool;
+
 //! Creates a memory block and allocates memory when size is greater than zero
 fmem_api fmemMemoryBlock fmemCreate(const fmemType type, const size_t size);
 //! Initializes the given block or allocates memory when size is greater than zero
 fmem_api bool fmemInit(fmemMemoryBlock *block, const fmemType type, const size_t size);
 //! Initializes the given block to a fixed size block from existing source memory
 fmem_api bool fmemInitFromSource(fmemMemoryBlock *block, void *sourceMemory, const size_t sourceSize);
+//! Initializes the given block to a sub arena, that gets chunks of at least the given size from the concurrent parent block
+fmem_api bool fmemInitSubArena(fmemMemoryBlock *block, fmemMemoryBlock *parent, const size_t chunkSize);
 //! Release this and all appended memory blocks
 fmem_api void fmemFree(fmemMemoryBlock *block);
 //! Gets memory from the block by the given size
@@ -313,7 +431,7 @@ fmem_api bool fmemPushBlock(fmemMemoryBlock *src, fmemMemoryBlock *dst, const si
 fmem_api size_t fmemGetRemainingSize(fmemMemoryBlock *block);
 //! Returns the total size of all blocks starting by the given block
 fmem_api size_t fmemGetTotalSize(fmemMemoryBlock *block);
-//! Resets the given block usage to zero without freeing any memory
+//! Resets the given block usage to zero without freeing any memory (Virtual blocks give the committed pages back), concurrent blocks must not be pushed on while resetting
 fmem_api void fmemReset(fmemMemoryBlock *block);
 //! Initializes a temporary block with the remaining size of the source block
 fmem_api bool fmemBeginTemporary(fmemMemoryBlock *source, fmemMemoryBlock *temporary);
@@ -322,26 +440,123 @@ fmem_api void fmemEndTemporary(fmemMemoryBlock *temporary);
 //! Returns the block header pointer for the given block
 fmem_api fmemBlockHeader *fmemGetHeader(fmemMemoryBlock *block);
 
+//! Initializes the pool for items of the given size, that are allocated in chunks of the given item count
+fmem_api bool fmemPoolInit(fmemPool *pool, const size_t itemSize, const size_t itemsPerChunk);
+//! Releases all chunks of the pool
+fmem_api void fmemPoolFree(fmemPool *pool);
+//! Gets a single item from the pool
+fmem_api void *fmemPoolPush(fmemPool *pool, const fmemPushFlags flags);
+//! Gives a single item back to the pool
+fmem_api void fmemPoolRelease(fmemPool *pool, void *item);
+
 //! Gets memory for a struct from the block and return a pointer to the struct
 #define fmemPushStruct(block, type, flags) (type *)fmemPush(block, sizeof(type), flags)
+//! Initializes the pool for items of the given struct
+#define fmemPoolInitStruct(pool, type, itemsPerChunk) fmemPoolInit(pool, sizeof(type), itemsPerChunk)
+//! Gets a struct from the pool and return a pointer to the struct
+#define fmemPoolPushStruct(pool, type, flags) (type *)fmemPoolPush(pool, flags)
 
 #endif // FMEM_H
 
 #if defined(FMEM_IMPLEMENTATION) && !defined(FMEM_IMPLEMENTED)
 #define FMEM_IMPLEMENTED
 
+#if defined(_WIN32)
+#	include <windows.h> // VirtualAlloc, VirtualFree
+#else
+#	include <sys/mman.h> // mmap, mprotect, madvise, munmap
+#	include <unistd.h> // sysconf
+#	if !defined(MAP_ANONYMOUS)
+#		error "MAP_ANONYMOUS is not available, include the implementation before any other header or define _DEFAULT_SOURCE!"
+#	endif
+#endif
+
 //! Default spacing after the header
 #define FMEM__HEADER_SPACING sizeof(uintptr_t)
 //! Default block size = Page size
 #define FMEM__MIN_BLOCKSIZE 4096
 //! Size of the meta data for the block (Header+Spacing+Block+Spacing)
-#define FMEM__BLOCK_META_SIZE sizeof(fmemBlockHeader) + FMEM__HEADER_SPACING + sizeof(fmemMemoryBlock) + FMEM__HEADER_SPACING
+#define FMEM__BLOCK_META_SIZE (sizeof(fmemBlockHeader) + FMEM__HEADER_SPACING + sizeof(fmemMemoryBlock) + FMEM__HEADER_SPACING)
 //! Offset to block from the header
-#define FMEM__OFFSET_TO_BLOCK sizeof(fmemBlockHeader) + FMEM__HEADER_SPACING
+#define FMEM__OFFSET_TO_BLOCK (sizeof(fmemBlockHeader) + FMEM__HEADER_SPACING)
 //! Returns the header from the given block
 #define FMEM__GETHEADER(block) (fmemBlockHeader *)((uint8_t *)(block)->base - (FMEM__BLOCK_META_SIZE))
 //! Returns the header from the given block
 #define FMEM__GETBLOCK(header) (fmemMemoryBlock *)((uint8_t *)(header) + FMEM__OFFSET_TO_BLOCK)
+//! Minimum size that is committed at once for virtual blocks
+#define FMEM__VIRTUAL_COMMIT_SIZE FMEM_KILOBYTES(64)
+
+static size_t fmem__GetPageSize(void) {
+#if defined(_WIN32)
+	SYSTEM_INFO systemInfo;
+	GetSystemInfo(&systemInfo);
+	size_t result = (size_t)systemInfo.dwPageSize;
+#else
+	long pageSize = sysconf(_SC_PAGESIZE);
+	size_t result = pageSize > 0 ? (size_t)pageSize : FMEM__MIN_BLOCKSIZE;
+#endif
+	return(result);
+}
+
+// Reserves the size and one guard page after it, nothing is accessible until it is committed
+static void *fmem__ReserveVirtual(const size_t size, const size_t guardSize) {
+#if defined(_WIN32)
+	void *result = VirtualAlloc(fmem_null, size + guardSize, MEM_RESERVE, PAGE_NOACCESS);
+#else
+	void *result = mmap(fmem_null, size + guardSize, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (result == MAP_FAILED) {
+		result = fmem_null;
+	}
+#endif
+	return(result);
+}
+
+static bool fmem__CommitVirtual(void *base, const size_t size) {
+#if defined(_WIN32)
+	bool result = VirtualAlloc(base, size, MEM_COMMIT, PAGE_READWRITE) != fmem_null;
+#else
+	bool result = mprotect(base, size, PROT_READ | PROT_WRITE) == 0;
+#endif
+	return(result);
+}
+
+static void fmem__DecommitVirtual(void *base, const size_t size) {
+#if defined(_WIN32)
+	VirtualFree(base, size, MEM_DECOMMIT);
+#else
+	madvise(base, size, MADV_DONTNEED);
+	mprotect(base, size, PROT_NONE);
+#endif
+}
+
+static void fmem__ReleaseVirtual(void *base, const size_t size, const size_t guardSize) {
+#if defined(_WIN32)
+	VirtualFree(base, 0, MEM_RELEASE);
+#else
+	munmap(base, size + guardSize);
+#endif
+}
+
+static uint8_t *fmem__PushVirtual(fmemMemoryBlock *block, const size_t size) {
+	if (block->base == fmem_null || size > (block->size - block->used)) {
+		return fmem_null;
+	}
+	size_t newUsed = block->used + size;
+	if (newUsed > block->committed) {
+		// Commit in bigger steps to keep the number of system calls low
+		size_t commitEnd = ((newUsed + FMEM__VIRTUAL_COMMIT_SIZE - 1) / FMEM__VIRTUAL_COMMIT_SIZE) * FMEM__VIRTUAL_COMMIT_SIZE;
+		if (commitEnd > block->size) {
+			commitEnd = block->size;
+		}
+		if (!fmem__CommitVirtual((uint8_t *)block->base + block->committed, commitEnd - block->committed)) {
+			return fmem_null;
+		}
+		block->committed = commitEnd;
+	}
+	uint8_t *result = (uint8_t *)block->base + block->used;
+	block->used = newUsed;
+	return(result);
+}
 
 static size_t fmem__GetSpaceAvailableFor(const fmemMemoryBlock *block, const size_t size) {
 	size_t result = ((block->size > 0) && (block->used <= block->size)) ? ((block->size - block->used) - size) : 0;
@@ -395,7 +610,7 @@ fmem_api size_t fmemGetRemainingSize(fmemMemoryBlock *block) {
 			break;
 		}
 		result += fmem__GetSpaceAvailableFor(testBlock, 0);
-		if (testBlock->type != fmemType_Growable) {
+		if (testBlock->type != fmemType_Growable && testBlock->type != fmemType_Concurrent) {
 			break;
 		}
 		fmemBlockHeader *header = FMEM__GETHEADER(testBlock);
@@ -416,7 +631,7 @@ fmem_api size_t fmemGetTotalSize(fmemMemoryBlock *block) {
 		}
 		size_t sizeForBlock = testBlock->size;
 		result += sizeForBlock;
-		if (testBlock->type != fmemType_Growable) {
+		if (testBlock->type != fmemType_Growable && testBlock->type != fmemType_Concurrent) {
 			break;
 		}
 		fmemBlockHeader *header = FMEM__GETHEADER(testBlock);
@@ -436,14 +651,28 @@ fmem_api bool fmemInit(fmemMemoryBlock *block, const fmemType type, const size_t
 	if (block == fmem_null) {
 		return(false);
 	}
-	if (type == fmemType_Fixed && size == 0) {
+	if ((type == fmemType_Fixed || type == fmemType_Concurrent) && size == 0) {
 		return(false);
 	}
-	if (type == fmemType_Temporary) {
+	if (type == fmemType_Temporary || type == fmemType_SubArena) {
 		return(false);
 	}
 	FMEM_MEMSET(block, 0, sizeof(*block));
 	block->type = type;
+	if (type == fmemType_Virtual) {
+		if (size == 0) {
+			return(false);
+		}
+		size_t pageSize = fmem__GetPageSize();
+		size_t reserveSize = ((size + pageSize - 1) / pageSize) * pageSize;
+		void *base = fmem__ReserveVirtual(reserveSize, pageSize);
+		if (base == fmem_null) {
+			return(false);
+		}
+		block->base = base;
+		block->size = reserveSize;
+		return(true);
+	}
 	if (size > 0) {
 		size_t blockSize;
 		size_t metaSize = FMEM__BLOCK_META_SIZE;
@@ -477,10 +706,89 @@ fmem_api bool fmemInitFromSource(fmemMemoryBlock *block, void *sourceMemory, con
 	return(true);
 }
 
+fmem_api bool fmemInitSubArena(fmemMemoryBlock *block, fmemMemoryBlock *parent, const size_t chunkSize) {
+	if (block == fmem_null || parent == fmem_null || chunkSize == 0) {
+		return(false);
+	}
+	// Chunks are taken from the parent by many threads, which is only safe for concurrent blocks
+	if (parent->type != fmemType_Concurrent) {
+		return(false);
+	}
+	// The first chunk is taken on the first push
+	FMEM_MEMSET(block, 0, sizeof(*block));
+	block->type = fmemType_SubArena;
+	block->source = parent;
+	block->chunkSize = chunkSize;
+	return(true);
+}
+
+static uint8_t *fmem__PushConcurrent(fmemMemoryBlock *block, const size_t size) {
+	for (;;) {
+		fmemMemoryBlock *currentBlock = (fmemMemoryBlock *)FMEM_ATOMIC_LOAD_PTR(&block->current);
+		if (currentBlock == fmem_null) {
+			currentBlock = block;
+		}
+		size_t used = FMEM_ATOMIC_LOAD_SIZE(&currentBlock->used);
+		if ((used + size) <= currentBlock->size) {
+			if (FMEM_ATOMIC_CAS_SIZE(&currentBlock->used, used + size, used) == used) {
+				uint8_t *result = (uint8_t *)currentBlock->base + used;
+				return(result);
+			}
+			continue;
+		}
+
+		// Current block is full, only one thread switches to the next block while the others spin
+		if (FMEM_ATOMIC_CAS_SIZE(&block->lock, 1, 0) != 0) {
+			continue;
+		}
+		fmemMemoryBlock *lockedBlock = (fmemMemoryBlock *)FMEM_ATOMIC_LOAD_PTR(&block->current);
+		if (lockedBlock == fmem_null) {
+			lockedBlock = block;
+		}
+		if (lockedBlock == currentBlock) {
+			// Blocks after the current block are unused since the last reset, so they are reused in order
+			fmemBlockHeader *currentHeader = FMEM__GETHEADER(currentBlock);
+			fmemMemoryBlock *nextBlock = currentHeader->next;
+			if (nextBlock != fmem_null && nextBlock->size >= size) {
+				nextBlock->used = 0;
+			} else {
+				size_t minSize = size > block->size ? size : block->size;
+				size_t blockSize = fmem__ComputeBlockSize(minSize + FMEM__BLOCK_META_SIZE);
+				fmemBlockHeader *newHeader = fmem__AllocateBlock(blockSize);
+				if (newHeader == fmem_null) {
+					FMEM_ATOMIC_CAS_SIZE(&block->lock, 0, 1);
+					return fmem_null;
+				}
+				fmemMemoryBlock *newBlock = FMEM__GETBLOCK(newHeader);
+				newBlock->base = (uint8_t *)newHeader + FMEM__BLOCK_META_SIZE;
+				newBlock->size = blockSize - FMEM__BLOCK_META_SIZE;
+				newBlock->type = fmemType_Concurrent;
+
+				// Insert after the current block
+				newHeader->prev = currentBlock;
+				newHeader->next = nextBlock;
+				if (nextBlock != fmem_null) {
+					fmemBlockHeader *nextHeader = FMEM__GETHEADER(nextBlock);
+					nextHeader->prev = newBlock;
+				}
+				currentHeader->next = newBlock;
+				nextBlock = newBlock;
+			}
+			FMEM_ATOMIC_STORE_PTR(&block->current, nextBlock);
+		}
+		FMEM_ATOMIC_CAS_SIZE(&block->lock, 0, 1);
+	}
+}
+
 fmem_api void fmemFree(fmemMemoryBlock *block) {
+	if ((block != fmem_null) && (block->type == fmemType_Virtual) && (block->base != fmem_null)) {
+		fmem__ReleaseVirtual(block->base, block->size, fmem__GetPageSize());
+		FMEM_MEMSET(block, 0, sizeof(*block));
+		return;
+	}
 	if ((block != fmem_null) &&
 		(block->temporary == fmem_null) &&
-		(block->source != fmem_null)) {
+		(block->source == fmem_null)) {
 		fmemMemoryBlock *freeBlock = block;
 		while (freeBlock != fmem_null) {
 			if (freeBlock->base == fmem_null || freeBlock->size == 0 || freeBlock->source != fmem_null) {
@@ -503,6 +811,50 @@ fmem_api uint8_t *fmemPush(fmemMemoryBlock *block, const size_t size, const fmem
 		return fmem_null;
 	}
 
+	if (block->type == fmemType_Virtual) {
+		uint8_t *virtualResult = fmem__PushVirtual(block, size);
+		if (virtualResult != fmem_null && (flags & fmemPushFlags_Clear)) {
+			FMEM_MEMSET(virtualResult, 0, size);
+		}
+		return(virtualResult);
+	}
+
+	if (block->type == fmemType_Concurrent) {
+		uint8_t *concurrentResult = fmem__PushConcurrent(block, size);
+		if (concurrentResult != fmem_null && (flags & fmemPushFlags_Clear)) {
+			FMEM_MEMSET(concurrentResult, 0, size);
+		}
+		return(concurrentResult);
+	}
+
+	// Bump on the current block, this is the common case
+	fmemMemoryBlock *currentBlock = block->current != fmem_null ? block->current : block;
+	if (currentBlock->base != fmem_null && (currentBlock->used + size) <= currentBlock->size) {
+		uint8_t *bumped = (uint8_t *)currentBlock->base + currentBlock->used;
+		currentBlock->used += size;
+		if (flags & fmemPushFlags_Clear) {
+			FMEM_MEMSET(bumped, 0, size);
+		}
+		return(bumped);
+	}
+
+	// Sub arenas take a new chunk from the source block, the rest of the previous chunk is left unused
+	if (block->type == fmemType_SubArena) {
+		fmemMemoryBlock *parent = (fmemMemoryBlock *)block->source;
+		size_t chunkSize = size > block->chunkSize ? size : block->chunkSize;
+		uint8_t *chunk = fmemPush(parent, chunkSize, fmemPushFlags_None);
+		if (chunk == fmem_null) {
+			return fmem_null;
+		}
+		block->base = chunk;
+		block->size = chunkSize;
+		block->used = size;
+		if (flags & fmemPushFlags_Clear) {
+			FMEM_MEMSET(chunk, 0, size);
+		}
+		return(chunk);
+	}
+
 	// Find best fitting block (Most space available after append)
 	fmemMemoryBlock *bestBlock = fmem_null;
 	fmemMemoryBlock *searchBlock = block;
@@ -535,6 +887,9 @@ fmem_api uint8_t *fmemPush(fmemMemoryBlock *block, const size_t size, const fmem
 	if (bestBlock != fmem_null) {
 		result = (uint8_t *)bestBlock->base + bestBlock->used;
 		bestBlock->used += size;
+		if (block->type == fmemType_Growable) {
+			block->current = bestBlock != block ? bestBlock : fmem_null;
+		}
 		goto done;
 	} else {
 		if (block->type != fmemType_Growable) {
@@ -570,6 +925,7 @@ fmem_api uint8_t *fmemPush(fmemMemoryBlock *block, const size_t size, const fmem
 		block->base = (uint8_t *)newHeader + FMEM__BLOCK_META_SIZE;
 		block->used = size;
 		block->source = fmem_null;
+		block->current = fmem_null;
 		result = (uint8_t *)block->base;
 		goto done;
 	}
@@ -587,6 +943,7 @@ fmem_api uint8_t *fmemPush(fmemMemoryBlock *block, const size_t size, const fmem
 	tailHeader = FMEM__GETHEADER(tailBlock);
 	tailHeader->next = newBlock;
 
+	block->current = newBlock;
 	result = (uint8_t *)newBlock->base;
 done:
 	if (result != fmem_null) {
@@ -614,6 +971,7 @@ fmem_api bool fmemPushBlock(fmemMemoryBlock *src, fmemMemoryBlock *dst, const si
 	dst->size = size;
 	dst->used = 0;
 	dst->source = src;
+	dst->current = fmem_null;
 	dst->type = fmemType_Fixed;
 	return(true);
 }
@@ -621,6 +979,15 @@ fmem_api bool fmemPushBlock(fmemMemoryBlock *src, fmemMemoryBlock *dst, const si
 fmem_api void fmemReset(fmemMemoryBlock *block) {
 	if (block != fmem_null && block->temporary == fmem_null) {
 		block->used = 0;
+		block->current = fmem_null;
+		if (block->type == fmemType_SubArena) {
+			// The chunk belongs to the source block, which is reset as well
+			block->base = fmem_null;
+			block->size = 0;
+		} else if (block->type == fmemType_Virtual && block->committed > 0) {
+			fmem__DecommitVirtual(block->base, block->committed);
+			block->committed = 0;
+		}
 	}
 }
 
@@ -631,6 +998,9 @@ fmem_api bool fmemBeginTemporary(fmemMemoryBlock *source, fmemMemoryBlock *tempo
 	if (source->base == fmem_null || source->size == 0) {
 		return(false);
 	}
+	if (source->type == fmemType_Concurrent || source->type == fmemType_Virtual) {
+		return(false);
+	}
 	size_t remainingSize = fmemGetRemainingSize(source);
 	if (remainingSize == 0) {
 		return(false);
@@ -668,4 +1038,64 @@ fmem_api void fmemEndTemporary(fmemMemoryBlock *temporary) {
 	FMEM_MEMSET(temporary, 0, sizeof(*temporary));
 }
 
+fmem_api bool fmemPoolInit(fmemPool *pool, const size_t itemSize, const size_t itemsPerChunk) {
+	if (pool == fmem_null || itemSize == 0 || itemsPerChunk == 0) {
+		return(false);
+	}
+	FMEM_MEMSET(pool, 0, sizeof(*pool));
+	// Free items store the pointer to the next free item, so each item is pointer sized and aligned
+	pool->itemSize = ((itemSize + sizeof(void *) - 1) / sizeof(void *)) * sizeof(void *);
+	pool->itemsPerChunk = itemsPerChunk;
+	if (!fmemInit(&pool->memory, fmemType_Growable, 0)) {
+		return(false);
+	}
+	return(true);
+}
+
+fmem_api void fmemPoolFree(fmemPool *pool) {
+	if (pool != fmem_null) {
+		fmemFree(&pool->memory);
+		FMEM_MEMSET(pool, 0, sizeof(*pool));
+	}
+}
+
+fmem_api void *fmemPoolPush(fmemPool *pool, const fmemPushFlags flags) {
+	if (pool == fmem_null || pool->itemSize == 0) {
+		return fmem_null;
+	}
+	void *result;
+	if (pool->firstFree != fmem_null) {
+		result = pool->firstFree;
+		pool->firstFree = *(void **)result;
+	} else {
+		if (pool->chunkCursor == pool->chunkEnd) {
+			// Items of a new chunk are not linked into the free list, they are handed out in order
+			size_t chunkSize = pool->itemSize * pool->itemsPerChunk;
+			uint8_t *chunk = fmemPush(&pool->memory, chunkSize, fmemPushFlags_None);
+			if (chunk == fmem_null) {
+				return fmem_null;
+			}
+			pool->chunkCursor = chunk;
+			pool->chunkEnd = chunk + chunkSize;
+		}
+		result = pool->chunkCursor;
+		pool->chunkCursor += pool->itemSize;
+	}
+	++pool->usedCount;
+	if (flags & fmemPushFlags_Clear) {
+		FMEM_MEMSET(result, 0, pool->itemSize);
+	}
+	return(result);
+}
+
+fmem_api void fmemPoolRelease(fmemPool *pool, void *item) {
+	if (pool == fmem_null || item == fmem_null) {
+		return;
+	}
+	FMEM_ASSERT(pool->usedCount > 0);
+	*(void **)item = pool->firstFree;
+	pool->firstFree = item;
+	--pool->usedCount;
+}
+
 #endif // FMEM_IMPLEMENTATION
\ No newline at end of file
@@ -192,6 +192,9 @@ SOFTWARE.
 	- New: Added function fplGetCPUCapabilitiesTypeName() that returns the name of a @ref fplCPUCapabilitiesType
 	- New: Added function fplGetTargetAudioFrameCount() that computes the target audio frames for an input/out sample rate from number of input frames
 	- New: Added field manualLoad to @ref fplAudioSettings that controls the initialization behavior of the audio system
+	- New: Added function fplDirectoryScan() that scans directories recursively in parallel and reports the entries while scanning
+	- New: Added enum fplDirectoryScanFlags that controls the recursion and the details of a directory scan
+	- Fixed: fplCPUID() and fplCPUXCR0() was always failing on GCC/Clang, so fplCPUGetCapabilities() returned no capabilities
 	- Fixed: fplCreateColorRGBA() was not compiling on GCC due to inlining failing
 	- Fixed: fplCreateVideoRectFromLTRB() was not compiling on GCC due to inlining failing
     - Fixed: fpl__VideoBackend_Vulkan_PrepareWindow() was crashing due to invalid free of memory
@@ -6888,6 +6891,50 @@ fpl_platform_api bool fplDirectoryListNext(fplFileEntry *entry);
 */
 fpl_platform_api void fplDirectoryListEnd(fplFileEntry *entry);
 
+/**
+* @enum fplDirectoryScanFlags
+* @brief An enumeration of directory scan flags.
+*/
+typedef enum fplDirectoryScanFlags {
+	//! No flags, scans the first level only and reports files and directories with all details.
+	fplDirectoryScanFlags_None = 0,
+	//! Scans all sub-directories as well.
+	fplDirectoryScanFlags_Recursive = 1 << 0,
+	//! Reports files only.
+	fplDirectoryScanFlags_FilesOnly = 1 << 1,
+	//! Reports the name and type only, so no time stamps, permissions and size needs to be queried per entry.
+	fplDirectoryScanFlags_NameAndTypeOnly = 1 << 2,
+} fplDirectoryScanFlags;
+//! fplDirectoryScanFlags operator overloads for C++.
+FPL_ENUM_AS_FLAGS_OPERATORS(fplDirectoryScanFlags);
+
+/**
+* @brief A callback for reporting a found file or directory from @ref fplDirectoryScan().
+* @param[in] fullPath The full path to the file or directory.
+* @param[in] entry Reference to the file entry structure @ref fplFileEntry, the internal handle and root info are not set.
+* @param[in] userData The user data pointer.
+* @return Returns true to continue scanning, false to stop the scan.
+* @note This callback is called from multiple threads at the same time!
+*/
+typedef bool (fpl_directory_scan_callback)(const char *fullPath, const fplFileEntry *entry, void *userData);
+
+/**
+* @brief Scans the given directory in parallel and reports each found file/directory to the callback.
+* @param[in] path The full path to the root directory.
+* @param[in] filter The filter wildcard for the reported entries (If empty or null it will not filter anything at all).
+* @param[in] flags The @ref fplDirectoryScanFlags.
+* @param[in] threadCount The number of threads including the calling thread (Zero uses the number of CPU cores).
+* @param[in] callback The @ref fpl_directory_scan_callback that is called for each found entry.
+* @param[in] userData The user data pointer passed to the callback.
+* @return Returns true when the root directory was scanned or the scan was stopped by the callback, false otherwise.
+* @note This function blocks until all directories are scanned, the entries are reported while scanning.
+* @note Directories are processed from a shared work queue, so the order of the reported entries is undefined.
+* @note Symbolic links to directories are reported but not followed.
+* @note The platform must be initialized, because it uses threads and synchronization primitives.
+* @see @ref section_category_io_paths_traversing
+*/
+fpl_common_api bool fplDirectoryScan(const char *path, const char *filter, const fplDirectoryScanFlags flags, const uint32_t threadCount, fpl_directory_scan_callback *callback, void *userData);
+
 /** @} */
 
 // ----------------------------------------------------------------------------
@@ -9910,6 +9957,7 @@ typedef struct fpl__Win32WindowState {
 #endif
 
 #if defined(FPL_PLATFORM_LINUX)
+#	include <sys/syscall.h> // SYS_getdents64
 #	define fpl__lseek64 lseek64
 #	define fpl__off64_t off64_t
 #else
@@ -11651,6 +11699,7 @@ fpl_internal void fpl__m_CPUID(fplCPUIDLeaf *outLeaf, const uint32_t functionId)
 	outLeaf->ecx = ecx;
 	outLeaf->edx = edx;
 }
+#		define fpl__m_CPUID fpl__m_CPUID
 
 		// XCR0 for GCC/CLANG
 fpl_internal uint64_t fpl__m_GetXCR0(void) {
@@ -11658,6 +11707,7 @@ fpl_internal uint64_t fpl__m_GetXCR0(void) {
 	__asm(".byte 0x0F, 0x01, 0xd0" : "=a"(eax), "=d"(edx) : "c"(0));
 	return eax;
 }
+#		define fpl__m_GetXCR0 fpl__m_GetXCR0
 
 		// RDTSC for non-MSVC
 #		if defined(FPL_ARCH_X86)
@@ -12136,6 +12186,173 @@ fpl_common_api size_t fplFileGetSizeFromHandle(const fplFileHandle *fileHandle)
 
 #endif // FPL__COMMON_FILES_DEFINED
 
+//
+// Common Directory Scan
+//
+#if !defined(FPL__COMMON_DIRECTORY_SCAN_DEFINED)
+#define FPL__COMMON_DIRECTORY_SCAN_DEFINED
+
+#define FPL__MAX_DIRECTORY_SCAN_THREAD_COUNT 64
+
+typedef struct fpl__DirectoryScanState {
+	fplMutexHandle lock;
+	fplConditionVariable condition;
+	char **directories;
+	size_t directoryCount;
+	size_t directoryCapacity;
+	const char *filter;
+	fpl_directory_scan_callback *callback;
+	void *userData;
+	fplDirectoryScanFlags flags;
+	uint32_t activeCount;
+	volatile int32_t isStopped;
+} fpl__DirectoryScanState;
+
+// Lists a single directory and passes all entries to fpl__DirectoryScanHandleEntry(), implemented per platform
+fpl_internal void fpl__PlatformDirectoryScanList(fpl__DirectoryScanState *state, const char *directoryPath);
+
+fpl_internal void fpl__DirectoryScanPush(fpl__DirectoryScanState *state, const char *directoryPath) {
+	size_t pathLen = fplGetStringLength(directoryPath);
+	char *pathCopy = (char *)fpl__AllocateDynamicMemory(pathLen + 1, 8);
+	if (pathCopy == fpl_null) {
+		return;
+	}
+	fplCopyStringLen(directoryPath, pathLen, pathCopy, pathLen + 1);
+	fplMutexLock(&state->lock);
+	if (state->directoryCount == state->directoryCapacity) {
+		size_t newCapacity = state->directoryCapacity > 0 ? state->directoryCapacity * 2 : 64;
+		char **newDirectories = (char **)fpl__AllocateDynamicMemory(sizeof(char *) * newCapacity, 8);
+		if (newDirectories == fpl_null) {
+			fplMutexUnlock(&state->lock);
+			fpl__ReleaseDynamicMemory(pathCopy);
+			return;
+		}
+		if (state->directories != fpl_null) {
+			fplMemoryCopy(state->directories, sizeof(char *) * state->directoryCount, newDirectories);
+			fpl__ReleaseDynamicMemory(state->directories);
+		}
+		state->directories = newDirectories;
+		state->directoryCapacity = newCapacity;
+	}
+	state->directories[state->directoryCount++] = pathCopy;
+	fplMutexUnlock(&state->lock);
+	fplConditionSignal(&state->condition);
+}
+
+// Reports the entry and queues up directories for recursion, returns false when the scan was stopped
+fpl_internal bool fpl__DirectoryScanHandleEntry(fpl__DirectoryScanState *state, const char *fullPath, const fplFileEntry *entry, const bool canRecurse) {
+	if (fplAtomicLoadS32(&state->isStopped)) {
+		return(false);
+	}
+	bool isDirectory = entry->type == fplFileEntryType_Directory;
+	if (isDirectory && canRecurse && (state->flags & fplDirectoryScanFlags_Recursive)) {
+		fpl__DirectoryScanPush(state, fullPath);
+	}
+	if (isDirectory && (state->flags & fplDirectoryScanFlags_FilesOnly)) {
+		return(true);
+	}
+	if (state->filter != fpl_null && !fplIsStringMatchWildcard(entry->name, state->filter)) {
+		return(true);
+	}
+	if (!state->callback(fullPath, entry, state->userData)) {
+		fplAtomicStoreS32(&state->isStopped, 1);
+		fplConditionBroadcast(&state->condition);
+		return(false);
+	}
+	return(true);
+}
+
+fpl_internal void fpl__DirectoryScanWork(fpl__DirectoryScanState *state) {
+	fplMutexLock(&state->lock);
+	for (;;) {
+		// Wait while other threads may still produce directories
+		while (state->directoryCount == 0 && state->activeCount > 0 && !fplAtomicLoadS32(&state->isStopped)) {
+			fplConditionWait(&state->condition, &state->lock, FPL_TIMEOUT_INFINITE);
+		}
+		if (state->directoryCount == 0 || fplAtomicLoadS32(&state->isStopped)) {
+			break;
+		}
+		char *directoryPath = state->directories[--state->directoryCount];
+		++state->activeCount;
+		fplMutexUnlock(&state->lock);
+
+		fpl__PlatformDirectoryScanList(state, directoryPath);
+		fpl__ReleaseDynamicMemory(directoryPath);
+
+		fplMutexLock(&state->lock);
+		--state->activeCount;
+		if (state->activeCount == 0) {
+			fplConditionBroadcast(&state->condition);
+		}
+	}
+	fplMutexUnlock(&state->lock);
+}
+
+fpl_internal void fpl__DirectoryScanThreadProc(const fplThreadHandle *thread, void *data) {
+	fpl__DirectoryScanState *state = (fpl__DirectoryScanState *)data;
+	fpl__DirectoryScanWork(state);
+}
+
+fpl_common_api bool fplDirectoryScan(const char *path, const char *filter, const fplDirectoryScanFlags flags, const uint32_t threadCount, fpl_directory_scan_callback *callback, void *userData) {
+	FPL__CheckArgumentNull(path, false);
+	FPL__CheckArgumentNull(callback, false);
+	if (!fplDirectoryExists(path)) {
+		return(false);
+	}
+
+	fpl__DirectoryScanState state = fplZeroInit;
+	if (!fplMutexInit(&state.lock)) {
+		return(false);
+	}
+	if (!fplConditionInit(&state.condition)) {
+		fplMutexDestroy(&state.lock);
+		return(false);
+	}
+	if (fplGetStringLength(filter) > 0 && !fplIsStringEqual(filter, "*")) {
+		state.filter = filter;
+	}
+	state.flags = flags;
+	state.callback = callback;
+	state.userData = userData;
+
+	fpl__DirectoryScanPush(&state, path);
+
+	// The calling thread is the first worker, additional threads are only used for recursive scans
+	size_t workerCount = threadCount > 0 ? threadCount : fplCPUGetCoreCount();
+	workerCount = fplMax(fplMin(workerCount, (size_t)FPL__MAX_DIRECTORY_SCAN_THREAD_COUNT), (size_t)1);
+	if (!(flags & fplDirectoryScanFlags_Recursive)) {
+		workerCount = 1;
+	}
+	fplThreadHandle *threads[FPL__MAX_DIRECTORY_SCAN_THREAD_COUNT];
+	size_t createdThreadCount = 0;
+	for (size_t i = 1; i < workerCount; ++i) {
+		fplThreadHandle *thread = fplThreadCreate(fpl__DirectoryScanThreadProc, &state);
+		if (thread == fpl_null) {
+			break;
+		}
+		threads[createdThreadCount++] = thread;
+	}
+
+	fpl__DirectoryScanWork(&state);
+
+	if (createdThreadCount > 0) {
+		fplThreadWaitForAll(threads, createdThreadCount, sizeof(fplThreadHandle *), FPL_TIMEOUT_INFINITE);
+	}
+
+	// Remaining directories when the scan was stopped
+	for (size_t i = 0; i < state.directoryCount; ++i) {
+		fpl__ReleaseDynamicMemory(state.directories[i]);
+	}
+	if (state.directories != fpl_null) {
+		fpl__ReleaseDynamicMemory(state.directories);
+	}
+	fplConditionDestroy(&state.condition);
+	fplMutexDestroy(&state.lock);
+	return(true);
+}
+
+#endif // FPL__COMMON_DIRECTORY_SCAN_DEFINED
+
 //
 // Common Paths
 //
@@ -15483,6 +15700,39 @@ fpl_platform_api void fplDirectoryListEnd(fplFileEntry *entry) {
 	}
 }
 
+fpl_internal void fpl__PlatformDirectoryScanList(fpl__DirectoryScanState *state, const char *directoryPath) {
+	char pathAndFilter[FPL_MAX_PATH_LENGTH];
+	fplCopyString(directoryPath, pathAndFilter, fplArrayCount(pathAndFilter));
+	fplEnforcePathSeparatorLen(pathAndFilter, fplArrayCount(pathAndFilter));
+	fplStringAppend("*", pathAndFilter, fplArrayCount(pathAndFilter));
+	wchar_t pathAndFilterWide[FPL_MAX_PATH_LENGTH];
+	fplUTF8StringToWideString(pathAndFilter, fplGetStringLength(pathAndFilter), pathAndFilterWide, fplArrayCount(pathAndFilterWide));
+
+	// @NOTE(final): Basic info skips the short names and large fetch returns more entries per call
+	WIN32_FIND_DATAW findData;
+	HANDLE searchHandle = FindFirstFileExW(pathAndFilterWide, FindExInfoBasic, &findData, FindExSearchNameMatch, fpl_null, FIND_FIRST_EX_LARGE_FETCH);
+	if (searchHandle == INVALID_HANDLE_VALUE) {
+		return;
+	}
+	do {
+		if (lstrcmpW(findData.cFileName, L".") == 0 || lstrcmpW(findData.cFileName, L"..") == 0) {
+			continue;
+		}
+		fplFileEntry entry;
+		fplClearStruct(&entry);
+		fpl__Win32FillFileEntry(directoryPath, &findData, &entry);
+		char fullPath[FPL_MAX_PATH_LENGTH];
+		fplCopyString(directoryPath, fullPath, fplArrayCount(fullPath));
+		fplEnforcePathSeparatorLen(fullPath, fplArrayCount(fullPath));
+		fplStringAppend(entry.name, fullPath, fplArrayCount(fullPath));
+		bool canRecurse = !(findData.dwFileAttributes & FILE_ATTRIBUTE_REPARSE_POINT);
+		if (!fpl__DirectoryScanHandleEntry(state, fullPath, &entry, canRecurse)) {
+			break;
+		}
+	} while (FindNextFileW(searchHandle, &findData) == TRUE);
+	FindClose(searchHandle);
+}
+
 //
 // Win32 Path/Directories
 //
@@ -17774,17 +18024,12 @@ fpl_platform_api bool fplRemoveDirectory(const char *path) {
 	return(result);
 }
 
-fpl_internal void fpl__PosixFillFileEntry(struct dirent *dp, fplFileEntry *entry) {
-	fplAssert((dp != fpl_null) && (entry != fpl_null));
-	fplCopyString(dp->d_name, entry->name, fplArrayCount(entry->name));
+fpl_internal void fpl__PosixFillFileEntryFromPath(const char *fullPath, fplFileEntry *entry) {
+	fplAssert((fullPath != fpl_null) && (entry != fpl_null));
 	entry->type = fplFileEntryType_Unknown;
 	entry->attributes = fplFileAttributeFlags_None;
 	entry->size = 0;
 	entry->permissions.umask = 0;
-	char fullPath[FPL_MAX_PATH_LENGTH];
-	fplCopyString(entry->internalRoot.rootPath, fullPath, fplArrayCount(fullPath));
-	fplEnforcePathSeparatorLen(fullPath, fplArrayCount(fullPath));
-	fplStringAppend(dp->d_name, fullPath, fplArrayCount(fullPath));
 	struct stat sb;
 	if (stat(fullPath, &sb) == 0) {
 		if (S_ISDIR(sb.st_mode)) {
@@ -17793,7 +18038,7 @@ fpl_internal void fpl__PosixFillFileEntry(struct dirent *dp, fplFileEntry *entry
 			entry->type = fplFileEntryType_File;
 		}
 		entry->size = (size_t)sb.st_size;
-		if (dp->d_name[0] == '.') {
+		if (entry->name[0] == '.') {
 			// @NOTE(final): Any filename starting with dot is hidden in POSIX
 			entry->attributes |= fplFileAttributeFlags_Hidden;
 		}
@@ -17827,6 +18072,16 @@ fpl_internal void fpl__PosixFillFileEntry(struct dirent *dp, fplFileEntry *entry
 	}
 }
 
+fpl_internal void fpl__PosixFillFileEntry(struct dirent *dp, fplFileEntry *entry) {
+	fplAssert((dp != fpl_null) && (entry != fpl_null));
+	fplCopyString(dp->d_name, entry->name, fplArrayCount(entry->name));
+	char fullPath[FPL_MAX_PATH_LENGTH];
+	fplCopyString(entry->internalRoot.rootPath, fullPath, fplArrayCount(fullPath));
+	fplEnforcePathSeparatorLen(fullPath, fplArrayCount(fullPath));
+	fplStringAppend(dp->d_name, fullPath, fplArrayCount(fullPath));
+	fpl__PosixFillFileEntryFromPath(fullPath, entry);
+}
+
 fpl_platform_api bool fplDirectoryListBegin(const char *path, const char *filter, fplFileEntry *entry) {
 	FPL__CheckArgumentNull(path, false);
 	FPL__CheckArgumentNull(entry, false);
@@ -17881,6 +18136,90 @@ fpl_platform_api void fplDirectoryListEnd(fplFileEntry *entry) {
 	}
 }
 
+// Returns false when the scan was stopped
+fpl_internal bool fpl__PosixDirectoryScanEntry(fpl__DirectoryScanState *state, const char *directoryPath, const char *name, const unsigned char direntType) {
+	if ((name[0] == '.' && name[1] == 0) || (name[0] == '.' && name[1] == '.' && name[2] == 0)) {
+		return(true);
+	}
+	char fullPath[FPL_MAX_PATH_LENGTH];
+	fplCopyString(directoryPath, fullPath, fplArrayCount(fullPath));
+	fplEnforcePathSeparatorLen(fullPath, fplArrayCount(fullPath));
+	fplStringAppend(name, fullPath, fplArrayCount(fullPath));
+
+	fplFileEntry entry;
+	fplClearStruct(&entry);
+	fplCopyString(name, entry.name, fplArrayCount(entry.name));
+
+	// @NOTE(final): The dirent type avoids a stat() per entry, when only the name and type are required
+	bool canRecurse = true;
+	if (direntType == DT_DIR) {
+		entry.type = fplFileEntryType_Directory;
+	} else if (direntType == DT_REG) {
+		entry.type = fplFileEntryType_File;
+	} else if (direntType == DT_LNK) {
+		canRecurse = false;
+	}
+	if (entry.type == fplFileEntryType_Unknown || !(state->flags & fplDirectoryScanFlags_NameAndTypeOnly)) {
+		fpl__PosixFillFileEntryFromPath(fullPath, &entry);
+	}
+	if (direntType == DT_UNKNOWN && entry.type == fplFileEntryType_Directory) {
+		struct stat sb;
+		canRecurse = (lstat(fullPath, &sb) == 0) && !S_ISLNK(sb.st_mode);
+	}
+	bool result = fpl__DirectoryScanHandleEntry(state, fullPath, &entry, canRecurse);
+	return(result);
+}
+
+#if defined(FPL_PLATFORM_LINUX)
+typedef struct fpl__LinuxDirent64 {
+	uint64_t d_ino;
+	int64_t d_off;
+	unsigned short d_reclen;
+	unsigned char d_type;
+	char d_name[1];
+} fpl__LinuxDirent64;
+#endif
+
+fpl_internal void fpl__PlatformDirectoryScanList(fpl__DirectoryScanState *state, const char *directoryPath) {
+#if defined(FPL_PLATFORM_LINUX)
+	// @NOTE(final): getdents64 returns a batch of entries per syscall, instead of one readdir() call per entry
+	int fd = open(directoryPath, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+	if (fd == -1) {
+		return;
+	}
+	uint64_t buffer[4096];
+	bool isRunning = true;
+	while (isRunning) {
+		long bytesRead = syscall(SYS_getdents64, fd, buffer, sizeof(buffer));
+		if (bytesRead <= 0) {
+			break;
+		}
+		const uint8_t *p = (const uint8_t *)buffer;
+		for (long offset = 0; offset < bytesRead;) {
+			const fpl__LinuxDirent64 *dp = (const fpl__LinuxDirent64 *)(p + offset);
+			if (!fpl__PosixDirectoryScanEntry(state, directoryPath, dp->d_name, dp->d_type)) {
+				isRunning = false;
+				break;
+			}
+			offset += dp->d_reclen;
+		}
+	}
+	close(fd);
+#else
+	DIR *dir = opendir(directoryPath);
+	if (dir == fpl_null) {
+		return;
+	}
+	struct dirent *dp;
+	while ((dp = readdir(dir)) != fpl_null) {
+		if (!fpl__PosixDirectoryScanEntry(state, directoryPath, dp->d_name, dp->d_type)) {
+			break;
+		}
+	}
+	closedir(dir);
+#endif
+}
+
 //
 // POSIX Operating System
 //